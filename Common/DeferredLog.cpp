@@ -0,0 +1,331 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+#include "Common/DeferredLog.h"
+
+enum class FormatLength {
+	NONE,
+	HH,
+	H,
+	L,
+	LL,
+	Z,
+	J,
+	T,
+	BIG_L,
+};
+
+struct FormatSpec {
+	const char *flags;
+	int flagsLen;
+	const char *width;
+	int widthLen;
+	bool widthStar;
+	bool hasPrecision;
+	const char *precision;
+	int precisionLen;
+	bool precisionStar;
+	const char *length;
+	int lengthLen;
+	FormatLength lengthType;
+	char conv;
+};
+
+// p points just after the %.  Returns the position after the conversion, or nullptr if unsupported.
+static const char *ParseFormatSpec(const char *p, FormatSpec *spec) {
+	spec->flags = p;
+	while (*p && strchr("-+ #0'", *p))
+		p++;
+	spec->flagsLen = (int)(p - spec->flags);
+
+	spec->width = p;
+	spec->widthStar = *p == '*';
+	if (spec->widthStar)
+		p++;
+	else while (*p >= '0' && *p <= '9')
+		p++;
+	spec->widthLen = (int)(p - spec->width);
+
+	spec->hasPrecision = *p == '.';
+	spec->precisionStar = false;
+	if (spec->hasPrecision)
+		p++;
+	spec->precision = p;
+	if (spec->hasPrecision) {
+		spec->precisionStar = *p == '*';
+		if (spec->precisionStar)
+			p++;
+		else while (*p >= '0' && *p <= '9')
+			p++;
+	}
+	spec->precisionLen = (int)(p - spec->precision);
+
+	spec->length = p;
+	switch (*p) {
+	case 'h':
+		p++;
+		spec->lengthType = *p == 'h' ? FormatLength::HH : FormatLength::H;
+		if (*p == 'h')
+			p++;
+		break;
+	case 'l':
+		p++;
+		spec->lengthType = *p == 'l' ? FormatLength::LL : FormatLength::L;
+		if (*p == 'l')
+			p++;
+		break;
+	case 'z': p++; spec->lengthType = FormatLength::Z; break;
+	case 'j': p++; spec->lengthType = FormatLength::J; break;
+	case 't': p++; spec->lengthType = FormatLength::T; break;
+	case 'L': p++; spec->lengthType = FormatLength::BIG_L; break;
+	default: spec->lengthType = FormatLength::NONE; break;
+	}
+	spec->lengthLen = (int)(p - spec->length);
+
+	spec->conv = *p;
+	if (!*p || !strchr("diouxXcsfFeEgGaAp", *p))
+		return nullptr;
+	// Wide characters and long doubles aren't worth supporting.
+	if ((spec->conv == 's' || spec->conv == 'c') && spec->lengthType != FormatLength::NONE)
+		return nullptr;
+	if (spec->lengthType == FormatLength::BIG_L)
+		return nullptr;
+	return p + 1;
+}
+
+static bool IsIntegerConv(char c) {
+	return strchr("diouxXc", c) != nullptr;
+}
+
+static bool IsFloatConv(char c) {
+	return strchr("fFeEgGaA", c) != nullptr;
+}
+
+class ArgWriter {
+public:
+	ArgWriter(u8 *data, size_t size) : data_(data), size_(size) {}
+
+	bool Write(const void *src, size_t sz) {
+		if (pos_ + sz > size_)
+			return false;
+		memcpy(data_ + pos_, src, sz);
+		pos_ += sz;
+		return true;
+	}
+	size_t Remaining() const {
+		return size_ - pos_;
+	}
+	size_t Pos() const {
+		return pos_;
+	}
+
+private:
+	u8 *data_;
+	size_t size_;
+	size_t pos_ = 0;
+};
+
+class ArgReader {
+public:
+	ArgReader(const u8 *data, size_t size) : data_(data), size_(size) {}
+
+	template <typename T>
+	T Read() {
+		T value{};
+		if (pos_ + sizeof(T) <= size_)
+			memcpy(&value, data_ + pos_, sizeof(T));
+		pos_ += sizeof(T);
+		return value;
+	}
+	const char *ReadBytes(size_t sz) {
+		const char *p = (const char *)data_ + pos_;
+		pos_ += sz;
+		return pos_ <= size_ ? p : nullptr;
+	}
+
+private:
+	const u8 *data_;
+	size_t size_;
+	size_t pos_ = 0;
+};
+
+static const u16 NULL_STRING = 0xFFFF;
+
+bool DeferredLogCapture(DeferredLogRecord *rec, const char *format, va_list args) {
+	ArgWriter writer(rec->args, sizeof(rec->args));
+	for (const char *p = format; *p; ) {
+		if (*p++ != '%')
+			continue;
+		if (*p == '%') {
+			p++;
+			continue;
+		}
+
+		FormatSpec spec;
+		p = ParseFormatSpec(p, &spec);
+		if (!p)
+			return false;
+
+		if (spec.widthStar) {
+			int width = va_arg(args, int);
+			if (!writer.Write(&width, sizeof(width)))
+				return false;
+		}
+		// Negative means none, like printf. Matters for %.*s on strings that aren't terminated.
+		int precision = -1;
+		if (spec.precisionStar) {
+			precision = va_arg(args, int);
+			if (!writer.Write(&precision, sizeof(precision)))
+				return false;
+		} else if (spec.hasPrecision) {
+			precision = 0;
+			for (int i = 0; i < spec.precisionLen; ++i)
+				precision = precision * 10 + (spec.precision[i] - '0');
+		}
+
+		u64 value = 0;
+		if (IsIntegerConv(spec.conv)) {
+			switch (spec.lengthType) {
+			case FormatLength::L: value = (u64)va_arg(args, long); break;
+			case FormatLength::LL: value = (u64)va_arg(args, long long); break;
+			case FormatLength::Z: value = (u64)va_arg(args, size_t); break;
+			case FormatLength::J: value = (u64)va_arg(args, intmax_t); break;
+			case FormatLength::T: value = (u64)va_arg(args, ptrdiff_t); break;
+			default: value = (u64)va_arg(args, int); break;
+			}
+			if (!writer.Write(&value, sizeof(value)))
+				return false;
+		} else if (IsFloatConv(spec.conv)) {
+			double d = va_arg(args, double);
+			if (!writer.Write(&d, sizeof(d)))
+				return false;
+		} else if (spec.conv == 'p') {
+			value = (u64)(uintptr_t)va_arg(args, void *);
+			if (!writer.Write(&value, sizeof(value)))
+				return false;
+		} else if (spec.conv == 's') {
+			const char *str = va_arg(args, const char *);
+			u16 len = NULL_STRING;
+			if (str) {
+				// Never cut a string short - if it doesn't fit, the line gets formatted immediately.
+				size_t avail = writer.Remaining() > sizeof(len) ? writer.Remaining() - sizeof(len) : 0;
+				size_t limit = precision >= 0 ? std::min(avail + 1, (size_t)precision) : avail + 1;
+				size_t strLen = strnlen(str, limit);
+				if (strLen > avail)
+					return false;
+				len = (u16)strLen;
+			}
+			if (!writer.Write(&len, sizeof(len)))
+				return false;
+			if (str && !writer.Write(str, len))
+				return false;
+		}
+	}
+
+	rec->argsSize = (u16)writer.Pos();
+	return true;
+}
+
+template <typename T>
+static void AppendFormatted(std::string *out, const char *spec, T value) {
+	char temp[256];
+	int n = snprintf(temp, sizeof(temp), spec, value);
+	if (n < 0)
+		return;
+	if (n < (int)sizeof(temp)) {
+		out->append(temp, n);
+		return;
+	}
+
+	size_t pos = out->size();
+	out->resize(pos + n + 1);
+	snprintf(&(*out)[pos], n + 1, spec, value);
+	out->resize(pos + n);
+}
+
+void DeferredLogFormat(const DeferredLogRecord &rec, std::string *out) {
+	ArgReader reader(rec.args, rec.argsSize);
+	const char *p = rec.format;
+	while (*p) {
+		const char *literal = p;
+		while (*p && *p != '%')
+			p++;
+		out->append(literal, p - literal);
+		if (!*p)
+			break;
+
+		p++;
+		if (*p == '%') {
+			out->push_back('%');
+			p++;
+			continue;
+		}
+
+		FormatSpec spec;
+		p = ParseFormatSpec(p, &spec);
+		if (!p) {
+			// Can't happen if it was captured, but let's not read garbage.
+			break;
+		}
+
+		// Rebuild the conversion with any * replaced by the captured values.
+		char specStr[64];
+		int len = snprintf(specStr, sizeof(specStr), "%%%.*s", spec.flagsLen, spec.flags);
+		if (spec.widthStar)
+			len += snprintf(specStr + len, sizeof(specStr) - len, "%d", reader.Read<int>());
+		else
+			len += snprintf(specStr + len, sizeof(specStr) - len, "%.*s", spec.widthLen, spec.width);
+		if (spec.precisionStar) {
+			int precision = reader.Read<int>();
+			if (precision >= 0)
+				len += snprintf(specStr + len, sizeof(specStr) - len, ".%d", precision);
+		} else if (spec.hasPrecision) {
+			len += snprintf(specStr + len, sizeof(specStr) - len, ".%.*s", spec.precisionLen, spec.precision);
+		}
+		snprintf(specStr + len, sizeof(specStr) - len, "%.*s%c", spec.lengthLen, spec.length, spec.conv);
+
+		if (IsIntegerConv(spec.conv)) {
+			u64 value = reader.Read<u64>();
+			switch (spec.lengthType) {
+			case FormatLength::L: AppendFormatted(out, specStr, (long)value); break;
+			case FormatLength::LL: AppendFormatted(out, specStr, (long long)value); break;
+			case FormatLength::Z: AppendFormatted(out, specStr, (size_t)value); break;
+			case FormatLength::J: AppendFormatted(out, specStr, (intmax_t)value); break;
+			case FormatLength::T: AppendFormatted(out, specStr, (ptrdiff_t)value); break;
+			default: AppendFormatted(out, specStr, (int)value); break;
+			}
+		} else if (IsFloatConv(spec.conv)) {
+			AppendFormatted(out, specStr, reader.Read<double>());
+		} else if (spec.conv == 'p') {
+			AppendFormatted(out, specStr, (void *)(uintptr_t)reader.Read<u64>());
+		} else if (spec.conv == 's') {
+			u16 strLen = reader.Read<u16>();
+			if (strLen == NULL_STRING) {
+				AppendFormatted(out, specStr, (const char *)nullptr);
+			} else {
+				const char *str = reader.ReadBytes(strLen);
+				AppendFormatted(out, specStr, str ? std::string(str, strLen).c_str() : "");
+			}
+		}
+	}
+}
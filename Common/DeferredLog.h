@@ -0,0 +1,80 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <atomic>
+#include <cstdarg>
+#include <string>
+
+#include "Common/CommonTypes.h"
+#include "Common/Log.h"
+
+// A log line recorded without formatting it.  The format string and file are assumed to be
+// static (they always are through the log macros), but string arguments are copied.
+struct DeferredLogRecord {
+	u64 seq;
+	// Wall clock time in milliseconds since the epoch.
+	s64 timeMs;
+	const char *format;
+	const char *file;
+	int line;
+	LogLevel level;
+	LogType type;
+	bool hasThreadName;
+	char threadName[15];
+	u16 argsSize;
+	u8 args[190];
+};
+
+// Packs the arguments for format into the record.  Returns false if the format can't be
+// deferred (unusual conversions, or too much data), in which case it should be logged directly.
+bool DeferredLogCapture(DeferredLogRecord *rec, const char *format, va_list args);
+// Appends the formatted message of a captured record.
+void DeferredLogFormat(const DeferredLogRecord &rec, std::string *out);
+
+// Single producer (the logging thread), single consumer (whoever flushes) ring of records.
+class DeferredLogRing {
+public:
+	enum { CAPACITY = 1024 };
+
+	// Returns nullptr if the ring is full.
+	DeferredLogRecord *BeginWrite() {
+		u32 head = head_.load(std::memory_order_relaxed);
+		if (head - tail_.load(std::memory_order_acquire) >= CAPACITY)
+			return nullptr;
+		return &records_[head & (CAPACITY - 1)];
+	}
+	void EndWrite() {
+		head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+	// The consumer may look at up to Available() records, then Consume() them.
+	u32 Available() const {
+		return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+	}
+	const DeferredLogRecord &Peek(u32 i) const {
+		return records_[(tail_.load(std::memory_order_relaxed) + i) & (CAPACITY - 1)];
+	}
+	void Consume(u32 count) {
+		tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+
+private:
+	std::atomic<u32> head_{};
+	std::atomic<u32> tail_{};
+	DeferredLogRecord records_[CAPACITY];
+};
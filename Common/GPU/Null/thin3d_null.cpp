@@ -0,0 +1,502 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "Common/GPU/thin3d.h"
+#include "Common/GPU/thin3d_create.h"
+#include "Common/StringUtils.h"
+#include "Common/TimeUtil.h"
+#include "Common/Log.h"
+
+// A DrawContext that never talks to a device. Everything the GPU core asks for is validated
+// and counted, so the hardware path (vertex decode, texture decode, state mapping, shader generation)
+// can be profiled deterministically on machines without a GPU.
+
+namespace Draw {
+
+class NullShaderModule : public ShaderModule {
+public:
+	NullShaderModule(NullContextStats *stats, ShaderStage stage, const uint8_t *data, size_t size) : stats_(stats), stage_(stage), source_((const char *)data, size) {
+		stats_->shadersCreated++;
+		stats_->liveShaders++;
+	}
+	~NullShaderModule() {
+		stats_->liveShaders--;
+	}
+	ShaderStage GetStage() const override {
+		return stage_;
+	}
+
+private:
+	NullContextStats *stats_;
+	ShaderStage stage_;
+	// Kept around so the generated code can be inspected in a debugger.
+	std::string source_;
+};
+
+class NullPipeline : public Pipeline {
+public:
+	NullPipeline(NullContextStats *stats, const PipelineDesc &desc) : prim(desc.prim), stats_(stats) {
+		if (desc.uniformDesc)
+			uniformSize = desc.uniformDesc->uniformBufferSize;
+		for (auto shader : desc.shaders) {
+			shader->AddRef();
+			shaders.push_back(shader);
+		}
+		stats_->pipelinesCreated++;
+		stats_->livePipelines++;
+	}
+	~NullPipeline() {
+		for (auto shader : shaders)
+			shader->Release();
+		stats_->livePipelines--;
+	}
+
+	Primitive prim;
+	size_t uniformSize = 0;
+	std::vector<ShaderModule *> shaders;
+
+private:
+	NullContextStats *stats_;
+};
+
+class NullBuffer : public Buffer {
+public:
+	NullBuffer(NullContextStats *stats, size_t size) : size(size), stats_(stats) {
+		stats_->buffersCreated++;
+		stats_->liveBuffers++;
+	}
+	~NullBuffer() {
+		stats_->liveBuffers--;
+	}
+
+	size_t size;
+
+private:
+	NullContextStats *stats_;
+};
+
+class NullTexture : public Texture {
+public:
+	NullTexture(NullContextStats *stats, const TextureDesc &desc) : mipLevels(desc.mipLevels), stats_(stats) {
+		width_ = desc.width;
+		height_ = desc.height;
+		depth_ = desc.depth;
+		format_ = desc.format;
+		stats_->texturesCreated++;
+		stats_->liveTextures++;
+	}
+	~NullTexture() {
+		stats_->liveTextures--;
+	}
+
+	int mipLevels;
+
+private:
+	NullContextStats *stats_;
+};
+
+class NullFramebuffer : public Framebuffer {
+public:
+	NullFramebuffer(NullContextStats *stats, const FramebufferDesc &desc) : stats_(stats) {
+		width_ = desc.width;
+		height_ = desc.height;
+		layers_ = desc.numLayers;
+		multiSampleLevel_ = desc.multiSampleLevel;
+		stats_->framebuffersCreated++;
+		stats_->liveFramebuffers++;
+	}
+	~NullFramebuffer() {
+		stats_->liveFramebuffers--;
+	}
+
+private:
+	NullContextStats *stats_;
+};
+
+class NullDrawContext : public DrawContext {
+public:
+	NullDrawContext();
+	~NullDrawContext();
+
+	const DeviceCaps &GetDeviceCaps() const override {
+		return caps_;
+	}
+	uint32_t GetSupportedShaderLanguages() const override {
+		return (uint32_t)ShaderLanguage::GLSL_VULKAN;
+	}
+	uint32_t GetDataFormatSupport(DataFormat fmt) const override;
+
+	InputLayout *CreateInputLayout(const InputLayoutDesc &desc) override {
+		return new InputLayout();
+	}
+	DepthStencilState *CreateDepthStencilState(const DepthStencilStateDesc &desc) override {
+		return new DepthStencilState();
+	}
+	BlendState *CreateBlendState(const BlendStateDesc &desc) override {
+		return new BlendState();
+	}
+	SamplerState *CreateSamplerState(const SamplerStateDesc &desc) override {
+		return new SamplerState();
+	}
+	RasterState *CreateRasterState(const RasterStateDesc &desc) override {
+		return new RasterState();
+	}
+	Buffer *CreateBuffer(size_t size, uint32_t usageFlags) override {
+		return new NullBuffer(&stats_, size);
+	}
+	Pipeline *CreateGraphicsPipeline(const PipelineDesc &desc, const char *tag) override;
+	Texture *CreateTexture(const TextureDesc &desc) override;
+	ShaderModule *CreateShaderModule(ShaderStage stage, ShaderLanguage language, const uint8_t *data, size_t dataSize, const char *tag) override;
+	Framebuffer *CreateFramebuffer(const FramebufferDesc &desc) override {
+		return new NullFramebuffer(&stats_, desc);
+	}
+
+	void UpdateBuffer(Buffer *buffer, const uint8_t *data, size_t offset, size_t size, UpdateBufferFlags flags) override;
+	void UpdateTextureLevels(Texture *texture, const uint8_t **data, TextureCallback initDataCallback, int numLevels) override;
+
+	void CopyFramebufferImage(Framebuffer *src, int level, int x, int y, int z, Framebuffer *dst, int dstLevel, int dstX, int dstY, int dstZ, int width, int height, int depth, int channelBits, const char *tag) override {
+		stats_.copies++;
+	}
+	bool BlitFramebuffer(Framebuffer *src, int srcX1, int srcY1, int srcX2, int srcY2, Framebuffer *dst, int dstX1, int dstY1, int dstX2, int dstY2, int channelBits, FBBlitFilter filter, const char *tag) override {
+		stats_.copies++;
+		return true;
+	}
+	bool CopyFramebufferToMemory(Framebuffer *src, int channelBits, int x, int y, int w, int h, Draw::DataFormat format, void *pixels, int pixelStride, ReadbackMode mode, const char *tag) override;
+
+	void BindFramebufferAsRenderTarget(Framebuffer *fbo, const RenderPassInfo &rp, const char *tag) override;
+	void BindFramebufferAsTexture(Framebuffer *fbo, int binding, FBChannel channelBit, int layer) override {}
+
+	void GetFramebufferDimensions(Framebuffer *fbo, int *w, int *h) override;
+
+	void Invalidate(InvalidationFlags flags) override {}
+
+	void BindTextures(int start, int count, Texture **textures, TextureBindFlags flags) override {}
+	void BindNativeTexture(int index, void *nativeTexture) override {}
+	void BindSamplerStates(int start, int count, SamplerState **states) override {}
+	void BindVertexBuffer(Buffer *buffer, int offset) override {}
+	void BindIndexBuffer(Buffer *indexBuffer, int offset) override {}
+	void BindPipeline(Pipeline *pipeline) override {
+		curPipeline_ = (NullPipeline *)pipeline;
+	}
+
+	void UpdateDynamicUniformBuffer(const void *ub, size_t size) override;
+
+	void SetScissorRect(int left, int top, int width, int height) override {}
+	void SetViewport(const Viewport &viewport) override {}
+	void SetBlendFactor(float color[4]) override {}
+	void SetStencilParams(uint8_t refValue, uint8_t writeMask, uint8_t compareMask) override {}
+
+	void Draw(int vertexCount, int offset) override;
+	void DrawIndexed(int vertexCount, int offset) override;
+	void DrawUP(const void *vdata, int vertexCount) override;
+	void Clear(int mask, uint32_t colorval, float depthVal, int stencilVal) override {
+		stats_.clears++;
+	}
+
+	void BeginFrame(DebugFlags debugFlags) override;
+	void EndFrame() override;
+	void Present(PresentMode presentMode, int vblanks) override;
+
+	int GetFrameCount() override { return frameCount_; }
+
+	std::string GetInfoString(InfoField info) const override {
+		switch (info) {
+		case APIVERSION: return "1.0";
+		case VENDORSTRING: return "Null";
+		case VENDOR: return "";
+		case DRIVER: return "-";
+		case SHADELANGVERSION: return "GLSL 450 (not compiled)";
+		case APINAME: return "Null";
+		default: return "?";
+		}
+	}
+
+	uint64_t GetNativeObject(NativeObject obj, void *srcObject) override {
+		switch (obj) {
+		case NativeObject::CONTEXT:
+			return (uint64_t)(uintptr_t)&stats_;
+		default:
+			return 0;
+		}
+	}
+
+	void HandleEvent(Event ev, int width, int height, void *param1, void *param2) override;
+
+	void SetInvalidationCallback(InvalidationCallback callback) override {
+		invalidationCallback_ = callback;
+	}
+
+	void ResetStats() override;
+	std::string GetGpuProfileString() const override;
+
+private:
+	DeviceCaps caps_{};
+	NullContextStats stats_{};
+	InvalidationCallback invalidationCallback_;
+	int frameCount_ = FRAME_TIME_HISTORY_LENGTH;
+
+	AutoRef<NullPipeline> curPipeline_;
+	AutoRef<Framebuffer> curRenderTarget_;
+
+	// Texture init callbacks need somewhere to write.
+	std::vector<uint8_t> scratch_;
+};
+
+NullDrawContext::NullDrawContext() {
+	caps_.vendor = GPUVendor::VENDOR_UNKNOWN;
+	caps_.deviceName = "Null";
+
+	// Claim everything the hardware cores can make use of, so the widest set of paths is exercised.
+	caps_.preferredDepthBufferFormat = DataFormat::D24_S8;
+	caps_.preferredShadowMapFormatLow = DataFormat::D16;
+	caps_.preferredShadowMapFormatHigh = DataFormat::D32F;
+	caps_.anisoSupported = true;
+	caps_.depthRangeMinusOneToOne = false;
+	caps_.dualSourceBlend = true;
+	caps_.logicOpSupported = true;
+	caps_.depthClampSupported = true;
+	caps_.clipDistanceSupported = true;
+	caps_.cullDistanceSupported = true;
+	caps_.framebufferCopySupported = true;
+	caps_.framebufferBlitSupported = true;
+	caps_.framebufferDepthCopySupported = true;
+	caps_.framebufferSeparateDepthCopySupported = true;
+	caps_.framebufferDepthBlitSupported = true;
+	caps_.framebufferStencilBlitSupported = true;
+	caps_.texture3DSupported = true;
+	caps_.fragmentShaderInt32Supported = true;
+	caps_.textureNPOTFullySupported = true;
+	caps_.fragmentShaderDepthWriteSupported = true;
+	caps_.fragmentShaderStencilWriteSupported = false;
+	caps_.textureDepthSupported = true;
+	caps_.blendMinMaxSupported = true;
+	caps_.multiViewSupported = false;
+	caps_.isTilingGPU = false;
+	caps_.textureSwizzleSupported = false;
+	caps_.supportsD3D9 = false;
+	caps_.multiSampleLevelsMask = 1;
+
+	caps_.presentInstantModeChange = true;
+	caps_.presentMaxInterval = 1;
+	caps_.presentModesSupported = PresentMode::FIFO | PresentMode::IMMEDIATE;
+
+	shaderLanguageDesc_.Init(GLSL_VULKAN);
+
+	targetWidth_ = 480;
+	targetHeight_ = 272;
+}
+
+NullDrawContext::~NullDrawContext() {
+	DestroyPresets();
+	curPipeline_ = nullptr;
+	curRenderTarget_ = nullptr;
+}
+
+uint32_t NullDrawContext::GetDataFormatSupport(DataFormat fmt) const {
+	if (fmt == DataFormat::UNDEFINED)
+		return 0;
+	if (DataFormatIsDepthStencil(fmt))
+		return FMT_DEPTHSTENCIL | FMT_TEXTURE | FMT_BLIT;
+	if (DataFormatIsBlockCompressed(fmt, nullptr))
+		return FMT_TEXTURE;
+	return FMT_RENDERTARGET | FMT_TEXTURE | FMT_INPUTLAYOUT | FMT_AUTOGEN_MIPS | FMT_BLIT;
+}
+
+Pipeline *NullDrawContext::CreateGraphicsPipeline(const PipelineDesc &desc, const char *tag) {
+	for (auto shader : desc.shaders) {
+		if (!shader) {
+			ERROR_LOG(G3D, "Null shader passed to CreateGraphicsPipeline(%s)", tag);
+			return nullptr;
+		}
+	}
+	return new NullPipeline(&stats_, desc);
+}
+
+ShaderModule *NullDrawContext::CreateShaderModule(ShaderStage stage, ShaderLanguage language, const uint8_t *data, size_t dataSize, const char *tag) {
+	if (language != ShaderLanguage::GLSL_VULKAN) {
+		ERROR_LOG(G3D, "Unsupported shader language");
+		return nullptr;
+	}
+	return new NullShaderModule(&stats_, stage, data, dataSize);
+}
+
+static size_t TextureLevelSize(DataFormat fmt, int w, int h, int d) {
+	int blockSize = 0;
+	if (DataFormatIsBlockCompressed(fmt, &blockSize)) {
+		return (size_t)((w + 3) / 4) * ((h + 3) / 4) * blockSize * d;
+	}
+	return (size_t)w * h * d * DataFormatSizeInBytes(fmt);
+}
+
+Texture *NullDrawContext::CreateTexture(const TextureDesc &desc) {
+	if (!(GetDataFormatSupport(desc.format) & FMT_TEXTURE)) {
+		return nullptr;
+	}
+	if (desc.width <= 0 || desc.height <= 0 || desc.depth <= 0) {
+		ERROR_LOG(G3D, "Bad texture dimensions %dx%dx%d (%s)", desc.width, desc.height, desc.depth, desc.tag ? desc.tag : "");
+		return nullptr;
+	}
+
+	NullTexture *tex = new NullTexture(&stats_, desc);
+	if (!desc.initData.empty()) {
+		UpdateTextureLevels(tex, (const uint8_t **)desc.initData.data(), desc.initDataCallback, (int)desc.initData.size());
+	}
+	return tex;
+}
+
+void NullDrawContext::UpdateTextureLevels(Texture *texture, const uint8_t **data, TextureCallback initDataCallback, int numLevels) {
+	NullTexture *tex = (NullTexture *)texture;
+	int w = tex->Width();
+	int h = tex->Height();
+	int d = tex->Depth();
+	for (int i = 0; i < numLevels; i++) {
+		size_t size = TextureLevelSize(tex->Format(), w, h, d);
+		if (initDataCallback) {
+			// The callback writes the level out just like it would into a mapped staging buffer.
+			if (scratch_.size() < size)
+				scratch_.resize(size);
+			uint32_t byteStride = (uint32_t)(size / std::max(1, h * d));
+			initDataCallback(scratch_.data(), data[i], w, h, d, byteStride, byteStride * h);
+		}
+		stats_.textureBytes += size;
+		w = std::max(1, w / 2);
+		h = std::max(1, h / 2);
+		d = std::max(1, d / 2);
+	}
+}
+
+void NullDrawContext::UpdateBuffer(Buffer *buffer, const uint8_t *data, size_t offset, size_t size, UpdateBufferFlags flags) {
+	_dbg_assert_(offset + size <= ((NullBuffer *)buffer)->size);
+	stats_.bufferBytes += size;
+}
+
+void NullDrawContext::UpdateDynamicUniformBuffer(const void *ub, size_t size) {
+	_dbg_assert_(curPipeline_ && size == curPipeline_->uniformSize);
+	stats_.uniformBytes += size;
+}
+
+bool NullDrawContext::CopyFramebufferToMemory(Framebuffer *src, int channelBits, int x, int y, int w, int h, Draw::DataFormat format, void *pixels, int pixelStride, ReadbackMode mode, const char *tag) {
+	// Nothing was ever rendered, so a readback is all zeroes. This keeps the readback itself deterministic.
+	size_t bpp = DataFormatSizeInBytes(format);
+	uint8_t *dst = (uint8_t *)pixels;
+	for (int i = 0; i < h; i++) {
+		memset(dst + (size_t)i * pixelStride * bpp, 0, (size_t)w * bpp);
+	}
+	stats_.readbackBytes += (uint64_t)w * h * bpp;
+	return true;
+}
+
+void NullDrawContext::BindFramebufferAsRenderTarget(Framebuffer *fbo, const RenderPassInfo &rp, const char *tag) {
+	curRenderTarget_ = fbo;
+	stats_.renderPasses++;
+	if (invalidationCallback_) {
+		invalidationCallback_(InvalidationCallbackFlags::RENDER_PASS_STATE);
+	}
+}
+
+void NullDrawContext::GetFramebufferDimensions(Framebuffer *fbo, int *w, int *h) {
+	if (fbo) {
+		*w = fbo->Width();
+		*h = fbo->Height();
+	} else {
+		*w = targetWidth_;
+		*h = targetHeight_;
+	}
+}
+
+void NullDrawContext::Draw(int vertexCount, int offset) {
+	_dbg_assert_(curPipeline_);
+	stats_.draws++;
+	stats_.vertices += vertexCount;
+}
+
+void NullDrawContext::DrawIndexed(int vertexCount, int offset) {
+	_dbg_assert_(curPipeline_);
+	stats_.draws++;
+	stats_.vertices += vertexCount;
+}
+
+void NullDrawContext::DrawUP(const void *vdata, int vertexCount) {
+	_dbg_assert_(curPipeline_);
+	stats_.draws++;
+	stats_.vertices += vertexCount;
+}
+
+void NullDrawContext::BeginFrame(DebugFlags debugFlags) {
+	FrameTimeData &frameTimeData = frameTimeHistory_.Add(frameCount_);
+	frameTimeData.afterFenceWait = time_now_d();
+	frameTimeData.frameBegin = frameTimeData.afterFenceWait;
+}
+
+void NullDrawContext::EndFrame() {
+	frameTimeHistory_[frameCount_].firstSubmit = time_now_d();
+	curPipeline_ = nullptr;
+}
+
+void NullDrawContext::Present(PresentMode presentMode, int vblanks) {
+	frameTimeHistory_[frameCount_].queuePresent = time_now_d();
+	curRenderTarget_ = nullptr;
+	stats_.frames++;
+	frameCount_++;
+}
+
+void NullDrawContext::HandleEvent(Event ev, int width, int height, void *param1, void *param2) {
+	switch (ev) {
+	case Event::RESIZED:
+	case Event::GOT_BACKBUFFER:
+		targetWidth_ = width;
+		targetHeight_ = height;
+		break;
+	default:
+		break;
+	}
+}
+
+void NullDrawContext::ResetStats() {
+	// Keep the live counts, they describe what currently exists.
+	NullContextStats live = stats_;
+	stats_ = NullContextStats{};
+	stats_.liveTextures = live.liveTextures;
+	stats_.liveFramebuffers = live.liveFramebuffers;
+	stats_.liveBuffers = live.liveBuffers;
+	stats_.livePipelines = live.livePipelines;
+	stats_.liveShaders = live.liveShaders;
+}
+
+std::string NullDrawContext::GetGpuProfileString() const {
+	return StringFromFormat(
+		"Frames: %llu, render passes: %llu\n"
+		"Draws: %llu (%llu verts), clears: %llu, copies: %llu\n"
+		"Uploaded: %llu buffer, %llu texture, %llu uniform bytes\n"
+		"Read back: %llu bytes\n"
+		"Live: %d textures, %d framebuffers, %d buffers, %d pipelines, %d shaders\n",
+		(unsigned long long)stats_.frames, (unsigned long long)stats_.renderPasses,
+		(unsigned long long)stats_.draws, (unsigned long long)stats_.vertices, (unsigned long long)stats_.clears, (unsigned long long)stats_.copies,
+		(unsigned long long)stats_.bufferBytes, (unsigned long long)stats_.textureBytes, (unsigned long long)stats_.uniformBytes,
+		(unsigned long long)stats_.readbackBytes,
+		stats_.liveTextures, stats_.liveFramebuffers, stats_.liveBuffers, stats_.livePipelines, stats_.liveShaders);
+}
+
+DrawContext *T3DCreateNullContext() {
+	return new NullDrawContext();
+}
+
+}  // namespace Draw
@@ -33,4 +33,34 @@ DrawContext *T3DCreateD3D11Context(ID3D11Device *device, ID3D11DeviceContext *co
 
 DrawContext *T3DCreateVulkanContext(VulkanContext *context, bool useRenderThread);
 
+// Accepts every call and keeps track of resources, but never touches a device. Used to benchmark
+// the hardware GPU path on machines without a GPU, see GPU/Null.
+DrawContext *T3DCreateNullContext();
+
+// Running totals kept by the null context. Get it through GetNativeObject(NativeObject::CONTEXT).
+struct NullContextStats {
+	uint64_t frames;
+	uint64_t renderPasses;
+	uint64_t draws;
+	uint64_t vertices;
+	uint64_t clears;
+	uint64_t bufferBytes;
+	uint64_t textureBytes;
+	uint64_t uniformBytes;
+	uint64_t readbackBytes;
+	uint64_t copies;
+
+	int texturesCreated;
+	int framebuffersCreated;
+	int buffersCreated;
+	int pipelinesCreated;
+	int shadersCreated;
+
+	int liveTextures;
+	int liveFramebuffers;
+	int liveBuffers;
+	int livePipelines;
+	int liveShaders;
+};
+
 }  // namespace Draw
@@ -24,15 +24,19 @@
 #endif
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <ctime>
 
 #include "Common/Data/Encoding/Utf8.h"
 
 #include "Common/LogManager.h"
 #include "Common/ConsoleListener.h"
+#include "Common/DeferredLog.h"
 #include "Common/TimeUtil.h"
 #include "Common/File/FileUtil.h"
 #include "Common/StringUtils.h"
+#include "Common/Thread/ThreadUtil.h"
 
 // Don't need to savestate this.
 const char *hleCurrentThreadName = nullptr;
@@ -77,6 +81,11 @@ bool GenericLogEnabled(LogLevel level, LogType type) {
 
 LogManager *LogManager::logManager_ = NULL;
 
+// Bumped for each LogManager, so threads notice their ring belongs to an old one.
+static std::atomic<int> deferredGenerationCounter;
+static thread_local std::shared_ptr<DeferredLogRing> deferredThreadRing;
+static thread_local int deferredThreadRingGeneration;
+
 // NOTE: Needs to be kept in sync with the LogType enum.
 static const char * const g_logTypeNames[] = {
 	"SYSTEM",
@@ -117,6 +126,7 @@ static const char * const g_logTypeNames[] = {
 
 LogManager::LogManager(bool *enabledSetting) {
 	g_bLogEnabledSetting = enabledSetting;
+	deferredGeneration_ = ++deferredGenerationCounter;
 
 	_dbg_assert_(ARRAY_SIZE(g_logTypeNames) == (size_t)LogType::NUMBER_OF_LOGS);
 
@@ -158,6 +168,8 @@ LogManager::LogManager(bool *enabledSetting) {
 }
 
 LogManager::~LogManager() {
+	SetDeferred(false);
+
 	for (int i = 0; i < (int)LogType::NUMBER_OF_LOGS; ++i) {
 #if !defined(MOBILE_DEVICE) || defined(_DEBUG)
 		RemoveListener(fileLog_);
@@ -211,14 +223,9 @@ void LogManager::LoadConfig(const Section *section, bool debugDefaults) {
 	}
 }
 
-void LogManager::Log(LogLevel level, LogType type, const char *file, int line, const char *format, va_list args) {
-	const LogChannel &log = log_[(size_t)type];
-	if (level > log.level || !log.enabled)
-		return;
-
-	LogMessage message;
-	message.level = level;
-	message.log = log.m_shortName;
+static void FormatLogHeader(LogMessage *message, LogLevel level, const LogChannel &log, const char *file, int line, const char *threadName) {
+	message->level = level;
+	message->log = log.m_shortName;
 
 #ifdef _WIN32
 	static const char sep = '\\';
@@ -234,18 +241,50 @@ void LogManager::Log(LogLevel level, LogType type, const char *file, int line, c
 			file = fileshort + 1;
 	}
 
-	GetTimeFormatted(message.timestamp);
-
-	if (hleCurrentThreadName) {
-		snprintf(message.header, sizeof(message.header), "%-12.12s %c[%s]: %s:%d",
-			hleCurrentThreadName, level_to_char[(int)level],
+	if (threadName) {
+		snprintf(message->header, sizeof(message->header), "%-12.12s %c[%s]: %s:%d",
+			threadName, level_to_char[(int)level],
 			log.m_shortName,
 			file, line);
 	} else {
-		snprintf(message.header, sizeof(message.header), "%s:%d %c[%s]:",
+		snprintf(message->header, sizeof(message->header), "%s:%d %c[%s]:",
 			file, line, level_to_char[(int)level],
 			log.m_shortName);
 	}
+}
+
+// Same as GetTimeFormatted(), but for a time recorded earlier.
+static void FormatLogTime(char formattedTime[13], s64 timeMs) {
+	time_t sysTime = (time_t)(timeMs / 1000);
+	struct tm *gmTime = localtime(&sysTime);
+	char tmp[6];
+	strftime(tmp, sizeof(tmp), "%M:%S", gmTime);
+	snprintf(formattedTime, 11, "%s:%03u", tmp, (uint32_t)(timeMs % 1000));
+}
+
+void LogManager::Log(LogLevel level, LogType type, const char *file, int line, const char *format, va_list args) {
+	const LogChannel &log = log_[(size_t)type];
+	if (level > log.level || !log.enabled)
+		return;
+
+	if (deferred_) {
+		deferredWriters_++;
+		bool recorded = false;
+		// Check again now that SetDeferred(false) will wait for this line before its final flush.
+		if (deferred_) {
+			va_list args_copy;
+			va_copy(args_copy, args);
+			recorded = LogDeferred(level, type, file, line, format, args_copy);
+			va_end(args_copy);
+		}
+		deferredWriters_--;
+		if (recorded)
+			return;
+	}
+
+	LogMessage message;
+	FormatLogHeader(&message, level, log, file, line, hleCurrentThreadName);
+	GetTimeFormatted(message.timestamp);
 
 	char msgBuf[1024];
 	va_list args_copy;
@@ -268,6 +307,133 @@ void LogManager::Log(LogLevel level, LogType type, const char *file, int line, c
 	}
 }
 
+DeferredLogRing *LogManager::GetDeferredRing() {
+	if (!deferredThreadRing || deferredThreadRingGeneration != deferredGeneration_) {
+		deferredThreadRing = std::make_shared<DeferredLogRing>();
+		deferredThreadRingGeneration = deferredGeneration_;
+
+		std::lock_guard<std::mutex> guard(deferredLock_);
+		deferredRings_.push_back(deferredThreadRing);
+	}
+	return deferredThreadRing.get();
+}
+
+bool LogManager::LogDeferred(LogLevel level, LogType type, const char *file, int line, const char *format, va_list args) {
+	DeferredLogRing *ring = GetDeferredRing();
+	DeferredLogRecord *rec = ring->BeginWrite();
+	if (!rec) {
+		deferredDropped_++;
+		deferredWake_.notify_one();
+		return true;
+	}
+
+	if (!DeferredLogCapture(rec, format, args))
+		return false;
+
+	rec->seq = deferredSeq_.fetch_add(1, std::memory_order_relaxed);
+	rec->timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	rec->format = format;
+	rec->file = file;
+	rec->line = line;
+	rec->level = level;
+	rec->type = type;
+	rec->hasThreadName = hleCurrentThreadName != nullptr;
+	if (rec->hasThreadName)
+		truncate_cpy(rec->threadName, hleCurrentThreadName);
+	ring->EndWrite();
+
+	// Don't wait for the timer if this thread is logging a lot.
+	if (ring->Available() == DeferredLogRing::CAPACITY / 2)
+		deferredWake_.notify_one();
+	return true;
+}
+
+void LogManager::FlushDeferred() {
+	std::lock_guard<std::mutex> flushGuard(deferredFlushLock_);
+	std::vector<DeferredLogRecord> pending;
+	{
+		// Only copy the records out under the lock, listeners may take a while (or log themselves.)
+		std::lock_guard<std::mutex> guard(deferredLock_);
+		for (auto &ring : deferredRings_) {
+			u32 count = ring->Available();
+			for (u32 j = 0; j < count; ++j)
+				pending.push_back(ring->Peek(j));
+			ring->Consume(count);
+		}
+
+		// Threads that have exited only leave their rings here, so release them once drained.
+		deferredRings_.erase(std::remove_if(deferredRings_.begin(), deferredRings_.end(), [](const std::shared_ptr<DeferredLogRing> &ring) {
+			return ring.use_count() == 1 && ring->Available() == 0;
+		}), deferredRings_.end());
+	}
+
+	// Interleave threads in the order the lines were logged.
+	std::sort(pending.begin(), pending.end(), [](const DeferredLogRecord &a, const DeferredLogRecord &b) {
+		return a.seq < b.seq;
+	});
+
+	u64 dropped = deferredDropped_.exchange(0);
+	if (pending.empty() && dropped == 0)
+		return;
+
+	std::lock_guard<std::mutex> listeners_lock(listeners_lock_);
+	LogMessage message;
+	for (const DeferredLogRecord &rec : pending) {
+		FormatLogHeader(&message, rec.level, log_[(size_t)rec.type], rec.file, rec.line, rec.hasThreadName ? rec.threadName : nullptr);
+		FormatLogTime(message.timestamp, rec.timeMs);
+		message.msg.clear();
+		DeferredLogFormat(rec, &message.msg);
+		message.msg.push_back('\n');
+		for (auto &iter : listeners_) {
+			iter->Log(message);
+		}
+	}
+
+	if (dropped != 0) {
+		FormatLogHeader(&message, LogLevel::LWARNING, log_[(size_t)LogType::SYSTEM], __FILE__, __LINE__, nullptr);
+		GetTimeFormatted(message.timestamp);
+		message.msg = StringFromFormat("Dropped %llu deferred log lines, logging faster than they could be written\n", (unsigned long long)dropped);
+		for (auto &iter : listeners_) {
+			iter->Log(message);
+		}
+	}
+}
+
+void LogManager::DeferredThread() {
+	SetCurrentThreadName("LogFlush");
+	std::unique_lock<std::mutex> guard(deferredWakeLock_);
+	while (!deferredStop_) {
+		deferredWake_.wait_for(guard, std::chrono::milliseconds(10));
+		guard.unlock();
+		FlushDeferred();
+		guard.lock();
+	}
+}
+
+void LogManager::SetDeferred(bool deferred) {
+	if (deferred == deferred_)
+		return;
+
+	if (deferred) {
+		deferredStop_ = false;
+		deferredThread_ = std::thread([this] { DeferredThread(); });
+		deferred_ = true;
+	} else {
+		deferred_ = false;
+		// A thread may have seen deferred_ just before it changed, let it finish its line.
+		while (deferredWriters_ != 0)
+			std::this_thread::yield();
+		{
+			std::lock_guard<std::mutex> guard(deferredWakeLock_);
+			deferredStop_ = true;
+		}
+		deferredWake_.notify_one();
+		deferredThread_.join();
+		// Anything logged up to now still gets written.
+		FlushDeferred();
+	}
+}
+
 bool LogManager::IsEnabled(LogLevel level, LogType type) {
 	LogChannel &log = log_[(size_t)type];
 	if (level > log.level || !log.enabled)
@@ -19,7 +19,11 @@
 
 #include "ppsspp_config.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <vector>
 #include <cstdarg>
 #include <cstdio>
@@ -104,6 +108,7 @@ struct LogChannel {
 };
 
 class ConsoleListener;
+class DeferredLogRing;
 
 class LogManager {
 private:
@@ -124,6 +129,27 @@ class LogManager {
 	std::mutex listeners_lock_;
 	std::vector<LogListener*> listeners_;
 
+	// In deferred mode, each thread records raw lines into its own ring, and they're
+	// formatted and sent to listeners later on a background thread.
+	std::atomic<bool> deferred_{};
+	// Threads inside LogDeferred(), so turning deferred mode off can wait for them.
+	std::atomic<int> deferredWriters_{};
+	int deferredGeneration_ = 0;
+	std::mutex deferredLock_;
+	// Keeps lines from separate flushes in order, without blocking threads that register rings.
+	std::mutex deferredFlushLock_;
+	std::vector<std::shared_ptr<DeferredLogRing>> deferredRings_;
+	std::atomic<u64> deferredSeq_{};
+	std::atomic<u64> deferredDropped_{};
+	std::thread deferredThread_;
+	std::mutex deferredWakeLock_;
+	std::condition_variable deferredWake_;
+	bool deferredStop_ = false;
+
+	bool LogDeferred(LogLevel level, LogType type, const char *file, int line, const char *format, va_list args);
+	DeferredLogRing *GetDeferredRing();
+	void DeferredThread();
+
 public:
 	void AddListener(LogListener *listener);
 	void RemoveListener(LogListener *listener);
@@ -135,6 +161,18 @@ class LogManager {
 			 const char *file, int line, const char *fmt, va_list args);
 	bool IsEnabled(LogLevel level, LogType type);
 
+	// Deferred logging makes verbose levels cheap enough to leave on, at the cost of lines
+	// showing up slightly later (and being dropped if a thread outpaces the formatting.)
+	void SetDeferred(bool deferred);
+	bool IsDeferred() const {
+		return deferred_;
+	}
+	// Formats and sends everything recorded so far to the listeners.
+	void FlushDeferred();
+	u64 GetDeferredDropped() const {
+		return deferredDropped_;
+	}
+
 	LogChannel *GetLogChannel(LogType type) {
 		return &log_[(size_t)type];
 	}
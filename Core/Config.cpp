@@ -199,6 +199,7 @@ static const ConfigSetting generalSettings[] = {
 	ConfigSetting("FirstRun", &g_Config.bFirstRun, true, CfgFlag::DEFAULT),
 	ConfigSetting("RunCount", &g_Config.iRunCount, 0, CfgFlag::DEFAULT),
 	ConfigSetting("Enable Logging", &g_Config.bEnableLogging, true, CfgFlag::DEFAULT),
+	ConfigSetting("DeferredLogging", &g_Config.bDeferredLogging, false, CfgFlag::DEFAULT),
 	ConfigSetting("AutoRun", &g_Config.bAutoRun, true, CfgFlag::DEFAULT),
 	ConfigSetting("Browse", &g_Config.bBrowse, false, CfgFlag::DEFAULT),
 	ConfigSetting("IgnoreBadMemAccess", &g_Config.bIgnoreBadMemAccess, true, CfgFlag::DEFAULT),
@@ -350,6 +351,13 @@ static const ConfigSetting cpuSettings[] = {
 	ConfigSetting("HideSlowWarnings", &g_Config.bHideSlowWarnings, false, CfgFlag::DEFAULT),
 	ConfigSetting("HideStateWarnings", &g_Config.bHideStateWarnings, false, CfgFlag::DEFAULT),
 	ConfigSetting("PreloadFunctions", &g_Config.bPreloadFunctions, false, CfgFlag::PER_GAME),
+	ConfigSetting("IRBlockCache", &g_Config.bIRBlockCache, false, CfgFlag::PER_GAME),
+	ConfigSetting("IRBackgroundCompile", &g_Config.bIRBackgroundCompile, false, CfgFlag::PER_GAME),
+	ConfigSetting("IRTier2Threshold", &g_Config.iIRTier2Threshold, 0, CfgFlag::PER_GAME),
+	ConfigSetting("IRTraces", &g_Config.bIRTraces, false, CfgFlag::PER_GAME),
+	ConfigSetting("IRThreadedDispatch", &g_Config.bIRThreadedDispatch, false, CfgFlag::PER_GAME),
+	ConfigSetting("JitHeatMap", &g_Config.bJitHeatMap, false, CfgFlag::PER_GAME),
+	ConfigSetting("JitHeatMapPreloadBlocks", &g_Config.iJitHeatMapPreloadBlocks, 1000, CfgFlag::PER_GAME),
 	ConfigSetting("JitDisableFlags", &g_Config.uJitDisableFlags, (uint32_t)0, CfgFlag::PER_GAME),
 	ConfigSetting("CPUSpeed", &g_Config.iLockedCPUSpeed, 0, CfgFlag::PER_GAME | CfgFlag::REPORT),
 };
@@ -612,6 +620,7 @@ static const ConfigSetting graphicsSettings[] = {
 	ConfigSetting("SoftwareRendererJit", &g_Config.bSoftwareRenderingJit, true, CfgFlag::PER_GAME),
 	ConfigSetting("HardwareTransform", &g_Config.bHardwareTransform, true, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("SoftwareSkinning", &g_Config.bSoftwareSkinning, true, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("VertexCache", &g_Config.bVertexCache, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("TextureFiltering", &g_Config.iTexFiltering, 1, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("Smart2DTexFiltering", &g_Config.bSmart2DTexFiltering, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("InternalResolution", &g_Config.iInternalResolution, &DefaultInternalResolution, CfgFlag::PER_GAME | CfgFlag::REPORT),
@@ -635,6 +644,8 @@ static const ConfigSetting graphicsSettings[] = {
 	ConfigSetting("MultiSampleLevel", &g_Config.iMultiSampleLevel, 0, CfgFlag::PER_GAME),  // Number of samples is 1 << iMultiSampleLevel
 
 	ConfigSetting("TextureBackoffCache", &g_Config.bTextureBackoffCache, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("TextureAsyncDecode", &g_Config.bTextureAsyncDecode, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("TextureWriteWatch", &g_Config.bTextureWriteWatch, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("VertexDecJit", &g_Config.bVertexDecoderJit, &DefaultCodeGen, CfgFlag::DONT_SAVE | CfgFlag::REPORT),
 
 #ifndef MOBILE_DEVICE
@@ -1163,6 +1174,7 @@ void Config::Load(const char *iniFileName, const char *controllerIniFilename) {
 	debugDefaults = true;
 #endif
 	LogManager::GetInstance()->LoadConfig(log, debugDefaults);
+	LogManager::GetInstance()->SetDeferred(bDeferredLogging);
 
 	Section *recent = iniFile.GetOrCreateSection("Recent");
 	recent->Get("MaxRecent", &iMaxRecent, 1000);
@@ -87,6 +87,8 @@ struct Config {
 	bool bDumpAudio;
 	bool bSaveLoadResetsAVdumping;
 	bool bEnableLogging;
+	// Record log lines raw and format them on a background thread.
+	bool bDeferredLogging;
 	bool bDumpDecryptedEboot;
 	bool bFullscreenOnDoubleclick;
 
@@ -118,6 +120,14 @@ struct Config {
 	bool bHideSlowWarnings;
 	bool bHideStateWarnings;
 	bool bPreloadFunctions;
+	bool bIRBlockCache;
+	bool bIRBackgroundCompile;
+	int iIRTier2Threshold;
+	bool bIRTraces;
+	bool bIRThreadedDispatch;
+	// Records block execution counts, and precompiles the hottest blocks next boot.
+	bool bJitHeatMap;
+	int iJitHeatMapPreloadBlocks;
 	uint32_t uJitDisableFlags;
 
 	bool bDisableHTTPS;
@@ -170,6 +180,7 @@ struct Config {
 	bool bSoftwareRenderingJit;
 	bool bHardwareTransform; // only used in the GLES backend
 	bool bSoftwareSkinning;
+	bool bVertexCache;
 	bool bVendorBugChecksEnabled;
 	bool bUseGeometryShader;
 
@@ -214,6 +225,8 @@ struct Config {
 	float fUISaturation;
 
 	bool bTextureBackoffCache;
+	bool bTextureAsyncDecode;
+	bool bTextureWriteWatch;  // Only supported on Linux, see Memory::WriteWatch_Supported().
 	bool bVertexDecoderJit;
 	bool bFullScreen;
 	bool bFullScreenMulti;
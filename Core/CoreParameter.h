@@ -28,6 +28,8 @@ enum GPUCore {
 	GPUCORE_DIRECTX9,
 	GPUCORE_DIRECTX11,
 	GPUCORE_VULKAN,
+	// Hardware pipeline on the null thin3d context, only used by headless.
+	GPUCORE_NULL,
 };
 
 enum class FPSLimit {
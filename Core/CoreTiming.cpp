@@ -15,12 +15,14 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <atomic>
 #include <climits>
 #include <cstdio>
 #include <cstring>
 #include <mutex>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/Profiler/Profiler.h"
@@ -30,6 +32,7 @@
 #include "Core/CoreTiming.h"
 #include "Core/Core.h"
 #include "Core/Config.h"
+#include "Core/Debugger/SamplingProfiler.h"
 #include "Core/HLE/sceKernelThread.h"
 #include "Core/MIPS/MIPS.h"
 
@@ -60,10 +63,51 @@ struct BaseEvent {
 	int type;
 };
 
+// Only used to keep the save state format, which stores a sorted linked list.
 typedef LinkedListItem<BaseEvent> Event;
 
-Event *first;
-Event *eventPool = 0;
+struct QueuedEvent : public BaseEvent {
+	// Breaks ties between events at the same time, so they fire in the order scheduled.
+	u64 order;
+	int heapIndex;
+	// Links between pending events of the same type, -1 terminated.
+	int prevOfType;
+	int nextOfType;
+	// Links between pending events with the same type and userdata.
+	int prevOfKey;
+	int nextOfKey;
+};
+
+struct EventKey {
+	u64 userdata;
+	int type;
+
+	bool operator ==(const EventKey &other) const {
+		return userdata == other.userdata && type == other.type;
+	}
+};
+
+struct EventKeyHash {
+	size_t operator ()(const EventKey &key) const {
+		return std::hash<u64>()(key.userdata ^ ((u64)key.type << 48));
+	}
+};
+
+struct HeapEntry {
+	s64 time;
+	u64 order;
+	int slot;
+};
+
+// Pending events live in slots, and a binary heap of slot indices keeps them ordered.
+// This keeps scheduling and removal O(log n) even with many alarms and timers active.
+static std::vector<QueuedEvent> eventSlots;
+static std::vector<int> freeEventSlots;
+static std::vector<HeapEntry> eventHeap;
+static std::vector<int> firstEventOfType;
+// Lets UnscheduleEvent() skip the other alarms and timers sharing a type.
+static std::unordered_map<EventKey, int, EventKeyHash> firstEventOfKey;
+static u64 nextEventOrder;
 
 // Downcount has been moved to currentMIPS, to save a couple of clocks in every ARM JIT block
 // as we can already reach that structure through a register.
@@ -120,20 +164,127 @@ u64 GetGlobalTimeUs() {
 	return lastGlobalTimeUs + usSinceLast;
 }
 
-Event* GetNewEvent()
-{
-	if(!eventPool)
-		return new Event;
+Event *GetNewEvent() {
+	return new Event();
+}
 
-	Event* ev = eventPool;
-	eventPool = ev->next;
-	return ev;
+void FreeEvent(Event *ev) {
+	delete ev;
 }
 
-void FreeEvent(Event* ev)
-{
-	ev->next = eventPool;
-	eventPool = ev;
+static inline bool EventBefore(const HeapEntry &a, const HeapEntry &b) {
+	return a.time < b.time || (a.time == b.time && a.order < b.order);
+}
+
+static inline void SetHeapEntry(size_t i, const HeapEntry &entry) {
+	eventHeap[i] = entry;
+	eventSlots[entry.slot].heapIndex = (int)i;
+}
+
+static void SiftUp(size_t i) {
+	HeapEntry entry = eventHeap[i];
+	while (i > 0) {
+		size_t parent = (i - 1) / 2;
+		if (!EventBefore(entry, eventHeap[parent]))
+			break;
+		SetHeapEntry(i, eventHeap[parent]);
+		i = parent;
+	}
+	SetHeapEntry(i, entry);
+}
+
+static void SiftDown(size_t i) {
+	const size_t n = eventHeap.size();
+	HeapEntry entry = eventHeap[i];
+	while (true) {
+		size_t child = i * 2 + 1;
+		if (child >= n)
+			break;
+		if (child + 1 < n && EventBefore(eventHeap[child + 1], eventHeap[child]))
+			child++;
+		if (!EventBefore(eventHeap[child], entry))
+			break;
+		SetHeapEntry(i, eventHeap[child]);
+		i = child;
+	}
+	SetHeapEntry(i, entry);
+}
+
+static void AddEventToQueue(s64 time, int event_type, u64 userdata) {
+	int slot;
+	if (freeEventSlots.empty()) {
+		slot = (int)eventSlots.size();
+		eventSlots.push_back(QueuedEvent{});
+	} else {
+		slot = freeEventSlots.back();
+		freeEventSlots.pop_back();
+	}
+
+	QueuedEvent &ev = eventSlots[slot];
+	ev.time = time;
+	ev.userdata = userdata;
+	ev.type = event_type;
+	ev.order = nextEventOrder++;
+	ev.prevOfType = -1;
+	ev.nextOfType = -1;
+	if (event_type >= 0) {
+		if (event_type >= (int)firstEventOfType.size())
+			firstEventOfType.resize(event_type + 1, -1);
+		ev.nextOfType = firstEventOfType[event_type];
+		if (ev.nextOfType != -1)
+			eventSlots[ev.nextOfType].prevOfType = slot;
+		firstEventOfType[event_type] = slot;
+	}
+
+	int &firstOfKey = firstEventOfKey.emplace(EventKey{ userdata, event_type }, -1).first->second;
+	ev.prevOfKey = -1;
+	ev.nextOfKey = firstOfKey;
+	if (ev.nextOfKey != -1)
+		eventSlots[ev.nextOfKey].prevOfKey = slot;
+	firstOfKey = slot;
+
+	eventHeap.push_back(HeapEntry{ time, ev.order, slot });
+	SiftUp(eventHeap.size() - 1);
+}
+
+static void RemoveQueuedEvent(int slot) {
+	const QueuedEvent &ev = eventSlots[slot];
+	if (ev.prevOfType != -1)
+		eventSlots[ev.prevOfType].nextOfType = ev.nextOfType;
+	else if (ev.type >= 0)
+		firstEventOfType[ev.type] = ev.nextOfType;
+	if (ev.nextOfType != -1)
+		eventSlots[ev.nextOfType].prevOfType = ev.prevOfType;
+
+	if (ev.prevOfKey != -1) {
+		eventSlots[ev.prevOfKey].nextOfKey = ev.nextOfKey;
+	} else if (ev.nextOfKey != -1) {
+		firstEventOfKey[EventKey{ ev.userdata, ev.type }] = ev.nextOfKey;
+	} else {
+		firstEventOfKey.erase(EventKey{ ev.userdata, ev.type });
+	}
+	if (ev.nextOfKey != -1)
+		eventSlots[ev.nextOfKey].prevOfKey = ev.prevOfKey;
+
+	size_t i = ev.heapIndex;
+	HeapEntry last = eventHeap.back();
+	eventHeap.pop_back();
+	if (i < eventHeap.size()) {
+		SetHeapEntry(i, last);
+		if (i > 0 && EventBefore(last, eventHeap[(i - 1) / 2]))
+			SiftUp(i);
+		else
+			SiftDown(i);
+	}
+
+	freeEventSlots.push_back(slot);
+}
+
+// Pending events in the order they will fire.
+static std::vector<HeapEntry> GetSortedEvents() {
+	std::vector<HeapEntry> sorted = eventHeap;
+	std::sort(sorted.begin(), sorted.end(), &EventBefore);
+	return sorted;
 }
 
 int RegisterEvent(const char *name, TimedCallback callback) {
@@ -179,7 +330,7 @@ void RestoreRegisterEvent(int &event_type, const char *name, TimedCallback callb
 }
 
 void UnregisterAllEvents() {
-	_dbg_assert_msg_(first == nullptr, "Unregistering events with events pending - this isn't good.");
+	_dbg_assert_msg_(eventHeap.empty(), "Unregistering events with events pending - this isn't good.");
 	event_types.clear();
 	usedEventTypes.clear();
 	restoredEventTypes.clear();
@@ -202,11 +353,10 @@ void Shutdown()
 	ClearPendingEvents();
 	UnregisterAllEvents();
 
-	while (eventPool) {
-		Event *ev = eventPool;
-		eventPool = ev->next;
-		delete ev;
-	}
+	eventSlots.shrink_to_fit();
+	freeEventSlots.shrink_to_fit();
+	eventHeap.shrink_to_fit();
+	firstEventOfType.shrink_to_fit();
 }
  
 u64 GetTicks()
@@ -226,30 +376,11 @@ u64 GetIdleTicks()
 
 void ClearPendingEvents()
 {
-	while (first)
-	{
-		Event *e = first->next;
-		FreeEvent(first);
-		first = e;
-	}
-}
-
-void AddEventToQueue(Event* ne)
-{
-	Event* prev = NULL;
-	Event** pNext = &first;
-	for(;;)
-	{
-		Event*& next = *pNext;
-		if(!next || ne->time < next->time)
-		{
-			ne->next = next;
-			next = ne;
-			break;
-		}
-		prev = next;
-		pNext = &prev->next;
-	}
+	eventSlots.clear();
+	freeEventSlots.clear();
+	eventHeap.clear();
+	firstEventOfType.clear();
+	firstEventOfKey.clear();
 }
 
 // This must be run ONLY from within the cpu thread
@@ -257,55 +388,35 @@ void AddEventToQueue(Event* ne)
 // than Advance
 void ScheduleEvent(s64 cyclesIntoFuture, int event_type, u64 userdata)
 {
-	Event *ne = GetNewEvent();
-	ne->userdata = userdata;
-	ne->type = event_type;
-	ne->time = GetTicks() + cyclesIntoFuture;
-	AddEventToQueue(ne);
+	AddEventToQueue(GetTicks() + cyclesIntoFuture, event_type, userdata);
 }
 
 // Returns cycles left in timer.
 s64 UnscheduleEvent(int event_type, u64 userdata)
 {
 	s64 result = 0;
-	if (!first)
-		return result;
-	while(first)
-	{
-		if (first->type == event_type && first->userdata == userdata)
-		{
-			result = first->time - GetTicks();
-
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-	if (!first)
+	auto it = firstEventOfKey.find(EventKey{ userdata, event_type });
+	if (it == firstEventOfKey.end())
 		return result;
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type && ptr->userdata == userdata)
-		{
-			result = ptr->time - GetTicks();
-
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
+
+	// If there are several, report the one that would've fired last.
+	u64 lastOrder = 0;
+	s64 lastTime = 0;
+	bool found = false;
+	int slot = it->second;
+	while (slot != -1) {
+		const QueuedEvent &ev = eventSlots[slot];
+		if (!found || ev.time > lastTime || (ev.time == lastTime && ev.order > lastOrder)) {
+			lastTime = ev.time;
+			lastOrder = ev.order;
+			found = true;
 		}
+		int next = ev.nextOfKey;
+		RemoveQueuedEvent(slot);
+		slot = next;
 	}
 
+	result = lastTime - GetTicks();
 	return result;
 }
 
@@ -315,66 +426,30 @@ void RegisterMHzChangeCallback(MHzChangeCallback callback) {
 
 bool IsScheduled(int event_type)
 {
-	if (!first)
+	if (event_type < 0 || event_type >= (int)firstEventOfType.size())
 		return false;
-	Event *e = first;
-	while (e) {
-		if (e->type == event_type)
-			return true;
-		e = e->next;
-	}
-	return false;
+	return firstEventOfType[event_type] != -1;
 }
 
 void RemoveEvent(int event_type)
 {
-	if (!first)
-		return;
-	while(first)
-	{
-		if (first->type == event_type)
-		{
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-	if (!first)
+	if (event_type < 0 || event_type >= (int)firstEventOfType.size())
 		return;
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type)
-		{
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
-		}
-	}
+	while (firstEventOfType[event_type] != -1)
+		RemoveQueuedEvent(firstEventOfType[event_type]);
 }
 
 void ProcessEvents() {
-	while (first) {
-		if (first->time <= (s64)GetTicks()) {
-			// INFO_LOG(CPU, "%s (%lld, %lld) ", first->name ? first->name : "?", (u64)GetTicks(), (u64)first->time);
-			Event *evt = first;
-			first = first->next;
-			if (evt->type >= 0 && evt->type < event_types.size()) {
-				event_types[evt->type].callback(evt->userdata, (int)(GetTicks() - evt->time));
+	while (!eventHeap.empty()) {
+		if (eventHeap[0].time <= (s64)GetTicks()) {
+			// Copy it out, the callback may schedule more events.
+			BaseEvent evt = eventSlots[eventHeap[0].slot];
+			RemoveQueuedEvent(eventHeap[0].slot);
+			if (evt.type >= 0 && (size_t)evt.type < event_types.size()) {
+				event_types[evt.type].callback(evt.userdata, (int)(GetTicks() - evt.time));
 			} else {
-				_dbg_assert_msg_(false, "Bad event type %d", evt->type);
+				_dbg_assert_msg_(false, "Bad event type %d", evt.type);
 			}
-			FreeEvent(evt);
 		} else {
 			// Caught up to the current time.
 			break;
@@ -386,6 +461,7 @@ void ForceCheck()
 {
 	int cyclesExecuted = slicelength - currentMIPS->downcount;
 	globalTimer += cyclesExecuted;
+	SamplingProfilerSample(currentMIPS->pc, cyclesExecuted);
 	// This will cause us to check for new events immediately.
 	currentMIPS->downcount = -1;
 	// But let's not eat a bunch more time in Advance() because of this.
@@ -401,10 +477,12 @@ void Advance() {
 	int cyclesExecuted = slicelength - currentMIPS->downcount;
 	globalTimer += cyclesExecuted;
 	currentMIPS->downcount = slicelength;
+	// The cycles of the slice all go to where it ended, which averages out over many slices.
+	SamplingProfilerSample(currentMIPS->pc, cyclesExecuted);
 
 	ProcessEvents();
 
-	if (!first) {
+	if (eventHeap.empty()) {
 		// This should never happen in PPSSPP.
 		if (slicelength < 10000) {
 			slicelength += 10000;
@@ -412,7 +490,7 @@ void Advance() {
 		}
 	} else {
 		// Note that events can eat cycles as well.
-		int target = (int)(first->time - globalTimer);
+		int target = (int)(eventHeap[0].time - globalTimer);
 		if (target > MAX_SLICE_LENGTH)
 			target = MAX_SLICE_LENGTH;
 
@@ -423,10 +501,8 @@ void Advance() {
 }
 
 void LogPendingEvents() {
-	Event *ptr = first;
-	while (ptr) {
-		//INFO_LOG(CPU, "PENDING: Now: %lld Pending: %lld Type: %d", globalTimer, ptr->time, ptr->type);
-		ptr = ptr->next;
+	for (const HeapEntry &entry : GetSortedEvents()) {
+		DEBUG_LOG(CPU, "PENDING: Now: %lld Pending: %lld Type: %d", (long long)globalTimer, (long long)entry.time, eventSlots[entry.slot].type);
 	}
 }
 
@@ -435,9 +511,9 @@ void Idle(int maxIdle) {
 	if (maxIdle != 0 && cyclesDown > maxIdle)
 		cyclesDown = maxIdle;
 
-	if (first && cyclesDown > 0) {
+	if (!eventHeap.empty() && cyclesDown > 0) {
 		int cyclesExecuted = slicelength - currentMIPS->downcount;
-		int cyclesNextEvent = (int) (first->time - globalTimer);
+		int cyclesNextEvent = (int) (eventHeap[0].time - globalTimer);
 
 		if (cyclesNextEvent < cyclesExecuted + cyclesDown)
 			cyclesDown = cyclesNextEvent - cyclesExecuted;
@@ -456,14 +532,13 @@ void Idle(int maxIdle) {
 }
 
 std::string GetScheduledEventsSummary() {
-	Event *ptr = first;
 	std::string text = "Scheduled events\n";
 	text.reserve(1000);
-	while (ptr) {
+	for (const HeapEntry &entry : GetSortedEvents()) {
+		const QueuedEvent *ptr = &eventSlots[entry.slot];
 		unsigned int t = ptr->type;
 		if (t >= event_types.size()) {
 			_dbg_assert_msg_(false, "Invalid event type %d", t);
-			ptr = ptr->next;
 			continue;
 		}
 		const char *name = event_types[t].name;
@@ -472,7 +547,6 @@ std::string GetScheduledEventsSummary() {
 		char temp[512];
 		snprintf(temp, sizeof(temp), "%s : %i %08x%08x\n", name, (int)ptr->time, (u32)(ptr->userdata >> 32), (u32)(ptr->userdata));
 		text += temp;
-		ptr = ptr->next;
 	}
 	return text;
 }
@@ -513,6 +587,19 @@ void DoState(PointerWrap &p) {
 	usedEventTypes.clear();
 	restoredEventTypes.clear();
 
+	// The queue is saved as a linked list in firing order, as it always has been.
+	Event *first = nullptr;
+	if (p.mode != PointerWrap::MODE_READ) {
+		Event **pNext = &first;
+		for (const HeapEntry &entry : GetSortedEvents()) {
+			Event *ev = GetNewEvent();
+			*(BaseEvent *)ev = eventSlots[entry.slot];
+			ev->next = nullptr;
+			*pNext = ev;
+			pNext = &ev->next;
+		}
+	}
+
 	if (s >= 3) {
 		DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, Event_DoState>(p, first, (Event **)nullptr);
 		// This is here because we previously stored a second queue of "threadsafe" events. Gone now. Remove in the next section version upgrade.
@@ -522,6 +609,16 @@ void DoState(PointerWrap &p) {
 		DoIgnoreUnusedLinkedList(p);
 	}
 
+	if (p.mode == PointerWrap::MODE_READ)
+		ClearPendingEvents();
+	while (first) {
+		Event *next = first->next;
+		if (p.mode == PointerWrap::MODE_READ)
+			AddEventToQueue(first->time, first->type, first->userdata);
+		FreeEvent(first);
+		first = next;
+	}
+
 	Do(p, CPU_HZ);
 	Do(p, slicelength);
 	Do(p, globalTimer);
@@ -66,6 +66,9 @@ class MemSlabMap {
 	static constexpr uint32_t SLICE_SIZE = MAX_SIZE / SLICES;
 
 	Slab *FindSlab(uint32_t addr);
+	Slab *AllocSlab();
+	void ReleaseSlab(Slab *slab);
+	void ClearFreeSlabs();
 	void Clear();
 	// Returns the new slab after size.
 	Slab *Split(Slab *slab, uint32_t size);
@@ -78,6 +81,8 @@ class MemSlabMap {
 	Slab *lastFind_ = nullptr;
 	std::vector<Slab *> heads_;
 	Slab *bulkStorage_ = nullptr;
+	// Recycled slabs, since small writes split and merge constantly.
+	std::vector<Slab *> freeSlabs_;
 };
 
 struct PendingNotifyMem {
@@ -87,6 +92,7 @@ struct PendingNotifyMem {
 	uint32_t copySrc;
 	uint64_t ticks;
 	uint32_t pc;
+	uint32_t tagLength;
 	char tag[128];
 };
 
@@ -202,6 +208,8 @@ void MemSlabMap::DoState(PointerWrap &p) {
 		// This helps in case a debugger call happens concurrently.
 		Slab *old = first_;
 		Slab *oldBulk = bulkStorage_;
+		// These may point into oldBulk.
+		ClearFreeSlabs();
 		Do(p, count);
 
 		first_ = new Slab();
@@ -272,7 +280,32 @@ void MemSlabMap::Slab::DoState(PointerWrap &p) {
 	}
 }
 
+MemSlabMap::Slab *MemSlabMap::AllocSlab() {
+	if (freeSlabs_.empty())
+		return new Slab();
+
+	Slab *slab = freeSlabs_.back();
+	freeSlabs_.pop_back();
+	bool bulkStorage = slab->bulkStorage;
+	*slab = Slab();
+	slab->bulkStorage = bulkStorage;
+	return slab;
+}
+
+void MemSlabMap::ReleaseSlab(Slab *slab) {
+	freeSlabs_.push_back(slab);
+}
+
+void MemSlabMap::ClearFreeSlabs() {
+	for (Slab *slab : freeSlabs_) {
+		if (!slab->bulkStorage)
+			delete slab;
+	}
+	freeSlabs_.clear();
+}
+
 void MemSlabMap::Clear() {
+	ClearFreeSlabs();
 	Slab *s = first_;
 	while (s != nullptr) {
 		Slab *next = s->next;
@@ -280,7 +313,7 @@ void MemSlabMap::Clear() {
 			delete s;
 		s = next;
 	}
-	delete bulkStorage_;
+	delete [] bulkStorage_;
 	bulkStorage_ = nullptr;
 	first_ = nullptr;
 	lastFind_ = nullptr;
@@ -305,7 +338,7 @@ MemSlabMap::Slab *MemSlabMap::FindSlab(uint32_t addr) {
 }
 
 MemSlabMap::Slab *MemSlabMap::Split(Slab *slab, uint32_t size) {
-	Slab *next = new Slab();
+	Slab *next = AllocSlab();
 	next->start = slab->start + size;
 	next->end = slab->end;
 	next->ticks = slab->ticks;
@@ -374,8 +407,7 @@ void MemSlabMap::Merge(Slab *a, Slab *b) {
 	}
 	if (lastFind_ == b)
 		lastFind_ = a;
-	if (!b->bulkStorage)
-		delete b;
+	ReleaseSlab(b);
 }
 
 void MemSlabMap::FillHeads(Slab *slab) {
@@ -450,6 +482,26 @@ static inline uint32_t NormalizeAddress(uint32_t addr) {
 	return addr & 0x3FFFFFFF;
 }
 
+// Writes often march forward a piece at a time with the same tag, like a decode loop.
+// Marking them as one range ends up exactly the same, since equal adjacent slabs merge anyway.
+static inline bool ExtendLastMemInfo(MemBlockFlags flags, uint32_t start, uint32_t size, uint64_t ticks, uint32_t pc, const char *tag, size_t copyLength) {
+	if (pendingNotifies.empty())
+		return false;
+
+	auto &prev = pendingNotifies.back();
+	if (prev.copySrc != 0 || prev.flags != flags || prev.pc != pc || prev.start + prev.size != start)
+		return false;
+	// Keep each entry within one of the tracked address ranges.
+	if ((prev.start < 0x08000000) != (start < 0x08000000))
+		return false;
+	if (prev.tagLength != copyLength || memcmp(prev.tag, tag, copyLength) != 0)
+		return false;
+
+	prev.size += size;
+	prev.ticks = ticks;
+	return true;
+}
+
 static inline bool MergeRecentMemInfo(const PendingNotifyMem &info, size_t copyLength) {
 	if (pendingNotifies.size() < 4)
 		return false;
@@ -470,6 +522,7 @@ static inline bool MergeRecentMemInfo(const PendingNotifyMem &info, size_t copyL
 			return false;
 
 		memcpy(prev.tag, info.tag, copyLength + 1);
+		prev.tagLength = (uint32_t)copyLength;
 		prev.size = info.size;
 		prev.ticks = info.ticks;
 		prev.pc = info.pc;
@@ -489,28 +542,34 @@ void NotifyMemInfoPC(MemBlockFlags flags, uint32_t start, uint32_t size, uint32_
 	bool needFlush = false;
 	// When the setting is off, we skip smaller info to keep things fast.
 	if (MemBlockInfoDetailed(size) && flags != MemBlockFlags::READ) {
-		PendingNotifyMem info{ flags, start, size };
-		info.ticks = CoreTiming::GetTicks();
-		info.pc = pc;
-
+		uint64_t ticks = CoreTiming::GetTicks();
 		size_t copyLength = strLength;
-		if (copyLength >= sizeof(info.tag)) {
-			copyLength = sizeof(info.tag) - 1;
+		if (copyLength >= sizeof(PendingNotifyMem::tag)) {
+			copyLength = sizeof(PendingNotifyMem::tag) - 1;
 		}
-		memcpy(info.tag, tagStr, copyLength);
-		info.tag[copyLength] = 0;
 
 		std::lock_guard<std::mutex> guard(pendingWriteMutex);
-		// Sometimes we get duplicates, quickly check.
-		if (!MergeRecentMemInfo(info, copyLength)) {
-			if (start < 0x08000000) {
-				pendingNotifyMinAddr1 = std::min(pendingNotifyMinAddr1.load(), start);
+		if (ExtendLastMemInfo(flags, start, size, ticks, pc, tagStr, copyLength)) {
+			if (start < 0x08000000)
 				pendingNotifyMaxAddr1 = std::max(pendingNotifyMaxAddr1.load(), start + size);
-			} else {
-				pendingNotifyMinAddr2 = std::min(pendingNotifyMinAddr2.load(), start);
+			else
 				pendingNotifyMaxAddr2 = std::max(pendingNotifyMaxAddr2.load(), start + size);
+		} else {
+			PendingNotifyMem info{ flags, start, size, 0, ticks, pc, (uint32_t)copyLength, {} };
+			memcpy(info.tag, tagStr, copyLength);
+			info.tag[copyLength] = 0;
+
+			// Sometimes we get duplicates, quickly check.
+			if (!MergeRecentMemInfo(info, copyLength)) {
+				if (start < 0x08000000) {
+					pendingNotifyMinAddr1 = std::min(pendingNotifyMinAddr1.load(), start);
+					pendingNotifyMaxAddr1 = std::max(pendingNotifyMaxAddr1.load(), start + size);
+				} else {
+					pendingNotifyMinAddr2 = std::min(pendingNotifyMinAddr2.load(), start);
+					pendingNotifyMaxAddr2 = std::max(pendingNotifyMaxAddr2.load(), start + size);
+				}
+				pendingNotifies.push_back(info);
 			}
-			pendingNotifies.push_back(info);
 		}
 		needFlush = pendingNotifies.size() > MAX_PENDING_NOTIFIES_THREAD;
 	}
@@ -557,7 +616,7 @@ void NotifyMemInfoCopy(uint32_t destPtr, uint32_t srcPtr, uint32_t size, const c
 		info.pc = currentMIPS->pc;
 
 		// Store the prefix for now.  The correct tag will be calculated on flush.
-		truncate_cpy(info.tag, prefix);
+		info.tagLength = (uint32_t)truncate_cpy(info.tag, prefix);
 
 		std::lock_guard<std::mutex> guard(pendingWriteMutex);
 		if (destPtr < 0x08000000) {
@@ -0,0 +1,149 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+#include "Common/StringUtils.h"
+#include "Common/TimeUtil.h"
+#include "Core/Debugger/SamplingProfiler.h"
+#include "Core/Debugger/SymbolMap.h"
+#include "Core/MIPS/JitCommon/JitBlockCache.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
+
+std::atomic<bool> g_samplingProfilerRunning;
+
+static std::mutex samplesLock;
+static std::unordered_map<u32, SamplingProfilerPC> samples;
+static double startTime;
+static double elapsedTime;
+
+void SamplingProfilerStart() {
+	std::lock_guard<std::mutex> guard(samplesLock);
+	if (g_samplingProfilerRunning)
+		return;
+	startTime = time_now_d();
+	g_samplingProfilerRunning = true;
+}
+
+void SamplingProfilerStop() {
+	std::lock_guard<std::mutex> guard(samplesLock);
+	if (!g_samplingProfilerRunning)
+		return;
+	g_samplingProfilerRunning = false;
+	elapsedTime += time_now_d() - startTime;
+}
+
+void SamplingProfilerReset() {
+	std::lock_guard<std::mutex> guard(samplesLock);
+	samples.clear();
+	elapsedTime = 0.0;
+	startTime = time_now_d();
+}
+
+void SamplingProfilerRecord(u32 pc, int cycles) {
+	std::lock_guard<std::mutex> guard(samplesLock);
+	auto it = samples.find(pc);
+	if (it == samples.end()) {
+		// Only looked up once per PC, since the legacy block cache search is linear.
+		// We're on the emu thread, so the jit won't change underneath us.
+		int blockNum = -1;
+		JitBlockCacheDebugInterface *blockCache = MIPSComp::jit ? MIPSComp::jit->GetBlockCacheDebugInterface() : nullptr;
+		if (blockCache)
+			blockNum = blockCache->GetBlockNumberFromAddress(pc);
+		it = samples.emplace(pc, SamplingProfilerPC{ pc, blockNum, 0, 0 }).first;
+	}
+	it->second.samples++;
+	it->second.cycles += cycles;
+}
+
+SamplingProfilerReport SamplingProfilerGetReport(size_t maxFunctions, size_t maxPCs) {
+	SamplingProfilerReport report{};
+	{
+		std::lock_guard<std::mutex> guard(samplesLock);
+		report.running = g_samplingProfilerRunning;
+		report.seconds = elapsedTime + (report.running ? time_now_d() - startTime : 0.0);
+		report.pcs.reserve(samples.size());
+		for (const auto &it : samples)
+			report.pcs.push_back(it.second);
+	}
+
+	std::unordered_map<u32, SamplingProfilerFunction> functions;
+	std::unordered_map<u32, std::vector<int>> functionBlocks;
+	for (const SamplingProfilerPC &s : report.pcs) {
+		report.totalSamples += s.samples;
+		report.totalCycles += s.cycles;
+
+		u32 start = g_symbolMap ? g_symbolMap->GetFunctionStart(s.pc) : SymbolMap::INVALID_ADDRESS;
+		if (start == SymbolMap::INVALID_ADDRESS)
+			start = s.pc;
+		SamplingProfilerFunction &func = functions[start];
+		func.address = start;
+		func.samples += s.samples;
+		func.cycles += s.cycles;
+		if (s.blockNum != -1)
+			functionBlocks[start].push_back(s.blockNum);
+	}
+
+	auto hotter = [](const auto &a, const auto &b) {
+		return a.cycles > b.cycles;
+	};
+
+	report.functions.reserve(functions.size());
+	for (auto &it : functions) {
+		SamplingProfilerFunction &func = it.second;
+		std::vector<int> &blocks = functionBlocks[func.address];
+		std::sort(blocks.begin(), blocks.end());
+		func.blocks = (int)(std::unique(blocks.begin(), blocks.end()) - blocks.begin());
+		report.functions.push_back(func);
+	}
+
+	std::sort(report.functions.begin(), report.functions.end(), hotter);
+	if (maxFunctions != 0 && report.functions.size() > maxFunctions)
+		report.functions.resize(maxFunctions);
+	std::sort(report.pcs.begin(), report.pcs.end(), hotter);
+	if (maxPCs != 0 && report.pcs.size() > maxPCs)
+		report.pcs.resize(maxPCs);
+
+	// Only look up names for what we're returning.
+	if (g_symbolMap) {
+		for (SamplingProfilerFunction &func : report.functions)
+			func.name = g_symbolMap->GetLabelString(func.address);
+	}
+
+	return report;
+}
+
+std::string SamplingProfilerFormatReport(const SamplingProfilerReport &report) {
+	std::string result = StringFromFormat("%u samples, %llu cycles over %0.2f seconds\n", report.totalSamples, (unsigned long long)report.totalCycles, report.seconds);
+	if (report.totalCycles == 0)
+		return result;
+
+	result += "\n   cycles  samples  blocks  address   function\n";
+	for (const SamplingProfilerFunction &func : report.functions) {
+		double percent = 100.0 * (double)func.cycles / (double)report.totalCycles;
+		result += StringFromFormat("%8.2f%% %8u %7d  %08x  %s\n", percent, func.samples, func.blocks, func.address, func.name.c_str());
+	}
+
+	result += "\n   cycles  samples   block  pc\n";
+	for (const SamplingProfilerPC &s : report.pcs) {
+		double percent = 100.0 * (double)s.cycles / (double)report.totalCycles;
+		result += StringFromFormat("%8.2f%% %8u %7d  %08x\n", percent, s.samples, s.blockNum, s.pc);
+	}
+	return result;
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// Samples the guest PC each time CoreTiming advances, weighted by the cycles run since the last one.
+// Since it's driven by emulated time rather than host time, it's cheap and works the same headless.
+
+struct SamplingProfilerPC {
+	u32 pc;
+	// Jit block containing the PC when first sampled, or -1.
+	int blockNum;
+	u32 samples;
+	u64 cycles;
+};
+
+struct SamplingProfilerFunction {
+	// Start of the function from the symbol map, or the PC itself if unknown.
+	u32 address;
+	std::string name;
+	u32 samples;
+	u64 cycles;
+	int blocks;
+};
+
+struct SamplingProfilerReport {
+	bool running;
+	double seconds;
+	u32 totalSamples;
+	u64 totalCycles;
+	// Sorted by cycles, hottest first.
+	std::vector<SamplingProfilerFunction> functions;
+	std::vector<SamplingProfilerPC> pcs;
+};
+
+extern std::atomic<bool> g_samplingProfilerRunning;
+
+void SamplingProfilerStart();
+void SamplingProfilerStop();
+void SamplingProfilerReset();
+// Limits are on the number of functions and PCs returned, 0 for all.
+SamplingProfilerReport SamplingProfilerGetReport(size_t maxFunctions, size_t maxPCs);
+// Human readable version, used by headless.
+std::string SamplingProfilerFormatReport(const SamplingProfilerReport &report);
+
+void SamplingProfilerRecord(u32 pc, int cycles);
+
+// Called from CoreTiming on the emu thread.
+inline void SamplingProfilerSample(u32 pc, int cycles) {
+	if (g_samplingProfilerRunning.load(std::memory_order_relaxed) && cycles > 0)
+		SamplingProfilerRecord(pc, cycles);
+}
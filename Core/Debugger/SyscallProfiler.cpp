@@ -0,0 +1,240 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+#include "Common/Data/Format/JSONWriter.h"
+#include "Common/StringUtils.h"
+#include "Common/TimeUtil.h"
+#include "Core/Debugger/SyscallProfiler.h"
+#include "Core/HLE/HLE.h"
+#include "Core/HLE/sceKernelThread.h"
+#include "Core/MIPS/MIPS.h"
+
+std::atomic<bool> g_syscallProfilerRunning;
+
+struct SyscallProfilerEvent {
+	const HLEFunction *func;
+	const char *module;
+	int threadID;
+	double start;
+	double seconds;
+};
+
+struct SyscallProfilerStats {
+	SyscallProfilerFunction func;
+	u32 frameCalls;
+	double frameSeconds;
+};
+
+// About 40 bytes each, so this caps the trace at around 20 MB.
+static const size_t MAX_TRACE_EVENTS = 500000;
+static const size_t MAX_FRAMES = 600;
+
+static std::mutex profilerLock;
+static std::unordered_map<const HLEFunction *, SyscallProfilerStats> stats;
+// Functions called since the last frame ended, so ending a frame doesn't walk them all.
+static std::vector<SyscallProfilerStats *> frameFunctions;
+static SyscallProfilerFrame currentFrame;
+static std::deque<SyscallProfilerFrame> frames;
+static std::vector<SyscallProfilerEvent> events;
+static std::vector<double> frameTimes;
+static std::unordered_map<int, std::string> threadNames;
+static u32 droppedEvents;
+static u32 frameCount;
+static double startTime;
+static double elapsedTime;
+// Trace timestamps are relative to this, so they stay consistent across a stop and start.
+static double traceStartTime;
+
+void SyscallProfilerStart() {
+	{
+		std::lock_guard<std::mutex> guard(profilerLock);
+		if (g_syscallProfilerRunning)
+			return;
+		startTime = time_now_d();
+		if (events.empty() && frameTimes.empty())
+			traceStartTime = startTime;
+		g_syscallProfilerRunning = true;
+	}
+	// The jit calls syscall thunks directly, recompile so they go through CallSyscall().
+	mipsr4k.ClearJitCache();
+}
+
+void SyscallProfilerStop() {
+	{
+		std::lock_guard<std::mutex> guard(profilerLock);
+		if (!g_syscallProfilerRunning)
+			return;
+		g_syscallProfilerRunning = false;
+		elapsedTime += time_now_d() - startTime;
+	}
+	mipsr4k.ClearJitCache();
+}
+
+void SyscallProfilerReset() {
+	std::lock_guard<std::mutex> guard(profilerLock);
+	stats.clear();
+	frameFunctions.clear();
+	currentFrame = {};
+	frames.clear();
+	events.clear();
+	frameTimes.clear();
+	threadNames.clear();
+	droppedEvents = 0;
+	frameCount = 0;
+	elapsedTime = 0.0;
+	startTime = time_now_d();
+	traceStartTime = startTime;
+}
+
+void SyscallProfilerRecord(const HLEFunction *func, const char *module, int threadID, double start, double seconds) {
+	std::lock_guard<std::mutex> guard(profilerLock);
+	auto it = stats.find(func);
+	if (it == stats.end())
+		it = stats.emplace(func, SyscallProfilerStats{ { module, func->name, 0, 0.0, 0.0, 0.0 }, 0, 0.0 }).first;
+
+	SyscallProfilerStats &s = it->second;
+	if (s.frameCalls++ == 0)
+		frameFunctions.push_back(&s);
+	s.func.calls++;
+	s.func.seconds += seconds;
+	s.func.maxSeconds = std::max(s.func.maxSeconds, seconds);
+	s.frameSeconds += seconds;
+	currentFrame.calls++;
+	currentFrame.seconds += seconds;
+
+	if (events.size() < MAX_TRACE_EVENTS) {
+		events.push_back(SyscallProfilerEvent{ func, module, threadID, start, seconds });
+		if (threadNames.find(threadID) == threadNames.end())
+			threadNames[threadID] = __KernelGetThreadName(threadID);
+	} else {
+		droppedEvents++;
+	}
+}
+
+void SyscallProfilerRecordFrame() {
+	std::lock_guard<std::mutex> guard(profilerLock);
+	for (SyscallProfilerStats *s : frameFunctions) {
+		s->func.maxFrameSeconds = std::max(s->func.maxFrameSeconds, s->frameSeconds);
+		s->frameCalls = 0;
+		s->frameSeconds = 0.0;
+	}
+	frameFunctions.clear();
+
+	frameCount++;
+	frames.push_back(currentFrame);
+	if (frames.size() > MAX_FRAMES)
+		frames.pop_front();
+	currentFrame = {};
+	if (events.size() < MAX_TRACE_EVENTS)
+		frameTimes.push_back(time_now_d());
+}
+
+SyscallProfilerReport SyscallProfilerGetReport(size_t maxFunctions, size_t maxFrames) {
+	SyscallProfilerReport report{};
+	std::lock_guard<std::mutex> guard(profilerLock);
+	report.running = g_syscallProfilerRunning;
+	report.seconds = elapsedTime + (report.running ? time_now_d() - startTime : 0.0);
+	report.droppedEvents = droppedEvents;
+	report.frameCount = frameCount;
+
+	report.functions.reserve(stats.size());
+	for (const auto &it : stats) {
+		report.functions.push_back(it.second.func);
+		report.calls += it.second.func.calls;
+		report.syscallSeconds += it.second.func.seconds;
+	}
+	std::sort(report.functions.begin(), report.functions.end(), [](const SyscallProfilerFunction &a, const SyscallProfilerFunction &b) {
+		return a.seconds > b.seconds;
+	});
+	if (maxFunctions != 0 && report.functions.size() > maxFunctions)
+		report.functions.resize(maxFunctions);
+
+	size_t firstFrame = maxFrames != 0 && frames.size() > maxFrames ? frames.size() - maxFrames : 0;
+	report.frames.assign(frames.begin() + firstFrame, frames.end());
+	return report;
+}
+
+std::string SyscallProfilerFormatReport(const SyscallProfilerReport &report) {
+	std::string result = StringFromFormat("%u syscalls, %0.2f ms over %0.2f seconds, %u frames\n", report.calls, report.syscallSeconds * 1000.0, report.seconds, report.frameCount);
+	if (report.calls == 0)
+		return result;
+
+	result += "\n     time   calls   avg us   max us  max/frame  function\n";
+	for (const SyscallProfilerFunction &func : report.functions) {
+		double percent = 100.0 * func.seconds / report.syscallSeconds;
+		double avg = func.seconds * 1000000.0 / func.calls;
+		result += StringFromFormat("%8.2f%% %7u %8.2f %8.2f %7.2f ms  %s::%s\n", percent, func.calls, avg, func.maxSeconds * 1000000.0, func.maxFrameSeconds * 1000.0, func.module, func.name);
+	}
+	return result;
+}
+
+void SyscallProfilerWriteTrace(json::JsonWriter &writer) {
+	std::lock_guard<std::mutex> guard(profilerLock);
+	// Timestamps are in microseconds.  writeFloat() doesn't keep enough digits for them.
+	auto writeMicros = [&](const char *name, double seconds) {
+		writer.writeRaw(name, StringFromFormat("%0.3f", seconds * 1000000.0));
+	};
+
+	writer.pushArray("traceEvents");
+	for (const auto &it : threadNames) {
+		writer.pushDict();
+		writer.writeString("name", "thread_name");
+		writer.writeString("ph", "M");
+		writer.writeInt("pid", 1);
+		writer.writeInt("tid", it.first);
+		writer.pushDict("args");
+		writer.writeString("name", it.second);
+		writer.pop();
+		writer.pop();
+	}
+	for (size_t i = 0; i < frameTimes.size(); ++i) {
+		writer.pushDict();
+		writer.writeString("name", StringFromFormat("Frame %d", (int)i));
+		writer.writeString("ph", "i");
+		writer.writeString("s", "g");
+		writer.writeInt("pid", 1);
+		writer.writeInt("tid", 0);
+		writeMicros("ts", frameTimes[i] - traceStartTime);
+		writer.pop();
+	}
+	for (const SyscallProfilerEvent &e : events) {
+		writer.pushDict();
+		writer.writeString("name", e.func->name);
+		writer.writeString("cat", e.module);
+		writer.writeString("ph", "X");
+		writer.writeInt("pid", 1);
+		writer.writeInt("tid", e.threadID);
+		writeMicros("ts", e.start - traceStartTime);
+		writeMicros("dur", e.seconds);
+		writer.pop();
+	}
+	writer.pop();
+	writer.writeString("displayTimeUnit", "ms");
+}
+
+std::string SyscallProfilerExportTrace() {
+	json::JsonWriter writer;
+	writer.begin();
+	SyscallProfilerWriteTrace(writer);
+	writer.end();
+	return writer.str();
+}
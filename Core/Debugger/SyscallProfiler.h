@@ -0,0 +1,85 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace json {
+class JsonWriter;
+}
+
+struct HLEFunction;
+
+// Measures host time spent in each HLE function, per call and per frame, while running.
+// Syscalls are timed in CallSyscall() in HLE.cpp, which the jit calls for every syscall while
+// the profiler is on.  Can also export each call as a Chrome trace event.
+
+struct SyscallProfilerFunction {
+	const char *module;
+	const char *name;
+	u32 calls;
+	double seconds;
+	// The slowest single call, and the most time spent in one frame.
+	double maxSeconds;
+	double maxFrameSeconds;
+};
+
+struct SyscallProfilerFrame {
+	u32 calls;
+	double seconds;
+};
+
+struct SyscallProfilerReport {
+	bool running;
+	double seconds;
+	u32 calls;
+	double syscallSeconds;
+	u32 frameCount;
+	// Calls that didn't fit in the trace, they're still counted above.
+	u32 droppedEvents;
+	// Sorted by time, slowest first.
+	std::vector<SyscallProfilerFunction> functions;
+	// Most recent last, only the last few hundred are kept.
+	std::vector<SyscallProfilerFrame> frames;
+};
+
+extern std::atomic<bool> g_syscallProfilerRunning;
+
+void SyscallProfilerStart();
+void SyscallProfilerStop();
+void SyscallProfilerReset();
+// Limits are on the number of functions and frames returned, 0 for all.
+SyscallProfilerReport SyscallProfilerGetReport(size_t maxFunctions, size_t maxFrames);
+// Human readable version, used by headless.
+std::string SyscallProfilerFormatReport(const SyscallProfilerReport &report);
+// Writes traceEvents in the Chrome trace event format (chrome://tracing, Perfetto) into the current dict.
+void SyscallProfilerWriteTrace(json::JsonWriter &writer);
+std::string SyscallProfilerExportTrace();
+
+void SyscallProfilerRecord(const HLEFunction *func, const char *module, int threadID, double start, double seconds);
+void SyscallProfilerRecordFrame();
+
+// Called from __DisplayFlip() on the emu thread.
+inline void SyscallProfilerEndFrame() {
+	if (g_syscallProfilerRunning.load(std::memory_order_relaxed))
+		SyscallProfilerRecordFrame();
+}
@@ -60,6 +60,7 @@
 #include "Core/Debugger/WebSocket/InputSubscriber.h"
 #include "Core/Debugger/WebSocket/MemoryInfoSubscriber.h"
 #include "Core/Debugger/WebSocket/MemorySubscriber.h"
+#include "Core/Debugger/WebSocket/ProfilerSubscriber.h"
 #include "Core/Debugger/WebSocket/ReplaySubscriber.h"
 #include "Core/Debugger/WebSocket/SteppingSubscriber.h"
 #include "Core/Debugger/WebSocket/ClientConfigSubscriber.h"
@@ -77,6 +78,7 @@ static const std::vector<SubscriberInit> subscribers({
 	&WebSocketInputInit,
 	&WebSocketMemoryInfoInit,
 	&WebSocketMemoryInit,
+	&WebSocketProfilerInit,
 	&WebSocketReplayInit,
 	&WebSocketSteppingInit,
 	&WebSocketClientConfigInit,
@@ -0,0 +1,277 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "Core/Debugger/SamplingProfiler.h"
+#include "Core/Debugger/SyscallProfiler.h"
+#include "Core/Debugger/WebSocket/ProfilerSubscriber.h"
+#include "Core/Debugger/WebSocket/WebSocketUtils.h"
+#include "Core/System.h"
+
+class WebSocketProfilerState : public DebuggerSubscriber {
+public:
+	~WebSocketProfilerState() {
+		// Don't leave it running if the client went away.
+		if (started_)
+			SamplingProfilerStop();
+		if (syscallStarted_)
+			SyscallProfilerStop();
+	}
+
+	void CPUStart(DebuggerRequest &req);
+	void CPUStop(DebuggerRequest &req);
+	void CPUReport(DebuggerRequest &req);
+	void SyscallStart(DebuggerRequest &req);
+	void SyscallStop(DebuggerRequest &req);
+	void SyscallReport(DebuggerRequest &req);
+	void SyscallTrace(DebuggerRequest &req);
+
+protected:
+	bool started_ = false;
+	bool syscallStarted_ = false;
+};
+
+DebuggerSubscriber *WebSocketProfilerInit(DebuggerEventHandlerMap &map) {
+	auto p = new WebSocketProfilerState();
+	map["profiler.cpu.start"] = std::bind(&WebSocketProfilerState::CPUStart, p, std::placeholders::_1);
+	map["profiler.cpu.stop"] = std::bind(&WebSocketProfilerState::CPUStop, p, std::placeholders::_1);
+	map["profiler.cpu.report"] = std::bind(&WebSocketProfilerState::CPUReport, p, std::placeholders::_1);
+	map["profiler.syscall.start"] = std::bind(&WebSocketProfilerState::SyscallStart, p, std::placeholders::_1);
+	map["profiler.syscall.stop"] = std::bind(&WebSocketProfilerState::SyscallStop, p, std::placeholders::_1);
+	map["profiler.syscall.report"] = std::bind(&WebSocketProfilerState::SyscallReport, p, std::placeholders::_1);
+	map["profiler.syscall.trace"] = std::bind(&WebSocketProfilerState::SyscallTrace, p, std::placeholders::_1);
+
+	return p;
+}
+
+// Start sampling guest code (profiler.cpu.start)
+//
+// Parameters:
+//  - reset: optional boolean, pass false to keep samples from a previous run.
+//
+// Response (same event name) with no extra data.
+//
+// Note: samples are taken as emulated time advances, so stepping or pausing doesn't skew them.
+void WebSocketProfilerState::CPUStart(DebuggerRequest &req) {
+	if (!PSP_IsInited())
+		return req.Fail("CPU not started");
+
+	bool reset = true;
+	if (!req.ParamBool("reset", &reset, DebuggerParamType::OPTIONAL))
+		return;
+
+	if (reset)
+		SamplingProfilerReset();
+	SamplingProfilerStart();
+	started_ = true;
+
+	req.Respond();
+}
+
+// Stop sampling guest code (profiler.cpu.stop)
+//
+// No parameters.
+//
+// Response (same event name) with no extra data.
+//
+// Note: samples are kept until the next start, use profiler.cpu.report to get them.
+void WebSocketProfilerState::CPUStop(DebuggerRequest &req) {
+	SamplingProfilerStop();
+	started_ = false;
+
+	req.Respond();
+}
+
+// Get the hottest sampled functions (profiler.cpu.report)
+//
+// Parameters:
+//  - functions: optional number of functions to return, default 100.  Use 0 for all.
+//  - pcs: optional number of individual PCs to return, default 0.
+//
+// Response (same event name):
+//  - running: boolean, whether samples are still being collected.
+//  - seconds: number, host time spent sampling.
+//  - samples: number of samples taken.
+//  - cycles: number of emulated cycles the samples cover.
+//  - functions: array of objects, hottest first:
+//     - address: start address of function, or the PC if not within a known function.
+//     - name: string, function name or empty if unknown.
+//     - samples: number of samples within the function.
+//     - cycles: number of emulated cycles attributed to the function.
+//     - blocks: number of distinct jit blocks sampled within the function.
+//  - pcs: array of objects, hottest first:
+//     - pc: sampled address.
+//     - block: number of jit block containing the address, or -1.
+//     - samples: number of samples at this address.
+//     - cycles: number of emulated cycles attributed to this address.
+void WebSocketProfilerState::CPUReport(DebuggerRequest &req) {
+	uint32_t maxFunctions = 100;
+	if (!req.ParamU32("functions", &maxFunctions, false, DebuggerParamType::OPTIONAL))
+		return;
+	uint32_t maxPCs = 0;
+	if (!req.ParamU32("pcs", &maxPCs, false, DebuggerParamType::OPTIONAL))
+		return;
+
+	SamplingProfilerReport report = SamplingProfilerGetReport(maxFunctions, maxPCs);
+	// Zero means all functions, but only means no PCs.
+	if (maxPCs == 0)
+		report.pcs.clear();
+
+	JsonWriter &json = req.Respond();
+	json.writeBool("running", report.running);
+	json.writeFloat("seconds", report.seconds);
+	json.writeUint("samples", report.totalSamples);
+	json.writeFloat("cycles", (double)report.totalCycles);
+	json.pushArray("functions");
+	for (const SamplingProfilerFunction &func : report.functions) {
+		json.pushDict();
+		json.writeUint("address", func.address);
+		json.writeString("name", func.name);
+		json.writeUint("samples", func.samples);
+		json.writeFloat("cycles", (double)func.cycles);
+		json.writeInt("blocks", func.blocks);
+		json.pop();
+	}
+	json.pop();
+	json.pushArray("pcs");
+	for (const SamplingProfilerPC &s : report.pcs) {
+		json.pushDict();
+		json.writeUint("pc", s.pc);
+		json.writeInt("block", s.blockNum);
+		json.writeUint("samples", s.samples);
+		json.writeFloat("cycles", (double)s.cycles);
+		json.pop();
+	}
+	json.pop();
+}
+
+// Start timing HLE syscalls (profiler.syscall.start)
+//
+// Parameters:
+//  - reset: optional boolean, pass false to keep calls from a previous run.
+//
+// Response (same event name) with no extra data.
+//
+// Note: this makes the jit recompile, so that every syscall goes through the timed path.
+void WebSocketProfilerState::SyscallStart(DebuggerRequest &req) {
+	if (!PSP_IsInited())
+		return req.Fail("CPU not started");
+
+	bool reset = true;
+	if (!req.ParamBool("reset", &reset, DebuggerParamType::OPTIONAL))
+		return;
+
+	if (reset)
+		SyscallProfilerReset();
+	SyscallProfilerStart();
+	syscallStarted_ = true;
+
+	req.Respond();
+}
+
+// Stop timing HLE syscalls (profiler.syscall.stop)
+//
+// No parameters.
+//
+// Response (same event name) with no extra data.
+//
+// Note: data is kept until the next start, use profiler.syscall.report or trace to get it.
+void WebSocketProfilerState::SyscallStop(DebuggerRequest &req) {
+	SyscallProfilerStop();
+	syscallStarted_ = false;
+
+	req.Respond();
+}
+
+// Get the syscalls that took the most host time (profiler.syscall.report)
+//
+// Parameters:
+//  - functions: optional number of functions to return, default 100.  Use 0 for all.
+//  - frames: optional number of recent frames to return, default 0.
+//
+// Response (same event name):
+//  - running: boolean, whether syscalls are still being timed.
+//  - seconds: number, host time spent profiling.
+//  - calls: number of syscalls timed.
+//  - syscallSeconds: number, host time spent in those syscalls.
+//  - frameCount: number of frames profiled.
+//  - droppedEvents: number of calls left out of the trace because it was full.
+//  - functions: array of objects, slowest first:
+//     - module: string, HLE module name.
+//     - name: string, function name.
+//     - calls: number of calls.
+//     - seconds: number, total host time.
+//     - maxSeconds: number, host time of the slowest call.
+//     - maxFrameSeconds: number, most host time spent in a single frame.
+//  - frames: array of objects, most recent last:
+//     - calls: number of syscalls during the frame.
+//     - seconds: number, host time spent in syscalls during the frame.
+void WebSocketProfilerState::SyscallReport(DebuggerRequest &req) {
+	uint32_t maxFunctions = 100;
+	if (!req.ParamU32("functions", &maxFunctions, false, DebuggerParamType::OPTIONAL))
+		return;
+	uint32_t maxFrames = 0;
+	if (!req.ParamU32("frames", &maxFrames, false, DebuggerParamType::OPTIONAL))
+		return;
+
+	SyscallProfilerReport report = SyscallProfilerGetReport(maxFunctions, maxFrames);
+	// Zero means all functions, but no frames.
+	if (maxFrames == 0)
+		report.frames.clear();
+
+	JsonWriter &json = req.Respond();
+	json.writeBool("running", report.running);
+	json.writeFloat("seconds", report.seconds);
+	json.writeUint("calls", report.calls);
+	json.writeFloat("syscallSeconds", report.syscallSeconds);
+	json.writeUint("frameCount", report.frameCount);
+	json.writeUint("droppedEvents", report.droppedEvents);
+	json.pushArray("functions");
+	for (const SyscallProfilerFunction &func : report.functions) {
+		json.pushDict();
+		json.writeString("module", func.module);
+		json.writeString("name", func.name);
+		json.writeUint("calls", func.calls);
+		json.writeFloat("seconds", func.seconds);
+		json.writeFloat("maxSeconds", func.maxSeconds);
+		json.writeFloat("maxFrameSeconds", func.maxFrameSeconds);
+		json.pop();
+	}
+	json.pop();
+	json.pushArray("frames");
+	for (const SyscallProfilerFrame &frame : report.frames) {
+		json.pushDict();
+		json.writeUint("calls", frame.calls);
+		json.writeFloat("seconds", frame.seconds);
+		json.pop();
+	}
+	json.pop();
+}
+
+// Get each timed syscall as a Chrome trace event (profiler.syscall.trace)
+//
+// No parameters.
+//
+// Response (same event name):
+//  - traceEvents: array of trace events, in the Chrome trace event format.
+//    Complete events ("X") for each syscall, with the guest thread as tid.
+//  - displayTimeUnit: string, "ms".
+//
+// Note: the response minus event and ticket can be loaded into chrome://tracing or Perfetto.
+void WebSocketProfilerState::SyscallTrace(DebuggerRequest &req) {
+	JsonWriter &json = req.Respond();
+	SyscallProfilerWriteTrace(json);
+}
@@ -24,6 +24,7 @@
 #include "Common/StringUtils.h"
 #include "Core/FileSystems/MetaFileSystem.h"
 #include "Core/HLE/sceKernelThread.h"
+#include "Core/MemWriteWatch.h"
 #include "Core/Reporting.h"
 #include "Core/System.h"
 
@@ -534,10 +535,13 @@ size_t MetaFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size)
 {
 	std::lock_guard<std::recursive_mutex> guard(lock);
 	IFileSystem *sys = GetHandleOwner(handle);
-	if (sys)
-		return sys->ReadFile(handle, pointer, size);
-	else
+	if (!sys)
 		return 0;
+	// File systems may read() straight into guest memory, which fails rather than faults if write watched.
+	Memory::WriteWatch_BeginHostWrite(pointer, size);
+	size_t result = sys->ReadFile(handle, pointer, size);
+	Memory::WriteWatch_EndHostWrite(pointer, size);
+	return result;
 }
 
 size_t MetaFileSystem::WriteFile(u32 handle, const u8 *pointer, s64 size)
@@ -554,10 +558,12 @@ size_t MetaFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &usec)
 {
 	std::lock_guard<std::recursive_mutex> guard(lock);
 	IFileSystem *sys = GetHandleOwner(handle);
-	if (sys)
-		return sys->ReadFile(handle, pointer, size, usec);
-	else
+	if (!sys)
 		return 0;
+	Memory::WriteWatch_BeginHostWrite(pointer, size);
+	size_t result = sys->ReadFile(handle, pointer, size, usec);
+	Memory::WriteWatch_EndHostWrite(pointer, size);
+	return result;
 }
 
 size_t MetaFileSystem::WriteFile(u32 handle, const u8 *pointer, s64 size, int &usec)
@@ -19,6 +19,8 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 #include "Common/Profiler/Profiler.h"
 
@@ -28,6 +30,7 @@
 #include "Core/Config.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/Debugger/SyscallProfiler.h"
 #include "Core/MemMapHelpers.h"
 #include "Core/Reporting.h"
 #include "Core/System.h"
@@ -62,6 +65,14 @@ enum
 };
 
 static std::vector<HLEModule> moduleDB;
+// Module names point into the static tables, so views are safe as keys.
+static std::unordered_map<std::string_view, int> moduleIndexByName;
+// Keyed by (moduleIndex << 32) | nid, so import linking doesn't scan the function tables.
+static std::unordered_map<u64, int> funcIndexByNid;
+// Parallel to moduleDB's function tables, with the flag checks resolved at registration.
+typedef void (*HLESyscallThunk)(const HLEFunction *info);
+static std::vector<std::vector<HLESyscallThunk>> syscallThunks;
+static HLESyscallThunk ChooseSyscallThunk(const HLEFunction &func, bool idle);
 static int delayedResultEvent = -1;
 static int hleAfterSyscall = HLE_AFTER_NOTHING;
 static const char *hleAfterSyscallReschedReason;
@@ -155,6 +166,9 @@ void HLEShutdown() {
 	latestSyscall = nullptr;
 	latestSyscallPC = 0;
 	moduleDB.clear();
+	moduleIndexByName.clear();
+	funcIndexByNid.clear();
+	syscallThunks.clear();
 	enqueuedMipsCalls.clear();
 	for (auto p : mipsCallActions) {
 		delete p;
@@ -165,25 +179,33 @@ void HLEShutdown() {
 void RegisterModule(const char *name, int numFunctions, const HLEFunction *funcTable)
 {
 	HLEModule module = {name, numFunctions, funcTable};
+	int moduleIndex = (int)moduleDB.size();
 	moduleDB.push_back(module);
+
+	// If a name or NID is registered twice, the first one wins, same as a linear search.
+	moduleIndexByName.emplace(name, moduleIndex);
+	for (int i = 0; i < numFunctions; i++)
+		funcIndexByNid.emplace(((u64)moduleIndex << 32) | funcTable[i].ID, i);
+
+	std::vector<HLESyscallThunk> &thunks = syscallThunks.emplace_back();
+	thunks.reserve(numFunctions);
+	for (int i = 0; i < numFunctions; i++)
+		thunks.push_back(ChooseSyscallThunk(funcTable[i], !strcmp(name, "FakeSysCalls") && funcTable[i].ID == NID_IDLE));
 }
 
 int GetModuleIndex(const char *moduleName)
 {
-	for (size_t i = 0; i < moduleDB.size(); i++)
-		if (strcmp(moduleName, moduleDB[i].name) == 0)
-			return (int)i;
+	auto it = moduleIndexByName.find(moduleName);
+	if (it != moduleIndexByName.end())
+		return it->second;
 	return -1;
 }
 
 int GetFuncIndex(int moduleIndex, u32 nib)
 {
-	const HLEModule &module = moduleDB[moduleIndex];
-	for (int i = 0; i < module.numFunctions; i++)
-	{
-		if (module.funcTable[i].ID == nib)
-			return i;
-	}
+	auto it = funcIndexByNid.find(((u64)moduleIndex << 32) | nib);
+	if (it != funcIndexByNid.end())
+		return it->second;
 	return -1;
 }
 
@@ -589,6 +611,13 @@ inline void hleFinishSyscall(const HLEFunction &info)
 	hleAfterSyscallReschedReason = 0;
 }
 
+inline static void hleFinishSyscallOrDeadbeef(const HLEFunction &info) {
+	if (hleAfterSyscall != HLE_AFTER_NOTHING)
+		hleFinishSyscall(info);
+	else
+		SetDeadbeefRegs();
+}
+
 static void updateSyscallStats(int modulenum, int funcnum, double total)
 {
 	const char *name = moduleDB[modulenum].funcTable[funcnum].name;
@@ -604,6 +633,13 @@ static void updateSyscallStats(int modulenum, int funcnum, double total)
 	kernelStats.msInSyscalls += total;
 
 	KernelStatsSyscall statCall(modulenum, funcnum);
+	int calls = ++kernelStats.summedSyscallCalls[statCall];
+	if (calls > kernelStats.summedMostCalls)
+	{
+		kernelStats.summedMostCalls = calls;
+		kernelStats.summedMostCalledName = name;
+	}
+
 	auto summedStat = kernelStats.summedMsInSyscalls.find(statCall);
 	if (summedStat == kernelStats.summedMsInSyscalls.end())
 	{
@@ -625,43 +661,67 @@ static void updateSyscallStats(int modulenum, int funcnum, double total)
 	}
 }
 
-inline void CallSyscallWithFlags(const HLEFunction *info)
-{
+template <u32 checks>
+static void CallSyscallThunk(const HLEFunction *info) {
 	latestSyscall = info;
 	latestSyscallPC = currentMIPS->pc;
-	const u32 flags = info->flags;
 
-	if (flags & HLE_CLEAR_STACK_BYTES) {
+	if constexpr ((checks & HLE_CLEAR_STACK_BYTES) != 0) {
 		u32 stackStart = __KernelGetCurThreadStackStart();
 		if (currentMIPS->r[MIPS_REG_SP] - info->stackBytesToClear >= stackStart) {
 			Memory::Memset(currentMIPS->r[MIPS_REG_SP] - info->stackBytesToClear, 0, info->stackBytesToClear, "HLEStackClear");
 		}
 	}
 
-	if ((flags & HLE_NOT_DISPATCH_SUSPENDED) && !__KernelIsDispatchEnabled()) {
-		RETURN(hleLogDebug(HLE, SCE_KERNEL_ERROR_CAN_NOT_WAIT, "dispatch suspended"));
-	} else if ((flags & HLE_NOT_IN_INTERRUPT) && __IsInInterrupt()) {
-		RETURN(hleLogDebug(HLE, SCE_KERNEL_ERROR_ILLEGAL_CONTEXT, "in interrupt"));
-	} else {
-		info->func();
+	if constexpr ((checks & HLE_NOT_DISPATCH_SUSPENDED) != 0) {
+		if (!__KernelIsDispatchEnabled()) {
+			RETURN(hleLogDebug(HLE, SCE_KERNEL_ERROR_CAN_NOT_WAIT, "dispatch suspended"));
+			hleFinishSyscallOrDeadbeef(*info);
+			return;
+		}
+	}
+	if constexpr ((checks & HLE_NOT_IN_INTERRUPT) != 0) {
+		if (__IsInInterrupt()) {
+			RETURN(hleLogDebug(HLE, SCE_KERNEL_ERROR_ILLEGAL_CONTEXT, "in interrupt"));
+			hleFinishSyscallOrDeadbeef(*info);
+			return;
+		}
 	}
 
-	if (hleAfterSyscall != HLE_AFTER_NOTHING)
-		hleFinishSyscall(*info);
-	else
-		SetDeadbeefRegs();
+	info->func();
+	hleFinishSyscallOrDeadbeef(*info);
 }
 
-inline void CallSyscallWithoutFlags(const HLEFunction *info)
-{
-	latestSyscall = info;
-	latestSyscallPC = currentMIPS->pc;
+static void CallIdleSyscallThunk(const HLEFunction *info) {
 	info->func();
+}
 
-	if (hleAfterSyscall != HLE_AFTER_NOTHING)
-		hleFinishSyscall(*info);
-	else
-		SetDeadbeefRegs();
+static void CallUnimplementedSyscallThunk(const HLEFunction *info) {
+	RETURN(SCE_KERNEL_ERROR_LIBRARY_NOT_YET_LINKED);
+	ERROR_LOG_REPORT(HLE, "Unimplemented HLE function %s", info->name ? info->name : "(\?\?\?)");
+}
+
+// The flags that are checked before the call. Each combination gets its own thunk,
+// indexed by these bits shifted down.
+static_assert(HLE_CLEAR_STACK_BYTES == HLE_NOT_IN_INTERRUPT << 2 && HLE_NOT_DISPATCH_SUSPENDED == HLE_NOT_IN_INTERRUPT << 1, "Thunk flags must be contiguous");
+static const HLESyscallThunk syscallThunksByFlags[8] = {
+	&CallSyscallThunk<0>,
+	&CallSyscallThunk<HLE_NOT_IN_INTERRUPT>,
+	&CallSyscallThunk<HLE_NOT_DISPATCH_SUSPENDED>,
+	&CallSyscallThunk<HLE_NOT_DISPATCH_SUSPENDED | HLE_NOT_IN_INTERRUPT>,
+	&CallSyscallThunk<HLE_CLEAR_STACK_BYTES>,
+	&CallSyscallThunk<HLE_CLEAR_STACK_BYTES | HLE_NOT_IN_INTERRUPT>,
+	&CallSyscallThunk<HLE_CLEAR_STACK_BYTES | HLE_NOT_DISPATCH_SUSPENDED>,
+	&CallSyscallThunk<HLE_CLEAR_STACK_BYTES | HLE_NOT_DISPATCH_SUSPENDED | HLE_NOT_IN_INTERRUPT>,
+};
+
+static HLESyscallThunk ChooseSyscallThunk(const HLEFunction &func, bool idle) {
+	if (!func.func)
+		return &CallUnimplementedSyscallThunk;
+	if (idle)
+		return &CallIdleSyscallThunk;
+	const u32 checks = func.flags & (HLE_NOT_IN_INTERRUPT | HLE_NOT_DISPATCH_SUSPENDED | HLE_CLEAR_STACK_BYTES);
+	return syscallThunksByFlags[checks / HLE_NOT_IN_INTERRUPT];
 }
 
 const HLEFunction *GetSyscallFuncPointer(MIPSOpcode op)
@@ -684,8 +744,19 @@ const HLEFunction *GetSyscallFuncPointer(MIPSOpcode op)
 	return &moduleDB[modulenum].funcTable[funcnum];
 }
 
+// Same checks as GetSyscallFuncPointer(), but quiet, for the hot path.
+inline static HLESyscallThunk GetSyscallThunk(MIPSOpcode op, const HLEFunction **info) {
+	u32 callno = (op >> 6) & 0xFFFFF;
+	u32 funcnum = callno & 0xFFF;
+	u32 modulenum = (callno & 0xFF000) >> 12;
+	if (modulenum >= (u32)syscallThunks.size() || funcnum >= (u32)syscallThunks[modulenum].size())
+		return nullptr;
+	*info = &moduleDB[modulenum].funcTable[funcnum];
+	return syscallThunks[modulenum][funcnum];
+}
+
 void *GetQuickSyscallFunc(MIPSOpcode op) {
-	if (coreCollectDebugStats)
+	if (coreCollectDebugStats || g_syscallProfilerRunning)
 		return nullptr;
 
 	const HLEFunction *info = GetSyscallFuncPointer(op);
@@ -693,12 +764,11 @@ void *GetQuickSyscallFunc(MIPSOpcode op) {
 		return nullptr;
 	DEBUG_LOG(HLE, "Compiling syscall to %s", info->name);
 
-	// TODO: Do this with a flag?
+	// The idle thunk only forwards, so call the function directly.
 	if (op == idleOp)
 		return (void *)info->func;
-	if (info->flags != 0)
-		return (void *)&CallSyscallWithFlags;
-	return (void *)&CallSyscallWithoutFlags;
+	const HLEFunction *thunkInfo = nullptr;
+	return (void *)GetSyscallThunk(op, &thunkInfo);
 }
 
 static double hleSteppingTime = 0.0;
@@ -711,45 +781,52 @@ void hleSetFlipTime(double t) {
 	hleFlipTime = t;
 }
 
-void CallSyscall(MIPSOpcode op)
-{
-	PROFILE_THIS_SCOPE("syscall");
-	double start = 0.0;  // need to initialize to fix the race condition where coreCollectDebugStats is enabled in the middle of this func.
-	if (coreCollectDebugStats) {
-		start = time_now_d();
-	}
+static void CallSyscallWithStats(MIPSOpcode op) {
+	double start = time_now_d();
 
 	const HLEFunction *info = GetSyscallFuncPointer(op);
 	if (!info) {
 		RETURN(SCE_KERNEL_ERROR_LIBRARY_NOT_YET_LINKED);
 		return;
 	}
+	// Might switch threads, so grab it before the call.
+	SceUID threadID = g_syscallProfilerRunning ? __KernelGetCurThread() : 0;
+	const HLEFunction *thunkInfo = nullptr;
+	GetSyscallThunk(op, &thunkInfo)(info);
 
-	if (info->func) {
-		if (op == idleOp)
-			info->func();
-		else if (info->flags != 0)
-			CallSyscallWithFlags(info);
-		else
-			CallSyscallWithoutFlags(info);
+	u32 callno = (op >> 6) & 0xFFFFF; //20 bits
+	int funcnum = callno & 0xFFF;
+	int modulenum = (callno & 0xFF000) >> 12;
+	double total = time_now_d() - start - hleSteppingTime;
+	if (total >= hleFlipTime)
+		total -= hleFlipTime;
+	_dbg_assert_msg_(total >= 0.0, "Time spent in syscall became negative");
+	hleSteppingTime = 0.0;
+	hleFlipTime = 0.0;
+	if (coreCollectDebugStats)
+		updateSyscallStats(modulenum, funcnum, total);
+	if (g_syscallProfilerRunning)
+		SyscallProfilerRecord(info, moduleDB[modulenum].name, threadID, start, total);
+}
+
+void CallSyscall(MIPSOpcode op)
+{
+	PROFILE_THIS_SCOPE("syscall");
+	// Timing is kept off the normal path, which goes straight to the thunk.
+	if (coreCollectDebugStats || g_syscallProfilerRunning) {
+		CallSyscallWithStats(op);
+		return;
 	}
-	else {
+
+	const HLEFunction *info = nullptr;
+	HLESyscallThunk thunk = GetSyscallThunk(op, &info);
+	if (!thunk) {
+		// Let it log why.
+		GetSyscallFuncPointer(op);
 		RETURN(SCE_KERNEL_ERROR_LIBRARY_NOT_YET_LINKED);
-		ERROR_LOG_REPORT(HLE, "Unimplemented HLE function %s", info->name ? info->name : "(\?\?\?)");
-	}
-
-	if (coreCollectDebugStats) {
-		u32 callno = (op >> 6) & 0xFFFFF; //20 bits
-		int funcnum = callno & 0xFFF;
-		int modulenum = (callno & 0xFF000) >> 12;
-		double total = time_now_d() - start - hleSteppingTime;
-		if (total >= hleFlipTime)
-			total -= hleFlipTime;
-		_dbg_assert_msg_(total >= 0.0, "Time spent in syscall became negative");
-		hleSteppingTime = 0.0;
-		hleFlipTime = 0.0;
-		updateSyscallStats(modulenum, funcnum, total);
+		return;
 	}
+	thunk(info);
 }
 
 size_t hleFormatLogArgs(char *message, size_t sz, const char *argmask) {
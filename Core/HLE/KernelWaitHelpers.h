@@ -305,6 +305,51 @@ inline void CleanupWaitingThreads(WaitType waitType, SceUID uid, std::vector<T>
 	waitingThreads.resize(size);
 }
 
+// Thread id of a waiting thread info struct.
+template <typename T>
+inline SceUID WaitingThreadID(const T &waitInfo) {
+	return waitInfo.threadID;
+}
+
+// Thread id for a simpler list of SceUIDs.
+template <>
+inline SceUID WaitingThreadID(const SceUID &threadID) {
+	return threadID;
+}
+
+// Stable sort of a waitingThreads list by current thread priority, best first.
+// Each priority is looked up once, and lists that are already in order (the common case) aren't touched.
+template <typename T>
+inline void SortWaitingThreadsByPriority(std::vector<T> &waitingThreads) {
+	size_t size = waitingThreads.size();
+	size_t i = 1;
+	if (size > 1) {
+		u32 lastPrio = __KernelGetThreadPrio(WaitingThreadID(waitingThreads[0]));
+		for (; i < size; ++i) {
+			u32 prio = __KernelGetThreadPrio(WaitingThreadID(waitingThreads[i]));
+			if (prio < lastPrio)
+				break;
+			lastPrio = prio;
+		}
+	}
+	if (i >= size)
+		return;
+
+	std::vector<std::pair<u32, size_t>> order;
+	order.reserve(size);
+	for (size_t j = 0; j < size; ++j)
+		order.emplace_back(__KernelGetThreadPrio(WaitingThreadID(waitingThreads[j])), j);
+	std::stable_sort(order.begin(), order.end(), [](const std::pair<u32, size_t> &a, const std::pair<u32, size_t> &b) {
+		return a.first < b.first;
+	});
+
+	std::vector<T> sorted;
+	sorted.reserve(size);
+	for (const auto &entry : order)
+		sorted.push_back(waitingThreads[entry.second]);
+	waitingThreads.swap(sorted);
+}
+
 template <typename T>
 inline void RemoveWaitingThread(std::vector<T> &waitingThreads, const SceUID threadID) {
 	waitingThreads.erase(std::remove(waitingThreads.begin(), waitingThreads.end(), threadID), waitingThreads.end());
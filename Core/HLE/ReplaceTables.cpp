@@ -30,6 +30,7 @@
 #include "Core/Debugger/MemBlockInfo.h"
 #include "Core/Debugger/SymbolMap.h"
 #include "Core/MemMap.h"
+#include "Core/MemMapBulk.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/MIPS/MIPSCodeUtils.h"
 #include "Core/MIPS/MIPSAnalyst.h"
@@ -138,23 +139,8 @@ static int Replace_memcpy() {
 		}
 	}
 	if (!skip && bytes != 0) {
-		u8 *dst = Memory::GetPointerWriteRange(destPtr, bytes);
-		const u8 *src = Memory::GetPointerRange(srcPtr, bytes);
-
-		if (!dst || !src) {
-			// Already logged.
-		} else if (std::min(destPtr, srcPtr) + bytes > std::max(destPtr, srcPtr)) {
-			// Overlap.  Star Ocean breaks if it's not handled in 16 bytes blocks.
-			const u32 blocks = bytes & ~0x0f;
-			for (u32 offset = 0; offset < blocks; offset += 0x10) {
-				memcpy(dst + offset, src + offset, 0x10);
-			}
-			for (u32 offset = blocks; offset < bytes; ++offset) {
-				dst[offset] = src[offset];
-			}
-		} else {
-			memmove(dst, src, bytes);
-		}
+		// Star Ocean breaks if overlap isn't handled in 16 bytes blocks.
+		Memory::Bulk::CopyForward16(destPtr, srcPtr, bytes);
 	}
 	RETURN(destPtr);
 
@@ -205,14 +191,20 @@ static int Replace_memcpy_jak() {
 		sliced = true;
 	}
 	if (!skip && bytes != 0) {
-		u8 *dst = Memory::GetPointerWriteRange(destPtr, bytes);
-		const u8 *src = Memory::GetPointerRange(srcPtr, bytes);
-
-		if (dst && src) {
-			// Jak style overlap.
-			for (u32 i = 0; i < bytes; i++) {
-				dst[i] = src[i];
+		u32 physDest = Memory::Bulk::PhysicalAddress(destPtr, bytes);
+		u32 physSrc = Memory::Bulk::PhysicalAddress(srcPtr, bytes);
+		if (physDest > physSrc && physDest < physSrc + bytes) {
+			u8 *dst = Memory::GetPointerWriteRange(destPtr, bytes);
+			const u8 *src = Memory::GetPointerRange(srcPtr, bytes);
+			if (dst && src) {
+				// Jak style overlap, repeating the bytes between src and dest.
+				for (u32 i = 0; i < bytes; i++) {
+					dst[i] = src[i];
+				}
 			}
+		} else {
+			// Otherwise a byte at a time forward is the same as memmove.
+			Memory::Bulk::Move(destPtr, srcPtr, bytes);
 		}
 	}
 
@@ -270,11 +262,7 @@ static int Replace_memcpy16() {
 		}
 	}
 	if (!skip && bytes != 0) {
-		u8 *dst = Memory::GetPointerWriteRange(destPtr, bytes);
-		const u8 *src = Memory::GetPointerRange(srcPtr, bytes);
-		if (dst && src) {
-			memmove(dst, src, bytes);
-		}
+		Memory::Bulk::Move(destPtr, srcPtr, bytes);
 	}
 	RETURN(destPtr);
 
@@ -338,11 +326,7 @@ static int Replace_memmove() {
 		}
 	}
 	if (!skip && bytes != 0) {
-		u8 *dst = Memory::GetPointerWriteRange(destPtr, bytes);
-		const u8 *src = Memory::GetPointerRange(srcPtr, bytes);
-		if (dst && src) {
-			memmove(dst, src, bytes);
-		}
+		Memory::Bulk::Move(destPtr, srcPtr, bytes);
 	}
 	RETURN(destPtr);
 
@@ -362,10 +346,7 @@ static int Replace_memset() {
 		skip = gpu->PerformMemorySet(destPtr, value, bytes);
 	}
 	if (!skip && bytes != 0) {
-		u8 *dst = Memory::GetPointerWriteRange(destPtr, bytes);
-		if (dst) {
-			memset(dst, value, bytes);
-		}
+		Memory::Bulk::Set(destPtr, value, bytes);
 	}
 	RETURN(destPtr);
 
@@ -396,10 +377,7 @@ static int Replace_memset_jak() {
 		sliced = true;
 	}
 	if (!skip && bytes != 0) {
-		u8 *dst = Memory::GetPointerWriteRange(destPtr, bytes);
-		if (dst) {
-			memset(dst, value, bytes);
-		}
+		Memory::Bulk::Set(destPtr, value, bytes);
 	}
 
 	NotifyMemInfo(MemBlockFlags::WRITE, destPtr, bytes, "ReplaceMemset");
@@ -422,20 +400,11 @@ static int Replace_memset_jak() {
 	return 5 + bytes * 6 + 2;  // approximation
 }
 
-static uint32_t SafeStringLen(const uint32_t ptr, uint32_t maxLen = 0x07FFFFFF) {
-	maxLen = Memory::ValidSize(ptr, 0x07FFFFFF);
-	const uint8_t *p = Memory::GetPointerRange(ptr, maxLen);
-	if (!p)
-		return 0;
-	const uint8_t *end = (const uint8_t *)memchr(p, '\0', maxLen);
-	if (!end)
-		return 0;
-	return (uint32_t)(end - p);
-}
-
 static int Replace_strlen() {
 	u32 srcPtr = PARAM(0);
-	u32 len = SafeStringLen(srcPtr);
+	u32 len = 0;
+	if (!Memory::Bulk::StringLength(srcPtr, 0x07FFFFFF, &len))
+		len = 0;
 	RETURN(len);
 	return 7 + len * 4;  // approximation
 }
@@ -443,11 +412,10 @@ static int Replace_strlen() {
 static int Replace_strcpy() {
 	u32 destPtr = PARAM(0);
 	u32 srcPtr = PARAM(1);
-	u32 len = SafeStringLen(srcPtr);
-	char *dst = (char *)Memory::GetPointerWriteRange(destPtr, len);
-	const char *src = (const char *)Memory::GetPointerRange(srcPtr, len);
-	if (dst && src && len != 0) {
-		strcpy(dst, src);
+	u32 len = 0;
+	if (Memory::Bulk::StringLength(srcPtr, 0x07FFFFFF, &len)) {
+		// Including the terminator.
+		Memory::Bulk::Move(destPtr, srcPtr, len + 1);
 	}
 	RETURN(destPtr);
 	return 10;  // approximation
@@ -457,40 +425,34 @@ static int Replace_strncpy() {
 	u32 destPtr = PARAM(0);
 	u32 srcPtr = PARAM(1);
 	u32 bytes = PARAM(2);
-	char *dst = (char *)Memory::GetPointerRange(destPtr, bytes);
-	u32 srcLen = SafeStringLen(srcPtr, bytes);
-	const char *src = (const char *)Memory::GetPointerRange(srcPtr, srcLen == 0 ? bytes : srcLen);
-	if (dst && src && bytes != 0) {
-		strncpy(dst, src, bytes);
+	u32 srcLen = 0;
+	bool terminated = Memory::Bulk::StringLength(srcPtr, bytes, &srcLen);
+	// If it's unterminated, that's fine as long as it's all valid memory.
+	if (bytes != 0 && (terminated || srcLen == bytes)) {
+		u8 *dst = Memory::GetPointerWriteRange(destPtr, bytes);
+		if (dst) {
+			memmove(dst, Memory::GetPointerUnchecked(srcPtr), srcLen);
+			memset(dst + srcLen, 0, bytes - srcLen);
+		}
 	}
 	RETURN(destPtr);
 	return 10;  // approximation
 }
 
 static int Replace_strcmp() {
-	u32 aLen = SafeStringLen(PARAM(0));
-	const char *a = (const char *)Memory::GetPointerRange(PARAM(0), aLen);
-	u32 bLen = SafeStringLen(PARAM(1));
-	const char *b = (const char *)Memory::GetPointerRange(PARAM(1), bLen);
-	if (a && b && aLen != 0 && bLen != 0) {
-		RETURN(strcmp(a, b));
-	} else {
-		RETURN(0);
-	}
+	int result = 0;
+	if (!Memory::Bulk::StringCompare(PARAM(0), PARAM(1), 0xFFFFFFFF, &result))
+		result = 0;
+	RETURN(result);
 	return 10;  // approximation
 }
 
 static int Replace_strncmp() {
 	u32 bytes = PARAM(2);
-	u32 aLen = SafeStringLen(PARAM(0), bytes);
-	const char *a = (const char *)Memory::GetPointerRange(PARAM(0), aLen == 0 ? bytes : aLen);
-	u32 bLen = SafeStringLen(PARAM(1), bytes);
-	const char *b = (const char *)Memory::GetPointerRange(PARAM(1), bLen == 0 ? bytes : bLen);
-	if (a && b && bytes != 0) {
-		RETURN(strncmp(a, b, bytes));
-	} else {
-		RETURN(0);
-	}
+	int result = 0;
+	if (!Memory::Bulk::StringCompare(PARAM(0), PARAM(1), bytes, &result))
+		result = 0;
+	RETURN(result);
 	return 10 + bytes / 4;  // approximation
 }
 
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "Core/HLE/sceKernel.h"
+#include "Common/BitSet.h"
 #include "Common/Serialize/Serializer.h"
 
 struct ThreadQueueList {
@@ -27,8 +28,6 @@ struct ThreadQueueList {
 	static const int INITIAL_CAPACITY = 32;
 
 	struct Queue {
-		// Next ever-been-used queue (worse priority.)
-		Queue *next;
 		// First valid item in data.
 		int first;
 		// One after last valid item in data.
@@ -51,7 +50,7 @@ struct ThreadQueueList {
 
 	ThreadQueueList() {
 		memset(queues, 0, sizeof(queues));
-		first = invalid();
+		memset(nonEmpty, 0, sizeof(nonEmpty));
 	}
 
 	~ThreadQueueList() {
@@ -75,44 +74,33 @@ struct ThreadQueueList {
 	}
 
 	inline SceUID pop_first() {
-		Queue *cur = first;
-		while (cur != invalid()) {
-			if (cur->size() > 0)
-				return cur->data[cur->first++];
-			cur = cur->next;
-		}
+		int priority = first_priority(NUM_QUEUES);
+		if (priority >= 0)
+			return pop(priority);
 
 		_dbg_assert_msg_(false, "ThreadQueueList should not be empty.");
 		return 0;
 	}
 
 	inline SceUID pop_first_better(u32 priority) {
-		Queue *cur = first;
 		// Don't bother looking past (worse than) this priority.
-		Queue *stop = &queues[priority];
-		while (cur < stop) {
-			if (cur->size() > 0)
-				return cur->data[cur->first++];
-			cur = cur->next;
-		}
-
+		int best = first_priority(priority);
+		if (best >= 0)
+			return pop(best);
 		return 0;
 	}
 
 	inline SceUID peek_first() {
-		Queue *cur = first;
-		while (cur != invalid()) {
-			if (cur->size() > 0)
-				return cur->data[cur->first];
-			cur = cur->next;
-		}
-
+		int priority = first_priority(NUM_QUEUES);
+		if (priority >= 0)
+			return queues[priority].data[queues[priority].first];
 		return 0;
 	}
 
 	inline void push_front(u32 priority, const SceUID threadID) {
 		Queue *cur = &queues[priority];
 		cur->data[--cur->first] = threadID;
+		mark_non_empty(priority);
 		// If we ran out of room toward the front, add more room for next time.
 		if (cur->first == 0)
 			rebalance(priority);
@@ -121,13 +109,14 @@ struct ThreadQueueList {
 	inline void push_back(u32 priority, const SceUID threadID) {
 		Queue *cur = &queues[priority];
 		cur->data[cur->end++] = threadID;
+		mark_non_empty(priority);
 		if (cur->full())
 			rebalance(priority);
 	}
 
 	inline void remove(u32 priority, const SceUID threadID) {
 		Queue *cur = &queues[priority];
-		_dbg_assert_msg_(cur->next != nullptr, "ThreadQueueList::Queue should already be linked up.");
+		_dbg_assert_msg_(cur->data != nullptr, "ThreadQueueList::Queue should already be linked up.");
 
 		for (int i = cur->first; i < cur->end; ++i) {
 			if (cur->data[i] == threadID) {
@@ -139,6 +128,8 @@ struct ThreadQueueList {
 
 				// Now we're one shorter.
 				--cur->end;
+				if (cur->empty())
+					mark_empty(priority);
 				return;
 			}
 		}
@@ -148,7 +139,7 @@ struct ThreadQueueList {
 
 	inline void rotate(u32 priority) {
 		Queue *cur = &queues[priority];
-		_dbg_assert_msg_(cur->next != nullptr, "ThreadQueueList::Queue should already be linked up.");
+		_dbg_assert_msg_(cur->data != nullptr, "ThreadQueueList::Queue should already be linked up.");
 
 		if (cur->size() > 1) {
 			// Grab the front and push it on the end.
@@ -164,7 +155,7 @@ struct ThreadQueueList {
 				free(queues[i].data);
 		}
 		memset(queues, 0, sizeof(queues));
-		first = invalid();
+		memset(nonEmpty, 0, sizeof(nonEmpty));
 	}
 
 	inline bool empty(u32 priority) const {
@@ -174,7 +165,7 @@ struct ThreadQueueList {
 
 	inline void prepare(u32 priority) {
 		Queue *cur = &queues[priority];
-		if (cur->next == nullptr)
+		if (cur->data == nullptr)
 			link(priority, INITIAL_CAPACITY);
 	}
 
@@ -208,6 +199,8 @@ struct ThreadQueueList {
 				link(i, capacity);
 				cur->first = (cur->capacity - size) / 2;
 				cur->end = cur->first + size;
+				if (size != 0)
+					mark_non_empty(i);
 			}
 
 			if (size != 0)
@@ -216,11 +209,39 @@ struct ThreadQueueList {
 	}
 
 private:
-	Queue *invalid() const {
-		return (Queue *)-1;
+	static const int BITMAP_WORDS = NUM_QUEUES / 64;
+
+	// Best (lowest) priority level with any threads, stopping before the given level, or -1.
+	inline int first_priority(u32 stop) const {
+		for (int i = 0; i < BITMAP_WORDS; ++i) {
+			if ((u32)i * 64 >= stop)
+				break;
+			u64 bits = nonEmpty[i];
+			if (stop < (u32)(i + 1) * 64)
+				bits &= (1ULL << (stop & 63)) - 1;
+			if (bits != 0)
+				return i * 64 + LeastSignificantSetBit(bits);
+		}
+		return -1;
+	}
+
+	inline SceUID pop(int priority) {
+		Queue *cur = &queues[priority];
+		SceUID threadID = cur->data[cur->first++];
+		if (cur->empty())
+			mark_empty(priority);
+		return threadID;
 	}
 
-	// Initialize a priority level and link to other queues.
+	inline void mark_non_empty(u32 priority) {
+		nonEmpty[priority >> 6] |= 1ULL << (priority & 63);
+	}
+
+	inline void mark_empty(u32 priority) {
+		nonEmpty[priority >> 6] &= ~(1ULL << (priority & 63));
+	}
+
+	// Initialize a priority level.
 	void link(u32 priority, int size) {
 		_dbg_assert_msg_(queues[priority].data == nullptr, "ThreadQueueList::Queue should only be initialized once.");
 
@@ -241,21 +262,6 @@ struct ThreadQueueList {
 		// Start smack in the middle so it can move both directions.
 		cur->first = size / 2;
 		cur->end = size / 2;
-
-		for (int i = (int)priority - 1; i >= 0; --i) {
-			// This queue is before ours, and points past us.
-			// We'll have it point to our new queue, inserting into the chain.
-			if (queues[i].next != nullptr) {
-				cur->next = queues[i].next;
-				queues[i].next = cur;
-				return;
-			}
-		}
-
-		// Never found above - that means there's no better queue yet.
-		// The new one is now first, and whoever was first is after it.
-		cur->next = first;
-		first = cur;
 	}
 
 	// Move or allocate as necessary to maintain free space on both sides.
@@ -282,8 +288,8 @@ struct ThreadQueueList {
 		}
 	}
 
-	// The first queue that's ever been used.
-	Queue *first;
+	// One bit per priority level with threads in it, so the best level is a bit scan away.
+	u64 nonEmpty[BITMAP_WORDS];
 	// The priority level queues of thread ids.
 	Queue queues[NUM_QUEUES];
 };
@@ -42,6 +42,7 @@
 #include "Core/Reporting.h"
 #include "Core/Core.h"
 #include "Core/System.h"
+#include "Core/Debugger/SyscallProfiler.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HLE/FunctionWrappers.h"
 #include "Core/HLE/sceDisplay.h"
@@ -563,6 +564,7 @@ static void NotifyUserIfSlow() {
 
 void __DisplayFlip(int cyclesLate) {
 	flippedThisFrame = true;
+	SyscallProfilerEndFrame();
 	// We flip only if the framebuffer was dirty. This eliminates flicker when using
 	// non-buffered rendering. The interaction with frame skipping seems to need
 	// some work.
@@ -19,6 +19,7 @@
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Core/CoreTiming.h"
 #include "Core/MemMapHelpers.h"
+#include "Core/MemMapBulk.h"
 #include "Core/Reporting.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HLE/sceDmac.h"
@@ -51,12 +52,7 @@ static int __DmacMemcpy(u32 dst, u32 src, u32 size) {
 	}
 	if (!skip && size != 0) {
 		currentMIPS->InvalidateICache(src, size);
-		if (Memory::IsValidRange(dst, size) && Memory::IsValidRange(src, size)) {
-			memcpy(Memory::GetPointerWriteUnchecked(dst), Memory::GetPointerUnchecked(src), size);
-		}
-		if (MemBlockInfoDetailed(size)) {
-			NotifyMemInfoCopy(dst, src, size, "DmacMemcpy/");
-		}
+		Memory::Bulk::TryMove(dst, src, size, "DmacMemcpy/");
 		currentMIPS->InvalidateICache(dst, size);
 	}
 
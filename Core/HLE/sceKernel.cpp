@@ -481,7 +481,7 @@ void KernelObject::GetQuickInfo(char *ptr, int size)
 }
 
 KernelObjectPool::KernelObjectPool() {
-	memset(occupied, 0, sizeof(bool)*maxCount);
+	memset(slots, 0, sizeof(slots));
 	nextID = initialNextID;
 }
 
@@ -492,10 +492,10 @@ SceUID KernelObjectPool::Create(KernelObject *obj, int rangeBottom, int rangeTop
 		rangeBottom = nextID++;
 
 	for (int i = rangeBottom; i < rangeTop; i++) {
-		if (!occupied[i]) {
-			occupied[i] = true;
-			pool[i] = obj;
-			pool[i]->uid = i + handleOffset;
+		if (slots[i].type == 0) {
+			slots[i].obj = obj;
+			slots[i].type = obj->GetIDType();
+			obj->uid = i + handleOffset;
 			return i + handleOffset;
 		}
 	}
@@ -505,34 +505,38 @@ SceUID KernelObjectPool::Create(KernelObject *obj, int rangeBottom, int rangeTop
 }
 
 bool KernelObjectPool::IsValid(SceUID handle) const {
-	int index = handle - handleOffset;
-	if (index < 0 || index >= maxCount)
-		return false;
-	else
-		return occupied[index];
+	const u32 index = (u32)(handle - handleOffset);
+	return index < (u32)maxCount && slots[index].type != 0;
+}
+
+void KernelObjectPool::ReportBadHandle(SceUID handle, const char *expectedTypeName) const {
+	if (IsValid(handle)) {
+		KernelObject *obj = slots[handle - handleOffset].obj;
+		WARN_LOG(SCEKERNEL, "Kernel: Wrong object type for %d (%08x), was %s, should have been %s", handle, handle, obj->GetTypeName(), expectedTypeName);
+	} else if (handle != 0 && (u32)handle != 0x80020001) {
+		// Tekken 6 spams 0x80020001 gets wrong with no ill effects, also on the real PSP
+		WARN_LOG(SCEKERNEL, "Kernel: Bad %s handle %d (%08x)", expectedTypeName, handle, handle);
+	}
 }
 
 void KernelObjectPool::Clear() {
 	for (int i = 0; i < maxCount; i++) {
 		// brutally clear everything, no validation
-		if (occupied[i])
-			delete pool[i];
-		pool[i] = nullptr;
-		occupied[i] = false;
+		if (slots[i].type != 0)
+			delete slots[i].obj;
+		slots[i].obj = nullptr;
+		slots[i].type = 0;
 	}
 	nextID = initialNextID;
 }
 
 void KernelObjectPool::List() {
 	for (int i = 0; i < maxCount; i++) {
-		if (occupied[i]) {
+		if (slots[i].type != 0) {
 			char buffer[256];
-			if (pool[i]) {
-				pool[i]->GetQuickInfo(buffer, sizeof(buffer));
-				DEBUG_LOG(SCEKERNEL, "KO %i: %s \"%s\": %s", i + handleOffset, pool[i]->GetTypeName(), pool[i]->GetName(), buffer);
-			} else {
-				ERROR_LOG(SCEKERNEL, "KO %i: bad object", i + handleOffset);
-			}
+			KernelObject *obj = slots[i].obj;
+			obj->GetQuickInfo(buffer, sizeof(buffer));
+			DEBUG_LOG(SCEKERNEL, "KO %i: %s \"%s\": %s", i + handleOffset, obj->GetTypeName(), obj->GetName(), buffer);
 		}
 	}
 }
@@ -540,7 +544,7 @@ void KernelObjectPool::List() {
 int KernelObjectPool::GetCount() const {
 	int count = 0;
 	for (int i = 0; i < maxCount; i++) {
-		if (occupied[i])
+		if (slots[i].type != 0)
 			count++;
 	}
 	return count;
@@ -566,6 +570,11 @@ void KernelObjectPool::DoState(PointerWrap &p) {
 	}
 
 	Do(p, nextID);
+
+	// The state still has a separate occupied array, followed by each object with its type.
+	bool occupied[maxCount];
+	for (int i = 0; i < maxCount; ++i)
+		occupied[i] = slots[i].type != 0;
 	DoArray(p, occupied, maxCount);
 	for (int i = 0; i < maxCount; ++i) {
 		if (!occupied[i])
@@ -574,18 +583,20 @@ void KernelObjectPool::DoState(PointerWrap &p) {
 		int type;
 		if (p.mode == p.MODE_READ) {
 			Do(p, type);
-			pool[i] = CreateByIDType(type);
+			KernelObject *obj = CreateByIDType(type);
 
 			// Already logged an error.
-			if (pool[i] == nullptr)
+			if (obj == nullptr)
 				return;
 
-			pool[i]->uid = i + handleOffset;
+			obj->uid = i + handleOffset;
+			slots[i].obj = obj;
+			slots[i].type = obj->GetIDType();
 		} else {
-			type = pool[i]->GetIDType();
+			type = slots[i].type;
 			Do(p, type);
 		}
-		pool[i]->DoState(p);
+		slots[i].obj->DoState(p);
 		if (p.error >= p.ERROR_FAILURE)
 			break;
 	}
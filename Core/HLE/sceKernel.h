@@ -428,7 +428,8 @@ class KernelObject
 	}
 };
 
-// TODO: Delete the "occupied" array, rely on non-zero pool entries?
+// Each slot keeps the object's ID type next to the pointer, so a lookup is a range check and
+// a compare without touching the object. A type of 0 means the slot is free.
 class KernelObjectPool {
 public:
 	KernelObjectPool();
@@ -444,10 +445,10 @@ class KernelObjectPool {
 	u32 Destroy(SceUID handle) {
 		u32 error;
 		if (Get<T>(handle, error)) {
-			int index = handle - handleOffset;
-			occupied[index] = false;
-			delete pool[index];
-			pool[index] = nullptr;
+			Slot &slot = slots[handle - handleOffset];
+			delete slot.obj;
+			slot.obj = nullptr;
+			slot.type = 0;
 		}
 		return error;
 	};
@@ -456,45 +457,30 @@ class KernelObjectPool {
 
 	template <class T>
 	T* Get(SceUID handle, u32 &outError) {
-		if (handle < handleOffset || handle >= handleOffset+maxCount || !occupied[handle-handleOffset]) {
-			// Tekken 6 spams 0x80020001 gets wrong with no ill effects, also on the real PSP
-			if (handle != 0 && (u32)handle != 0x80020001) {
-				WARN_LOG(SCEKERNEL, "Kernel: Bad %s handle %d (%08x)", T::GetStaticTypeName(), handle, handle);
-			}
-			outError = T::GetMissingErrorCode();
-			return 0;
-		} else {
-			// Previously we had a dynamic_cast here, but since RTTI was disabled traditionally,
-			// it just acted as a static cast and everything worked. This means that we will never
-			// see the Wrong type object error below, but we'll just have to live with that danger.
-			T* t = static_cast<T*>(pool[handle - handleOffset]);
-			if (t == nullptr || t->GetIDType() != T::GetStaticIDType()) {
-				WARN_LOG(SCEKERNEL, "Kernel: Wrong object type for %d (%08x), was %s, should have been %s", handle, handle, t ? t->GetTypeName() : "null", T::GetStaticTypeName());
-				outError = T::GetMissingErrorCode();
-				return 0;
-			}
+		const u32 index = (u32)(handle - handleOffset);
+		if (index < (u32)maxCount && slots[index].type == T::GetStaticIDType()) {
 			outError = SCE_KERNEL_ERROR_OK;
-			return t;
+			return static_cast<T *>(slots[index].obj);
 		}
+		ReportBadHandle(handle, T::GetStaticTypeName());
+		outError = T::GetMissingErrorCode();
+		return nullptr;
 	}
 
 	// ONLY use this when you KNOW the handle is valid.
 	template <class T>
 	T *GetFast(SceUID handle) {
 		const SceUID realHandle = handle - handleOffset;
-		_dbg_assert_(realHandle >= 0 && realHandle < maxCount && occupied[realHandle]);
-		return static_cast<T *>(pool[realHandle]);
+		_dbg_assert_(realHandle >= 0 && realHandle < maxCount && slots[realHandle].type != 0);
+		return static_cast<T *>(slots[realHandle].obj);
 	}
 
 	template <class T, typename ArgT>
 	void Iterate(bool func(T *, ArgT), ArgT arg) {
 		int type = T::GetStaticIDType();
 		for (int i = 0; i < maxCount; i++) {
-			if (!occupied[i])
-				continue;
-			T *t = static_cast<T *>(pool[i]);
-			if (t->GetIDType() == type) {
-				if (!func(t, arg))
+			if (slots[i].type == type) {
+				if (!func(static_cast<T *>(slots[i].obj), arg))
 					break;
 			}
 		}
@@ -503,12 +489,9 @@ class KernelObjectPool {
 	int ListIDType(int type, SceUID_le *uids, int count) const {
 		int total = 0;
 		for (int i = 0; i < maxCount; i++) {
-			if (!occupied[i]) {
-				continue;
-			}
-			if (pool[i]->GetIDType() == type) {
+			if (slots[i].type == type) {
 				if (total < count) {
-					*uids++ = pool[i]->GetUID();
+					*uids++ = i + handleOffset;
 				}
 				++total;
 			}
@@ -517,12 +500,11 @@ class KernelObjectPool {
 	}
 
 	bool GetIDType(SceUID handle, int *type) const {
-		if (handle < handleOffset || handle >= handleOffset+maxCount || !occupied[handle-handleOffset]) {
+		if (!IsValid(handle)) {
 			ERROR_LOG(SCEKERNEL, "Kernel: Bad object handle %i (%08x)", handle, handle);
 			return false;
 		}
-		KernelObject *t = pool[handle - handleOffset];
-		*type = t->GetIDType();
+		*type = slots[handle - handleOffset].type;
 		return true;
 	}
 
@@ -536,8 +518,16 @@ class KernelObjectPool {
 		handleOffset = 0x100,
 		initialNextID = 0x10
 	};
-	KernelObject *pool[maxCount];
-	bool occupied[maxCount];
+
+	struct Slot {
+		KernelObject *obj;
+		int type;
+	};
+
+	// Kept out of line so Get() stays small where it's inlined.
+	void ReportBadHandle(SceUID handle, const char *expectedTypeName) const;
+
+	Slot slots[maxCount];
 	int nextID;
 };
 
@@ -556,6 +546,9 @@ struct KernelStats {
 		summedMsInSyscalls.clear();
 		summedSlowestSyscallTime = 0;
 		summedSlowestSyscallName = 0;
+		summedSyscallCalls.clear();
+		summedMostCalls = 0;
+		summedMostCalledName = 0;
 	}
 
 	double msInSyscalls;
@@ -564,6 +557,9 @@ struct KernelStats {
 	std::map<KernelStatsSyscall, double> summedMsInSyscalls;
 	double summedSlowestSyscallTime;
 	const char *summedSlowestSyscallName;
+	std::map<KernelStatsSyscall, int> summedSyscallCalls;
+	int summedMostCalls;
+	const char *summedMostCalledName;
 };
 
 extern KernelStats kernelStats;
@@ -614,11 +614,6 @@ void __KernelFplEndCallback(SceUID threadID, SceUID prevCallbackId)
 		DEBUG_LOG(SCEKERNEL, "sceKernelAllocateFplCB: Resuming mbx wait from callback");
 }
 
-static bool __FplThreadSortPriority(FplWaitingThread thread1, FplWaitingThread thread2)
-{
-	return __KernelThreadSortPriority(thread1.threadID, thread2.threadID);
-}
-
 static bool __KernelClearFplThreads(FPL *fpl, int reason)
 {
 	u32 error;
@@ -637,7 +632,7 @@ static void __KernelSortFplThreads(FPL *fpl)
 	HLEKernel::CleanupWaitingThreads(WAITTYPE_FPL, uid, fpl->waitingThreads);
 
 	if ((fpl->nf.attr & PSP_FPL_ATTR_PRIORITY) != 0)
-		std::stable_sort(fpl->waitingThreads.begin(), fpl->waitingThreads.end(), __FplThreadSortPriority);
+		HLEKernel::SortWaitingThreadsByPriority(fpl->waitingThreads);
 }
 
 int sceKernelCreateFpl(const char *name, u32 mpid, u32 attr, u32 blockSize, u32 numBlocks, u32 optPtr) {
@@ -1470,11 +1465,6 @@ void __KernelVplEndCallback(SceUID threadID, SceUID prevCallbackId)
 		DEBUG_LOG(SCEKERNEL, "sceKernelAllocateVplCB: Resuming mbx wait from callback");
 }
 
-static bool __VplThreadSortPriority(VplWaitingThread thread1, VplWaitingThread thread2)
-{
-	return __KernelThreadSortPriority(thread1.threadID, thread2.threadID);
-}
-
 static bool __KernelClearVplThreads(VPL *vpl, int reason)
 {
 	u32 error;
@@ -1493,7 +1483,7 @@ static void __KernelSortVplThreads(VPL *vpl)
 	HLEKernel::CleanupWaitingThreads(WAITTYPE_VPL, uid, vpl->waitingThreads);
 
 	if ((vpl->nv.attr & PSP_VPL_ATTR_PRIORITY) != 0)
-		std::stable_sort(vpl->waitingThreads.begin(), vpl->waitingThreads.end(), __VplThreadSortPriority);
+		HLEKernel::SortWaitingThreadsByPriority(vpl->waitingThreads);
 }
 
 SceUID sceKernelCreateVpl(const char *name, int partition, u32 attr, u32 vplSize, u32 optPtr) {
@@ -1969,7 +1959,7 @@ static void __KernelSortTlsplThreads(TLSPL *tls)
 	HLEKernel::CleanupWaitingThreads(WAITTYPE_TLSPL, uid, tls->waitingThreads);
 
 	if ((tls->ntls.attr & PSP_FPL_ATTR_PRIORITY) != 0)
-		std::stable_sort(tls->waitingThreads.begin(), tls->waitingThreads.end(), __KernelThreadSortPriority);
+		HLEKernel::SortWaitingThreadsByPriority(tls->waitingThreads);
 }
 
 int __KernelFreeTls(TLSPL *tls, SceUID threadID)
@@ -28,6 +28,7 @@
 #include "Common/StringUtils.h"
 #include "Common/System/Request.h"
 #include "Common/System/System.h"
+#include "Common/TimeUtil.h"
 
 #include "Core/Config.h"
 #include "Core/Core.h"
@@ -42,6 +43,7 @@
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/MIPSAnalyst.h"
 #include "Core/MIPS/MIPSCodeUtils.h"
+#include "Core/MIPS/JitCommon/JitHeatMap.h"
 #include "Core/ELF/ElfReader.h"
 #include "Core/ELF/PBPReader.h"
 #include "Core/ELF/PrxDecrypter.h"
@@ -1151,6 +1153,7 @@ static int gzipDecompress(u8 *OutBuffer, int OutBufferLength, u8 *InBuffer) {
 }
 
 static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 loadAddress, bool fromTop, std::string *error_string, u32 *magic, u32 &error) {
+	double loadStartTime = time_now_d();
 	PSPModule *module = new PSPModule();
 	kernelObjects.Create(module);
 	loadedModules.insert(module->GetUID());
@@ -1390,7 +1393,9 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 	DEBUG_LOG(LOADER,"===================================================");
 
 	u32 firstImportStubAddr = 0;
+	double importStartTime = time_now_d();
 	KernelImportModuleFuncs(module, &firstImportStubAddr);
+	double importTime = time_now_d() - importStartTime;
 
 	if (textSection == -1) {
 		module->textStart = reader.GetVaddr();
@@ -1618,6 +1623,8 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 			module->nm.entry_addr = module->nm.module_start_func;
 
 		MIPSAnalyst::PrecompileFunctions();
+		if (module->textEnd > module->textStart)
+			MIPSComp::PrecompileHotBlocks(module->textStart, module->textEnd + 4 - module->textStart);
 
 	} else {
 		module->nm.entry_addr = -1;
@@ -1654,6 +1661,8 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 		module->modulePtr.NotifyWrite("KernelModule");
 	}
 
+	INFO_LOG(LOADER, "Module %s loaded in %0.2f ms (%d imports linked in %0.2f ms)", modinfo->name, (time_now_d() - loadStartTime) * 1000.0, (int)module->importedFuncs.size(), importTime * 1000.0);
+
 	error = 0;
 	return module;
 }
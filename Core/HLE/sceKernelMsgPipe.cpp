@@ -125,11 +125,6 @@ struct MsgPipeWaitingThread
 	}
 };
 
-static bool __KernelMsgPipeThreadSortPriority(const MsgPipeWaitingThread &thread1, const MsgPipeWaitingThread &thread2)
-{
-	return __KernelThreadSortPriority(thread1.threadID, thread2.threadID);
-}
-
 struct MsgPipe : public KernelObject
 {
 	const char *GetName() override { return nmp.name; }
@@ -252,7 +247,7 @@ struct MsgPipe : public KernelObject
 		HLEKernel::CleanupWaitingThreads(WAITTYPE_MSGPIPE, GetUID(), waitingThreads);
 
 		if (usePrio)
-			std::stable_sort(waitingThreads.begin(), waitingThreads.end(), __KernelMsgPipeThreadSortPriority);
+			HLEKernel::SortWaitingThreadsByPriority(waitingThreads);
 	}
 
 	void SortReceiveThreads()
@@ -207,7 +207,6 @@ SceUID __KernelSetupRootThread(SceUID moduleId, int args, const char *argp, int
 void __KernelStartIdleThreads(SceUID moduleId);
 void __KernelReturnFromThread();  // Called as HLE function
 u32 __KernelGetThreadPrio(SceUID id);
-bool __KernelThreadSortPriority(SceUID thread1, SceUID thread2);
 bool __KernelIsDispatchEnabled();
 void __KernelReturnFromExtendStack();
 
@@ -49,6 +49,7 @@
 #include "Core/Core.h"
 #include "Core/Reporting.h"
 #include "Core/MemMapHelpers.h"
+#include "Core/MemWriteWatch.h"
 
 #include "Core/HLE/HLEHelperThread.h"
 #include "Core/HLE/FunctionWrappers.h"
@@ -520,7 +521,10 @@ int DoBlockingPdpRecv(AdhocSocketRequest& req, s64& result) {
 	if (ret >= 0 && ret <= *req.length) {
 		sinlen = sizeof(sin);
         memset(&sin, 0, sinlen);
+		// The socket writes straight into guest memory, which fails rather than faults if write watched.
+		Memory::WriteWatch_BeginHostWrite(req.buffer, std::max(0, *req.length));
 		ret = recvfrom(pdpsocket.id, (char*)req.buffer, std::max(0, *req.length), MSG_NOSIGNAL, (struct sockaddr*)&sin, &sinlen);
+		Memory::WriteWatch_EndHostWrite(req.buffer, std::max(0, *req.length));
 		// UDP can also receives 0 data, while on TCP receiving 0 data = connection gracefully closed, but not sure whether PDP can send/recv 0 data or not tho
 		*req.length = 0;
 		if (ret >= 0) {
@@ -709,8 +713,10 @@ int DoBlockingPtpRecv(AdhocSocketRequest& req, s64& result) {
 		return 0;
 	}
 
+	Memory::WriteWatch_BeginHostWrite(req.buffer, std::max(0, *req.length));
 	int ret = recv(ptpsocket.id, (char*)req.buffer, std::max(0, *req.length), MSG_NOSIGNAL);
 	int sockerr = errno;
+	Memory::WriteWatch_EndHostWrite(req.buffer, std::max(0, *req.length));
 
 	// Received Data. POSIX: May received 0 bytes when the remote peer already closed the connection.
 	if (ret > 0) {
@@ -1923,8 +1929,10 @@ static int sceNetAdhocPdpRecv(int id, void *addr, void * port, void *buf, void *
 				sinlen = sizeof(sin);
 				memset(&sin, 0, sinlen);
 				// On Windows: Socket Error 10014 may happen when buffer size is less than the minimum allowed/required (ie. negative number on Vulcanus Seek and Destroy), the address is not a valid part of the user address space (ie. on the stack or when buffer overflow occurred), or the address is not properly aligned (ie. multiple of 4 on 32bit and multiple of 8 on 64bit) https://stackoverflow.com/questions/861154/winsock-error-code-10014
+				Memory::WriteWatch_BeginHostWrite(buf, std::max(0, *len));
 				received = recvfrom(pdpsocket.id, (char*)buf, std::max(0, *len), MSG_NOSIGNAL, (struct sockaddr*)&sin, &sinlen);
 				error = errno;
+				Memory::WriteWatch_EndHostWrite(buf, std::max(0, *len));
 
 				// On Windows: recvfrom on UDP can get error WSAECONNRESET when previous sendto's destination is unreachable (or destination port is not bound), may need to disable SIO_UDP_CONNRESET
 				if (received == SOCKET_ERROR && (error == EAGAIN || error == EWOULDBLOCK || error == ECONNRESET)) {
@@ -4300,8 +4308,10 @@ static int sceNetAdhocPtpRecv(int id, u32 dataAddr, u32 dataSizeAddr, int timeou
 					int error = 0;
 
 					// Receive Data. POSIX: May received 0 bytes when the remote peer already closed the connection.
+					Memory::WriteWatch_BeginHostWrite(buf, std::max(0, *len));
 					received = recv(ptpsocket.id, (char*)buf, std::max(0, *len), MSG_NOSIGNAL);
 					error = errno;
+					Memory::WriteWatch_EndHostWrite(buf, std::max(0, *len));
 
 					if (received == SOCKET_ERROR && (error == EAGAIN || error == EWOULDBLOCK || (ptpsocket.state == ADHOC_PTP_STATE_SYN_SENT && (error == ENOTCONN || connectInProgress(error))))) {
 						if (flag == 0) {
@@ -26,8 +26,10 @@
 #include "Core/Config.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/HLE/HLE.h"
 #include "Core/HLE/sceKernel.h"
 #include "Core/HW/Display.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
 #include "GPU/GPU.h"
 #include "GPU/GPUInterface.h"
 
@@ -180,6 +182,27 @@ void DisplayNotifySleep(double t, int pos) {
 	frameSleepHistory[pos] += t;
 }
 
+// Lists the syscalls that took the most host time since stats were last reset.
+static void GetTopSyscallStats(char *buffer, size_t bufsize, int count) {
+	std::vector<std::pair<double, KernelStatsSyscall>> sorted;
+	sorted.reserve(kernelStats.summedMsInSyscalls.size());
+	for (const auto &stat : kernelStats.summedMsInSyscalls)
+		sorted.emplace_back(stat.second, stat.first);
+	count = std::min(count, (int)sorted.size());
+	std::partial_sort(sorted.begin(), sorted.begin() + count, sorted.end(), [](const auto &a, const auto &b) {
+		return a.first > b.first;
+	});
+
+	buffer[0] = '\0';
+	size_t used = 0;
+	for (int i = 0; i < count && used < bufsize; ++i) {
+		const KernelStatsSyscall &call = sorted[i].second;
+		auto calls = kernelStats.summedSyscallCalls.find(call);
+		used += snprintf(buffer + used, bufsize - used, "  %s: %0.2f ms, %d calls\n", GetFuncName(call.first, call.second),
+			sorted[i].first * 1000.0, calls != kernelStats.summedSyscallCalls.end() ? calls->second : 0);
+	}
+}
+
 void __DisplayGetDebugStats(char *stats, size_t bufsize) {
 	char statbuf[4096];
 	if (!gpu) {
@@ -187,16 +210,27 @@ void __DisplayGetDebugStats(char *stats, size_t bufsize) {
 		return;
 	}
 	gpu->GetStats(statbuf, sizeof(statbuf));
+	char syscallbuf[512];
+	GetTopSyscallStats(syscallbuf, sizeof(syscallbuf), 5);
 
 	snprintf(stats, bufsize,
 		"Kernel processing time: %0.2f ms\n"
 		"Slowest syscall: %s : %0.2f ms\n"
-		"Most active syscall: %s : %0.2f ms\n%s",
+		"Most active syscall: %s : %0.2f ms\n"
+		"Most called syscall: %s : %d calls\n"
+		"Top syscalls:\n%s"
+		"Block dispatches: %d\n"
+		"Linked regs kept: %d\n%s",
 		kernelStats.msInSyscalls * 1000.0f,
 		kernelStats.slowestSyscallName ? kernelStats.slowestSyscallName : "(none)",
 		kernelStats.slowestSyscallTime * 1000.0f,
 		kernelStats.summedSlowestSyscallName ? kernelStats.summedSlowestSyscallName : "(none)",
 		kernelStats.summedSlowestSyscallTime * 1000.0f,
+		kernelStats.summedMostCalledName ? kernelStats.summedMostCalledName : "(none)",
+		kernelStats.summedMostCalls,
+		syscallbuf,
+		(int)MIPSComp::jitStats.lastFrameBlockDispatches,
+		(int)MIPSComp::jitStats.lastFrameLinkedRegsKept,
 		statbuf);
 }
 
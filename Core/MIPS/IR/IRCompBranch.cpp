@@ -113,6 +113,12 @@ void IRFrontend::BranchRSRTComp(MIPSOpcode op, IRComparison cc, bool likely) {
 			ir.WriteSetConstant(MIPS_GET_RD(branchInfo.delaySlotOp), GetCompilerPC() + 12);
 	}
 
+	// The not taken side already exited, so the taken side is straight line code.
+	if (likely && !branchInfo.delaySlotIsBranch && CanContinueBranch(targetAddr)) {
+		ContinueAt(targetAddr);
+		return;
+	}
+
 	FlushAll();
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
@@ -164,6 +170,11 @@ void IRFrontend::BranchRSZeroComp(MIPSOpcode op, IRComparison cc, bool andLink,
 	}
 
 	// Taken
+	if (likely && !branchInfo.delaySlotIsBranch && CanContinueBranch(targetAddr)) {
+		ContinueAt(targetAddr);
+		return;
+	}
+
 	FlushAll();
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
@@ -357,6 +368,11 @@ void IRFrontend::Comp_Jump(MIPSOpcode op) {
 		break;
 	}
 
+	if (CanContinueJump(targetAddr)) {
+		ContinueAt(targetAddr);
+		return;
+	}
+
 	int dcAmount = js.downcountAmount;
 	ir.Write(IROp::Downcount, 0, ir.AddConstant(dcAmount));
 	js.downcountAmount = 0;
@@ -114,6 +114,53 @@ void IRFrontend::CompileDelaySlot() {
 	js.inDelaySlot = false;
 }
 
+bool IRFrontend::CanContinueJump(u32 targetAddr) {
+	if (!opts.continueJumps)
+		return false;
+	return CanContinueTo(targetAddr);
+}
+
+bool IRFrontend::CanContinueBranch(u32 targetAddr) {
+	if (!opts.continueBranches)
+		return false;
+	return CanContinueTo(targetAddr);
+}
+
+bool IRFrontend::CanContinueTo(u32 targetAddr) {
+	// The delay slot might have ended the block (syscall, break, etc.)
+	if (!js.compiling || js.cancel || js.hadBreakpoints)
+		return false;
+	if (js.numInstructions >= opts.continueMaxInstructions)
+		return false;
+	if (targetAddr == 0 || !Memory::IsValidAddress(targetAddr))
+		return false;
+
+	// Don't unroll loops, the target would already be part of the trace.
+	u32 segmentStart = js.lastContinuedPC == 0 ? js.blockStart : js.lastContinuedPC;
+	if (targetAddr >= segmentStart && targetAddr < GetCompilerPC() + 8)
+		return false;
+	if (js.lastContinuedPC != 0 && targetAddr >= js.blockStart && targetAddr < js.blockStart + js.initialBlockSize)
+		return false;
+	for (const auto &range : proxyRanges_) {
+		if (targetAddr >= range.first && targetAddr < range.first + range.second)
+			return false;
+	}
+	return true;
+}
+
+void IRFrontend::ContinueAt(u32 targetAddr) {
+	// The range so far ends after the delay slot.
+	u32 end = GetCompilerPC() + 8;
+	if (js.lastContinuedPC == 0)
+		js.initialBlockSize = end - js.blockStart;
+	else
+		proxyRanges_.push_back(std::make_pair(js.lastContinuedPC, end - js.lastContinuedPC));
+	js.lastContinuedPC = targetAddr;
+
+	// The main loop adds 4.
+	js.compilerPC = targetAddr - 4;
+}
+
 bool IRFrontend::CheckRounding(u32 blockAddress) {
 	bool cleanSlate = false;
 	if (js.hasSetRounding && !js.lastSetRounding) {
@@ -235,10 +282,21 @@ u32 IRFrontend::GetCompilerPC() {
 }
 
 MIPSOpcode IRFrontend::GetOffsetInstruction(int offset) {
-	return Memory::Read_Instruction(GetCompilerPC() + 4 * offset);
+	u32 addr = GetCompilerPC() + 4 * offset;
+	// Noted before reading, so a write in between makes CompiledOpsUnchanged() fail rather than pass.
+	compiledOps_.push_back(std::make_pair(addr, Memory::Read_Opcode_JIT(addr).encoding));
+	return Memory::Read_Instruction(addr);
+}
+
+bool IRFrontend::CompiledOpsUnchanged() const {
+	for (const auto &op : compiledOps_) {
+		if (Memory::Read_Opcode_JIT(op.first).encoding != op.second)
+			return false;
+	}
+	return true;
 }
 
-void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload) {
+void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload, bool tier2) {
 	js.cancel = false;
 	js.preloading = preload;
 	js.blockStart = em_address;
@@ -254,6 +312,8 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 	js.inDelaySlot = false;
 	js.PrefixStart();
 	ir.Clear();
+	proxyRanges_.clear();
+	compiledOps_.clear();
 
 	js.numInstructions = 0;
 	while (js.compiling) {
@@ -261,6 +321,7 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 		CheckBreakpoint(GetCompilerPC());
 
 		MIPSOpcode inst = Memory::Read_Opcode_JIT(GetCompilerPC());
+		compiledOps_.push_back(std::make_pair(GetCompilerPC(), inst.encoding));
 		js.downcountAmount += MIPSGetInstructionCycleEstimate(inst);
 		MIPSCompileOp(inst, this);
 		js.compilerPC += 4;
@@ -272,7 +333,13 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 		ir.Clear();
 	}
 
-	mipsBytes = js.compilerPC - em_address;
+	if (js.lastContinuedPC == 0) {
+		mipsBytes = js.compilerPC - em_address;
+	} else {
+		// The block size only covers the first range, the rest are tracked as proxies.
+		proxyRanges_.push_back(std::make_pair(js.lastContinuedPC, js.compilerPC - js.lastContinuedPC));
+		mipsBytes = js.initialBlockSize;
+	}
 
 	IRWriter simplified;
 	IRWriter *code = &ir;
@@ -288,7 +355,24 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 			// &MergeLoadStore,
 			// &ThreeOpToTwoOp,
 		};
-		if (IRApplyPasses(passes, ARRAY_SIZE(passes), ir, simplified, opts))
+		// Only used for hot blocks, since these passes are slower.
+		// ThreeOpToTwoOp is left out, it only adds instructions for the interpreter.
+		static const IRPassFunc tier2Passes[] = {
+			&ApplyMemoryValidation,
+			&RemoveLoadStoreLeftRight,
+			&OptimizeFPMoves,
+			&PropagateConstants,
+			&PurgeTemps,
+			&ReduceVec4Flush,
+			&ReorderLoadStore,
+			&MergeLoadStore,
+		};
+		bool logPasses;
+		if (tier2)
+			logPasses = IRApplyPasses(tier2Passes, ARRAY_SIZE(tier2Passes), ir, simplified, opts);
+		else
+			logPasses = IRApplyPasses(passes, ARRAY_SIZE(passes), ir, simplified, opts);
+		if (logPasses)
 			logBlocks = 1;
 		code = &simplified;
 		//if (ir.GetInstructions().size() >= 24)
@@ -300,11 +384,19 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 	if (logBlocks > 0 && dontLogBlocks == 0) {
 		char temp2[256];
 		NOTICE_LOG(JIT, "=============== mips %08x ===============", em_address);
-		for (u32 cpc = em_address; cpc != GetCompilerPC(); cpc += 4) {
+		for (u32 cpc = em_address; cpc != em_address + mipsBytes; cpc += 4) {
 			temp2[0] = 0;
 			MIPSDisAsm(Memory::Read_Opcode_JIT(cpc), cpc, temp2, sizeof(temp2), true);
 			NOTICE_LOG(JIT, "M: %08x   %s", cpc, temp2);
 		}
+		for (const auto &range : proxyRanges_) {
+			NOTICE_LOG(JIT, "=============== continued at %08x ===============", range.first);
+			for (u32 cpc = range.first; cpc != range.first + range.second; cpc += 4) {
+				temp2[0] = 0;
+				MIPSDisAsm(Memory::Read_Opcode_JIT(cpc), cpc, temp2, sizeof(temp2), true);
+				NOTICE_LOG(JIT, "M: %08x   %s", cpc, temp2);
+			}
+		}
 	}
 
 	if (logBlocks > 0 && dontLogBlocks == 0) {
@@ -89,7 +89,8 @@ class IRFrontend : public MIPSFrontendInterface {
 	void DoState(PointerWrap &p);
 	bool CheckRounding(u32 blockAddress);  // returns true if we need a do-over
 
-	void DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload);
+	// Tier 2 also runs the passes that are too slow to use on every block.
+	void DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload, bool tier2 = false);
 
 	void EatPrefix() override {
 		js.EatPrefix();
@@ -98,6 +99,28 @@ class IRFrontend : public MIPSFrontendInterface {
 	void SetOptions(const IROptions &o) {
 		opts = o;
 	}
+	const IROptions &GetOptions() const {
+		return opts;
+	}
+
+	// State outside the MIPS code which changes the generated IR, for cached blocks.
+	u32 GetCompileFlags() const {
+		return (js.hasSetRounding ? 1 : 0) | (js.startDefaultPrefix ? 2 : 0);
+	}
+	void SetCompileFlags(u32 flags) {
+		js.hasSetRounding = (flags & 1) != 0;
+		js.startDefaultPrefix = (flags & 2) != 0;
+	}
+	// When skipping DoJit() for a cached block that sets the rounding mode.
+	void SetHasSetRounding() {
+		js.hasSetRounding = true;
+	}
+	// Other MIPS ranges the last DoJit() followed jumps into, besides the block itself.
+	const IRProxyRanges &GetProxyRanges() const {
+		return proxyRanges_;
+	}
+	// Whether the MIPS code the last DoJit() read is still there, for compiles off the emu thread.
+	bool CompiledOpsUnchanged() const;
 
 private:
 	void RestoreRoundingMode(bool force = false);
@@ -112,6 +135,12 @@ class IRFrontend : public MIPSFrontendInterface {
 	void EatInstruction(MIPSOpcode op);
 	MIPSOpcode GetOffsetInstruction(int offset);
 
+	// Traces: compile the jump target inline rather than exiting the block.
+	bool CanContinueJump(u32 targetAddr);
+	bool CanContinueBranch(u32 targetAddr);
+	bool CanContinueTo(u32 targetAddr);
+	void ContinueAt(u32 targetAddr);
+
 	void CheckBreakpoint(u32 addr);
 	void CheckMemoryBreakpoint(int rs, int offset);
 
@@ -138,6 +167,9 @@ class IRFrontend : public MIPSFrontendInterface {
 	JitState js;
 	IRWriter ir;
 	IROptions opts{};
+	IRProxyRanges proxyRanges_;
+	// Address and opcode of everything read by the last DoJit().
+	std::vector<std::pair<u32, u32>> compiledOps_;
 
 	int dontLogBlocks = 0;
 	int logBlocks = 0;
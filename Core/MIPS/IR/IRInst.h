@@ -405,8 +405,15 @@ struct IROptions {
 	bool unalignedLoadStoreVec4;
 	bool preferVec4;
 	bool preferVec4Dot;
+	// Follow jumps and taken likely branches into the target, forming a trace.
+	bool continueJumps;
+	bool continueBranches;
+	int continueMaxInstructions;
 };
 
+// Start address and size in bytes of MIPS code compiled into a block after a jump.
+typedef std::vector<std::pair<u32, u32>> IRProxyRanges;
+
 const IRMeta *GetIRMeta(IROp op);
 void DisassembleIR(char *buf, size_t bufsize, IRInst inst);
 void InitIR();
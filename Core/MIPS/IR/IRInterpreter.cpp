@@ -1148,3 +1148,542 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 	// We hit count.  If this is a full block, it was badly constructed.
 	return 0;
 }
+
+// Threaded dispatch.  Each IRThreadedInst has its handler resolved ahead of time, so the loop
+// only jumps from one handler to the next.  Less common ops go through IRInterpret() one at a time.
+#define IR_THREADED_OPS(X) \
+	X(Fallback) \
+	X(End) \
+	X(SetConst) \
+	X(SetConstF) \
+	X(Add) \
+	X(Sub) \
+	X(And) \
+	X(Or) \
+	X(Xor) \
+	X(Mov) \
+	X(AddConst) \
+	X(SubConst) \
+	X(AndConst) \
+	X(OrConst) \
+	X(XorConst) \
+	X(Neg) \
+	X(Not) \
+	X(Ext8to32) \
+	X(Ext16to32) \
+	X(ShlImm) \
+	X(ShrImm) \
+	X(SarImm) \
+	X(RorImm) \
+	X(Shl) \
+	X(Shr) \
+	X(Sar) \
+	X(Slt) \
+	X(SltU) \
+	X(SltConst) \
+	X(SltUConst) \
+	X(MovZ) \
+	X(MovNZ) \
+	X(Clz) \
+	X(Min) \
+	X(Max) \
+	X(BSwap32) \
+	X(MfLo) \
+	X(MfHi) \
+	X(Mult) \
+	X(MultU) \
+	X(Load8) \
+	X(Load8Ext) \
+	X(Load16) \
+	X(Load16Ext) \
+	X(Load32) \
+	X(LoadFloat) \
+	X(Store8) \
+	X(Store16) \
+	X(Store32) \
+	X(StoreFloat) \
+	X(FAdd) \
+	X(FSub) \
+	X(FMul) \
+	X(FDiv) \
+	X(FSqrt) \
+	X(FNeg) \
+	X(FAbs) \
+	X(FMov) \
+	X(FMovToGPR) \
+	X(FMovFromGPR) \
+	X(FpCondToReg) \
+	X(Downcount) \
+	X(SetPC) \
+	X(SetPCConst) \
+	X(ExitToConst) \
+	X(ExitToReg) \
+	X(ExitToPC) \
+	X(ExitToConstIfEq) \
+	X(ExitToConstIfNeq) \
+	X(ExitToConstIfGtZ) \
+	X(ExitToConstIfGeZ) \
+	X(ExitToConstIfLtZ) \
+	X(ExitToConstIfLeZ) \
+	X(DowncountExitToConst) \
+	X(DowncountExitToReg) \
+	X(DowncountExitToConstIfEq) \
+	X(DowncountExitToConstIfNeq) \
+	X(DowncountExitToConstIfGtZ) \
+	X(DowncountExitToConstIfGeZ) \
+	X(DowncountExitToConstIfLtZ) \
+	X(DowncountExitToConstIfLeZ)
+
+enum class IRThreadedOp : u32 {
+#define IR_THREADED_ENUM(name) name,
+	IR_THREADED_OPS(IR_THREADED_ENUM)
+#undef IR_THREADED_ENUM
+};
+
+static IRThreadedOp ThreadedOpFor(IROp op) {
+	switch (op) {
+#define IR_THREADED_DIRECT(name) case IROp::name: return IRThreadedOp::name;
+	IR_THREADED_DIRECT(SetConst)
+	IR_THREADED_DIRECT(SetConstF)
+	IR_THREADED_DIRECT(Add)
+	IR_THREADED_DIRECT(Sub)
+	IR_THREADED_DIRECT(And)
+	IR_THREADED_DIRECT(Or)
+	IR_THREADED_DIRECT(Xor)
+	IR_THREADED_DIRECT(Mov)
+	IR_THREADED_DIRECT(AddConst)
+	IR_THREADED_DIRECT(SubConst)
+	IR_THREADED_DIRECT(AndConst)
+	IR_THREADED_DIRECT(OrConst)
+	IR_THREADED_DIRECT(XorConst)
+	IR_THREADED_DIRECT(Neg)
+	IR_THREADED_DIRECT(Not)
+	IR_THREADED_DIRECT(Ext8to32)
+	IR_THREADED_DIRECT(Ext16to32)
+	IR_THREADED_DIRECT(ShlImm)
+	IR_THREADED_DIRECT(ShrImm)
+	IR_THREADED_DIRECT(SarImm)
+	IR_THREADED_DIRECT(RorImm)
+	IR_THREADED_DIRECT(Shl)
+	IR_THREADED_DIRECT(Shr)
+	IR_THREADED_DIRECT(Sar)
+	IR_THREADED_DIRECT(Slt)
+	IR_THREADED_DIRECT(SltU)
+	IR_THREADED_DIRECT(SltConst)
+	IR_THREADED_DIRECT(SltUConst)
+	IR_THREADED_DIRECT(MovZ)
+	IR_THREADED_DIRECT(MovNZ)
+	IR_THREADED_DIRECT(Clz)
+	IR_THREADED_DIRECT(Min)
+	IR_THREADED_DIRECT(Max)
+	IR_THREADED_DIRECT(BSwap32)
+	IR_THREADED_DIRECT(MfLo)
+	IR_THREADED_DIRECT(MfHi)
+	IR_THREADED_DIRECT(Mult)
+	IR_THREADED_DIRECT(MultU)
+	IR_THREADED_DIRECT(Load8)
+	IR_THREADED_DIRECT(Load8Ext)
+	IR_THREADED_DIRECT(Load16)
+	IR_THREADED_DIRECT(Load16Ext)
+	IR_THREADED_DIRECT(Load32)
+	IR_THREADED_DIRECT(LoadFloat)
+	IR_THREADED_DIRECT(Store8)
+	IR_THREADED_DIRECT(Store16)
+	IR_THREADED_DIRECT(Store32)
+	IR_THREADED_DIRECT(StoreFloat)
+	IR_THREADED_DIRECT(FAdd)
+	IR_THREADED_DIRECT(FSub)
+	IR_THREADED_DIRECT(FMul)
+	IR_THREADED_DIRECT(FDiv)
+	IR_THREADED_DIRECT(FSqrt)
+	IR_THREADED_DIRECT(FNeg)
+	IR_THREADED_DIRECT(FAbs)
+	IR_THREADED_DIRECT(FMov)
+	IR_THREADED_DIRECT(FMovToGPR)
+	IR_THREADED_DIRECT(FMovFromGPR)
+	IR_THREADED_DIRECT(FpCondToReg)
+	IR_THREADED_DIRECT(Downcount)
+	IR_THREADED_DIRECT(SetPC)
+	IR_THREADED_DIRECT(SetPCConst)
+	IR_THREADED_DIRECT(ExitToConst)
+	IR_THREADED_DIRECT(ExitToReg)
+	IR_THREADED_DIRECT(ExitToPC)
+	IR_THREADED_DIRECT(ExitToConstIfEq)
+	IR_THREADED_DIRECT(ExitToConstIfNeq)
+	IR_THREADED_DIRECT(ExitToConstIfGtZ)
+	IR_THREADED_DIRECT(ExitToConstIfGeZ)
+	IR_THREADED_DIRECT(ExitToConstIfLtZ)
+	IR_THREADED_DIRECT(ExitToConstIfLeZ)
+#undef IR_THREADED_DIRECT
+	default:
+		return IRThreadedOp::Fallback;
+	}
+}
+
+// Every block ends in a Downcount followed by its exits, so those pairs are worth fusing.
+static IRThreadedOp FusedDowncountOpFor(IROp op) {
+	switch (op) {
+	case IROp::ExitToConst: return IRThreadedOp::DowncountExitToConst;
+	case IROp::ExitToReg: return IRThreadedOp::DowncountExitToReg;
+	case IROp::ExitToConstIfEq: return IRThreadedOp::DowncountExitToConstIfEq;
+	case IROp::ExitToConstIfNeq: return IRThreadedOp::DowncountExitToConstIfNeq;
+	case IROp::ExitToConstIfGtZ: return IRThreadedOp::DowncountExitToConstIfGtZ;
+	case IROp::ExitToConstIfGeZ: return IRThreadedOp::DowncountExitToConstIfGeZ;
+	case IROp::ExitToConstIfLtZ: return IRThreadedOp::DowncountExitToConstIfLtZ;
+	case IROp::ExitToConstIfLeZ: return IRThreadedOp::DowncountExitToConstIfLeZ;
+	default: return IRThreadedOp::Fallback;
+	}
+}
+
+void IRCompileThreaded(const IRInst *inst, int count, std::vector<IRThreadedInst> &out) {
+	out.clear();
+	out.reserve(count + 1);
+	for (int i = 0; i < count; ++i) {
+		IRThreadedInst t{};
+		t.inst = inst[i];
+		t.handler = (u32)ThreadedOpFor(inst[i].op);
+		if (inst[i].op == IROp::Downcount && i + 1 < count) {
+			IRThreadedOp fused = FusedDowncountOpFor(inst[i + 1].op);
+			if (fused != IRThreadedOp::Fallback) {
+				t.inst = inst[i + 1];
+				t.handler = (u32)fused;
+				t.constant2 = inst[i].constant;
+				++i;
+			}
+		}
+		out.push_back(t);
+	}
+
+	IRThreadedInst end{};
+	end.handler = (u32)IRThreadedOp::End;
+	out.push_back(end);
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+// Use computed gotos, so each handler has its own indirect jump to the next.
+#define IR_THREADED_LABEL(name) op_##name:
+#define IR_THREADED_DISPATCH() goto *labels[t->handler]
+#define IR_THREADED_NEXT() t++; IR_THREADED_DISPATCH()
+#else
+#define IR_THREADED_LABEL(name) case IRThreadedOp::name:
+#define IR_THREADED_NEXT() t++; continue
+#endif
+
+u32 IRInterpretThreaded(MIPSState *mips, const IRThreadedInst *t) {
+#if defined(__GNUC__) || defined(__clang__)
+	static const void *const labels[] = {
+#define IR_THREADED_ADDRESS(name) &&op_##name,
+		IR_THREADED_OPS(IR_THREADED_ADDRESS)
+#undef IR_THREADED_ADDRESS
+	};
+	IR_THREADED_DISPATCH();
+	{
+#else
+	while (true) {
+		switch ((IRThreadedOp)t->handler) {
+#endif
+
+	IR_THREADED_LABEL(Fallback)
+	{
+		u32 exitPC = IRInterpret(mips, &t->inst, 1);
+		if (exitPC != 0)
+			return exitPC;
+		IR_THREADED_NEXT();
+	}
+	IR_THREADED_LABEL(End)
+		// Same as IRInterpret() running out of instructions.
+		return 0;
+
+	IR_THREADED_LABEL(SetConst)
+		mips->r[t->inst.dest] = t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(SetConstF)
+		memcpy(&mips->f[t->inst.dest], &t->inst.constant, 4);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Add)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] + mips->r[t->inst.src2];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Sub)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] - mips->r[t->inst.src2];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(And)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] & mips->r[t->inst.src2];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Or)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] | mips->r[t->inst.src2];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Xor)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] ^ mips->r[t->inst.src2];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Mov)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(AddConst)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] + t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(SubConst)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] - t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(AndConst)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] & t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(OrConst)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] | t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(XorConst)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] ^ t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Neg)
+		mips->r[t->inst.dest] = -(s32)mips->r[t->inst.src1];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Not)
+		mips->r[t->inst.dest] = ~mips->r[t->inst.src1];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Ext8to32)
+		mips->r[t->inst.dest] = SignExtend8ToU32(mips->r[t->inst.src1]);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Ext16to32)
+		mips->r[t->inst.dest] = SignExtend16ToU32(mips->r[t->inst.src1]);
+		IR_THREADED_NEXT();
+
+	IR_THREADED_LABEL(ShlImm)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] << (int)t->inst.src2;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(ShrImm)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] >> (int)t->inst.src2;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(SarImm)
+		mips->r[t->inst.dest] = (s32)mips->r[t->inst.src1] >> (int)t->inst.src2;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(RorImm)
+	{
+		u32 x = mips->r[t->inst.src1];
+		int sa = t->inst.src2;
+		mips->r[t->inst.dest] = (x >> sa) | (x << (32 - sa));
+		IR_THREADED_NEXT();
+	}
+	IR_THREADED_LABEL(Shl)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] << (mips->r[t->inst.src2] & 31);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Shr)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] >> (mips->r[t->inst.src2] & 31);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Sar)
+		mips->r[t->inst.dest] = (s32)mips->r[t->inst.src1] >> (mips->r[t->inst.src2] & 31);
+		IR_THREADED_NEXT();
+
+	IR_THREADED_LABEL(Slt)
+		mips->r[t->inst.dest] = (s32)mips->r[t->inst.src1] < (s32)mips->r[t->inst.src2];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(SltU)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] < mips->r[t->inst.src2];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(SltConst)
+		mips->r[t->inst.dest] = (s32)mips->r[t->inst.src1] < (s32)t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(SltUConst)
+		mips->r[t->inst.dest] = mips->r[t->inst.src1] < t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(MovZ)
+		if (mips->r[t->inst.src1] == 0)
+			mips->r[t->inst.dest] = mips->r[t->inst.src2];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(MovNZ)
+		if (mips->r[t->inst.src1] != 0)
+			mips->r[t->inst.dest] = mips->r[t->inst.src2];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Clz)
+		mips->r[t->inst.dest] = clz32(mips->r[t->inst.src1]);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Min)
+		mips->r[t->inst.dest] = (s32)mips->r[t->inst.src1] < (s32)mips->r[t->inst.src2] ? mips->r[t->inst.src1] : mips->r[t->inst.src2];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Max)
+		mips->r[t->inst.dest] = (s32)mips->r[t->inst.src1] > (s32)mips->r[t->inst.src2] ? mips->r[t->inst.src1] : mips->r[t->inst.src2];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(BSwap32)
+	{
+		u32 x = mips->r[t->inst.src1];
+		mips->r[t->inst.dest] = ((x & 0xFF000000) >> 24) | ((x & 0x00FF0000) >> 8) | ((x & 0x0000FF00) << 8) | ((x & 0x000000FF) << 24);
+		IR_THREADED_NEXT();
+	}
+	IR_THREADED_LABEL(MfLo)
+		mips->r[t->inst.dest] = mips->lo;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(MfHi)
+		mips->r[t->inst.dest] = mips->hi;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Mult)
+	{
+		s64 result = (s64)(s32)mips->r[t->inst.src1] * (s64)(s32)mips->r[t->inst.src2];
+		memcpy(&mips->lo, &result, 8);
+		IR_THREADED_NEXT();
+	}
+	IR_THREADED_LABEL(MultU)
+	{
+		u64 result = (u64)mips->r[t->inst.src1] * (u64)mips->r[t->inst.src2];
+		memcpy(&mips->lo, &result, 8);
+		IR_THREADED_NEXT();
+	}
+
+	IR_THREADED_LABEL(Load8)
+		mips->r[t->inst.dest] = Memory::ReadUnchecked_U8(mips->r[t->inst.src1] + t->inst.constant);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Load8Ext)
+		mips->r[t->inst.dest] = SignExtend8ToU32(Memory::ReadUnchecked_U8(mips->r[t->inst.src1] + t->inst.constant));
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Load16)
+		mips->r[t->inst.dest] = Memory::ReadUnchecked_U16(mips->r[t->inst.src1] + t->inst.constant);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Load16Ext)
+		mips->r[t->inst.dest] = SignExtend16ToU32(Memory::ReadUnchecked_U16(mips->r[t->inst.src1] + t->inst.constant));
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Load32)
+		mips->r[t->inst.dest] = Memory::ReadUnchecked_U32(mips->r[t->inst.src1] + t->inst.constant);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(LoadFloat)
+		mips->f[t->inst.dest] = Memory::ReadUnchecked_Float(mips->r[t->inst.src1] + t->inst.constant);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Store8)
+		Memory::WriteUnchecked_U8(mips->r[t->inst.src3], mips->r[t->inst.src1] + t->inst.constant);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Store16)
+		Memory::WriteUnchecked_U16(mips->r[t->inst.src3], mips->r[t->inst.src1] + t->inst.constant);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(Store32)
+		Memory::WriteUnchecked_U32(mips->r[t->inst.src3], mips->r[t->inst.src1] + t->inst.constant);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(StoreFloat)
+		Memory::WriteUnchecked_Float(mips->f[t->inst.src3], mips->r[t->inst.src1] + t->inst.constant);
+		IR_THREADED_NEXT();
+
+	IR_THREADED_LABEL(FAdd)
+		mips->f[t->inst.dest] = mips->f[t->inst.src1] + mips->f[t->inst.src2];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(FSub)
+		mips->f[t->inst.dest] = mips->f[t->inst.src1] - mips->f[t->inst.src2];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(FMul)
+		if ((my_isinf(mips->f[t->inst.src1]) && mips->f[t->inst.src2] == 0.0f) || (my_isinf(mips->f[t->inst.src2]) && mips->f[t->inst.src1] == 0.0f)) {
+			mips->fi[t->inst.dest] = 0x7fc00000;
+		} else {
+			mips->f[t->inst.dest] = mips->f[t->inst.src1] * mips->f[t->inst.src2];
+		}
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(FDiv)
+		mips->f[t->inst.dest] = mips->f[t->inst.src1] / mips->f[t->inst.src2];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(FSqrt)
+		mips->f[t->inst.dest] = sqrtf(mips->f[t->inst.src1]);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(FNeg)
+		mips->f[t->inst.dest] = -mips->f[t->inst.src1];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(FAbs)
+		mips->f[t->inst.dest] = fabsf(mips->f[t->inst.src1]);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(FMov)
+		mips->f[t->inst.dest] = mips->f[t->inst.src1];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(FMovToGPR)
+		memcpy(&mips->r[t->inst.dest], &mips->f[t->inst.src1], 4);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(FMovFromGPR)
+		memcpy(&mips->f[t->inst.dest], &mips->r[t->inst.src1], 4);
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(FpCondToReg)
+		mips->r[t->inst.dest] = mips->fpcond;
+		IR_THREADED_NEXT();
+
+	IR_THREADED_LABEL(Downcount)
+		mips->downcount -= (int)t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(SetPC)
+		mips->pc = mips->r[t->inst.src1];
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(SetPCConst)
+		mips->pc = t->inst.constant;
+		IR_THREADED_NEXT();
+
+	IR_THREADED_LABEL(ExitToConst)
+		return t->inst.constant;
+	IR_THREADED_LABEL(ExitToReg)
+		return mips->r[t->inst.src1];
+	IR_THREADED_LABEL(ExitToPC)
+		return mips->pc;
+	IR_THREADED_LABEL(ExitToConstIfEq)
+		if (mips->r[t->inst.src1] == mips->r[t->inst.src2])
+			return t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(ExitToConstIfNeq)
+		if (mips->r[t->inst.src1] != mips->r[t->inst.src2])
+			return t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(ExitToConstIfGtZ)
+		if ((s32)mips->r[t->inst.src1] > 0)
+			return t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(ExitToConstIfGeZ)
+		if ((s32)mips->r[t->inst.src1] >= 0)
+			return t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(ExitToConstIfLtZ)
+		if ((s32)mips->r[t->inst.src1] < 0)
+			return t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(ExitToConstIfLeZ)
+		if ((s32)mips->r[t->inst.src1] <= 0)
+			return t->inst.constant;
+		IR_THREADED_NEXT();
+
+	// Fused: constant2 is the downcount amount.
+	IR_THREADED_LABEL(DowncountExitToConst)
+		mips->downcount -= (int)t->constant2;
+		return t->inst.constant;
+	IR_THREADED_LABEL(DowncountExitToReg)
+		mips->downcount -= (int)t->constant2;
+		return mips->r[t->inst.src1];
+	IR_THREADED_LABEL(DowncountExitToConstIfEq)
+		mips->downcount -= (int)t->constant2;
+		if (mips->r[t->inst.src1] == mips->r[t->inst.src2])
+			return t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(DowncountExitToConstIfNeq)
+		mips->downcount -= (int)t->constant2;
+		if (mips->r[t->inst.src1] != mips->r[t->inst.src2])
+			return t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(DowncountExitToConstIfGtZ)
+		mips->downcount -= (int)t->constant2;
+		if ((s32)mips->r[t->inst.src1] > 0)
+			return t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(DowncountExitToConstIfGeZ)
+		mips->downcount -= (int)t->constant2;
+		if ((s32)mips->r[t->inst.src1] >= 0)
+			return t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(DowncountExitToConstIfLtZ)
+		mips->downcount -= (int)t->constant2;
+		if ((s32)mips->r[t->inst.src1] < 0)
+			return t->inst.constant;
+		IR_THREADED_NEXT();
+	IR_THREADED_LABEL(DowncountExitToConstIfLeZ)
+		mips->downcount -= (int)t->constant2;
+		if ((s32)mips->r[t->inst.src1] <= 0)
+			return t->inst.constant;
+		IR_THREADED_NEXT();
+
+#if !defined(__GNUC__) && !defined(__clang__)
+		default:
+			// Unknown handler, must be a bug in IRCompileThreaded().
+			Crash();
+		}
+#endif
+	}
+	return 0;
+}
+
+#undef IR_THREADED_LABEL
+#undef IR_THREADED_DISPATCH
+#undef IR_THREADED_NEXT
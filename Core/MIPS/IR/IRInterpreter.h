@@ -1,9 +1,10 @@
 #pragma once
 
+#include <vector>
 #include "Common/CommonTypes.h"
+#include "Core/MIPS/IR/IRInst.h"
 
 class MIPSState;
-struct IRInst;
 
 inline static u32 ReverseBits32(u32 v) {
 	// http://graphics.stanford.edu/~seander/bithacks.html#ReverseParallel
@@ -24,3 +25,15 @@ u32 IRRunBreakpoint(u32 pc);
 u32 IRRunMemCheck(u32 pc, u32 addr);
 
 u32 IRInterpret(MIPSState *ms, const IRInst *inst, int count);
+
+// A block with its handlers resolved ahead of time, for IRInterpretThreaded().
+struct IRThreadedInst {
+	// Operands, and the original instruction for ops that fall back to IRInterpret().
+	IRInst inst;
+	u32 handler;
+	// For fused pairs, the constant of the first instruction.
+	u32 constant2;
+};
+
+void IRCompileThreaded(const IRInst *inst, int count, std::vector<IRThreadedInst> &out);
+u32 IRInterpretThreaded(MIPSState *ms, const IRThreadedInst *inst);
@@ -16,18 +16,24 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include "ppsspp_config.h"
+#include <algorithm>
 #include <set>
 
 #include "ext/xxhash.h"
 #include "Common/Profiler/Profiler.h"
 
+#include "Common/File/FileUtil.h"
 #include "Common/Log.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/StringUtils.h"
+#include "Common/Thread/ThreadManager.h"
+#include "Common/TimeUtil.h"
 
 #include "Core/Config.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/Debugger/Breakpoints.h"
+#include "Core/ELF/ParamSFO.h"
 #include "Core/HLE/sceKernelMemory.h"
 #include "Core/MemMap.h"
 #include "Core/MIPS/MIPS.h"
@@ -40,10 +46,33 @@
 #include "Core/MIPS/IR/IRNativeCommon.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/Reporting.h"
+#include "Core/System.h"
 
 namespace MIPSComp {
 
-IRJit::IRJit(MIPSState *mipsState) : frontend_(mipsState->HasDefaultPrefix()), mips_(mipsState) {
+#define IR_DISK_CACHE_MAGIC 0x43425249  // IRBC
+// Bump when the file layout changes.  IR and frontend changes are covered by the git version in the key.
+#define IR_DISK_CACHE_VERSION 1
+// Limit how many versions of code at the same address (overlays) we keep around.
+static const size_t IR_DISK_CACHE_MAX_PER_ADDRESS = 8;
+
+struct IRDiskCacheHeader {
+	u32 magic;
+	u32 version;
+	u64 key;
+	u32 numEntries;
+	u32 instSize;
+};
+
+struct IRDiskCacheEntryHeader {
+	u32 address;
+	u32 size;
+	u32 flags;
+	u32 numInstructions;
+	u64 hash;
+};
+
+IRJit::IRJit(MIPSState *mipsState) : frontend_(mipsState->HasDefaultPrefix()), bgFrontend_(mipsState->HasDefaultPrefix()), mips_(mipsState) {
 	// u32 size = 128 * 1024;
 	// blTrampolines_ = kernelMemory.Alloc(size, true, "trampoline");
 	InitIR();
@@ -65,10 +94,36 @@ IRJit::IRJit(MIPSState *mipsState) : frontend_(mipsState->HasDefaultPrefix()), m
 	opts.unalignedLoadStoreVec4 = false;
 	opts.preferVec4 = true;
 #endif
+	opts.continueJumps = g_Config.bIRTraces;
+	opts.continueBranches = g_Config.bIRTraces;
+	opts.continueMaxInstructions = jo.continueMaxInstructions;
 	frontend_.SetOptions(opts);
+	bgFrontend_.SetOptions(opts);
+	blocks_.SetThreadedDispatch(g_Config.bIRThreadedDispatch);
+	blocks_.SetHeatMap(jitHeatMap.IsRecording());
+	// Only the IR interpreter can fall back to interpreting while compiling.
+	backgroundCompile_ = g_Config.bIRBackgroundCompile && g_threadManager.IsInitialized();
+	tier2Threshold_ = (u32)std::max(g_Config.iIRTier2Threshold, 0);
+
+	std::string discID = g_paramSFO.GetDiscID();
+	if (g_Config.bIRBlockCache && !discID.empty()) {
+		// Anything that changes the IR output should be part of the key.
+		std::string keyData = StringFromFormat("%s/%08x/%d%d%d%d/%d%d%d", PPSSPP_GIT_VERSION, opts.disableFlags, opts.unalignedLoadStore, opts.unalignedLoadStoreVec4, opts.preferVec4, opts.preferVec4Dot, opts.continueJumps, opts.continueBranches, opts.continueMaxInstructions);
+		diskCacheKey_ = XXH3_64bits(keyData.data(), keyData.size());
+
+		File::CreateFullPath(GetSysDirectory(DIRECTORY_APP_CACHE));
+		diskCachePath_ = GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + ".irblockcache");
+		blocks_.LoadDiskCache(diskCachePath_, diskCacheKey_);
+	}
 }
 
 IRJit::~IRJit() {
+	WaitForBackgroundCompiles();
+	if (blocks_.UsesHeatMap())
+		blocks_.CollectAllHeat(jitHeatMap);
+	if (diskCachePath_.Valid()) {
+		blocks_.SaveDiskCache(diskCachePath_, diskCacheKey_);
+	}
 }
 
 void IRJit::DoState(PointerWrap &p) {
@@ -80,30 +135,51 @@ void IRJit::UpdateFCR31() {
 
 void IRJit::ClearCache() {
 	INFO_LOG(JIT, "IRJit: Clearing the cache!");
+	WaitForBackgroundCompiles();
+	std::lock_guard<std::recursive_mutex> guard(blocksLock_);
+	if (blocks_.UsesHeatMap())
+		blocks_.CollectAllHeat(jitHeatMap);
 	blocks_.Clear();
 }
 
 void IRJit::InvalidateCacheAt(u32 em_address, int length) {
+	// Anything compiling in the background might've read the old code.
+	bgGeneration_++;
 	std::vector<int> numbers = blocks_.FindInvalidatedBlockNumbers(em_address, length);
+	if (numbers.empty())
+		return;
+
+	// Restoring the first ops races with background compiles reading them (see GetOriginalOp.)
+	std::lock_guard<std::recursive_mutex> guard(blocksLock_);
 	for (int block_num : numbers) {
 		auto block = blocks_.GetBlock(block_num);
+		if (blocks_.UsesHeatMap())
+			blocks_.CollectHeat(jitHeatMap, block_num);
 		int cookie = block->GetTargetOffset() < 0 ? block_num : block->GetTargetOffset();
-		block->Destroy(cookie);
+		blocks_.DestroyBlock(block_num, cookie);
 	}
 }
 
 void IRJit::Compile(u32 em_address) {
 	PROFILE_THIS_SCOPE("jitc");
 
-	if (g_Config.bPreloadFunctions) {
+	// Nothing is running right now, so it's safe to move block instructions.
+	blocks_.CompactArenaIfNeeded();
+
+	if (g_Config.bPreloadFunctions || blocks_.UsesHeatMap()) {
 		// Look to see if we've preloaded this block.
 		int block_num = blocks_.FindPreloadBlock(em_address);
 		if (block_num != -1) {
 			IRBlock *b = blocks_.GetBlock(block_num);
 			// Okay, let's link and finalize the block now.
 			int cookie = b->GetTargetOffset() < 0 ? block_num : b->GetTargetOffset();
-			b->Finalize(cookie);
+			{
+				std::lock_guard<std::recursive_mutex> guard(blocksLock_);
+				b->Finalize(cookie);
+			}
 			if (b->IsValid()) {
+				if (blocks_.UsesHeatMap())
+					blocks_.CountHeat(block_num);
 				// Success, we're done.
 				FinalizeTargetBlock(b, block_num);
 				return;
@@ -128,37 +204,264 @@ void IRJit::Compile(u32 em_address) {
 }
 
 bool IRJit::CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload) {
-	frontend_.DoJit(em_address, instructions, mipsBytes, preload);
+	// Breakpoints and memchecks are compiled into the IR, so those blocks can't be shared with the disk cache.
+	bool useDiskCache = blocks_.HasDiskCache() && !CBreakPoints::HasBreakPoints() && !CBreakPoints::HasMemChecks();
+	u32 compileFlags = frontend_.GetCompileFlags();
+	bool cached = useDiskCache && blocks_.LookupDiskCache(em_address, compileFlags, instructions, mipsBytes);
+	IRProxyRanges proxies;
+	if (cached) {
+		NoteRoundingMode(instructions);
+	} else {
+		frontend_.DoJit(em_address, instructions, mipsBytes, preload);
+		proxies = frontend_.GetProxyRanges();
+	}
 	if (instructions.empty()) {
 		_dbg_assert_(preload);
 		// We return true when preloading so it doesn't abort.
 		return preload;
 	}
 
-	int block_num = blocks_.AllocateBlock(em_address);
+	return InstallBlock(em_address, instructions, mipsBytes, proxies, compileFlags, useDiskCache && !cached, preload);
+}
+
+bool IRJit::InstallBlock(u32 em_address, const std::vector<IRInst> &instructions, u32 mipsBytes, const IRProxyRanges &proxies, u32 compileFlags, bool storeInDiskCache, bool preload) {
+	int block_num;
+	{
+		// Background compiles may be looking up blocks (see GetOriginalOp.)
+		std::lock_guard<std::recursive_mutex> guard(blocksLock_);
+		block_num = blocks_.AllocateBlock(em_address);
+	}
 	if ((block_num & ~MIPS_EMUHACK_VALUE_MASK) != 0) {
 		// Out of block numbers.  Caller will handle.
 		return false;
 	}
 
 	IRBlock *b = blocks_.GetBlock(block_num);
-	b->SetInstructions(instructions);
+	blocks_.SetBlockInstructions(b, instructions);
 	b->SetOriginalSize(mipsBytes);
-	if (preload) {
+	b->SetProxyRanges(proxies);
+	if (preload || blocks_.HasDiskCache()) {
 		// Hash, then only update page stats, don't link yet.
 		// TODO: Should we always hash?  Then we can reuse blocks.
 		b->UpdateHash();
 	}
+	// Traces depend on code outside the block, so they aren't cached.
+	if (storeInDiskCache && proxies.empty()) {
+		blocks_.StoreDiskCache(em_address, mipsBytes, compileFlags, b->GetHash(), instructions);
+	}
 	if (!CompileTargetBlock(b, block_num, preload))
 		return false;
-	// Overwrites the first instruction, and also updates stats.
-	blocks_.FinalizeBlock(block_num, preload);
+	{
+		// Overwrites the first instruction, and also updates stats.  Background compiles read it back.
+		std::lock_guard<std::recursive_mutex> guard(blocksLock_);
+		blocks_.FinalizeBlock(block_num, preload);
+	}
 	if (!preload)
 		FinalizeTargetBlock(b, block_num);
 
 	return true;
 }
 
+class IRCompileTask : public Task {
+public:
+	IRCompileTask(IRJit *jit) : jit_(jit) {}
+
+	TaskType Type() const override { return TaskType::CPU_COMPUTE; }
+	TaskPriority Priority() const override { return TaskPriority::HIGH; }
+
+	void Run() override {
+		jit_->RunBackgroundCompiles();
+	}
+
+private:
+	IRJit *jit_;
+};
+
+void IRJit::CompileInBackground(u32 em_address) {
+	blocks_.CompactArenaIfNeeded();
+	PublishBackgroundCompiles();
+	if (MIPS_IS_RUNBLOCK(Memory::ReadUnchecked_U32(em_address))) {
+		// Just got published, we'll run it next.
+		return;
+	}
+
+	// Debugging compiles checks into the blocks, keep it simple and synchronous.
+	bool debugging = CBreakPoints::HasBreakPoints() || CBreakPoints::HasMemChecks();
+	if (debugging || ((g_Config.bPreloadFunctions || blocks_.UsesHeatMap()) && blocks_.FindPreloadBlock(em_address) != -1)) {
+		Compile(em_address);
+		return;
+	}
+
+	u32 compileFlags = frontend_.GetCompileFlags();
+	std::vector<IRInst> instructions;
+	u32 mipsBytes;
+	if (blocks_.HasDiskCache() && blocks_.LookupDiskCache(em_address, compileFlags, instructions, mipsBytes)) {
+		// Cheap enough to install right away.
+		NoteRoundingMode(instructions);
+		if (!InstallBlock(em_address, instructions, mipsBytes, IRProxyRanges(), compileFlags, false, false)) {
+			ERROR_LOG(JIT, "Ran out of block numbers, clearing cache");
+			ClearCache();
+		} else if (frontend_.CheckRounding(em_address)) {
+			ClearCache();
+		}
+		return;
+	}
+
+	if (bgPending_.insert(em_address).second) {
+		IRBackgroundCompile c{};
+		c.em_address = em_address;
+		c.compileFlags = compileFlags;
+		c.generation = bgGeneration_;
+		c.queueTime = time_now_d();
+
+		std::lock_guard<std::mutex> guard(bgLock_);
+		bgQueue_.push_back(std::move(c));
+		if (!bgRunning_) {
+			bgRunning_ = true;
+			g_threadManager.EnqueueTask(new IRCompileTask(this));
+		}
+	}
+
+	InterpretUntilBranch();
+}
+
+void IRJit::RunBackgroundCompiles() {
+	while (true) {
+		IRBackgroundCompile c;
+		{
+			std::lock_guard<std::mutex> guard(bgLock_);
+			if (bgQueue_.empty()) {
+				bgRunning_ = false;
+				bgCond_.notify_all();
+				return;
+			}
+			c = std::move(bgQueue_.front());
+			bgQueue_.pop_front();
+		}
+
+		double start = time_now_d();
+		bgFrontend_.SetCompileFlags(c.compileFlags);
+		bgFrontend_.DoJit(c.em_address, c.instructions, c.mipsBytes, false);
+		c.proxies = bgFrontend_.GetProxyRanges();
+		if (!c.instructions.empty()) {
+			c.hash = IRBlock::CalculateHash(c.em_address, c.mipsBytes, &c.proxies);
+			// The hash is only good if it's of the code that was compiled, so check nothing changed since.
+			if (!bgFrontend_.CompiledOpsUnchanged())
+				c.instructions.clear();
+		}
+		c.compileTime = time_now_d() - start;
+
+		std::lock_guard<std::mutex> guard(bgLock_);
+		bgDone_.push_back(std::move(c));
+	}
+}
+
+void IRJit::PublishBackgroundCompiles() {
+	std::vector<IRBackgroundCompile> done;
+	{
+		std::lock_guard<std::mutex> guard(bgLock_);
+		if (bgDone_.empty())
+			return;
+		done.swap(bgDone_);
+	}
+
+	bool outOfBlocks = false;
+	bool roundingChanged = false;
+	for (const IRBackgroundCompile &c : done) {
+		bgPending_.erase(c.em_address);
+		// Drop anything that might've been compiled from stale code or frontend state.
+		if (outOfBlocks || c.instructions.empty() || c.generation != bgGeneration_ || c.compileFlags != frontend_.GetCompileFlags())
+			continue;
+		if (MIPS_IS_RUNBLOCK(Memory::ReadUnchecked_U32(c.em_address)))
+			continue;
+		if (IRBlock::CalculateHash(c.em_address, c.mipsBytes, &c.proxies) != c.hash)
+			continue;
+
+		NoteRoundingMode(c.instructions);
+		bool useDiskCache = blocks_.HasDiskCache() && !CBreakPoints::HasBreakPoints() && !CBreakPoints::HasMemChecks();
+		if (!InstallBlock(c.em_address, c.instructions, c.mipsBytes, c.proxies, c.compileFlags, useDiskCache, false)) {
+			// We'll just recompile anything we need after clearing.
+			outOfBlocks = true;
+			continue;
+		}
+		blocks_.RecordBackgroundCompile(c.compileTime, time_now_d() - c.queueTime);
+		roundingChanged = roundingChanged || frontend_.CheckRounding(c.em_address);
+	}
+
+	if (outOfBlocks) {
+		ERROR_LOG(JIT, "Ran out of block numbers, clearing cache");
+		ClearCache();
+	} else if (roundingChanged) {
+		ClearCache();
+	}
+}
+
+void IRJit::WaitForBackgroundCompiles() {
+	std::unique_lock<std::mutex> guard(bgLock_);
+	bgQueue_.clear();
+	bgCond_.wait(guard, [&] { return !bgRunning_; });
+	bgDone_.clear();
+	guard.unlock();
+
+	bgPending_.clear();
+	bgGeneration_++;
+}
+
+void IRJit::PromoteBlock(int block_num) {
+	PROFILE_THIS_SCOPE("jitc");
+
+	IRBlock *b = blocks_.GetBlock(block_num);
+	// Whether or not it works out, don't try again.
+	b->SetTier(2);
+
+	u32 em_address, origSize;
+	b->GetRange(em_address, origSize);
+	// Can't be shared with tier 1, the frontend state must match.
+	if (CBreakPoints::HasBreakPoints() || CBreakPoints::HasMemChecks())
+		return;
+
+	std::vector<IRInst> instructions;
+	u32 mipsBytes;
+	frontend_.DoJit(em_address, instructions, mipsBytes, false, true);
+	if (instructions.empty() || mipsBytes != origSize || frontend_.GetProxyRanges() != b->GetProxyRanges()) {
+		WARN_LOG(JIT, "Unable to promote block at %08x to tier 2", em_address);
+		return;
+	}
+
+	// The block is still valid, so the code hasn't changed and the exits are the same.
+	blocks_.SetBlockInstructions(b, instructions);
+	if (blocks_.UsesThreadedDispatch())
+		blocks_.BuildThreaded(b);
+}
+
+void IRJit::NoteRoundingMode(const std::vector<IRInst> &instructions) {
+	for (const IRInst &inst : instructions) {
+		if (inst.op == IROp::UpdateRoundingMode) {
+			// DoJit() would've noted this, make sure CheckRounding() sees it.
+			frontend_.SetHasSetRounding();
+			break;
+		}
+	}
+}
+
+void IRJit::InterpretUntilBranch() {
+	// Like the interpreter's loop, but only until a branch resolves or we reach a compiled block.
+	bool branched = false;
+	do {
+		MIPSOpcode op = Memory::Read_Opcode_JIT(mips_->pc);
+		bool wasInDelaySlot = mips_->inDelaySlot;
+		MIPSInterpret(op);
+		mips_->downcount -= MIPSGetInstructionCycleEstimate(op);
+
+		// The reason we have to check this is the delay slot hack in Int_Syscall.
+		if (mips_->inDelaySlot && wasInDelaySlot) {
+			mips_->pc = mips_->nextPC;
+			mips_->inDelaySlot = false;
+			branched = true;
+		}
+	} while (mips_->inDelaySlot || (!branched && mips_->downcount >= 0 && coreState == CORE_RUNNING && !MIPS_IS_RUNBLOCK(Memory::ReadUnchecked_U32(mips_->pc))));
+}
+
 void IRJit::CompileFunction(u32 start_address, u32 length) {
 	PROFILE_THIS_SCOPE("jitc");
 
@@ -252,13 +555,23 @@ void IRJit::RunLoopUntil(u64 globalticks) {
 			if (opcode == MIPS_EMUHACK_OPCODE) {
 				u32 data = inst & 0xFFFFFF;
 				IRBlock *block = blocks_.GetBlock(data);
+				jitStats.blockDispatches++;
+				if (blocks_.UsesHeatMap())
+					blocks_.CountHeat(data);
+				if (tier2Threshold_ != 0 && block->CountExecution(tier2Threshold_))
+					PromoteBlock(data);
 				u32 startPC = mips_->pc;
-				mips_->pc = IRInterpret(mips_, block->GetInstructions(), block->GetNumInstructions());
+				if (block->HasThreaded())
+					mips_->pc = IRInterpretThreaded(mips_, block->GetThreaded());
+				else
+					mips_->pc = IRInterpret(mips_, block->GetInstructions(), block->GetNumInstructions());
 				// Note: this will "jump to zero" on a badly constructed block missing exits.
 				if (!Memory::IsValidAddress(mips_->pc) || (mips_->pc & 3) != 0) {
 					Core_ExecException(mips_->pc, startPC, ExecExceptionType::JUMP);
 					break;
 				}
+			} else if (backgroundCompile_) {
+				CompileInBackground(mips_->pc);
 			} else {
 				// RestoreRoundingMode(true);
 				Compile(mips_->pc);
@@ -288,62 +601,313 @@ void IRBlockCache::Clear() {
 		int cookie = blocks_[i].GetTargetOffset() < 0 ? i : blocks_[i].GetTargetOffset();
 		blocks_[i].Destroy(cookie);
 	}
+	// Block numbers start over, but keep the counters where native code expects them.
+	for (auto &chunk : heatCounters_)
+		memset(chunk.get(), 0, sizeof(u32) * IR_HEAT_CHUNK_SIZE);
 	blocks_.clear();
-	byPage_.clear();
+	pageIndex_.Clear();
+	arena_.clear();
+	arenaLiveBytes_ = 0;
+	arenaGarbageBytes_ = 0;
 }
 
-std::vector<int> IRBlockCache::FindInvalidatedBlockNumbers(u32 address, u32 length) {
-	u32 startPage = AddressToPage(address);
-	u32 endPage = AddressToPage(address + length);
+// Blocks can't be longer than this, since the count is a u16.
+static const u32 IR_MAX_BLOCK_INSTS = 0x10000;
+// Large enough for any block's threaded copy, which may have one more for the end.
+static const u32 IR_ARENA_CHUNK_BYTES = (IR_MAX_BLOCK_INSTS + 1) * sizeof(IRThreadedInst);
 
-	std::vector<int> found;
-	for (u32 page = startPage; page <= endPage; ++page) {
-		const auto iter = byPage_.find(page);
-		if (iter == byPage_.end())
-			continue;
+static u32 ArenaSize(u32 bytes) {
+	return (bytes + 7) & ~7;
+}
 
-		const std::vector<int> &blocksInPage = iter->second;
-		for (int i : blocksInPage) {
-			if (blocks_[i].OverlapsRange(address, length)) {
-				// Not removing from the page, hopefully doesn't build up with small recompiles.
-				found.push_back(i);
-			}
+u8 *IRBlockCache::AllocateArena(u32 bytes) {
+	bytes = ArenaSize(bytes);
+	if (arena_.empty() || arena_.back().capacity - arena_.back().used < bytes) {
+		ArenaChunk chunk;
+		chunk.data.reset(new u8[IR_ARENA_CHUNK_BYTES]);
+		chunk.capacity = IR_ARENA_CHUNK_BYTES;
+		chunk.used = 0;
+		arena_.push_back(std::move(chunk));
+	}
+
+	ArenaChunk &chunk = arena_.back();
+	u8 *p = chunk.data.get() + chunk.used;
+	chunk.used += bytes;
+	arenaLiveBytes_ += bytes;
+	return p;
+}
+
+void IRBlockCache::SetBlockInstructions(IRBlock *b, const std::vector<IRInst> &inst) {
+	ReleaseBlockInstructions(b);
+	IRInst *p = (IRInst *)AllocateArena((u32)(sizeof(IRInst) * inst.size()));
+	if (!inst.empty())
+		memcpy(p, &inst[0], sizeof(IRInst) * inst.size());
+	b->SetInstructions(p, (u16)inst.size());
+}
+
+void IRBlockCache::ReleaseBlockInstructions(IRBlock *b) {
+	ReleaseThreaded(b);
+	if (b->GetInstructions() == nullptr)
+		return;
+	u32 bytes = ArenaSize(sizeof(IRInst) * b->GetNumInstructions());
+	arenaLiveBytes_ -= bytes;
+	arenaGarbageBytes_ += bytes;
+	b->ClearInstructions();
+}
+
+void IRBlockCache::ReleaseThreaded(IRBlock *b) {
+	if (!b->HasThreaded())
+		return;
+	u32 bytes = ArenaSize(sizeof(IRThreadedInst) * b->GetNumThreaded());
+	arenaLiveBytes_ -= bytes;
+	arenaGarbageBytes_ += bytes;
+	b->ClearThreaded();
+}
+
+void IRBlockCache::BuildThreaded(IRBlock *b) {
+	ReleaseThreaded(b);
+	IRCompileThreaded(b->GetInstructions(), b->GetNumInstructions(), threadedScratch_);
+	IRThreadedInst *p = (IRThreadedInst *)AllocateArena((u32)(sizeof(IRThreadedInst) * threadedScratch_.size()));
+	memcpy(p, threadedScratch_.data(), sizeof(IRThreadedInst) * threadedScratch_.size());
+	b->SetThreaded(p, (u32)threadedScratch_.size());
+}
+
+void IRBlockCache::CompactArenaIfNeeded() {
+	// Only worth it once at least a chunk could be freed, and most of the arena is garbage.
+	if (arenaGarbageBytes_ >= IR_ARENA_CHUNK_BYTES && arenaGarbageBytes_ > arenaLiveBytes_)
+		CompactArena();
+}
+
+void IRBlockCache::CompactArena() {
+	std::vector<ArenaChunk> old;
+	old.swap(arena_);
+	arenaLiveBytes_ = 0;
+	arenaGarbageBytes_ = 0;
+
+	// Copy in block order, which is roughly the order they were compiled and run in.
+	// The threaded copy goes right after the instructions, since it's what runs.
+	for (auto &b : blocks_) {
+		if (b.GetInstructions() != nullptr) {
+			IRInst *p = (IRInst *)AllocateArena(sizeof(IRInst) * b.GetNumInstructions());
+			memcpy(p, b.GetInstructions(), sizeof(IRInst) * b.GetNumInstructions());
+			b.RelocateInstructions(p);
 		}
+		if (b.HasThreaded()) {
+			IRThreadedInst *p = (IRThreadedInst *)AllocateArena(sizeof(IRThreadedInst) * b.GetNumThreaded());
+			memcpy(p, b.GetThreaded(), sizeof(IRThreadedInst) * b.GetNumThreaded());
+			b.RelocateThreaded(p);
+		}
+	}
+
+	arenaCompactions_++;
+	INFO_LOG(JIT, "Compacted IR arena from %d to %d chunks", (int)old.size(), (int)arena_.size());
+}
+
+std::vector<int> IRBlockCache::FindInvalidatedBlockNumbers(u32 address, u32 length) {
+	std::vector<int> found;
+	// Most writes (like loading data files) don't touch any pages with code.
+	if (!pageIndex_.HasCode(address, length))
+		return found;
+
+	std::vector<int> candidates;
+	pageIndex_.FindBlocks(address, length, candidates);
+	for (int i : candidates) {
+		if (blocks_[i].OverlapsRange(address, length))
+			found.push_back(i);
 	}
 
 	return found;
 }
 
+void IRBlockCache::DestroyBlock(int i, int cookie) {
+	// Destroy() forgets the range, so this has to happen first.
+	RemoveFromPageIndex(i);
+	blocks_[i].Destroy(cookie);
+	ReleaseBlockInstructions(&blocks_[i]);
+}
+
+void IRBlockCache::RemoveFromPageIndex(int i) {
+	u32 startAddr, size;
+	blocks_[i].GetRange(startAddr, size);
+	pageIndex_.Remove(startAddr, size, i);
+	for (const auto &range : blocks_[i].GetProxyRanges())
+		pageIndex_.Remove(range.first, range.second, i);
+}
+
 void IRBlockCache::FinalizeBlock(int i, bool preload) {
 	if (!preload) {
 		int cookie = blocks_[i].GetTargetOffset() < 0 ? i : blocks_[i].GetTargetOffset();
 		blocks_[i].Finalize(cookie);
+		// Not all native backends count executions, so at least record that it ran.
+		if (heatMap_)
+			CountHeat(i);
 	}
+	if (threadedDispatch_)
+		BuildThreaded(&blocks_[i]);
 
 	u32 startAddr, size;
 	blocks_[i].GetRange(startAddr, size);
+	pageIndex_.Add(startAddr, size, i);
+
+	// Traces also need to be invalidated when any code they followed a jump into changes.
+	for (const auto &range : blocks_[i].GetProxyRanges())
+		pageIndex_.Add(range.first, range.second, i);
+}
+
+void IRBlockCache::AllocateHeatCounter(int i) {
+	while ((int)heatCounters_.size() <= i / IR_HEAT_CHUNK_SIZE) {
+		heatCounters_.push_back(std::unique_ptr<u32[]>(new u32[IR_HEAT_CHUNK_SIZE]));
+		memset(heatCounters_.back().get(), 0, sizeof(u32) * IR_HEAT_CHUNK_SIZE);
+	}
+}
+
+void IRBlockCache::CollectHeat(JitHeatMap &heatMap, int i) {
+	u32 *counter = GetHeatCounter(i);
+	heatMap.Add(blocks_[i].GetOriginalStart(), *counter);
+	*counter = 0;
+}
+
+void IRBlockCache::CollectAllHeat(JitHeatMap &heatMap) {
+	for (int i = 0; i < (int)blocks_.size(); ++i)
+		CollectHeat(heatMap, i);
+}
+
+bool IRBlockCache::LoadDiskCache(const Path &filename, u64 key) {
+	diskCacheEnabled_ = true;
+
+	FILE *f = File::OpenCFile(filename, "rb");
+	if (!f)
+		return false;
+
+	IRDiskCacheHeader header{};
+	bool success = fread(&header, sizeof(header), 1, f) == 1;
+	if (!success || header.magic != IR_DISK_CACHE_MAGIC || header.version != IR_DISK_CACHE_VERSION || header.instSize != (u32)sizeof(IRInst)) {
+		WARN_LOG(JIT, "IR block cache header mismatch, ignoring");
+		fclose(f);
+		return false;
+	}
+	if (header.key != key) {
+		// Different build or options, the IR may have changed.
+		INFO_LOG(JIT, "IR block cache is for a different build or options, ignoring");
+		fclose(f);
+		return false;
+	}
+
+	uint64_t fileSize = File::GetFileSize(f);
+	uint64_t bytesLeft = fileSize > sizeof(header) ? fileSize - sizeof(header) : 0;
+	int loaded = 0;
+	for (u32 i = 0; i < header.numEntries; ++i) {
+		IRDiskCacheEntryHeader entryHeader;
+		if (fread(&entryHeader, sizeof(entryHeader), 1, f) != 1) {
+			ERROR_LOG(JIT, "IR block cache truncated");
+			break;
+		}
+		bytesLeft -= std::min(bytesLeft, (uint64_t)sizeof(entryHeader));
+
+		// Blocks can't be longer than a u16 count.  Anything else means the file is corrupt, so don't trust any of it.
+		if (entryHeader.numInstructions >= IR_MAX_BLOCK_INSTS || (uint64_t)entryHeader.numInstructions * sizeof(IRInst) > bytesLeft) {
+			ERROR_LOG(JIT, "IR block cache corrupt (%u instructions), ignoring", entryHeader.numInstructions);
+			diskCache_.clear();
+			fclose(f);
+			return false;
+		}
+		bytesLeft -= (uint64_t)entryHeader.numInstructions * sizeof(IRInst);
+
+		IRDiskCacheEntry entry;
+		entry.size = entryHeader.size;
+		entry.flags = entryHeader.flags;
+		entry.hash = entryHeader.hash;
+		entry.instructions.resize(entryHeader.numInstructions);
+		if (entryHeader.numInstructions == 0 || fread(&entry.instructions[0], sizeof(IRInst), entryHeader.numInstructions, f) != entryHeader.numInstructions) {
+			ERROR_LOG(JIT, "IR block cache truncated");
+			break;
+		}
+		diskCache_[entryHeader.address].push_back(std::move(entry));
+		loaded++;
+	}
+	fclose(f);
+
+	INFO_LOG(JIT, "Loaded %d blocks from IR block cache", loaded);
+	return true;
+}
+
+void IRBlockCache::SaveDiskCache(const Path &filename, u64 key) {
+	FILE *f = File::OpenCFile(filename, "wb");
+	if (!f)
+		return;
+
+	IRDiskCacheHeader header{};
+	header.magic = IR_DISK_CACHE_MAGIC;
+	header.version = IR_DISK_CACHE_VERSION;
+	header.key = key;
+	header.instSize = (u32)sizeof(IRInst);
+	for (const auto &iter : diskCache_)
+		header.numEntries += (u32)iter.second.size();
+
+	bool writeFailed = fwrite(&header, sizeof(header), 1, f) != 1;
+	for (const auto &iter : diskCache_) {
+		for (const IRDiskCacheEntry &entry : iter.second) {
+			IRDiskCacheEntryHeader entryHeader;
+			entryHeader.address = iter.first;
+			entryHeader.size = entry.size;
+			entryHeader.flags = entry.flags;
+			entryHeader.numInstructions = (u32)entry.instructions.size();
+			entryHeader.hash = entry.hash;
+			writeFailed = writeFailed || fwrite(&entryHeader, sizeof(entryHeader), 1, f) != 1;
+			writeFailed = writeFailed || fwrite(&entry.instructions[0], sizeof(IRInst), entry.instructions.size(), f) != entry.instructions.size();
+		}
+	}
+	fclose(f);
 
-	u32 startPage = AddressToPage(startAddr);
-	u32 endPage = AddressToPage(startAddr + size);
+	if (writeFailed) {
+		ERROR_LOG(JIT, "Failed to write IR block cache, disk full?");
+		File::Delete(filename);
+	} else {
+		NOTICE_LOG(JIT, "Saved %d blocks to IR block cache (hits: %d, misses: %d, invalidations: %d)", header.numEntries, diskCacheHits_, diskCacheMisses_, diskCacheInvalidations_);
+	}
+}
+
+bool IRBlockCache::LookupDiskCache(u32 em_address, u32 flags, std::vector<IRInst> &instructions, u32 &mipsBytes) {
+	auto iter = diskCache_.find(em_address);
+	if (iter == diskCache_.end()) {
+		diskCacheMisses_++;
+		return false;
+	}
 
-	for (u32 page = startPage; page <= endPage; ++page) {
-		byPage_[page].push_back(i);
+	for (const IRDiskCacheEntry &entry : iter->second) {
+		if (entry.flags != flags || !Memory::IsValidRange(em_address, entry.size))
+			continue;
+		if (IRBlock::CalculateHash(em_address, entry.size) == entry.hash) {
+			instructions = entry.instructions;
+			mipsBytes = entry.size;
+			diskCacheHits_++;
+			return true;
+		}
 	}
+
+	// There was code here before, but it's changed (or the frontend state has.)
+	diskCacheInvalidations_++;
+	return false;
 }
 
-u32 IRBlockCache::AddressToPage(u32 addr) const {
-	// Use relatively small pages since basic blocks are typically small.
-	return (addr & 0x3FFFFFFF) >> 10;
+void IRBlockCache::StoreDiskCache(u32 em_address, u32 mipsBytes, u32 flags, u64 hash, const std::vector<IRInst> &instructions) {
+	std::vector<IRDiskCacheEntry> &entries = diskCache_[em_address];
+	for (const IRDiskCacheEntry &entry : entries) {
+		if (entry.size == mipsBytes && entry.flags == flags && entry.hash == hash)
+			return;
+	}
+
+	if (entries.size() >= IR_DISK_CACHE_MAX_PER_ADDRESS)
+		entries.erase(entries.begin());
+	entries.push_back(IRDiskCacheEntry{ mipsBytes, flags, hash, instructions });
 }
 
 int IRBlockCache::FindPreloadBlock(u32 em_address) {
-	u32 page = AddressToPage(em_address);
-	auto iter = byPage_.find(page);
-	if (iter == byPage_.end())
+	const std::vector<int> *blocksInPage = pageIndex_.GetBlocksInPage(em_address);
+	if (!blocksInPage)
 		return -1;
 
-	const std::vector<int> &blocksInPage = iter->second;
-	for (int i : blocksInPage) {
+	for (int i : *blocksInPage) {
 		if (blocks_[i].GetOriginalStart() == em_address) {
 			if (blocks_[i].HashMatches()) {
 				return i;
@@ -456,18 +1020,50 @@ void IRBlockCache::ComputeStats(BlockCacheStats &bcStats) const {
 	bcStats.minBloat = minBloat;
 	bcStats.maxBloat = maxBloat;
 	bcStats.avgBloat = totalBloat / (double)blocks_.size();
+	ComputeIRStats(bcStats);
 }
 
-int IRBlockCache::GetBlockNumberFromStartAddress(u32 em_address, bool realBlocksOnly) const {
-	u32 page = AddressToPage(em_address);
+void IRBlockCache::ComputeIRStats(BlockCacheStats &bcStats) const {
+	bcStats.diskCacheHits = diskCacheHits_;
+	bcStats.diskCacheMisses = diskCacheMisses_;
+	bcStats.diskCacheInvalidations = diskCacheInvalidations_;
+	bcStats.bgCompiles = bgCompiles_;
+	bcStats.bgCompileTimeAvg = bgCompiles_ != 0 ? (float)(bgCompileTime_ / bgCompiles_) : 0.0f;
+	bcStats.bgCompileTimeMax = (float)bgCompileTimeMax_;
+	bcStats.bgLatencyAvg = bgCompiles_ != 0 ? (float)(bgLatency_ / bgCompiles_) : 0.0f;
+	bcStats.bgLatencyMax = (float)bgLatencyMax_;
+
+	for (const auto &chunk : arena_)
+		bcStats.arenaBytes += chunk.capacity;
+	bcStats.arenaLiveBytes = arenaLiveBytes_;
+	bcStats.arenaGarbageBytes = arenaGarbageBytes_;
+	bcStats.arenaCompactions = arenaCompactions_;
+
+	for (const auto &b : blocks_) {
+		if (!b.IsValid())
+			continue;
+		if (b.GetTier() >= 2)
+			bcStats.numTier2Blocks++;
+		else
+			bcStats.numTier1Blocks++;
+	}
+}
 
-	const auto iter = byPage_.find(page);
-	if (iter == byPage_.end())
+void IRBlockCache::RecordBackgroundCompile(double compileTime, double latency) {
+	bgCompiles_++;
+	bgCompileTime_ += compileTime;
+	bgCompileTimeMax_ = std::max(bgCompileTimeMax_, compileTime);
+	bgLatency_ += latency;
+	bgLatencyMax_ = std::max(bgLatencyMax_, latency);
+}
+
+int IRBlockCache::GetBlockNumberFromStartAddress(u32 em_address, bool realBlocksOnly) const {
+	const std::vector<int> *blocksInPage = pageIndex_.GetBlocksInPage(em_address);
+	if (!blocksInPage)
 		return -1;
 
-	const std::vector<int> &blocksInPage = iter->second;
 	int best = -1;
-	for (int i : blocksInPage) {
+	for (int i : *blocksInPage) {
 		if (blocks_[i].GetOriginalStart() == em_address) {
 			best = i;
 			if (blocks_[i].IsValid()) {
@@ -478,6 +1074,18 @@ int IRBlockCache::GetBlockNumberFromStartAddress(u32 em_address, bool realBlocks
 	return best;
 }
 
+int IRBlockCache::GetBlockNumberFromAddress(u32 em_address) const {
+	const std::vector<int> *blocksInPage = pageIndex_.GetBlocksInPage(em_address);
+	if (!blocksInPage)
+		return -1;
+
+	for (int i : *blocksInPage) {
+		if (blocks_[i].IsValid() && blocks_[i].OverlapsRange(em_address, 4))
+			return i;
+	}
+	return -1;
+}
+
 bool IRBlock::HasOriginalFirstOp() const {
 	return Memory::ReadUnchecked_U32(origAddr_) == origFirstOpcode_.encoding;
 }
@@ -514,29 +1122,57 @@ void IRBlock::Destroy(int cookie) {
 
 u64 IRBlock::CalculateHash() const {
 	if (origAddr_) {
-		// This is unfortunate.  In case of emuhacks, we have to make a copy.
-		std::vector<u32> buffer;
-		buffer.resize(origSize_ / 4);
-		size_t pos = 0;
-		for (u32 off = 0; off < origSize_; off += 4) {
-			// Let's actually hash the replacement, if any.
-			MIPSOpcode instr = Memory::ReadUnchecked_Instruction(origAddr_ + off, false);
-			buffer[pos++] = instr.encoding;
-		}
-
-		return XXH3_64bits(&buffer[0], origSize_);
+		return CalculateHash(origAddr_, origSize_, &proxyRanges_);
 	}
 
 	return 0;
 }
 
+static u64 CalculateRangeHash(u32 addr, u32 size, u64 seed) {
+	// This is unfortunate.  In case of emuhacks, we have to make a copy.
+	std::vector<u32> buffer;
+	buffer.resize(size / 4);
+	size_t pos = 0;
+	for (u32 off = 0; off < size; off += 4) {
+		// Let's actually hash the replacement, if any.
+		MIPSOpcode instr = Memory::ReadUnchecked_Instruction(addr + off, false);
+		buffer[pos++] = instr.encoding;
+	}
+
+	return XXH3_64bits_withSeed(&buffer[0], size, seed);
+}
+
+u64 IRBlock::CalculateHash(u32 addr, u32 size, const IRProxyRanges *proxies) {
+	u64 hash = CalculateRangeHash(addr, size, 0);
+	if (proxies) {
+		// Chain them, so the hash changes if any range does.
+		for (const auto &range : *proxies)
+			hash = CalculateRangeHash(range.first, range.second, hash);
+	}
+	return hash;
+}
+
+static bool RangesOverlap(u32 addr, u32 size, u32 start, u32 length) {
+	start &= 0x3FFFFFFF;
+	return addr + size > start && addr < start + length;
+}
+
 bool IRBlock::OverlapsRange(u32 addr, u32 size) const {
 	addr &= 0x3FFFFFFF;
-	u32 origAddr = origAddr_ & 0x3FFFFFFF;
-	return addr + size > origAddr && addr < origAddr + origSize_;
+	if (RangesOverlap(addr, size, origAddr_, origSize_))
+		return true;
+	for (const auto &range : proxyRanges_) {
+		if (RangesOverlap(addr, size, range.first, range.second))
+			return true;
+	}
+	return false;
 }
 
 MIPSOpcode IRJit::GetOriginalOp(MIPSOpcode op) {
+	// Might be called from a background compile, while blocks are added.
+	std::unique_lock<std::recursive_mutex> guard(blocksLock_, std::defer_lock);
+	if (backgroundCompile_)
+		guard.lock();
 	IRBlock *b = blocks_.GetBlock(blocks_.FindByCookie(op.encoding & 0xFFFFFF));
 	if (b) {
 		return b->GetOriginalFirstOp();
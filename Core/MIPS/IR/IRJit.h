@@ -17,15 +17,23 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "Common/CommonTypes.h"
 #include "Common/CPUDetect.h"
+#include "Common/File/Path.h"
 #include "Core/MIPS/JitCommon/JitBlockCache.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
+#include "Core/MIPS/JitCommon/JitHeatMap.h"
 #include "Core/MIPS/IR/IRRegCache.h"
 #include "Core/MIPS/IR/IRInst.h"
+#include "Core/MIPS/IR/IRInterpreter.h"
 #include "Core/MIPS/IR/IRFrontend.h"
 #include "Core/MIPS/MIPSVFPUUtils.h"
 
@@ -35,7 +43,6 @@
 
 namespace MIPSComp {
 
-// TODO : Use arena allocators. For now let's just malloc.
 class IRBlock {
 public:
 	IRBlock() {}
@@ -48,23 +55,45 @@ class IRBlock {
 		origFirstOpcode_ = b.origFirstOpcode_;
 		targetOffset_ = b.targetOffset_;
 		numInstructions_ = b.numInstructions_;
+		execCount_ = b.execCount_;
+		tier_ = b.tier_;
+		proxyRanges_ = std::move(b.proxyRanges_);
+		threaded_ = b.threaded_;
+		numThreaded_ = b.numThreaded_;
 		b.instr_ = nullptr;
+		b.threaded_ = nullptr;
 	}
 
-	~IRBlock() {
-		delete[] instr_;
+	// The instructions live in the IRBlockCache arena, see IRBlockCache::SetBlockInstructions().
+	void SetInstructions(IRInst *inst, u16 count) {
+		instr_ = inst;
+		numInstructions_ = count;
 	}
-
-	void SetInstructions(const std::vector<IRInst> &inst) {
-		instr_ = new IRInst[inst.size()];
-		numInstructions_ = (u16)inst.size();
-		if (!inst.empty()) {
-			memcpy(instr_, &inst[0], sizeof(IRInst) * inst.size());
-		}
+	void RelocateInstructions(IRInst *inst) {
+		instr_ = inst;
+	}
+	void ClearInstructions() {
+		instr_ = nullptr;
+		numInstructions_ = 0;
 	}
 
 	const IRInst *GetInstructions() const { return instr_; }
 	int GetNumInstructions() const { return numInstructions_; }
+	// For IRInterpretThreaded(), null unless built.  Also in the arena, see IRBlockCache::BuildThreaded().
+	void SetThreaded(IRThreadedInst *threaded, u32 count) {
+		threaded_ = threaded;
+		numThreaded_ = count;
+	}
+	void RelocateThreaded(IRThreadedInst *threaded) {
+		threaded_ = threaded;
+	}
+	void ClearThreaded() {
+		threaded_ = nullptr;
+		numThreaded_ = 0;
+	}
+	bool HasThreaded() const { return threaded_ != nullptr; }
+	const IRThreadedInst *GetThreaded() const { return threaded_; }
+	u32 GetNumThreaded() const { return numThreaded_; }
 	MIPSOpcode GetOriginalFirstOp() const { return origFirstOpcode_; }
 	bool HasOriginalFirstOp() const;
 	bool RestoreOriginalFirstOp(int number);
@@ -72,6 +101,13 @@ class IRBlock {
 	void SetOriginalSize(u32 size) {
 		origSize_ = size;
 	}
+	// Code compiled in after following a jump, outside the original range.
+	void SetProxyRanges(const IRProxyRanges &ranges) {
+		proxyRanges_ = ranges;
+	}
+	const IRProxyRanges &GetProxyRanges() const {
+		return proxyRanges_;
+	}
 	void SetTargetOffset(int offset) {
 		targetOffset_ = offset;
 	}
@@ -81,11 +117,25 @@ class IRBlock {
 	void UpdateHash() {
 		hash_ = CalculateHash();
 	}
+	u64 GetHash() const {
+		return hash_;
+	}
 	bool HashMatches() const {
 		return origAddr_ && hash_ == CalculateHash();
 	}
 	bool OverlapsRange(u32 addr, u32 size) const;
 
+	// Returns true once, when the block has run often enough to be recompiled at tier 2.
+	bool CountExecution(u32 threshold) {
+		return tier_ == 1 && ++execCount_ == threshold;
+	}
+	int GetTier() const {
+		return tier_;
+	}
+	void SetTier(int tier) {
+		tier_ = (u8)tier;
+	}
+
 	void GetRange(u32 &start, u32 &size) const {
 		start = origAddr_;
 		size = origSize_;
@@ -97,6 +147,8 @@ class IRBlock {
 	void Finalize(int number);
 	void Destroy(int number);
 
+	static u64 CalculateHash(u32 addr, u32 size, const IRProxyRanges *proxies = nullptr);
+
 private:
 	u64 CalculateHash() const;
 
@@ -106,7 +158,20 @@ class IRBlock {
 	u32 origSize_ = 0;
 	MIPSOpcode origFirstOpcode_ = MIPSOpcode(0x68FFFFFF);
 	int targetOffset_ = -1;
+	u32 execCount_ = 0;
 	u16 numInstructions_ = 0;
+	u8 tier_ = 1;
+	IRProxyRanges proxyRanges_;
+	IRThreadedInst *threaded_ = nullptr;
+	u32 numThreaded_ = 0;
+};
+
+// A finalized block kept around for the on-disk cache, so it can be reused next boot.
+struct IRDiskCacheEntry {
+	u32 size;
+	u32 flags;
+	u64 hash;
+	std::vector<IRInst> instructions;
 };
 
 class IRBlockCache : public JitBlockCacheDebugInterface {
@@ -114,11 +179,28 @@ class IRBlockCache : public JitBlockCacheDebugInterface {
 	IRBlockCache() {}
 	void Clear();
 	std::vector<int> FindInvalidatedBlockNumbers(u32 address, u32 length);
+	// Restores the original first op and removes the block from the index, so it's not found again.
+	void DestroyBlock(int i, int cookie);
 	void FinalizeBlock(int i, bool preload = false);
+	void SetThreadedDispatch(bool enable) {
+		threadedDispatch_ = enable;
+	}
+	bool UsesThreadedDispatch() const {
+		return threadedDispatch_;
+	}
+	void SetHeatMap(bool enable) {
+		heatMap_ = enable;
+	}
+	bool UsesHeatMap() const {
+		return heatMap_;
+	}
 	int GetNumBlocks() const override { return (int)blocks_.size(); }
 	int AllocateBlock(int emAddr) {
 		blocks_.push_back(IRBlock(emAddr));
-		return (int)blocks_.size() - 1;
+		int i = (int)blocks_.size() - 1;
+		if (heatMap_)
+			AllocateHeatCounter(i);
+		return i;
 	}
 	IRBlock *GetBlock(int i) {
 		if (i >= 0 && i < (int)blocks_.size()) {
@@ -135,21 +217,108 @@ class IRBlockCache : public JitBlockCacheDebugInterface {
 		}
 	}
 
+	// False means no block could overlap the range, true may still have no overlap.
+	bool MayHaveCode(u32 address, u32 length) const {
+		return pageIndex_.HasCode(address, length);
+	}
+
 	int FindPreloadBlock(u32 em_address);
 	int FindByCookie(int cookie);
 
+	// Execution counts for the heat map.  These never move, so native code can increment them.
+	// Only valid when the heat map is enabled.
+	u32 *GetHeatCounter(int i) {
+		return &heatCounters_[i / IR_HEAT_CHUNK_SIZE][i % IR_HEAT_CHUNK_SIZE];
+	}
+	void CountHeat(int i) {
+		++*GetHeatCounter(i);
+	}
+	// Adds the counts to the heat map, and resets them.
+	void CollectHeat(JitHeatMap &heatMap, int i);
+	void CollectAllHeat(JitHeatMap &heatMap);
+
+	// Copies the instructions into the arena.  Any previous instructions become garbage.
+	void SetBlockInstructions(IRBlock *b, const std::vector<IRInst> &inst);
+	// For invalidated blocks.  The memory stays put until CompactArena(), in case it's running.
+	// Releases the threaded copy too.
+	void ReleaseBlockInstructions(IRBlock *b);
+	// Builds the threaded copy of the instructions, next to them in the arena.
+	void BuildThreaded(IRBlock *b);
+	// Moves instructions, so only call this when no block is executing.
+	void CompactArenaIfNeeded();
+
 	std::vector<u32> SaveAndClearEmuHackOps();
 	void RestoreSavedEmuHackOps(std::vector<u32> saved);
 
+	// The disk cache is keyed by start address, and validated against the hash of the MIPS code.
+	// The key includes anything about the frontend that changes the IR (options, build version.)
+	bool LoadDiskCache(const Path &filename, u64 key);
+	void SaveDiskCache(const Path &filename, u64 key);
+	bool HasDiskCache() const { return diskCacheEnabled_; }
+	bool LookupDiskCache(u32 em_address, u32 flags, std::vector<IRInst> &instructions, u32 &mipsBytes);
+	void StoreDiskCache(u32 em_address, u32 mipsBytes, u32 flags, u64 hash, const std::vector<IRInst> &instructions);
+
+	// Times are in seconds, latency is from queueing until the block was installed.
+	void RecordBackgroundCompile(double compileTime, double latency);
+
 	JitBlockDebugInfo GetBlockDebugInfo(int blockNum) const override;
 	void ComputeStats(BlockCacheStats &bcStats) const override;
+	// Stats that don't depend on the target, shared with native backends.
+	void ComputeIRStats(BlockCacheStats &bcStats) const;
 	int GetBlockNumberFromStartAddress(u32 em_address, bool realBlocksOnly = true) const override;
+	int GetBlockNumberFromAddress(u32 em_address) const override;
 
 private:
-	u32 AddressToPage(u32 addr) const;
+	u8 *AllocateArena(u32 bytes);
+	void ReleaseThreaded(IRBlock *b);
+	void RemoveFromPageIndex(int i);
+	void CompactArena();
+	void AllocateHeatCounter(int i);
+
+	static constexpr int IR_HEAT_CHUNK_SIZE = 4096;
 
 	std::vector<IRBlock> blocks_;
-	std::unordered_map<u32, std::vector<int>> byPage_;
+	JitPageIndex pageIndex_;
+
+	// Block instructions and their threaded copies are bump allocated in chunks, which are never resized.
+	struct ArenaChunk {
+		std::unique_ptr<u8[]> data;
+		u32 capacity;
+		u32 used;
+	};
+	std::vector<ArenaChunk> arena_;
+	u64 arenaLiveBytes_ = 0;
+	u64 arenaGarbageBytes_ = 0;
+	int arenaCompactions_ = 0;
+	std::vector<IRThreadedInst> threadedScratch_;
+
+	bool diskCacheEnabled_ = false;
+	bool threadedDispatch_ = false;
+	bool heatMap_ = false;
+	std::vector<std::unique_ptr<u32[]>> heatCounters_;
+	std::unordered_map<u32, std::vector<IRDiskCacheEntry>> diskCache_;
+	int diskCacheHits_ = 0;
+	int diskCacheMisses_ = 0;
+	int diskCacheInvalidations_ = 0;
+
+	int bgCompiles_ = 0;
+	double bgCompileTime_ = 0.0;
+	double bgCompileTimeMax_ = 0.0;
+	double bgLatency_ = 0.0;
+	double bgLatencyMax_ = 0.0;
+};
+
+// A block compile requested by the emu thread, run on a worker.
+struct IRBackgroundCompile {
+	u32 em_address;
+	u32 compileFlags;
+	u32 generation;
+	u32 mipsBytes;
+	u64 hash;
+	double queueTime;
+	double compileTime;
+	std::vector<IRInst> instructions;
+	IRProxyRanges proxies;
 };
 
 class IRJit : public JitInterface {
@@ -172,8 +341,15 @@ class IRJit : public JitInterface {
 	JitBlockCacheDebugInterface *GetBlockCacheDebugInterface() override { return &blocks_; }
 	MIPSOpcode GetOriginalOp(MIPSOpcode op) override;
 
-	std::vector<u32> SaveAndClearEmuHackOps() override { return blocks_.SaveAndClearEmuHackOps(); }
-	void RestoreSavedEmuHackOps(std::vector<u32> saved) override { blocks_.RestoreSavedEmuHackOps(saved); }
+	// These rewrite first ops, which background compiles may be reading.
+	std::vector<u32> SaveAndClearEmuHackOps() override {
+		std::lock_guard<std::recursive_mutex> guard(blocksLock_);
+		return blocks_.SaveAndClearEmuHackOps();
+	}
+	void RestoreSavedEmuHackOps(std::vector<u32> saved) override {
+		std::lock_guard<std::recursive_mutex> guard(blocksLock_);
+		blocks_.RestoreSavedEmuHackOps(saved);
+	}
 
 	void ClearCache() override;
 	void InvalidateCacheAt(u32 em_address, int length = 4) override;
@@ -189,8 +365,16 @@ class IRJit : public JitInterface {
 	void LinkBlock(u8 *exitPoint, const u8 *checkedEntry) override;
 	void UnlinkBlock(u8 *checkedEntry, u32 originalAddress) override;
 
+	// Called on a worker thread.
+	void RunBackgroundCompiles();
+
 protected:
 	bool CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload);
+	bool InstallBlock(u32 em_address, const std::vector<IRInst> &instructions, u32 mipsBytes, const IRProxyRanges &proxies, u32 compileFlags, bool storeInDiskCache, bool preload);
+	// Recompiles a hot block with the more expensive passes.
+	void PromoteBlock(int block_num);
+	// For blocks we didn't run DoJit() on ourselves.
+	void NoteRoundingMode(const std::vector<IRInst> &instructions);
 	virtual bool CompileTargetBlock(IRBlock *block, int block_num, bool preload) { return true; }
 	virtual void FinalizeTargetBlock(IRBlock *block, int block_num) {}
 
@@ -199,6 +383,32 @@ class IRJit : public JitInterface {
 	IRFrontend frontend_;
 	IRBlockCache blocks_;
 
+	// Number of runs before a block is recompiled at tier 2, or 0 to disable.
+	u32 tier2Threshold_ = 0;
+
+	Path diskCachePath_;
+	u64 diskCacheKey_ = 0;
+
+	// Background compilation: misses are interpreted while a worker runs the frontend.
+	void CompileInBackground(u32 em_address);
+	void PublishBackgroundCompiles();
+	void WaitForBackgroundCompiles();
+	void InterpretUntilBranch();
+
+	bool backgroundCompile_ = false;
+	IRFrontend bgFrontend_;
+	// Guards blocks and their first ops against GetOriginalOp() from the worker.  Recursive since
+	// Finalize() reads the first op through GetOriginalOp() too.
+	std::recursive_mutex blocksLock_;
+	std::mutex bgLock_;
+	std::condition_variable bgCond_;
+	std::deque<IRBackgroundCompile> bgQueue_;
+	std::vector<IRBackgroundCompile> bgDone_;
+	bool bgRunning_ = false;
+	// Only touched on the emu thread.
+	std::unordered_set<u32> bgPending_;
+	u32 bgGeneration_ = 0;
+
 	MIPSState *mips_;
 
 	// where to write branch-likely trampolines. not used atm
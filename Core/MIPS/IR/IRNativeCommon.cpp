@@ -480,7 +480,11 @@ void IRNativeBackend::CompileIRInst(IRInst inst) {
 }
 
 IRNativeJit::IRNativeJit(MIPSState *mipsState)
-	: IRJit(mipsState), debugInterface_(blocks_) {}
+	: IRJit(mipsState), debugInterface_(blocks_) {
+	// The native dispatcher always compiles synchronously, and doesn't use threaded IR.
+	backgroundCompile_ = false;
+	blocks_.SetThreadedDispatch(false);
+}
 
 void IRNativeJit::Init(IRNativeBackend &backend) {
 	backend_ = &backend;
@@ -531,8 +535,10 @@ void IRNativeJit::InvalidateCacheAt(u32 em_address, int length) {
 	std::vector<int> numbers = blocks_.FindInvalidatedBlockNumbers(em_address, length);
 	for (int block_num : numbers) {
 		auto block = blocks_.GetBlock(block_num);
+		if (blocks_.UsesHeatMap())
+			blocks_.CollectHeat(jitHeatMap, block_num);
 		backend_->InvalidateBlock(block, block_num);
-		block->Destroy(block->GetTargetOffset());
+		blocks_.DestroyBlock(block_num, block->GetTargetOffset());
 	}
 }
 
@@ -682,6 +688,29 @@ void IRNativeBackend::SetBlockCheckedOffset(int block_num, int offset) {
 	nativeBlocks_[block_num].checkedOffset = offset;
 }
 
+void IRNativeBackend::SetBlockLinkedEntry(int block_num, int offset, int patchOffset, int invalidOffset, const IRNativeLinkedReg *linked, int count) {
+	if (block_num >= (int)nativeBlocks_.size())
+		nativeBlocks_.resize(block_num + 1);
+
+	IRNativeBlock &nativeBlock = nativeBlocks_[block_num];
+	nativeBlock.linkedOffset = offset;
+	nativeBlock.linkedPatchOffset = patchOffset;
+	nativeBlock.linkedInvalidOffset = invalidOffset;
+	nativeBlock.linkedRegs.assign(linked, linked + count);
+}
+
+void IRNativeBackend::CountLinkedRegExit(int kept, int loaded) {
+	linkedRegExits_++;
+	linkedRegsKept_ += kept;
+	linkedRegsLoaded_ += loaded;
+}
+
+void IRNativeBackend::ComputeLinkStats(BlockCacheStats &bcStats) const {
+	bcStats.linkedRegExits = linkedRegExits_;
+	bcStats.linkedRegsKept = linkedRegsKept_;
+	bcStats.linkedRegsLoaded = linkedRegsLoaded_;
+}
+
 void IRNativeBackend::AddLinkableExit(int block_num, uint32_t pc, int exitStartOffset, int exitLen) {
 	linksTo_.emplace(pc, block_num);
 
@@ -698,6 +727,9 @@ void IRNativeBackend::EraseAllLinks(int block_num) {
 	if (block_num == -1) {
 		linksTo_.clear();
 		nativeBlocks_.clear();
+		linkedRegExits_ = 0;
+		linkedRegsKept_ = 0;
+		linkedRegsLoaded_ = 0;
 	} else {
 		linksTo_.erase(block_num);
 		if (block_num < (int)nativeBlocks_.size())
@@ -721,6 +753,10 @@ int IRNativeBlockCacheDebugInterface::GetBlockNumberFromStartAddress(u32 em_addr
 	return irBlocks_.GetBlockNumberFromStartAddress(em_address, realBlocksOnly);
 }
 
+int IRNativeBlockCacheDebugInterface::GetBlockNumberFromAddress(u32 em_address) const {
+	return irBlocks_.GetBlockNumberFromAddress(em_address);
+}
+
 void IRNativeBlockCacheDebugInterface::GetBlockCodeRange(int blockNum, int *startOffset, int *size) const {
 	int blockOffset = irBlocks_.GetBlock(blockNum)->GetTargetOffset();
 	int endOffset = backend_->GetNativeBlock(blockNum)->checkedOffset;
@@ -794,6 +830,8 @@ void IRNativeBlockCacheDebugInterface::ComputeStats(BlockCacheStats &bcStats) co
 	bcStats.minBloat = (float)minBloat;
 	bcStats.maxBloat = (float)maxBloat;
 	bcStats.avgBloat = (float)(totalBloat / (double)numBlocks);
+	irBlocks_.ComputeIRStats(bcStats);
+	backend_->ComputeLinkStats(bcStats);
 }
 
 } // namespace MIPSComp
@@ -19,6 +19,7 @@
 
 #include <unordered_map>
 #include "Core/MIPS/IR/IRJit.h"
+#include "Core/MIPS/IR/IRRegCache.h"
 #include "Core/MIPS/JitCommon/JitBlockCache.h"
 
 namespace MIPSComp {
@@ -57,6 +58,12 @@ struct IRNativeBlockExit {
 struct IRNativeBlock {
 	int checkedOffset = 0;
 	std::vector<IRNativeBlockExit> exits;
+	// Entry for linked exits that keep linkedRegs in native regs, if any.
+	int linkedOffset = 0;
+	// Overwritten on invalidate to jump to linkedInvalidOffset, which stores them.
+	int linkedPatchOffset = 0;
+	int linkedInvalidOffset = 0;
+	std::vector<IRNativeLinkedReg> linkedRegs;
 };
 
 class IRNativeBackend {
@@ -84,6 +91,8 @@ class IRNativeBackend {
 
 	const IRNativeBlock *GetNativeBlock(int block_num) const;
 	void SetBlockCheckedOffset(int block_num, int offset);
+	void SetBlockLinkedEntry(int block_num, int offset, int patchOffset, int invalidOffset, const IRNativeLinkedReg *linked, int count);
+	void ComputeLinkStats(BlockCacheStats &bcStats) const;
 
 	virtual const CodeBlockCommon &CodeBlock() const = 0;
 
@@ -151,11 +160,16 @@ class IRNativeBackend {
 
 	void AddLinkableExit(int block_num, uint32_t pc, int exitStartOffset, int exitLen);
 	void EraseAllLinks(int block_num);
+	// Counted at compile time, for exits that passed registers to the linked block.
+	void CountLinkedRegExit(int kept, int loaded);
 
 	IRNativeHooks hooks_;
 	IRBlockCache &blocks_;
 	std::vector<IRNativeBlock> nativeBlocks_;
 	std::unordered_multimap<uint32_t, int> linksTo_;
+	int linkedRegExits_ = 0;
+	int linkedRegsKept_ = 0;
+	int linkedRegsLoaded_ = 0;
 };
 
 class IRNativeBlockCacheDebugInterface : public JitBlockCacheDebugInterface {
@@ -164,6 +178,7 @@ class IRNativeBlockCacheDebugInterface : public JitBlockCacheDebugInterface {
 	void Init(const IRNativeBackend *backend);
 	int GetNumBlocks() const;
 	int GetBlockNumberFromStartAddress(u32 em_address, bool realBlocksOnly = true) const;
+	int GetBlockNumberFromAddress(u32 em_address) const;
 	JitBlockDebugInfo GetBlockDebugInfo(int blockNum) const;
 	void ComputeStats(BlockCacheStats &bcStats) const;
 
@@ -19,6 +19,7 @@
 #include <cstddef>
 #endif
 
+#include <algorithm>
 #include <cstring>
 #include "Common/Log.h"
 #include "Common/LogReporting.h"
@@ -748,6 +749,140 @@ void IRNativeRegCacheBase::FlushAll(bool gprs, bool fprs) {
 	}
 }
 
+static bool IsUnconditionalExit(const IRInstMeta &inst) {
+	if ((inst.m.flags & IRFLAG_EXIT) == 0)
+		return false;
+	switch (inst.op) {
+	case IROp::ExitToConstIfEq:
+	case IROp::ExitToConstIfNeq:
+	case IROp::ExitToConstIfGtZ:
+	case IROp::ExitToConstIfGeZ:
+	case IROp::ExitToConstIfLtZ:
+	case IROp::ExitToConstIfLeZ:
+	case IROp::ExitToConstIfFpTrue:
+	case IROp::ExitToConstIfFpFalse:
+		return false;
+	default:
+		return true;
+	}
+}
+
+int IRNativeRegCacheBase::ComputeLinkedRegs(const MIPSComp::IRBlock *irBlock, IRNativeLinkedReg linked[MAX_LINKED_REGS]) {
+	int allocCount = 0, base = 0;
+	const int *allocOrder = GetAllocationOrder(MIPSLoc::REG, MIPSMap::INIT, allocCount, base);
+
+	int numStatics;
+	const StaticAllocation *statics = GetStaticAllocations(numStatics);
+	auto isStaticNativeReg = [&](IRNativeReg nreg) {
+		for (int i = 0; i < numStatics; ++i) {
+			if (statics[i].nr == nreg)
+				return true;
+		}
+		return false;
+	};
+
+	// Leave at least half of the regs for the block itself.
+	int maxLinked = std::min(MAX_LINKED_REGS, (allocCount - numStatics) / 2);
+	IRNativeReg nativeRegs[MAX_LINKED_REGS];
+	int numNativeRegs = 0;
+	for (int i = 0; i < allocCount && numNativeRegs < maxLinked; ++i) {
+		IRNativeReg nreg = IRNativeReg(allocOrder[i] - base);
+		if (!isStaticNativeReg(nreg))
+			nativeRegs[numNativeRegs++] = nreg;
+	}
+
+	uint32_t written = 0;
+	uint32_t chosen = 0;
+	int count = 0;
+	const IRInst *instructions = irBlock->GetInstructions();
+	for (int i = 0; i < irBlock->GetNumInstructions() && count < numNativeRegs; ++i) {
+		IRInstMeta inst = GetIRMeta(instructions[i]);
+		// Anything after a barrier would be flushed first anyway.
+		if ((inst.m.flags & IRFLAG_BARRIER) != 0)
+			break;
+
+		IRReg reads[4];
+		int numReads = IRReadsFromGPRs(inst, reads);
+		for (int j = 0; j < numReads && count < numNativeRegs; ++j) {
+			IRReg r = reads[j];
+			if (r == MIPS_REG_ZERO || r >= 32 || mr[r].isStatic)
+				continue;
+			if ((written | chosen) & (1U << r))
+				continue;
+			chosen |= 1U << r;
+			linked[count].mipsReg = r;
+			linked[count].nativeReg = nativeRegs[count];
+			count++;
+		}
+
+		int dest = IRDestGPR(inst);
+		if (dest > 0 && dest < 32)
+			written |= 1U << dest;
+		if (IsUnconditionalExit(inst))
+			break;
+	}
+
+	return count;
+}
+
+void IRNativeRegCacheBase::StartLinked(const IRNativeLinkedReg *linked, int count) {
+	for (int i = 0; i < count; ++i) {
+		IRReg mreg = linked[i].mipsReg;
+		IRNativeReg nreg = linked[i].nativeReg;
+		_dbg_assert_(mr[mreg].loc == MIPSLoc::MEM && nr[nreg].mipsReg == IRREG_INVALID);
+
+		mr[mreg].loc = MIPSLoc::REG;
+		mr[mreg].nReg = nreg;
+		mr[mreg].imm = 0;
+		nr[nreg].mipsReg = mreg;
+		nr[nreg].isDirty = true;
+		nr[nreg].pointerified = false;
+		nr[nreg].normalized32 = false;
+	}
+}
+
+uint32_t IRNativeRegCacheBase::FlushAllForLink(const IRNativeLinkedReg *linked, int count) {
+	uint32_t kept = 0;
+	for (int i = 0; i < count; ++i) {
+		const RegStatusMIPS &m = mr[linked[i].mipsReg];
+		if (m.isStatic || m.nReg != linked[i].nativeReg)
+			continue;
+		if (m.loc != MIPSLoc::REG && m.loc != MIPSLoc::REG_IMM)
+			continue;
+		if (nr[m.nReg].pointerified)
+			continue;
+		kept |= 1U << i;
+	}
+
+	// Pretend the kept regs are static, so FlushAll() leaves them mapped (as they are.)
+	for (int i = 0; i < count; ++i) {
+		if (kept & (1U << i))
+			mr[linked[i].mipsReg].isStatic = true;
+	}
+	FlushAll();
+	for (int i = 0; i < count; ++i) {
+		if (kept & (1U << i))
+			mr[linked[i].mipsReg].isStatic = false;
+	}
+
+	return kept;
+}
+
+void IRNativeRegCacheBase::EmitLoadLinkedRegs(const IRNativeLinkedReg *linked, int count, uint32_t skipMask) {
+	for (int i = 0; i < count; ++i) {
+		if ((skipMask & (1U << i)) == 0)
+			LoadNativeReg(linked[i].nativeReg, linked[i].mipsReg, 1);
+	}
+}
+
+void IRNativeRegCacheBase::EmitStoreLinkedRegs(const IRNativeLinkedReg *linked, int count) {
+	// Must be right after StartLinked(), before anything else was mapped.
+	for (int i = 0; i < count; ++i) {
+		_dbg_assert_(mr[linked[i].mipsReg].nReg == linked[i].nativeReg);
+		StoreNativeReg(linked[i].nativeReg, linked[i].mipsReg, 1);
+	}
+}
+
 void IRNativeRegCacheBase::Map(const IRInst &inst) {
 	Mapping mapping[3];
 	MappingFromInst(inst, mapping);
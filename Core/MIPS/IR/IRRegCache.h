@@ -38,6 +38,13 @@ constexpr IRReg IRREG_INVALID = 255;
 class IRWriter;
 class MIPSState;
 
+// A GPR that a block expects in a specific native reg, when entered from a linked exit.
+struct IRNativeLinkedReg {
+	IRReg mipsReg;
+	IRNativeReg nativeReg;
+};
+constexpr int MAX_LINKED_REGS = 4;
+
 namespace MIPSComp {
 class IRBlock;
 struct JitOptions;
@@ -198,6 +205,17 @@ class IRNativeRegCacheBase {
 	void MapWithExtra(const IRInst &inst, std::vector<Mapping> extra);
 	virtual void FlushAll(bool gprs = true, bool fprs = true);
 
+	// Picks GPRs the block reads before writing, which linked exits may pass in native regs.
+	int ComputeLinkedRegs(const MIPSComp::IRBlock *irBlock, IRNativeLinkedReg linked[MAX_LINKED_REGS]);
+	// After Start(), maps the linked regs.  They're dirty, since a linked exit doesn't store them.
+	void StartLinked(const IRNativeLinkedReg *linked, int count);
+	// Like FlushAll(), but keeps linked regs that are already in the right native reg.
+	// Returns a mask of the linked regs kept (by index into linked.)
+	uint32_t FlushAllForLink(const IRNativeLinkedReg *linked, int count);
+	// These only emit code, the regcache state is left alone (for entry and exit paths.)
+	void EmitLoadLinkedRegs(const IRNativeLinkedReg *linked, int count, uint32_t skipMask);
+	void EmitStoreLinkedRegs(const IRNativeLinkedReg *linked, int count);
+
 protected:
 	virtual void SetupInitialRegs();
 	virtual const int *GetAllocationOrder(MIPSLoc type, MIPSMap flags, int &count, int &base) const = 0;
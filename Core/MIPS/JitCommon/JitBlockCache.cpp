@@ -39,6 +39,7 @@
 
 #include "Core/MIPS/JitCommon/JitBlockCache.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
+#include "Core/MIPS/JitCommon/JitHeatMap.h"
 
 // #include "JitBase.h"
 
@@ -120,7 +121,7 @@ void JitBlockCache::Shutdown() {
 // This clears the JIT cache. It's called from JitCache.cpp when the JIT cache
 // is full and when saving and loading states.
 void JitBlockCache::Clear() {
-	block_map_.clear();
+	pageIndex_.Clear();
 	proxyBlockMap_.clear();
 	for (int i = 0; i < num_blocks_; i++)
 		DestroyBlock(i, DestroyType::CLEAR);
@@ -166,6 +167,7 @@ int JitBlockCache::AllocateBlock(u32 startAddress) {
 
 	b.invalid = false;
 	b.originalAddress = startAddress;
+	b.heatCount = 0;
 	for (int i = 0; i < MAX_JIT_BLOCK_EXITS; ++i) {
 		b.exitAddress[i] = INVALID_EXIT;
 		b.exitPtrs[i] = 0;
@@ -216,7 +218,7 @@ void JitBlockCache::AddBlockMap(int block_num) {
 	// Convert the logical address to a physical address for the block map
 	// Yeah, this'll work fine for PSP too I think.
 	u32 pAddr = b.originalAddress & 0x1FFFFFFF;
-	block_map_[std::make_pair(pAddr + 4 * b.originalSize, pAddr)] = block_num;
+	pageIndex_.Add(pAddr, 4 * b.originalSize, block_num);
 }
 
 void JitBlockCache::RemoveBlockMap(int block_num) {
@@ -226,18 +228,7 @@ void JitBlockCache::RemoveBlockMap(int block_num) {
 	}
 
 	const u32 pAddr = b.originalAddress & 0x1FFFFFFF;
-	auto it = block_map_.find(std::make_pair(pAddr + 4 * b.originalSize, pAddr));
-	if (it != block_map_.end() && it->second == (u32)block_num) {
-		block_map_.erase(it);
-	} else {
-		// It wasn't in there, or it has the wrong key.  Let's search...
-		for (auto it = block_map_.begin(); it != block_map_.end(); ++it) {
-			if (it->second == (u32)block_num) {
-				block_map_.erase(it);
-				break;
-			}
-		}
-	}
+	pageIndex_.Remove(pAddr, 4 * b.originalSize, block_num);
 }
 
 static void ExpandRange(std::pair<u32, u32> &range, u32 newStart, u32 newEnd) {
@@ -255,6 +246,8 @@ void JitBlockCache::FinalizeBlock(int block_num, bool block_link) {
 
 	// Note that this hashes the emuhack too, which is intentional.
 	b.compiledHash = HashJitBlock(b);
+	// Even if the jit doesn't count executions, this records that it ran.
+	b.heatCount++;
 
 	AddBlockMap(block_num);
 
@@ -383,7 +376,7 @@ void JitBlockCache::GetBlockNumbersFromAddress(u32 em_address, std::vector<int>
 			block_numbers->push_back(i);
 }
 
-int JitBlockCache::GetBlockNumberFromAddress(u32 em_address) {
+int JitBlockCache::GetBlockNumberFromAddress(u32 em_address) const {
 	for (int i = 0; i < num_blocks_; i++) {
 		if (blocks_[i].ContainsAddress(em_address))
 			return i;
@@ -559,6 +552,8 @@ void JitBlockCache::DestroyBlock(int block_num, DestroyType type) {
 	}
 
 	b->invalid = true;
+	if (!b->IsPureProxy() && MIPSComp::jitHeatMap.IsRecording())
+		MIPSComp::jitHeatMap.Add(b->originalAddress, b->heatCount);
 	if (!b->IsPureProxy()) {
 		if (Memory::ReadUnchecked_U32(b->originalAddress) == GetEmuHackOpForBlock(block_num).encoding)
 			Memory::Write_Opcode_JIT(b->originalAddress, b->originalFirstOpcode);
@@ -600,25 +595,22 @@ void JitBlockCache::InvalidateICache(u32 address, const u32 length) {
 		return;
 	}
 
-	// Blocks may start and end in overlapping ways, and destroying one invalidates iterators.
-	// So after destroying one, we start over.
-	do {
-	restart:
-		auto next = block_map_.lower_bound(std::make_pair(pAddr, 0));
-		auto last = block_map_.upper_bound(std::make_pair(pEnd + MAX_BLOCK_INSTRUCTIONS, 0));
-		// Note that if next is end(), last will be end() too (equal.)
-		for (; next != last; ++next) {
-			const u32 blockStart = next->first.second;
-			const u32 blockEnd = next->first.first;
-			if (blockStart < pEnd && blockEnd > pAddr) {
-				DestroyBlock(next->second, DestroyType::INVALIDATE);
-				// Our iterator is now invalid.  Break and search again.
-				// Most of the time there shouldn't be a bunch of matching blocks.
-				goto restart;
-			}
-		}
-		// We got here - it wasn't in the map at all (or anymore.)
-	} while (false);
+	// Most writes (like loading data files) don't touch any pages with code.
+	if (!pageIndex_.HasCode(pAddr, length))
+		return;
+
+	std::vector<int> found;
+	pageIndex_.FindBlocks(pAddr, length, found);
+	for (int block_num : found) {
+		// Destroying a block can destroy others (for proxies), so check each is still around.
+		const JitBlock &b = blocks_[block_num];
+		if (b.invalid)
+			continue;
+		const u32 blockStart = b.originalAddress & 0x1FFFFFFF;
+		const u32 blockEnd = blockStart + 4 * b.originalSize;
+		if (blockStart < pEnd && blockEnd > pAddr)
+			DestroyBlock(block_num, DestroyType::INVALIDATE);
+	}
 }
 
 void JitBlockCache::InvalidateChangedBlocks() {
@@ -27,6 +27,7 @@
 #include "Common/CommonTypes.h"
 #include "Common/CodeBlock.h"
 #include "Core/MIPS/MIPS.h"
+#include "Core/MIPS/JitCommon/JitPageIndex.h"
 
 #if PPSSPP_ARCH(ARM) || PPSSPP_ARCH(ARM64)
 const int MAX_JIT_BLOCK_EXITS = 4;
@@ -43,6 +44,28 @@ struct BlockCacheStats {
 	float maxBloat;
 	u32 maxBloatBlock;
 	std::map<float, u32> bloatMap;
+	// Only used by the IR block cache, when the on-disk cache is enabled.
+	int diskCacheHits = 0;
+	int diskCacheMisses = 0;
+	int diskCacheInvalidations = 0;
+	// Background compiles, in seconds.
+	int bgCompiles = 0;
+	float bgCompileTimeAvg = 0.0f;
+	float bgCompileTimeMax = 0.0f;
+	float bgLatencyAvg = 0.0f;
+	float bgLatencyMax = 0.0f;
+	// Tiered compilation (IR interpreter only.)
+	int numTier1Blocks = 0;
+	int numTier2Blocks = 0;
+	// IR instruction arena.  Garbage is from invalidated blocks, until compacted.
+	u64 arenaBytes = 0;
+	u64 arenaLiveBytes = 0;
+	u64 arenaGarbageBytes = 0;
+	int arenaCompactions = 0;
+	// Native IR exits that kept registers for a linked block, and how many were kept or reloaded.
+	int linkedRegExits = 0;
+	int linkedRegsKept = 0;
+	int linkedRegsLoaded = 0;
 };
 
 enum class DestroyType {
@@ -73,6 +96,8 @@ struct JitBlock {
 	u16 codeSize;
 	u16 originalSize;
 	u16 blockNum;
+	// Executions for the heat map, only incremented by jits that support it.
+	u32 heatCount;
 
 	bool invalid;
 	bool linkStatus[MAX_JIT_BLOCK_EXITS];
@@ -107,6 +132,8 @@ class JitBlockCacheDebugInterface {
 public:
 	virtual int GetNumBlocks() const = 0;
 	virtual int GetBlockNumberFromStartAddress(u32 em_address, bool realBlocksOnly = true) const = 0;
+	// Any block containing the address, may be slow.
+	virtual int GetBlockNumberFromAddress(u32 em_address) const = 0;
 	virtual JitBlockDebugInfo GetBlockDebugInfo(int blockNum) const = 0;
 	virtual void ComputeStats(BlockCacheStats &bcStats) const = 0;
 
@@ -144,7 +171,7 @@ class JitBlockCache : public JitBlockCacheDebugInterface {
 	// This one is slow so should only be used for one-shots from the debugger UI, not for anything during runtime.
 	void GetBlockNumbersFromAddress(u32 em_address, std::vector<int> *block_numbers);
 	// Similar to above, but only the first matching address.
-	int GetBlockNumberFromAddress(u32 em_address);
+	int GetBlockNumberFromAddress(u32 em_address) const override;
 	int GetBlockNumberFromEmuHackOp(MIPSOpcode inst, bool ignoreBad = false) const;
 
 	u32 GetAddressFromBlockPtr(const u8 *ptr) const;
@@ -189,7 +216,7 @@ class JitBlockCache : public JitBlockCacheDebugInterface {
 
 	int num_blocks_ = 0;
 	std::unordered_multimap<u32, int> links_to_;
-	std::map<std::pair<u32,u32>, u32> block_map_; // (end_addr, start_addr) -> number
+	JitPageIndex pageIndex_;
 
 	enum {
 		JITBLOCK_RANGE_SCRATCH = 0,
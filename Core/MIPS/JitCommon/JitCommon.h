@@ -172,8 +172,26 @@ namespace MIPSComp {
 	// This seems to be the same for all branch types.
 	u32 ResolveNotTakenTarget(const BranchInfo &branchInfo);
 
+	// Per-frame counters for the debug overlay, see Core_UpdateDebugStats().
+	struct JitStats {
+		void ResetFrame() {
+			lastFrameBlockDispatches = blockDispatches;
+			blockDispatches = 0;
+			lastFrameLinkedRegsKept = linkedRegsKept;
+			linkedRegsKept = 0;
+		}
+
+		// Only the IR interpreter counts these, native dispatchers don't.
+		u32 blockDispatches;
+		u32 lastFrameBlockDispatches;
+		// Register flushes (and reloads) skipped by native linked exits, with debug stats on.
+		u32 linkedRegsKept;
+		u32 lastFrameLinkedRegsKept;
+	};
+
 	extern JitInterface *jit;
 	extern std::recursive_mutex jitLock;
+	extern JitStats jitStats;
 
 	void DoDummyJitState(PointerWrap &p);
 
@@ -0,0 +1,236 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstdio>
+
+#include "ext/xxhash.h"
+#include "Common/File/FileUtil.h"
+#include "Common/Log.h"
+#include "Common/TimeUtil.h"
+#include "Core/Config.h"
+#include "Core/ELF/ParamSFO.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
+#include "Core/MIPS/JitCommon/JitHeatMap.h"
+#include "Core/System.h"
+
+namespace MIPSComp {
+
+#define JIT_HEAT_MAP_MAGIC 0x50414D48  // HMAP
+#define JIT_HEAT_MAP_VERSION 1
+
+struct JitHeatMapHeader {
+	u32 magic;
+	u32 version;
+	u64 key;
+	u32 numEntries;
+	u32 reserved;
+};
+
+struct JitHeatMapEntry {
+	u32 address;
+	u32 count;
+};
+
+JitHeatMap jitHeatMap;
+
+void JitHeatMap::Begin(const Path &filename, u64 key) {
+	Clear();
+	Load(filename, key);
+
+	std::lock_guard<std::mutex> guard(lock_);
+	filename_ = filename;
+	key_ = key;
+	recording_ = true;
+}
+
+void JitHeatMap::End() {
+	Path filename;
+	u64 key;
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		if (!recording_)
+			return;
+		recording_ = false;
+		filename = filename_;
+		key = key_;
+	}
+
+	Save(filename, key);
+	Clear();
+}
+
+void JitHeatMap::Add(u32 address, u32 count) {
+	std::lock_guard<std::mutex> guard(lock_);
+	if (!recording_ || count == 0)
+		return;
+	u32 &value = counts_[address];
+	// Saturate, since these are only relative.
+	value = count > 0xFFFFFFFF - value ? 0xFFFFFFFF : value + count;
+}
+
+u32 JitHeatMap::GetCount(u32 address) const {
+	std::lock_guard<std::mutex> guard(lock_);
+	auto it = counts_.find(address);
+	return it == counts_.end() ? 0 : it->second;
+}
+
+size_t JitHeatMap::Size() const {
+	std::lock_guard<std::mutex> guard(lock_);
+	return counts_.size();
+}
+
+void JitHeatMap::Clear() {
+	std::lock_guard<std::mutex> guard(lock_);
+	counts_.clear();
+}
+
+std::vector<u32> JitHeatMap::GetHottest(size_t count, u32 start, u32 end) const {
+	std::vector<JitHeatMapEntry> entries;
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		for (const auto &it : counts_) {
+			if (it.first >= start && it.first < end)
+				entries.push_back({ it.first, it.second });
+		}
+	}
+
+	count = std::min(count, entries.size());
+	// Ties go to the lower address, so the order is stable.
+	auto hotter = [](const JitHeatMapEntry &a, const JitHeatMapEntry &b) {
+		return a.count != b.count ? a.count > b.count : a.address < b.address;
+	};
+	std::partial_sort(entries.begin(), entries.begin() + count, entries.end(), hotter);
+
+	std::vector<u32> addresses;
+	addresses.reserve(count);
+	for (size_t i = 0; i < count; ++i)
+		addresses.push_back(entries[i].address);
+	return addresses;
+}
+
+bool JitHeatMap::Load(const Path &filename, u64 key) {
+	FILE *f = File::OpenCFile(filename, "rb");
+	if (!f)
+		return false;
+
+	JitHeatMapHeader header{};
+	bool success = fread(&header, sizeof(header), 1, f) == 1;
+	if (!success || header.magic != JIT_HEAT_MAP_MAGIC || header.version != JIT_HEAT_MAP_VERSION) {
+		WARN_LOG(JIT, "Jit heat map header mismatch, ignoring");
+		fclose(f);
+		return false;
+	}
+	if (header.key != key) {
+		INFO_LOG(JIT, "Jit heat map is for a different game version, ignoring");
+		fclose(f);
+		return false;
+	}
+
+	std::vector<JitHeatMapEntry> entries(header.numEntries);
+	if (header.numEntries != 0 && fread(&entries[0], sizeof(JitHeatMapEntry), header.numEntries, f) != header.numEntries) {
+		ERROR_LOG(JIT, "Jit heat map truncated");
+		entries.clear();
+	}
+	fclose(f);
+
+	std::lock_guard<std::mutex> guard(lock_);
+	for (const JitHeatMapEntry &entry : entries) {
+		u32 count = entry.count / 2;
+		if (count != 0)
+			counts_[entry.address] = std::max(counts_[entry.address], count);
+	}
+
+	INFO_LOG(JIT, "Loaded %d blocks from jit heat map", (int)entries.size());
+	return !entries.empty();
+}
+
+bool JitHeatMap::Save(const Path &filename, u64 key) const {
+	std::vector<JitHeatMapEntry> entries;
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		entries.reserve(counts_.size());
+		for (const auto &it : counts_)
+			entries.push_back({ it.first, it.second });
+	}
+	// Hottest first, which makes the file easy to skim in a hex viewer.
+	std::sort(entries.begin(), entries.end(), [](const JitHeatMapEntry &a, const JitHeatMapEntry &b) {
+		return a.count != b.count ? a.count > b.count : a.address < b.address;
+	});
+
+	FILE *f = File::OpenCFile(filename, "wb");
+	if (!f)
+		return false;
+
+	JitHeatMapHeader header{};
+	header.magic = JIT_HEAT_MAP_MAGIC;
+	header.version = JIT_HEAT_MAP_VERSION;
+	header.key = key;
+	header.numEntries = (u32)entries.size();
+
+	bool writeFailed = fwrite(&header, sizeof(header), 1, f) != 1;
+	if (!entries.empty())
+		writeFailed = writeFailed || fwrite(&entries[0], sizeof(JitHeatMapEntry), entries.size(), f) != entries.size();
+	fclose(f);
+
+	if (writeFailed) {
+		ERROR_LOG(JIT, "Failed to write jit heat map, disk full?");
+		File::Delete(filename);
+		return false;
+	}
+
+	NOTICE_LOG(JIT, "Saved %d blocks to jit heat map", header.numEntries);
+	return true;
+}
+
+void BeginJitHeatMap() {
+	std::string discID = g_paramSFO.GetDiscID();
+	if (!g_Config.bJitHeatMap || discID.empty())
+		return;
+
+	// Addresses only make sense for the same version of the game.
+	std::string keyData = discID + "/" + g_paramSFO.GetValueString("DISC_VERSION");
+	u64 key = XXH3_64bits(keyData.data(), keyData.size());
+
+	File::CreateFullPath(GetSysDirectory(DIRECTORY_APP_CACHE));
+	jitHeatMap.Begin(GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + ".jitheatmap"), key);
+}
+
+void EndJitHeatMap() {
+	jitHeatMap.End();
+}
+
+void PrecompileHotBlocks(u32 start, u32 size) {
+	if (!jitHeatMap.IsRecording() || g_Config.iJitHeatMapPreloadBlocks <= 0)
+		return;
+
+	std::lock_guard<std::recursive_mutex> guard(jitLock);
+	if (!jit)
+		return;
+
+	double st = time_now_d();
+	std::vector<u32> hottest = jitHeatMap.GetHottest((size_t)g_Config.iJitHeatMapPreloadBlocks, start, start + size);
+	// Uses the preload path, so blocks are validated against the code when first run.
+	for (u32 address : hottest)
+		jit->CompileFunction(address, 4);
+	double et = time_now_d();
+
+	if (!hottest.empty())
+		NOTICE_LOG(JIT, "Precompiled %d hot blocks in %0.2f milliseconds", (int)hottest.size(), (et - st) * 1000.0);
+}
+
+}  // namespace MIPSComp
@@ -0,0 +1,71 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File/Path.h"
+
+namespace MIPSComp {
+
+// Execution counts per guest block start address, kept between sessions.
+// The jits add counts as blocks are destroyed (or on shutdown), and the hottest
+// blocks from previous sessions can be compiled before they're first run.
+class JitHeatMap {
+public:
+	// Loads any previous heat map for the key and starts recording.
+	void Begin(const Path &filename, u64 key);
+	// Saves the merged counts and stops recording.
+	void End();
+	bool IsRecording() const {
+		return recording_;
+	}
+
+	void Add(u32 address, u32 count);
+	u32 GetCount(u32 address) const;
+	size_t Size() const;
+	void Clear();
+
+	// Addresses within [start, end), hottest first.
+	std::vector<u32> GetHottest(size_t count, u32 start = 0, u32 end = 0xFFFFFFFF) const;
+
+	// Counts from the file are halved, so older sessions matter less over time.
+	bool Load(const Path &filename, u64 key);
+	bool Save(const Path &filename, u64 key) const;
+
+private:
+	// Background compiles may destroy blocks while the emu thread runs.
+	mutable std::mutex lock_;
+	std::unordered_map<u32, u32> counts_;
+	Path filename_;
+	u64 key_ = 0;
+	bool recording_ = false;
+};
+
+extern JitHeatMap jitHeatMap;
+
+// Called on boot and shutdown, uses g_Config.bJitHeatMap and the disc ID.
+void BeginJitHeatMap();
+void EndJitHeatMap();
+// Preloads the hottest blocks from previous sessions within a newly loaded range of code.
+void PrecompileHotBlocks(u32 start, u32 size);
+
+}  // namespace MIPSComp
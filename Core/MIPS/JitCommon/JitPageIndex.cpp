@@ -0,0 +1,224 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+
+#include "Common/BitSet.h"
+#include "Core/MIPS/JitCommon/JitPageIndex.h"
+
+JitPageIndex::JitPageIndex() {
+	Clear();
+}
+
+void JitPageIndex::Clear() {
+	bitmap_.assign(FLAT_PAGES / 64, 0);
+	flatLists_.assign(FLAT_PAGES, 0);
+	// Index 0 means no list, so keep a dummy there.
+	lists_.clear();
+	lists_.resize(1);
+	otherPages_.clear();
+}
+
+bool JitPageIndex::RangeToPages(u32 start, u32 size, u32 &firstPage, u32 &lastPage) {
+	if (size == 0)
+		return false;
+	start &= 0x3FFFFFFF;
+	u64 last = (u64)start + size - 1;
+	if (last > 0x3FFFFFFF)
+		last = 0x3FFFFFFF;
+	firstPage = AddressToPage(start);
+	lastPage = AddressToPage((u32)last);
+	return true;
+}
+
+bool JitPageIndex::PageHasCode(u32 page) const {
+	if (IsFlatPage(page)) {
+		u32 index = page - FLAT_START_PAGE;
+		return (bitmap_[index >> 6] & (1ULL << (index & 63))) != 0;
+	}
+	return otherPages_.find(page) != otherPages_.end();
+}
+
+std::vector<int> *JitPageIndex::GetPage(u32 page) {
+	if (IsFlatPage(page)) {
+		u32 index = page - FLAT_START_PAGE;
+		if ((bitmap_[index >> 6] & (1ULL << (index & 63))) == 0)
+			return nullptr;
+		return &lists_[flatLists_[index]];
+	}
+	auto it = otherPages_.find(page);
+	return it == otherPages_.end() ? nullptr : &it->second;
+}
+
+const std::vector<int> *JitPageIndex::GetPage(u32 page) const {
+	return const_cast<JitPageIndex *>(this)->GetPage(page);
+}
+
+std::vector<int> &JitPageIndex::CreatePage(u32 page) {
+	if (IsFlatPage(page)) {
+		u32 index = page - FLAT_START_PAGE;
+		if (flatLists_[index] == 0) {
+			flatLists_[index] = (u32)lists_.size();
+			lists_.emplace_back();
+		}
+		bitmap_[index >> 6] |= 1ULL << (index & 63);
+		return lists_[flatLists_[index]];
+	}
+	return otherPages_[page];
+}
+
+void JitPageIndex::Add(u32 start, u32 size, int block_num) {
+	u32 firstPage, lastPage;
+	if (!RangeToPages(start, size, firstPage, lastPage))
+		return;
+
+	for (u32 page = firstPage; page <= lastPage; ++page) {
+		std::vector<int> &blocks = CreatePage(page);
+		// Usually this is a new block, so it'd be at the end if it was already added.
+		if (blocks.empty() || (blocks.back() != block_num && std::find(blocks.begin(), blocks.end(), block_num) == blocks.end()))
+			blocks.push_back(block_num);
+	}
+}
+
+void JitPageIndex::Remove(u32 start, u32 size, int block_num) {
+	u32 firstPage, lastPage;
+	if (!RangeToPages(start, size, firstPage, lastPage))
+		return;
+
+	for (u32 page = firstPage; page <= lastPage; ++page) {
+		std::vector<int> *blocks = GetPage(page);
+		if (!blocks)
+			continue;
+		auto it = std::find(blocks->begin(), blocks->end(), block_num);
+		if (it != blocks->end())
+			blocks->erase(it);
+		if (!blocks->empty())
+			continue;
+
+		if (IsFlatPage(page)) {
+			u32 index = page - FLAT_START_PAGE;
+			bitmap_[index >> 6] &= ~(1ULL << (index & 63));
+		} else {
+			otherPages_.erase(page);
+		}
+	}
+}
+
+bool JitPageIndex::HasCode(u32 start, u32 size) const {
+	u32 firstPage, lastPage;
+	if (!RangeToPages(start, size, firstPage, lastPage))
+		return false;
+
+	// Check the flat part of the range a word at a time.
+	u32 flatFirst = std::max(firstPage, FLAT_START_PAGE);
+	u32 flatLast = std::min(lastPage, FLAT_START_PAGE + FLAT_PAGES - 1);
+	if (flatFirst <= flatLast) {
+		u32 first = flatFirst - FLAT_START_PAGE;
+		u32 last = flatLast - FLAT_START_PAGE;
+		for (u32 word = first >> 6; word <= last >> 6; ++word) {
+			u64 bits = bitmap_[word];
+			if (word == first >> 6)
+				bits &= ~0ULL << (first & 63);
+			if (word == last >> 6 && (last & 63) != 63)
+				bits &= (1ULL << ((last & 63) + 1)) - 1;
+			if (bits != 0)
+				return true;
+		}
+	}
+
+	if (otherPages_.empty())
+		return false;
+	if (lastPage - firstPage < otherPages_.size()) {
+		for (u32 page = firstPage; page <= lastPage; ++page) {
+			if (!IsFlatPage(page) && PageHasCode(page))
+				return true;
+		}
+		return false;
+	}
+	for (const auto &it : otherPages_) {
+		if (it.first >= firstPage && it.first <= lastPage)
+			return true;
+	}
+	return false;
+}
+
+void JitPageIndex::FindBlocks(u32 start, u32 size, std::vector<int> &blocks) const {
+	u32 firstPage, lastPage;
+	if (!RangeToPages(start, size, firstPage, lastPage))
+		return;
+
+	size_t startSize = blocks.size();
+	int pagesFound = 0;
+	auto addPage = [&](const std::vector<int> &pageBlocks) {
+		blocks.insert(blocks.end(), pageBlocks.begin(), pageBlocks.end());
+		pagesFound++;
+	};
+
+	u32 flatFirst = std::max(firstPage, FLAT_START_PAGE);
+	u32 flatLast = std::min(lastPage, FLAT_START_PAGE + FLAT_PAGES - 1);
+	if (flatFirst <= flatLast) {
+		u32 first = flatFirst - FLAT_START_PAGE;
+		u32 last = flatLast - FLAT_START_PAGE;
+		for (u32 word = first >> 6; word <= last >> 6; ++word) {
+			u64 bits = bitmap_[word];
+			if (word == first >> 6)
+				bits &= ~0ULL << (first & 63);
+			if (word == last >> 6 && (last & 63) != 63)
+				bits &= (1ULL << ((last & 63) + 1)) - 1;
+			// Skip straight to the pages with code.
+			while (bits != 0) {
+				u32 bit = (u32)LeastSignificantSetBit(bits);
+				bits &= bits - 1;
+				addPage(lists_[flatLists_[(word << 6) + bit]]);
+			}
+		}
+	}
+
+	if (!otherPages_.empty()) {
+		if (lastPage - firstPage < otherPages_.size()) {
+			for (u32 page = firstPage; page <= lastPage; ++page) {
+				if (IsFlatPage(page))
+					continue;
+				auto it = otherPages_.find(page);
+				if (it != otherPages_.end())
+					addPage(it->second);
+			}
+		} else {
+			for (const auto &it : otherPages_) {
+				if (it.first >= firstPage && it.first <= lastPage)
+					addPage(it.second);
+			}
+		}
+	}
+
+	// Blocks that cross pages are in each of them.
+	if (pagesFound > 1) {
+		std::sort(blocks.begin() + startSize, blocks.end());
+		blocks.erase(std::unique(blocks.begin() + startSize, blocks.end()), blocks.end());
+	}
+}
+
+const std::vector<int> *JitPageIndex::GetBlocksInPage(u32 address) const {
+	return GetPage(AddressToPage(address));
+}
+
+size_t JitPageIndex::CountPages() const {
+	size_t count = otherPages_.size();
+	for (u64 bits : bitmap_)
+		count += CountSetBits(bits);
+	return count;
+}
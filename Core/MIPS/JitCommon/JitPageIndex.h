@@ -0,0 +1,73 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// Maps guest code pages to the blocks with code in them, so invalidation only looks at nearby blocks.
+// RAM is covered by flat arrays and a bitmap, so checking a range without code is just a scan of bits.
+// Anything else (like scratchpad) falls back to a hash map.
+class JitPageIndex {
+public:
+	JitPageIndex();
+
+	void Clear();
+	// A block can be added to the same page more than once (i.e. for proxy ranges), it's only kept once.
+	void Add(u32 start, u32 size, int block_num);
+	void Remove(u32 start, u32 size, int block_num);
+
+	bool HasCode(u32 start, u32 size) const;
+	// Appends each block once, sorted.  They have code in the same pages, but may not overlap the range.
+	void FindBlocks(u32 start, u32 size, std::vector<int> &blocks) const;
+	// Returns nullptr if the page has no blocks.
+	const std::vector<int> *GetBlocksInPage(u32 address) const;
+
+	size_t CountPages() const;
+
+	static constexpr int PAGE_SHIFT = 10;
+	static u32 AddressToPage(u32 address) {
+		// Use relatively small pages since basic blocks are typically small.
+		return (address & 0x3FFFFFFF) >> PAGE_SHIFT;
+	}
+
+private:
+	// Covers main RAM, including the extra memory on later models.
+	static constexpr u32 FLAT_START_PAGE = 0x08000000 >> PAGE_SHIFT;
+	static constexpr u32 FLAT_PAGES = 0x04000000 >> PAGE_SHIFT;
+
+	static bool IsFlatPage(u32 page) {
+		return page - FLAT_START_PAGE < FLAT_PAGES;
+	}
+	bool PageHasCode(u32 page) const;
+	std::vector<int> *GetPage(u32 page);
+	const std::vector<int> *GetPage(u32 page) const;
+	std::vector<int> &CreatePage(u32 page);
+	// Pages are inclusive, returns false for an empty range.
+	static bool RangeToPages(u32 start, u32 size, u32 &firstPage, u32 &lastPage);
+
+	// One bit per flat page, set when it has any blocks.
+	std::vector<u64> bitmap_;
+	// Index into lists_ per flat page, 0 if never used.  Lists are reused when emptied.
+	std::vector<u32> flatLists_;
+	std::vector<std::vector<int>> lists_;
+	std::unordered_map<u32, std::vector<int>> otherPages_;
+};
@@ -53,6 +53,7 @@ namespace MIPSComp {
 #else
 		enableBlocklink = !Disabled(JitDisable::BLOCKLINK);
 #endif
+		enableLinkedRegs = enableBlocklink && !Disabled(JitDisable::LINKED_REGS);
 		immBranches = false;
 		continueBranches = false;
 		continueJumps = false;
@@ -200,6 +200,7 @@ namespace MIPSComp {
 		LSU_FPU = 0x4000,
 		LSU_VFPU = 0x8000,
 
+		LINKED_REGS = 0x00080000,
 		SIMD = 0x00100000,
 		BLOCKLINK = 0x00200000,
 		POINTERIFY = 0x00400000,
@@ -240,6 +241,8 @@ namespace MIPSComp {
 
 		// Common
 		bool enableBlocklink;
+		// Keep some registers in native regs across linked block exits (IR native only.)
+		bool enableLinkedRegs;
 		bool immBranches;
 		bool continueBranches;
 		bool continueJumps;
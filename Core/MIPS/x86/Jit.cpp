@@ -38,6 +38,7 @@
 #include "Core/MIPS/MIPSCodeUtils.h"
 #include "Core/MIPS/MIPSInt.h"
 #include "Core/MIPS/MIPSTables.h"
+#include "Core/MIPS/JitCommon/JitHeatMap.h"
 #include "Core/HLE/ReplaceTables.h"
 
 #include "RegCache.h"
@@ -384,6 +385,16 @@ const u8 *Jit::DoJit(u32 em_address, JitBlock *b) {
 
 	b->normalEntry = GetCodePtr();
 
+	if (jitHeatMap.IsRecording()) {
+		// Blocks are never moved, so this address is stable.
+		if (RipAccessible(&b->heatCount)) {
+			ADD(32, M(&b->heatCount), Imm8(1));
+		} else {
+			MOV(PTRBITS, R(RAX), ImmPtr(&b->heatCount));
+			ADD(32, MatR(RAX), Imm8(1));
+		}
+	}
+
 	MIPSAnalyst::AnalysisResults analysis = MIPSAnalyst::Analyze(em_address);
 
 	gpr.Start(mips_, &js, &jo, analysis);
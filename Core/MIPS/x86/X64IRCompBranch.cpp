@@ -42,7 +42,7 @@ void X64JitBackend::CompIR_Exit(IRInst inst) {
 	X64Reg exitReg = INVALID_REG;
 	switch (inst.op) {
 	case IROp::ExitToConst:
-		FlushAll();
+		FlushForConstExit(inst.constant);
 		WriteConstExit(inst.constant);
 		break;
 
@@ -77,7 +77,7 @@ void X64JitBackend::CompIR_ExitIf(IRInst inst) {
 		lhs = regs_.RX(inst.src1);
 		rhs = regs_.RX(inst.src2);
 		// This won't change those regs, intentionally.  It might affect flags, though.
-		FlushAll();
+		FlushForConstExit(inst.constant);
 
 		CMP(32, R(lhs), R(rhs));
 		switch (inst.op) {
@@ -104,7 +104,7 @@ void X64JitBackend::CompIR_ExitIf(IRInst inst) {
 	case IROp::ExitToConstIfLeZ:
 		regs_.Map(inst);
 		lhs = regs_.RX(inst.src1);
-		FlushAll();
+		FlushForConstExit(inst.constant);
 
 		CMP(32, R(lhs), Imm32(0));
 		switch (inst.op) {
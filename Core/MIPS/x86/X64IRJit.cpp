@@ -59,6 +59,42 @@ bool X64JitBackend::CompileBlock(IRBlock *block, int block_num, bool preload) {
 		return false;
 
 	u32 startPC = block->GetOriginalStart();
+	compilingBlockNum_ = block_num;
+	regs_.Start(block);
+
+	IRNativeLinkedReg linkedRegs[MAX_LINKED_REGS];
+	int numLinkedRegs = 0;
+	if (jo.enableLinkedRegs && !jo.useBackJump) {
+		numLinkedRegs = regs_.ComputeLinkedRegs(block, linkedRegs);
+		regs_.StartLinked(linkedRegs, numLinkedRegs);
+	}
+
+	FixupBranch linkedEntry;
+	if (numLinkedRegs != 0) {
+		// Linked exits jump here with the linked regs already in place (and not stored.)
+		int linkedOffset = (int)GetOffset(GetCodePointer());
+		WriteDebugPC(startPC);
+		if (jo.downcountInRegister) {
+			TEST(32, R(DOWNCOUNTREG), R(DOWNCOUNTREG));
+		} else {
+			CMP(32, MDisp(CTXREG, downcountOffset), Imm32(0));
+		}
+		// This is overwritten by InvalidateBlock() to jump to the invalid path.
+		int patchOffset = (int)GetOffset(GetCodePointer());
+		linkedEntry = J_CC(CC_NS, true);
+
+		regs_.EmitStoreLinkedRegs(linkedRegs, numLinkedRegs);
+		MOV(32, R(SCRATCH1), Imm32(startPC));
+		JMP(outerLoopPCInSCRATCH1_, true);
+
+		int invalidOffset = (int)GetOffset(GetCodePointer());
+		regs_.EmitStoreLinkedRegs(linkedRegs, numLinkedRegs);
+		MOV(32, R(SCRATCH1), Imm32(startPC));
+		JMP(dispatcherPCInSCRATCH1_, true);
+
+		SetBlockLinkedEntry(block_num, linkedOffset, patchOffset, invalidOffset, linkedRegs, numLinkedRegs);
+	}
+
 	bool wroteCheckedOffset = false;
 	if (jo.enableBlocklink && !jo.useBackJump) {
 		SetBlockCheckedOffset(block_num, (int)GetOffset(GetCodePointer()));
@@ -81,10 +117,24 @@ bool X64JitBackend::CompileBlock(IRBlock *block, int block_num, bool preload) {
 	// Don't worry, the codespace isn't large enough to overflow offsets.
 	const u8 *blockStart = GetCodePointer();
 	block->SetTargetOffset((int)GetOffset(blockStart));
-	compilingBlockNum_ = block_num;
 	lastConstPC_ = 0;
 
-	regs_.Start(block);
+	if (numLinkedRegs != 0) {
+		// Other entries need to load them.
+		regs_.EmitLoadLinkedRegs(linkedRegs, numLinkedRegs, 0);
+		SetJumpTarget(linkedEntry);
+	}
+
+	if (blocks_.UsesHeatMap()) {
+		// After the entries join up, so linked exits are counted too.
+		u32 *counter = blocks_.GetHeatCounter(block_num);
+		if (RipAccessible(counter)) {
+			ADD(32, M(counter), Imm8(1));
+		} else {
+			MOV(PTRBITS, R(SCRATCH1), ImmPtr(counter));
+			ADD(32, MatR(SCRATCH1), Imm8(1));
+		}
+	}
 
 	std::vector<const u8 *> addresses;
 	addresses.reserve(block->GetNumInstructions());
@@ -170,10 +220,52 @@ bool X64JitBackend::CompileBlock(IRBlock *block, int block_num, bool preload) {
 	return true;
 }
 
+int X64JitBackend::ExitTargetBlockNum(uint32_t pc) {
+	// Not yet findable by address, but loops are the most important to link.
+	if (compilingBlockNum_ != -1 && blocks_.GetBlock(compilingBlockNum_)->GetOriginalStart() == pc)
+		return compilingBlockNum_;
+	return blocks_.GetBlockNumberFromStartAddress(pc);
+}
+
+void X64JitBackend::FlushForConstExit(uint32_t pc) {
+	linkedExitBlockNum_ = -1;
+	linkedExitKept_ = 0;
+
+	int block_num = ExitTargetBlockNum(pc);
+	const IRNativeBlock *nativeBlock = GetNativeBlock(block_num);
+	if (block_num >= 0 && jo.enableLinkedRegs && nativeBlock && !nativeBlock->linkedRegs.empty()) {
+		linkedExitKept_ = regs_.FlushAllForLink(nativeBlock->linkedRegs.data(), (int)nativeBlock->linkedRegs.size());
+		linkedExitBlockNum_ = block_num;
+	} else {
+		FlushAll();
+	}
+}
+
 void X64JitBackend::WriteConstExit(uint32_t pc) {
-	int block_num = blocks_.GetBlockNumberFromStartAddress(pc);
+	int block_num = ExitTargetBlockNum(pc);
 	const IRNativeBlock *nativeBlock = GetNativeBlock(block_num);
 
+	if (linkedExitBlockNum_ != -1 && linkedExitBlockNum_ == block_num) {
+		// Load whatever wasn't already in place, the rest stays dirty in its reg.
+		const auto &linked = nativeBlock->linkedRegs;
+		regs_.EmitLoadLinkedRegs(linked.data(), (int)linked.size(), linkedExitKept_);
+
+		int kept = 0;
+		for (size_t i = 0; i < linked.size(); ++i) {
+			if (linkedExitKept_ & (1U << i))
+				kept++;
+		}
+		if (DebugStatsEnabled() && kept != 0 && RipAccessible(&jitStats.linkedRegsKept))
+			ADD(32, M(&jitStats.linkedRegsKept), Imm8(kept));
+		CountLinkedRegExit(kept, (int)linked.size() - kept);
+
+		// Never relinked, if the target is invalidated its linked entry handles it.
+		JMP(GetBasePtr() + nativeBlock->linkedOffset, true);
+		linkedExitBlockNum_ = -1;
+		return;
+	}
+	_dbg_assert_(linkedExitBlockNum_ == -1);
+
 	int exitStart = (int)GetOffset(GetCodePointer());
 	if (block_num >= 0 && jo.enableBlocklink && nativeBlock && nativeBlock->checkedOffset != 0) {
 		JMP(GetBasePtr() + nativeBlock->checkedOffset, true);
@@ -339,6 +431,22 @@ void X64JitBackend::InvalidateBlock(IRBlock *block, int block_num) {
 		}
 	}
 
+	const IRNativeBlock *nativeBlock = GetNativeBlock(block_num);
+	if (nativeBlock && !nativeBlock->linkedRegs.empty()) {
+		// Linked exits still jump to this entry, send them to the dispatcher instead.
+		u8 *patch = GetWritablePtrFromCodePtr(GetBasePtr()) + nativeBlock->linkedPatchOffset;
+		if (PlatformIsWXExclusive()) {
+			ProtectMemoryPages(patch, MIN_BLOCK_EXIT_LEN, MEM_PROT_READ | MEM_PROT_WRITE);
+		}
+
+		XEmitter emitter(patch);
+		emitter.JMP(GetBasePtr() + nativeBlock->linkedInvalidOffset, true);
+
+		if (PlatformIsWXExclusive()) {
+			ProtectMemoryPages(patch, MIN_BLOCK_EXIT_LEN, MEM_PROT_READ | MEM_PROT_EXEC);
+		}
+	}
+
 	EraseAllLinks(block_num);
 }
 
@@ -76,6 +76,9 @@ class X64JitBackend : public Gen::XCodeBlock, public IRNativeBackend {
 	// Note: destroys SCRATCH1.
 	void FlushAll();
 
+	int ExitTargetBlockNum(uint32_t pc);
+	// Use before a const exit, instead of FlushAll(), to keep regs for the target block.
+	void FlushForConstExit(uint32_t pc);
 	void WriteConstExit(uint32_t pc);
 	void OverwriteExit(int srcOffset, int len, int block_num) override;
 
@@ -161,6 +164,9 @@ class X64JitBackend : public Gen::XCodeBlock, public IRNativeBackend {
 
 	int jitStartOffset_ = 0;
 	int compilingBlockNum_ = -1;
+	// Set by FlushForConstExit() for the following WriteConstExit().
+	int linkedExitBlockNum_ = -1;
+	uint32_t linkedExitKept_ = 0;
 	int logBlocks_ = 0;
 	// Only useful in breakpoints, where it's set immediately prior.
 	uint32_t lastConstPC_ = 0;
@@ -39,6 +39,7 @@
 #include "Core/Core.h"
 #include "Core/MemFault.h"
 #include "Core/MemMap.h"
+#include "Core/MemWriteWatch.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/Debugger/SymbolMap.h"
 
@@ -103,6 +104,10 @@ static bool DisassembleNativeAt(const uint8_t *codePtr, int instructionSize, std
 }
 
 bool HandleFault(uintptr_t hostAddress, void *ctx) {
+	// Writes to watched RAM can come from any thread and any code, not just the JIT. Just retry them.
+	if (WriteWatch_HandleFault(hostAddress))
+		return true;
+
 	if (inCrashHandler)
 		return false;
 	inCrashHandler = true;
@@ -40,6 +40,7 @@
 #include "Core/HLE/ReplaceTables.h"
 #include "Core/MemMap.h"
 #include "Core/MemFault.h"
+#include "Core/MemWriteWatch.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/JitCommon/JitBlockCache.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
@@ -359,6 +360,10 @@ void DoState(PointerWrap &p) {
 	if (!s)
 		return;
 
+	// Everything is about to be overwritten, no point in faulting on each page.
+	if (p.mode == PointerWrap::MODE_READ)
+		WriteWatch_Reset();
+
 	if (s < 2) {
 		if (!g_RemasterMode)
 			g_MemorySize = RAM_NORMAL_SIZE;
@@ -397,6 +402,8 @@ void DoState(PointerWrap &p) {
 
 void Shutdown() {
 	std::lock_guard<std::recursive_mutex> guard(g_shutdownLock);
+	// The views are going away. The texture cache will enable it again after a reinit.
+	WriteWatch_SetEnabled(false);
 	u32 flags = 0;
 	MemoryMap_Shutdown(flags);
 	base = nullptr;
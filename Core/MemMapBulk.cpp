@@ -0,0 +1,164 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Common/Math/CrossSIMD.h"
+#include "Core/Debugger/MemBlockInfo.h"
+#include "Core/MemMap.h"
+#include "Core/MemMapBulk.h"
+
+namespace Memory {
+namespace Bulk {
+
+void CopyForward16Host(u8 *dest, const u8 *src, size_t size) {
+	// Each block is fully read before it's written, so overlap repeats 16 byte chunks.
+	size_t blocks = size & ~(size_t)15;
+	for (size_t offset = 0; offset < blocks; offset += 16) {
+#if PPSSPP_ARCH(SSE2)
+		_mm_storeu_si128((__m128i *)(dest + offset), _mm_loadu_si128((const __m128i *)(src + offset)));
+#elif PPSSPP_ARCH(ARM_NEON)
+		vst1q_u8(dest + offset, vld1q_u8(src + offset));
+#else
+		u8 block[16];
+		memcpy(block, src + offset, 16);
+		memcpy(dest + offset, block, 16);
+#endif
+	}
+	for (size_t offset = blocks; offset < size; ++offset)
+		dest[offset] = src[offset];
+}
+
+static bool ValidateCopy(u32 dest, u32 src, u32 size, bool report) {
+	if (IsValidRange(dest, size) && IsValidRange(src, size))
+		return true;
+	if (report) {
+		// These report the memory exception for whichever is bad.
+		GetPointerWriteRange(dest, size);
+		GetPointerRange(src, size);
+	}
+	return false;
+}
+
+static bool MoveRange(u32 dest, u32 src, u32 size, const char *tagPrefix, bool report) {
+	if (size == 0)
+		return true;
+	if (!ValidateCopy(dest, src, size, report))
+		return false;
+
+	// Use the same view for both, so memmove sees aliased mirrors as overlapping.
+	u8 *d = GetPointerWriteUnchecked(PhysicalAddress(dest, size));
+	const u8 *s = GetPointerUnchecked(PhysicalAddress(src, size));
+	memmove(d, s, size);
+
+	if (tagPrefix && MemBlockInfoDetailed(size))
+		NotifyMemInfoCopy(dest, src, size, tagPrefix);
+	return true;
+}
+
+bool Move(u32 dest, u32 src, u32 size, const char *tagPrefix) {
+	return MoveRange(dest, src, size, tagPrefix, true);
+}
+
+bool TryMove(u32 dest, u32 src, u32 size, const char *tagPrefix) {
+	return MoveRange(dest, src, size, tagPrefix, false);
+}
+
+bool CopyForward16(u32 dest, u32 src, u32 size, const char *tagPrefix) {
+	if (size == 0)
+		return true;
+	if (!ValidateCopy(dest, src, size, true))
+		return false;
+
+	u32 physDest = PhysicalAddress(dest, size);
+	u32 physSrc = PhysicalAddress(src, size);
+	u8 *d = GetPointerWriteUnchecked(physDest);
+	const u8 *s = GetPointerUnchecked(physSrc);
+	if (physDest < physSrc + size && physSrc < physDest + size)
+		CopyForward16Host(d, s, size);
+	else
+		memcpy(d, s, size);
+
+	if (tagPrefix && MemBlockInfoDetailed(size))
+		NotifyMemInfoCopy(dest, src, size, tagPrefix);
+	return true;
+}
+
+bool Set(u32 dest, u8 value, u32 size, const char *tag) {
+	if (size == 0)
+		return true;
+	if (!IsValidRange(dest, size)) {
+		GetPointerWriteRange(dest, size);
+		return false;
+	}
+
+	memset(GetPointerWriteUnchecked(dest), value, size);
+	if (tag)
+		NotifyMemInfo(MemBlockFlags::WRITE, dest, size, tag, strlen(tag));
+	return true;
+}
+
+bool StringLength(u32 address, u32 maxLen, u32 *len) {
+	*len = 0;
+	if (maxLen == 0)
+		return false;
+	u32 valid = ValidSize(address, maxLen);
+	if (valid == 0) {
+		// Just to report the bad pointer.
+		GetPointer(address);
+		return false;
+	}
+
+	// The libc memchr is already vectorized, better than we'd do here.
+	const u8 *p = GetPointerUnchecked(address);
+	const u8 *end = (const u8 *)memchr(p, '\0', valid);
+	if (!end) {
+		*len = valid;
+		return false;
+	}
+	*len = (u32)(end - p);
+	return true;
+}
+
+bool StringCompare(u32 a, u32 b, u32 maxLen, int *result) {
+	*result = 0;
+	if (maxLen == 0)
+		return true;
+
+	u32 valid = std::min(ValidSize(a, maxLen), ValidSize(b, maxLen));
+	if (valid == 0) {
+		// Report whichever pointer was bad.
+		GetPointer(a);
+		GetPointer(b);
+		return false;
+	}
+
+	// A bounded strncmp is a single vectorized pass in libc, no need to find the lengths first.
+	const char *pa = (const char *)GetPointerUnchecked(a);
+	const char *pb = (const char *)GetPointerUnchecked(b);
+	*result = strncmp(pa, pb, valid);
+	if (*result != 0 || valid == maxLen)
+		return true;
+	// Equal so far, but that's only a real answer if they ended before invalid memory.
+	return memchr(pa, '\0', valid) != nullptr;
+}
+
+}  // namespace Bulk
+}  // namespace Memory
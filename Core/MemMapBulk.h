@@ -0,0 +1,72 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <cstddef>
+
+#include "Common/CommonTypes.h"
+
+// Operations on whole ranges of guest memory, for the libc replacements and DMA.
+// Each range is validated once, rather than per pointer lookup.  The checked variants
+// report invalid ranges as memory exceptions just like GetPointerRange(), the Try variants
+// just return false.  Where a tag is passed, MemBlockInfo is notified once for the operation.
+
+namespace Memory {
+namespace Bulk {
+
+// Address with the cached/uncached/kernel bits stripped and VRAM mirrors folded onto the first,
+// so ranges that alias the same memory can be detected.  Ranges that cross a VRAM mirror
+// boundary keep their mirror, since the views are only contiguous in that direction.
+inline u32 PhysicalAddress(u32 address, u32 size) {
+	address &= 0x3FFFFFFF;
+	if ((address & 0x3F800000) == 0x04000000 && (address & 0x001FFFFF) + size <= 0x00200000)
+		address &= ~0x00600000;
+	return address;
+}
+
+inline bool RangesOverlap(u32 dest, u32 src, u32 size) {
+	u32 d = PhysicalAddress(dest, size);
+	u32 s = PhysicalAddress(src, size);
+	return d < s + size && s < d + size;
+}
+
+// Copies with memmove semantics, including between mirrors of the same memory.
+// For copies, the tag is a prefix for the source's tag (see NotifyMemInfoCopy.)
+bool Move(u32 dest, u32 src, u32 size, const char *tagPrefix = nullptr);
+bool TryMove(u32 dest, u32 src, u32 size, const char *tagPrefix = nullptr);
+
+// Copies forward 16 bytes at a time when the ranges overlap, which is what the PSP's libc
+// memcpy does and what some games depend on.  Otherwise a plain copy.
+bool CopyForward16(u32 dest, u32 src, u32 size, const char *tagPrefix = nullptr);
+
+bool Set(u32 dest, u8 value, u32 size, const char *tag = nullptr);
+
+// Finds the length of the string at address, reading no more than maxLen bytes.
+// Returns false if there's no terminator within maxLen bytes of valid memory, with *len
+// set to the bytes that were valid.
+bool StringLength(u32 address, u32 maxLen, u32 *len);
+
+// Compares like strncmp(), up to maxLen bytes.  Returns false if either string runs
+// into invalid memory before a difference or terminator.
+bool StringCompare(u32 a, u32 b, u32 maxLen, int *result);
+
+// The host side of CopyForward16(), for tests.
+void CopyForward16Host(u8 *dest, const u8 *src, size_t size);
+
+}  // namespace Bulk
+}  // namespace Memory
@@ -0,0 +1,290 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#include "Common/MachineContext.h"
+#include "Common/MemoryUtil.h"
+#include "Common/Log.h"
+#include "Core/MemMap.h"
+#include "Core/MemWriteWatch.h"
+
+#if PPSSPP_PLATFORM(LINUX) && !PPSSPP_PLATFORM(ANDROID) && defined(MACHINE_CONTEXT_SUPPORTED)
+#define WRITE_WATCH_SUPPORTED
+#include <sys/mman.h>
+#endif
+
+namespace Memory {
+
+extern u8 *m_pPhysicalRAM[3];
+extern u8 *m_pUncachedRAM[3];
+extern u8 *m_pKernelRAM[3];
+extern u8 *m_pUncachedKernelRAM[3];
+
+#ifdef WRITE_WATCH_SUPPORTED
+
+// Same as the primary RAM view size in Memory::Init.
+static const uint32_t WATCH_MAX_SIZE = 31 * 1024 * 1024;
+static const uint32_t WATCH_MIN_PAGE_SIZE = 4096;
+static const uint32_t WATCH_MAX_PAGES = WATCH_MAX_SIZE / WATCH_MIN_PAGE_SIZE;
+static const int WATCH_NUM_VIEWS = 4;
+
+static std::atomic<bool> g_watchEnabled{ false };
+// Protects everything below. Taken in the fault handler, so never write guest memory while holding it.
+static std::mutex g_watchLock;
+static bool g_watchAvailable;
+static uint32_t g_pageShift;
+static uint32_t g_numPages;
+static u8 *g_views[WATCH_NUM_VIEWS];
+static int g_numViews;
+
+static std::atomic<WriteWatchStamp> g_lastStamp{ 1 };
+static std::atomic<WriteWatchStamp> g_writeStamps[WATCH_MAX_PAGES];
+static bool g_protected[WATCH_MAX_PAGES];
+static uint16_t g_hostWrites[WATCH_MAX_PAGES];
+
+static bool PageRange(uint32_t address, uint32_t size, uint32_t *first, uint32_t *last) {
+	address &= 0x3FFFFFFF;
+	if (size == 0 || address < PSP_GetKernelMemoryBase())
+		return false;
+	uint32_t offset = address - PSP_GetKernelMemoryBase();
+	if (offset >= (g_numPages << g_pageShift) || size > (g_numPages << g_pageShift) - offset)
+		return false;
+	*first = offset >> g_pageShift;
+	*last = (offset + size - 1) >> g_pageShift;
+	return true;
+}
+
+static bool HostPageRange(const void *hostPtr, size_t size, uint32_t *first, uint32_t *last) {
+	uintptr_t ptr = (uintptr_t)hostPtr;
+	if (ptr < (uintptr_t)base || ptr - (uintptr_t)base >= 0x100000000ULL || size >= 0x100000000ULL)
+		return false;
+	return PageRange((uint32_t)(ptr - (uintptr_t)base), (uint32_t)size, first, last);
+}
+
+static bool SetProtection(uint32_t first, uint32_t count, bool writable) {
+	const size_t offset = (size_t)first << g_pageShift;
+	const size_t size = (size_t)count << g_pageShift;
+	const int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+	bool success = true;
+	for (int i = 0; i < g_numViews; i++) {
+		if (mprotect(g_views[i] + offset, size, prot) != 0)
+			success = false;
+	}
+	return success;
+}
+
+// Call with the lock held. Unprotects and stamps, coalescing runs of protected pages.
+static void UnprotectPages(uint32_t first, uint32_t last) {
+	const WriteWatchStamp stamp = ++g_lastStamp;
+	uint32_t runStart = first;
+	for (uint32_t p = first; p <= last + 1; ++p) {
+		if (p <= last && g_protected[p])
+			continue;
+		if (p > runStart && SetProtection(runStart, p - runStart, true))
+			std::fill(g_protected + runStart, g_protected + p, false);
+		runStart = p + 1;
+	}
+	for (uint32_t p = first; p <= last; ++p)
+		g_writeStamps[p].store(stamp, std::memory_order_release);
+}
+
+static void DisableLocked() {
+	if (!g_watchEnabled)
+		return;
+	if (g_numPages != 0)
+		UnprotectPages(0, g_numPages - 1);
+	g_watchEnabled = false;
+	INFO_LOG(MEMMAP, "Write watch disabled");
+}
+
+bool WriteWatch_Supported() {
+	int pageSize = GetMemoryProtectPageSize();
+	return pageSize >= (int)WATCH_MIN_PAGE_SIZE && pageSize <= 0x10000 && (pageSize & (pageSize - 1)) == 0;
+}
+
+void WriteWatch_SetAvailable(bool available) {
+	std::lock_guard<std::mutex> guard(g_watchLock);
+	if (!available)
+		DisableLocked();
+	g_watchAvailable = available;
+}
+
+void WriteWatch_SetEnabled(bool enabled) {
+	if (enabled == g_watchEnabled)
+		return;
+
+	std::lock_guard<std::mutex> guard(g_watchLock);
+	if (!enabled) {
+		DisableLocked();
+		return;
+	}
+	if (g_watchEnabled || !g_watchAvailable || !base || !WriteWatch_Supported())
+		return;
+
+	const uint32_t pageSize = (uint32_t)GetMemoryProtectPageSize();
+	g_pageShift = 0;
+	while ((1U << g_pageShift) < pageSize)
+		g_pageShift++;
+	g_numPages = std::min(g_MemorySize, WATCH_MAX_SIZE) >> g_pageShift;
+
+	g_numViews = 0;
+	u8 *const views[WATCH_NUM_VIEWS] = { m_pPhysicalRAM[0], m_pUncachedRAM[0], m_pKernelRAM[0], m_pUncachedKernelRAM[0] };
+	for (u8 *view : views) {
+		if (view && std::find(g_views, g_views + g_numViews, view) == g_views + g_numViews)
+			g_views[g_numViews++] = view;
+	}
+
+	const WriteWatchStamp stamp = ++g_lastStamp;
+	for (uint32_t p = 0; p < g_numPages; ++p) {
+		g_protected[p] = false;
+		g_hostWrites[p] = 0;
+		g_writeStamps[p].store(stamp, std::memory_order_relaxed);
+	}
+	g_watchEnabled = true;
+	INFO_LOG(MEMMAP, "Write watch enabled: %d pages of %d bytes in %d views", g_numPages, pageSize, g_numViews);
+}
+
+bool WriteWatch_Enabled() {
+	return g_watchEnabled;
+}
+
+WriteWatchStamp WriteWatch_Protect(uint32_t address, uint32_t size) {
+	uint32_t first, last;
+	if (!g_watchEnabled || !PageRange(address, size, &first, &last))
+		return 0;
+
+	std::lock_guard<std::mutex> guard(g_watchLock);
+	if (!g_watchEnabled)
+		return 0;
+	const WriteWatchStamp stamp = g_lastStamp;
+	uint32_t runStart = first;
+	for (uint32_t p = first; p <= last + 1; ++p) {
+		if (p <= last && !g_protected[p] && g_hostWrites[p] == 0)
+			continue;
+		if (p > runStart && SetProtection(runStart, p - runStart, false)) {
+			std::fill(g_protected + runStart, g_protected + p, true);
+		} else if (p > runStart) {
+			// Make sure we don't leave a partially protected run around.
+			SetProtection(runStart, p - runStart, true);
+			return 0;
+		}
+		runStart = p + 1;
+	}
+	return stamp;
+}
+
+bool WriteWatch_ChangedSince(uint32_t address, uint32_t size, WriteWatchStamp stamp) {
+	uint32_t first, last;
+	if (!g_watchEnabled || stamp == 0 || !PageRange(address, size, &first, &last))
+		return true;
+
+	for (uint32_t p = first; p <= last; ++p) {
+		if (g_writeStamps[p].load(std::memory_order_acquire) > stamp)
+			return true;
+	}
+	return false;
+}
+
+void WriteWatch_BeginHostWrite(const void *hostPtr, size_t size) {
+	uint32_t first, last;
+	if (!g_watchEnabled || !HostPageRange(hostPtr, size, &first, &last))
+		return;
+
+	std::lock_guard<std::mutex> guard(g_watchLock);
+	if (!g_watchEnabled)
+		return;
+	for (uint32_t p = first; p <= last; ++p)
+		g_hostWrites[p]++;
+	UnprotectPages(first, last);
+}
+
+void WriteWatch_EndHostWrite(const void *hostPtr, size_t size) {
+	uint32_t first, last;
+	if (!g_watchEnabled || !HostPageRange(hostPtr, size, &first, &last))
+		return;
+
+	std::lock_guard<std::mutex> guard(g_watchLock);
+	if (!g_watchEnabled)
+		return;
+	for (uint32_t p = first; p <= last; ++p) {
+		if (g_hostWrites[p] > 0)
+			g_hostWrites[p]--;
+	}
+	// Stamp again, anything hashed during the write may have seen partial data.
+	UnprotectPages(first, last);
+}
+
+void WriteWatch_Reset() {
+	if (!g_watchEnabled)
+		return;
+	std::lock_guard<std::mutex> guard(g_watchLock);
+	if (g_watchEnabled && g_numPages != 0)
+		UnprotectPages(0, g_numPages - 1);
+}
+
+bool WriteWatch_HandleFault(uintptr_t hostAddress) {
+	uint32_t first, last;
+	if (!g_watchEnabled || !HostPageRange((const void *)hostAddress, 1, &first, &last))
+		return false;
+
+	// If we waited on another thread that already unprotected the page, the access simply succeeds on retry.
+	std::lock_guard<std::mutex> guard(g_watchLock);
+	if (g_protected[first]) {
+		UnprotectPages(first, first);
+		// If this failed, let the normal crash handling see it rather than faulting forever.
+		return !g_protected[first];
+	}
+	return true;
+}
+
+#else
+
+bool WriteWatch_Supported() {
+	return false;
+}
+
+void WriteWatch_SetAvailable(bool available) {}
+void WriteWatch_SetEnabled(bool enabled) {}
+
+bool WriteWatch_Enabled() {
+	return false;
+}
+
+WriteWatchStamp WriteWatch_Protect(uint32_t address, uint32_t size) {
+	return 0;
+}
+
+bool WriteWatch_ChangedSince(uint32_t address, uint32_t size, WriteWatchStamp stamp) {
+	return true;
+}
+
+void WriteWatch_BeginHostWrite(const void *hostPtr, size_t size) {}
+void WriteWatch_EndHostWrite(const void *hostPtr, size_t size) {}
+void WriteWatch_Reset() {}
+
+bool WriteWatch_HandleFault(uintptr_t hostAddress) {
+	return false;
+}
+
+#endif
+
+}  // namespace Memory
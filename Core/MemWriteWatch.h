@@ -0,0 +1,66 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Write watching of PSP RAM, using page protection on the memory arena views.
+//
+// Caches of guest memory (currently only the texture cache) can protect the pages backing an entry,
+// and later ask whether anything wrote to them since, instead of rehashing the data. The first write
+// to a protected page faults, HandleFault() unprotects the page in all mirrors and stamps it, and the
+// write is retried.
+//
+// Only supported on desktop Linux for now, where the arena is a plain shared memory mapping.
+// Only the primary RAM views are watched. VRAM and the extra RAM of HD remasters are never clean.
+
+namespace Memory {
+
+typedef uint64_t WriteWatchStamp;
+
+bool WriteWatch_Supported();
+
+// Set by the core while HandleFault is installed as the exception handler. Enabling is ignored otherwise.
+void WriteWatch_SetAvailable(bool available);
+// Turns watching on or off. Turning it off unprotects everything and makes all stamps stale.
+void WriteWatch_SetEnabled(bool enabled);
+bool WriteWatch_Enabled();
+
+// Protects the pages covering the range and returns a stamp to compare against later.
+// Returns 0 if the range can't be watched. Read the memory after protecting, not before.
+WriteWatchStamp WriteWatch_Protect(uint32_t address, uint32_t size);
+
+// True if any page in the range may have been written after the stamp was taken.
+bool WriteWatch_ChangedSince(uint32_t address, uint32_t size, WriteWatchStamp stamp);
+
+// Writes that don't go through the CPU (like read() or recv() into guest memory) won't fault, they
+// fail with EFAULT instead. Bracket them with these, the range stays writable in between. That goes
+// for any syscall given a guest pointer, including file reads and socket receives.
+// Pointers outside watched RAM are ignored.
+void WriteWatch_BeginHostWrite(const void *hostPtr, size_t size);
+void WriteWatch_EndHostWrite(const void *hostPtr, size_t size);
+
+// Unprotects everything and makes all stamps stale. For savestates, shutdown, etc.
+void WriteWatch_Reset();
+
+// Called first thing from HandleFault. Returns true if the fault was a write to a watched page,
+// which is now writable again.
+bool WriteWatch_HandleFault(uintptr_t hostAddress);
+
+}  // namespace Memory
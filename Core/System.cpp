@@ -45,10 +45,13 @@
 
 #include "Core/RetroAchievements.h"
 #include "Core/MemFault.h"
+#include "Core/MemWriteWatch.h"
 #include "Core/HDRemaster.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/MIPSAnalyst.h"
 #include "Core/MIPS/MIPSVFPUUtils.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
+#include "Core/MIPS/JitCommon/JitHeatMap.h"
 #include "Core/Debugger/SymbolMap.h"
 #include "Core/System.h"
 #include "Core/HLE/HLE.h"
@@ -317,6 +320,8 @@ bool CPU_Init(std::string *errorString, FileLoader *loadedFile) {
 		*errorString = "Memory init failed";
 		return false;
 	}
+	// Before the jit is created, so it knows to count.
+	MIPSComp::BeginJitHeatMap();
 	mipsr4k.Reset();
 
 	LoadSymbolsIfSupported();
@@ -342,6 +347,7 @@ bool CPU_Init(std::string *errorString, FileLoader *loadedFile) {
 	}
 
 	InstallExceptionHandler(&Memory::HandleFault);
+	Memory::WriteWatch_SetAvailable(true);
 	return true;
 }
 
@@ -354,6 +360,7 @@ PSP_LoadingLock::~PSP_LoadingLock() {
 }
 
 void CPU_Shutdown() {
+	Memory::WriteWatch_SetAvailable(false);
 	UninstallExceptionHandler();
 
 	// Since we load on a background thread, wait for startup to complete.
@@ -372,6 +379,8 @@ void CPU_Shutdown() {
 
 	pspFileSystem.Shutdown();
 	mipsr4k.Shutdown();
+	// After the jit is gone, so all blocks have been counted.
+	MIPSComp::EndJitHeatMap();
 	Memory::Shutdown();
 	HLEPlugins::Shutdown();
 
@@ -408,6 +417,7 @@ void Core_UpdateDebugStats(bool collectStats) {
 	if (!PSP_CoreParameter().frozen && !Core_IsStepping()) {
 		kernelStats.ResetFrame();
 		gpuStats.ResetFrame();
+		MIPSComp::jitStats.ResetFrame();
 	}
 }
 
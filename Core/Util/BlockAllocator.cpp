@@ -17,6 +17,7 @@
 
 #include <cstring>
 
+#include "Common/BitScan.h"
 #include "Common/Log.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
@@ -25,7 +26,9 @@
 #include "Core/Util/BlockAllocator.h"
 #include "Core/Reporting.h"
 
-// Slow freaking thing but works (eventually) :)
+// The blocks are a linked list in address order, which is also how they're saved.
+// On top of that, blocks are indexed by address and free blocks by size class, so
+// allocations and lookups don't need to walk the whole list.
 
 BlockAllocator::BlockAllocator(int grain) : bottom_(NULL), top_(NULL), grain_(grain)
 {
@@ -44,6 +47,7 @@ void BlockAllocator::Init(u32 rangeStart, u32 rangeSize, bool suballoc) {
 	top_ = new Block(rangeStart_, rangeSize_, false, NULL, NULL);
 	bottom_ = top_;
 	suballoc_ = suballoc;
+	IndexBlock(top_);
 }
 
 void BlockAllocator::Shutdown()
@@ -55,6 +59,85 @@ void BlockAllocator::Shutdown()
 		bottom_ = next;
 	}
 	top_ = NULL;
+	ClearIndex();
+}
+
+int BlockAllocator::SizeClass(u32 size)
+{
+	return size == 0 ? 0 : 31 - clz32_nonzero(size);
+}
+
+void BlockAllocator::IndexBlock(Block *b)
+{
+	// Empty blocks can't contain an address or satisfy an allocation.
+	if (b->size == 0)
+		return;
+	blocksByStart_[b->start] = b;
+	if (!b->taken)
+		freeBlocks_[SizeClass(b->size)].insert(b);
+}
+
+void BlockAllocator::UnindexBlock(Block *b)
+{
+	if (b->size == 0)
+		return;
+	auto it = blocksByStart_.find(b->start);
+	if (it != blocksByStart_.end() && it->second == b)
+		blocksByStart_.erase(it);
+	if (!b->taken)
+		freeBlocks_[SizeClass(b->size)].erase(b);
+}
+
+void BlockAllocator::ClearIndex()
+{
+	blocksByStart_.clear();
+	for (FreeBlockSet &blocks : freeBlocks_)
+		blocks.clear();
+}
+
+BlockAllocator::Block *BlockAllocator::FindFreeBlock(u32 size, u32 grain, bool fromTop)
+{
+	// This must find exactly the block a walk of the list would've, so the lowest (or highest)
+	// fitting block wins.  Smaller size classes can't fit, and each class is in address order.
+	// Larger classes almost always fit on the first block, so check them first to bound the
+	// search through the class that may hold blocks that are too small.
+	Block *best = NULL;
+	for (int c = NUM_SIZE_CLASSES - 1; c >= SizeClass(size); --c)
+	{
+		const FreeBlockSet &blocks = freeBlocks_[c];
+		if (!fromTop)
+		{
+			for (Block *b : blocks)
+			{
+				if (best != NULL && b->start >= best->start)
+					break;
+				u32 offset = b->start % grain;
+				if (offset != 0)
+					offset = grain - offset;
+				if (b->size >= offset + size)
+				{
+					best = b;
+					break;
+				}
+			}
+		}
+		else
+		{
+			for (auto it = blocks.rbegin(); it != blocks.rend(); ++it)
+			{
+				Block *b = *it;
+				if (best != NULL && b->start <= best->start)
+					break;
+				u32 offset = (b->start + b->size - size) % grain;
+				if (b->size >= offset + size)
+				{
+					best = b;
+					break;
+				}
+			}
+		}
+	}
+	return best;
 }
 
 u32 BlockAllocator::AllocAligned(u32 &size, u32 sizeGrain, u32 grain, bool fromTop, const char *tag)
@@ -77,63 +160,57 @@ u32 BlockAllocator::AllocAligned(u32 &size, u32 sizeGrain, u32 grain, bool fromT
 	if (!fromTop)
 	{
 		//Allocate from bottom of mem
-		for (Block *bp = bottom_; bp != NULL; bp = bp->next)
+		Block *bp = FindFreeBlock(size, grain, false);
+		if (bp != NULL)
 		{
 			Block &b = *bp;
 			u32 offset = b.start % grain;
 			if (offset != 0)
 				offset = grain - offset;
 			u32 needed = offset + size;
-			if (b.taken == false && b.size >= needed)
+			UnindexBlock(&b);
+			if (b.size == needed)
 			{
-				if (b.size == needed)
-				{
-					if (offset >= grain_)
-						InsertFreeBefore(&b, offset);
-					b.taken = true;
-					b.SetAllocated(tag, suballoc_);
-					return b.start;
-				}
-				else
-				{
-					InsertFreeAfter(&b, b.size - needed);
-					if (offset >= grain_)
-						InsertFreeBefore(&b, offset);
-					b.taken = true;
-					b.SetAllocated(tag, suballoc_);
-					return b.start;
-				}
+				if (offset >= grain_)
+					InsertFreeBefore(&b, offset);
+			}
+			else
+			{
+				InsertFreeAfter(&b, b.size - needed);
+				if (offset >= grain_)
+					InsertFreeBefore(&b, offset);
 			}
+			b.taken = true;
+			IndexBlock(&b);
+			b.SetAllocated(tag, suballoc_);
+			return b.start;
 		}
 	}
 	else
 	{
 		// Allocate from top of mem.
-		for (Block *bp = top_; bp != NULL; bp = bp->prev)
+		Block *bp = FindFreeBlock(size, grain, true);
+		if (bp != NULL)
 		{
 			Block &b = *bp;
 			u32 offset = (b.start + b.size - size) % grain;
 			u32 needed = offset + size;
-			if (b.taken == false && b.size >= needed)
+			UnindexBlock(&b);
+			if (b.size == needed)
 			{
-				if (b.size == needed)
-				{
-					if (offset >= grain_)
-						InsertFreeAfter(&b, offset);
-					b.taken = true;
-					b.SetAllocated(tag, suballoc_);
-					return b.start;
-				}
-				else
-				{
-					InsertFreeBefore(&b, b.size - needed);
-					if (offset >= grain_)
-						InsertFreeAfter(&b, offset);
-					b.taken = true;
-					b.SetAllocated(tag, suballoc_);
-					return b.start;
-				}
+				if (offset >= grain_)
+					InsertFreeAfter(&b, offset);
 			}
+			else
+			{
+				InsertFreeBefore(&b, b.size - needed);
+				if (offset >= grain_)
+					InsertFreeAfter(&b, offset);
+			}
+			b.taken = true;
+			IndexBlock(&b);
+			b.SetAllocated(tag, suballoc_);
+			return b.start;
 		}
 	}
 
@@ -193,19 +270,23 @@ u32 BlockAllocator::AllocAt(u32 position, u32 size, const char *tag)
 			//good to go
 			else if (b.start == alignedPosition)
 			{
+				UnindexBlock(&b);
 				if (b.size != alignedSize)
 					InsertFreeAfter(&b, b.size - alignedSize);
 				b.taken = true;
+				IndexBlock(&b);
 				b.SetAllocated(tag, suballoc_);
 				CheckBlocks();
 				return position;
 			}
 			else
 			{
+				UnindexBlock(&b);
 				InsertFreeBefore(&b, alignedPosition - b.start);
 				if (b.size > alignedSize)
 					InsertFreeAfter(&b, b.size - alignedSize);
 				b.taken = true;
+				IndexBlock(&b);
 				b.SetAllocated(tag, suballoc_);
 
 				return position;
@@ -224,6 +305,7 @@ u32 BlockAllocator::AllocAt(u32 position, u32 size, const char *tag)
 	return -1;
 }
 
+// fromBlock must not be indexed when called, it's indexed again after merging.
 void BlockAllocator::MergeFreeBlocks(Block *fromBlock)
 {
 	DEBUG_LOG(SCEKERNEL, "Merging Blocks");
@@ -232,6 +314,7 @@ void BlockAllocator::MergeFreeBlocks(Block *fromBlock)
 	while (prev != NULL && prev->taken == false)
 	{
 		DEBUG_LOG(SCEKERNEL, "Block Alloc found adjacent free blocks - merging");
+		UnindexBlock(prev);
 		prev->size += fromBlock->size;
 		if (fromBlock->next == NULL)
 			top_ = prev;
@@ -252,6 +335,7 @@ void BlockAllocator::MergeFreeBlocks(Block *fromBlock)
 	while (next != NULL && next->taken == false)
 	{
 		DEBUG_LOG(SCEKERNEL, "Block Alloc found adjacent free blocks - merging");
+		UnindexBlock(next);
 		fromBlock->size += next->size;
 		fromBlock->next = next->next;
 		delete next;
@@ -262,6 +346,8 @@ void BlockAllocator::MergeFreeBlocks(Block *fromBlock)
 		top_ = fromBlock;
 	else
 		next->prev = fromBlock;
+
+	IndexBlock(fromBlock);
 }
 
 bool BlockAllocator::Free(u32 position)
@@ -270,6 +356,7 @@ bool BlockAllocator::Free(u32 position)
 	if (b && b->taken)
 	{
 		NotifyMemInfo(suballoc_ ? MemBlockFlags::SUB_FREE : MemBlockFlags::FREE, b->start, b->size, "");
+		UnindexBlock(b);
 		b->taken = false;
 		MergeFreeBlocks(b);
 		return true;
@@ -287,6 +374,7 @@ bool BlockAllocator::FreeExact(u32 position)
 	if (b && b->taken && b->start == position)
 	{
 		NotifyMemInfo(suballoc_ ? MemBlockFlags::SUB_FREE : MemBlockFlags::FREE, b->start, b->size, "");
+		UnindexBlock(b);
 		b->taken = false;
 		MergeFreeBlocks(b);
 		return true;
@@ -309,6 +397,7 @@ BlockAllocator::Block *BlockAllocator::InsertFreeBefore(Block *b, u32 size)
 
 	b->start += size;
 	b->size -= size;
+	IndexBlock(inserted);
 	return inserted;
 }
 
@@ -322,6 +411,7 @@ BlockAllocator::Block *BlockAllocator::InsertFreeAfter(Block *b, u32 size)
 		inserted->next->prev = inserted;
 
 	b->size -= size;
+	IndexBlock(inserted);
 	return inserted;
 }
 
@@ -345,30 +435,32 @@ const char *BlockAllocator::GetBlockTag(u32 addr) const {
 	return b->tag;
 }
 
-inline BlockAllocator::Block *BlockAllocator::GetBlockFromAddress(u32 addr)
+BlockAllocator::Block *BlockAllocator::GetBlockFromAddress(u32 addr)
 {
-	for (Block *bp = bottom_; bp != NULL; bp = bp->next)
+	auto it = blocksByStart_.upper_bound(addr);
+	if (it == blocksByStart_.begin())
+		return NULL;
+	--it;
+	Block *bp = it->second;
+	if (bp->start <= addr && bp->start + bp->size > addr)
 	{
-		Block &b = *bp;
-		if (b.start <= addr && b.start + b.size > addr)
-		{
-			// Got one!
-			return bp;
-		}
+		// Got one!
+		return bp;
 	}
 	return NULL;
 }
 
 const BlockAllocator::Block *BlockAllocator::GetBlockFromAddress(u32 addr) const
 {
-	for (const Block *bp = bottom_; bp != NULL; bp = bp->next)
+	auto it = blocksByStart_.upper_bound(addr);
+	if (it == blocksByStart_.begin())
+		return NULL;
+	--it;
+	const Block *bp = it->second;
+	if (bp->start <= addr && bp->start + bp->size > addr)
 	{
-		const Block &b = *bp;
-		if (b.start <= addr && b.start + b.size > addr)
-		{
-			// Got one!
-			return bp;
-		}
+		// Got one!
+		return bp;
 	}
 	return NULL;
 }
@@ -405,13 +497,13 @@ void BlockAllocator::ListBlocks() const
 u32 BlockAllocator::GetLargestFreeBlockSize() const
 {
 	u32 maxFreeBlock = 0;
-	for (const Block *bp = bottom_; bp != NULL; bp = bp->next)
+	// Only the largest non-empty size class can hold the largest block.
+	for (int c = NUM_SIZE_CLASSES - 1; c >= 0 && maxFreeBlock == 0; --c)
 	{
-		const Block &b = *bp;
-		if (!b.taken)
+		for (const Block *bp : freeBlocks_[c])
 		{
-			if (b.size > maxFreeBlock)
-				maxFreeBlock = b.size;
+			if (bp->size > maxFreeBlock)
+				maxFreeBlock = bp->size;
 		}
 	}
 	if (maxFreeBlock & (grain_ - 1))
@@ -422,13 +514,10 @@ u32 BlockAllocator::GetLargestFreeBlockSize() const
 u32 BlockAllocator::GetTotalFreeBytes() const
 {
 	u32 sum = 0;
-	for (const Block *bp = bottom_; bp != NULL; bp = bp->next)
+	for (const FreeBlockSet &blocks : freeBlocks_)
 	{
-		const Block &b = *bp;
-		if (!b.taken)
-		{
-			sum += b.size;
-		}
+		for (const Block *bp : blocks)
+			sum += bp->size;
 	}
 	if (sum & (grain_ - 1))
 		WARN_LOG_REPORT(HLE, "GetTotalFreeBytes: free size %08x does not align to grain %08x.", sum, grain_);
@@ -459,6 +548,9 @@ void BlockAllocator::DoState(PointerWrap &p)
 			top_->next->DoState(p);
 			top_ = top_->next;
 		}
+
+		for (Block *bp = bottom_; bp != NULL; bp = bp->next)
+			IndexBlock(bp);
 	}
 	else
 	{
@@ -19,6 +19,9 @@
 
 class PointerWrap;
 
+#include <map>
+#include <set>
+
 #include "Common/CommonTypes.h"
 
 class BlockAllocator
@@ -72,14 +75,34 @@ class BlockAllocator
 		Block *next;
 	};
 
+	struct BlockStartLess {
+		bool operator ()(const Block *a, const Block *b) const {
+			return a->start < b->start;
+		}
+	};
+
+	// Free blocks are bucketed by the highest set bit of their size.
+	static const int NUM_SIZE_CLASSES = 32;
+	typedef std::set<Block *, BlockStartLess> FreeBlockSet;
+
 	Block *bottom_;
 	Block *top_;
+	// Every block by start address, to find the one containing an address.
+	std::map<u32, Block *> blocksByStart_;
+	// Free blocks in address order, so first fit doesn't walk taken blocks.
+	FreeBlockSet freeBlocks_[NUM_SIZE_CLASSES];
 	u32 rangeStart_;
 	u32 rangeSize_;
 
 	u32 grain_;
 	bool suballoc_;
 
+	static int SizeClass(u32 size);
+	void IndexBlock(Block *b);
+	void UnindexBlock(Block *b);
+	void ClearIndex();
+	Block *FindFreeBlock(u32 size, u32 grain, bool fromTop);
+
 	void MergeFreeBlocks(Block *fromBlock);
 	Block *GetBlockFromAddress(u32 addr);
 	const Block *GetBlockFromAddress(u32 addr) const;
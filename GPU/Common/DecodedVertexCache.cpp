@@ -0,0 +1,171 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstring>
+
+#include "ext/xxhash.h"
+#include "GPU/GPU.h"
+#include "GPU/ge_constants.h"
+#include "GPU/Common/DecodedVertexCache.h"
+#include "GPU/Common/VertexDecoderCommon.h"
+
+// Smaller batches are cheaper to decode than to look up.
+#define VERTEXCACHE_MIN_VERTS 16
+// How many frames in a row a batch needs to hash the same before we keep a decoded copy.
+#define VERTEXCACHE_STABLE_FRAMES 3
+// After this many changes, only hash a batch every VERTEXCACHE_UNRELIABLE_SKIP_FRAMES.
+#define VERTEXCACHE_UNRELIABLE_CHANGES 4
+#define VERTEXCACHE_UNRELIABLE_SKIP_FRAMES 60
+#define VERTEXCACHE_KILL_AGE 120
+#define VERTEXCACHE_DECIMATION_INTERVAL 17
+#define VERTEXCACHE_MAX_DECODED_BYTES (32 * 1024 * 1024)
+
+bool DecodedVertexCache::Cacheable(u32 vertTypeID, int count) {
+	if (count < VERTEXCACHE_MIN_VERTS)
+		return false;
+	// Morph weights and bone matrices are applied by the decoder, so the output depends on more than the input.
+	if (vertTypeID & GE_VTYPE_MORPHCOUNT_MASK)
+		return false;
+	// Skinning in decode is flagged in the vertTypeID, see GetVertTypeID().
+	if ((vertTypeID & GE_VTYPE_WEIGHT_MASK) && (vertTypeID & (1 << 26)))
+		return false;
+	return true;
+}
+
+static inline void MergeDecodeSideEffects(const KnownVertexBounds &bounds, bool fullAlpha) {
+	gstate_c.vertBounds.minU = std::min(gstate_c.vertBounds.minU, bounds.minU);
+	gstate_c.vertBounds.minV = std::min(gstate_c.vertBounds.minV, bounds.minV);
+	gstate_c.vertBounds.maxU = std::max(gstate_c.vertBounds.maxU, bounds.maxU);
+	gstate_c.vertBounds.maxV = std::max(gstate_c.vertBounds.maxV, bounds.maxV);
+	gstate_c.vertexFullAlpha = gstate_c.vertexFullAlpha && fullAlpha;
+}
+
+void DecodedVertexCache::DecodeVerts(const VertexDecoder *dec, u32 vertTypeID, u8 *dest, const void *verts, const UVScale &uvScale, int indexLowerBound, int indexUpperBound) {
+	const int count = indexUpperBound - indexLowerBound + 1;
+	if (!Cacheable(vertTypeID, count)) {
+		dec->DecodeVerts(dest, verts, &uvScale, indexLowerBound, indexUpperBound);
+		return;
+	}
+
+	gpuStats.numVertexCacheLookups++;
+
+	const Key key{ verts, vertTypeID, (u16)indexLowerBound, (u16)indexUpperBound };
+	Entry *entry = entries_.GetOrNull(key);
+	if (!entry) {
+		entry = new Entry{};
+		entry->numChanges = -1;
+		entries_.Insert(key, entry);
+	}
+
+	const int frame = gpuStats.numFlips;
+	const bool newFrame = entry->lastFrame != frame;
+	entry->lastFrame = frame;
+
+	if (frame < entry->skipHashUntilFrame) {
+		dec->DecodeVerts(dest, verts, &uvScale, indexLowerBound, indexUpperBound);
+		return;
+	}
+
+	const u8 *start = (const u8 *)verts + indexLowerBound * dec->VertexSize();
+	const u64 hash = XXH3_64bits(start, count * dec->VertexSize());
+	if (hash != entry->hash || memcmp(&uvScale, &entry->uvScale, sizeof(UVScale)) != 0) {
+		entry->hash = hash;
+		entry->uvScale = uvScale;
+		entry->stableFrames = 0;
+		if (++entry->numChanges >= VERTEXCACHE_UNRELIABLE_CHANGES) {
+			entry->skipHashUntilFrame = frame + VERTEXCACHE_UNRELIABLE_SKIP_FRAMES;
+			entry->numChanges = 0;
+		}
+		if (!entry->decoded.empty()) {
+			decodedBytes_ -= entry->decoded.size();
+			entry->decoded.clear();
+			entry->decoded.shrink_to_fit();
+		}
+		dec->DecodeVerts(dest, verts, &uvScale, indexLowerBound, indexUpperBound);
+		return;
+	}
+
+	if (!entry->decoded.empty()) {
+		memcpy(dest, entry->decoded.data(), entry->decoded.size());
+		MergeDecodeSideEffects(entry->bounds, entry->fullAlpha);
+		gpuStats.numVertexCacheHits++;
+		gpuStats.numVertexCacheBytesSaved += (int)entry->decoded.size();
+		return;
+	}
+
+	if (newFrame)
+		entry->stableFrames++;
+	const size_t size = (size_t)count * dec->GetDecVtxFmt().stride;
+	if (entry->stableFrames >= VERTEXCACHE_STABLE_FRAMES && decodedBytes_ + size <= VERTEXCACHE_MAX_DECODED_BYTES) {
+		DecodeAndStore(entry, dec, dest, verts, uvScale, indexLowerBound, indexUpperBound);
+	} else {
+		dec->DecodeVerts(dest, verts, &uvScale, indexLowerBound, indexUpperBound);
+	}
+}
+
+void DecodedVertexCache::DecodeAndStore(Entry *entry, const VertexDecoder *dec, u8 *dest, const void *verts, const UVScale &uvScale, int indexLowerBound, int indexUpperBound) {
+	// Decode with fresh side effect state, so we can replay just this batch's part later.
+	const KnownVertexBounds prevBounds = gstate_c.vertBounds;
+	const bool prevFullAlpha = gstate_c.vertexFullAlpha;
+	gstate_c.vertBounds.minU = 512;
+	gstate_c.vertBounds.minV = 512;
+	gstate_c.vertBounds.maxU = 0;
+	gstate_c.vertBounds.maxV = 0;
+	gstate_c.vertexFullAlpha = true;
+
+	dec->DecodeVerts(dest, verts, &uvScale, indexLowerBound, indexUpperBound);
+
+	entry->bounds = gstate_c.vertBounds;
+	entry->fullAlpha = gstate_c.vertexFullAlpha;
+	gstate_c.vertBounds = prevBounds;
+	gstate_c.vertexFullAlpha = prevFullAlpha;
+	MergeDecodeSideEffects(entry->bounds, entry->fullAlpha);
+
+	const size_t size = (size_t)(indexUpperBound - indexLowerBound + 1) * dec->GetDecVtxFmt().stride;
+	entry->decoded.assign(dest, dest + size);
+	entry->numChanges = 0;
+	decodedBytes_ += size;
+}
+
+void DecodedVertexCache::Decimate() {
+	if (--decimationCounter_ > 0)
+		return;
+	decimationCounter_ = VERTEXCACHE_DECIMATION_INTERVAL;
+
+	const int killAgeBase = gpuStats.numFlips - VERTEXCACHE_KILL_AGE;
+	std::vector<Key> toRemove;
+	entries_.Iterate([&](const Key &key, Entry *entry) {
+		if (entry->lastFrame < killAgeBase) {
+			decodedBytes_ -= entry->decoded.size();
+			delete entry;
+			toRemove.push_back(key);
+		}
+	});
+	for (const Key &key : toRemove) {
+		entries_.Remove(key);
+	}
+	entries_.Maintain();
+}
+
+void DecodedVertexCache::Clear() {
+	entries_.Iterate([&](const Key &key, Entry *entry) {
+		delete entry;
+	});
+	entries_.Clear();
+	decodedBytes_ = 0;
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Data/Collections/Hashmaps.h"
+#include "GPU/GPUState.h"
+
+class VertexDecoder;
+
+// Keeps decoded copies of vertex data that games resubmit unchanged, frame after frame.
+//
+// Every batch is still hashed, but only batches that have hashed the same for a few frames get a
+// decoded copy, which is then copied out instead of running the decoder. Batches that keep changing
+// stop getting hashed for a while. Anything depending on more than the vertex data and UV scale
+// (morphing, skinning in the decoder) bypasses the cache.
+class DecodedVertexCache {
+public:
+	DecodedVertexCache() : entries_(256) {}
+	~DecodedVertexCache() {
+		Clear();
+	}
+
+	// Same contract as VertexDecoder::DecodeVerts, including the gstate_c side effects.
+	void DecodeVerts(const VertexDecoder *dec, u32 vertTypeID, u8 *dest, const void *verts, const UVScale &uvScale, int indexLowerBound, int indexUpperBound);
+
+	// Call once per frame. Drops entries that haven't been used in a while.
+	void Decimate();
+	void Clear();
+
+private:
+	struct Key {
+		const void *verts;
+		u32 vertTypeID;
+		u16 indexLowerBound;
+		u16 indexUpperBound;
+	};
+
+	struct Entry {
+		UVScale uvScale;
+		u64 hash;
+		int lastFrame;
+		int stableFrames;
+		int numChanges;
+		int skipHashUntilFrame;
+		// Only filled in once promoted, with what the decoder left in gstate_c.
+		std::vector<u8> decoded;
+		KnownVertexBounds bounds;
+		bool fullAlpha;
+	};
+
+	static bool Cacheable(u32 vertTypeID, int count);
+	void DecodeAndStore(Entry *entry, const VertexDecoder *dec, u8 *dest, const void *verts, const UVScale &uvScale, int indexLowerBound, int indexUpperBound);
+
+	DenseHashMap<Key, Entry *> entries_;
+	size_t decodedBytes_ = 0;
+	int decimationCounter_ = 0;
+};
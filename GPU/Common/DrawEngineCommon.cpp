@@ -133,6 +133,7 @@ void DrawEngineCommon::NotifyConfigChanged() {
 	useHWTransform_ = g_Config.bHardwareTransform;
 	useHWTessellation_ = UpdateUseHWTessellation(g_Config.bHardwareTessellation);
 	decOptions_.applySkinInDecode = g_Config.bSoftwareSkinning;
+	useVertexCache_ = g_Config.bVertexCache;
 }
 
 u32 DrawEngineCommon::NormalizeVertices(u8 *outPtr, u8 *bufPtr, const u8 *inPtr, int lowerBound, int upperBound, u32 vertType, int *vertexSize) {
@@ -982,7 +983,11 @@ void DrawEngineCommon::DecodeVerts(u8 *dest) {
 
 		int indexUpperBound = dv.indexUpperBound;
 		// Decode the verts (and at the same time apply morphing/skinning). Simple.
-		dec_->DecodeVerts(dest + numDecodedVerts_ * stride, dv.verts, &dv.uvScale, indexLowerBound, indexUpperBound);
+		if (useVertexCache_) {
+			vertexCache_.DecodeVerts(dec_, lastVType_, dest + numDecodedVerts_ * stride, dv.verts, dv.uvScale, indexLowerBound, indexUpperBound);
+		} else {
+			dec_->DecodeVerts(dest + numDecodedVerts_ * stride, dv.verts, &dv.uvScale, indexLowerBound, indexUpperBound);
+		}
 		numDecodedVerts_ += indexUpperBound - indexLowerBound + 1;
 	}
 	decodeVertsCounter_ = i;
@@ -24,6 +24,7 @@
 
 #include "GPU/Math3D.h"
 #include "GPU/GPUState.h"
+#include "GPU/Common/DecodedVertexCache.h"
 #include "GPU/Common/GPUStateUtils.h"
 #include "GPU/Common/GPUDebugInterface.h"
 #include "GPU/Common/IndexGenerator.h"
@@ -145,7 +146,12 @@ class DrawEngineCommon {
 
 	VertexDecoder *GetVertexDecoder(u32 vtype);
 
-	virtual void ClearTrackedVertexArrays() {}
+	virtual void ClearTrackedVertexArrays() {
+		vertexCache_.Clear();
+	}
+	void DecimateTrackedVertexArrays() {
+		vertexCache_.Decimate();
+	}
 
 protected:
 	virtual bool UpdateUseHWTessellation(bool enabled) const { return enabled; }
@@ -264,6 +270,10 @@ class DrawEngineCommon {
 	VertexDecoderJitCache *decJitCache_ = nullptr;
 	VertexDecoderOptions decOptions_{};
 
+	// Decoded copies of vertex data that doesn't change, used by DecodeVerts if enabled.
+	DecodedVertexCache vertexCache_;
+	bool useVertexCache_ = false;
+
 	TransformedVertex *transformed_ = nullptr;
 	TransformedVertex *transformedExpanded_ = nullptr;
 
@@ -27,6 +27,8 @@
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtils.h"
 #include "Common/TimeUtil.h"
+#include "Common/Thread/ThreadManager.h"
+#include "Common/Thread/Waitable.h"
 #include "Common/Math/math_util.h"
 #include "Common/GPU/thin3d.h"
 #include "Core/HDRemaster.h"
@@ -75,6 +77,50 @@
 #define TEXCACHE_MIN_PRESSURE 16 * 1024 * 1024  // Total in VRAM
 #define TEXCACHE_SECOND_MIN_PRESSURE 4 * 1024 * 1024
 
+// Limits for background decodes of changed textures (bTextureAsyncDecode.)
+#define TEXCACHE_MAX_ASYNC_DECODES 8
+#define TEXCACHE_MAX_ASYNC_DECODE_BYTES (16 * 1024 * 1024)  // Snapshots plus decoded output
+
+// A snapshot of a changed texture (memory, CLUT and state), decoded on a worker while the old texture stays bound.
+struct TexDecodeJob {
+	struct Level {
+		u32 texaddr;
+		int bufw;
+		int w;
+		int h;
+		std::vector<u8> src;
+		std::vector<u8> decoded;
+		CheckAlphaResult alpha;
+	};
+
+	u64 cachekey;
+	u32 fullhash;
+	GETextureFormat format;
+	GEPaletteFormat clutformat;
+	TexDecodeFlags flags;
+	Draw::DataFormat dstFmt;
+	int bpp;
+
+	GPUgstate state;
+	alignas(16) u32 clutRaw[512];
+	alignas(16) u32 clutConverted[512];
+	alignas(16) u32 expandClut[512];
+	bool clutIsRaw;
+	bool clutAlphaLinear;
+	u16 clutAlphaLinearColor;
+
+	int numLevels;
+	Level levels[8];
+	size_t bytes;
+
+	LimitedWaitable *waitable;
+	double decodeTime;
+	// SetTexture saw the result, the next build of the entry should use it.
+	bool consume;
+	// The entry was rebuilt some other way or is gone, the result will be thrown away.
+	bool abandoned;
+};
+
 // Just for reference
 
 // PSP Color formats:
@@ -98,6 +144,63 @@
 // GL_UNSIGNED_BYTE/RGBA:  AAAAAAAABBBBBBBBGGGGGGGGRRRRRRRR  (match)
 // These are Data::Format:: B4G4R4A4_PACK16, B5G6R6_PACK16, B5G5R5A1_PACK16, R8G8B8A8
 
+void TexCache::Insert(u64 key, TexCacheEntry *entry) {
+	TexCacheEntry *old = index_.GetOrNull(key);
+	if (old) {
+		index_.Remove(key);
+	}
+	index_.Insert(key, entry);
+
+	if (rangeIndex_) {
+		if (pages_.empty()) {
+			pages_.resize(NUM_PAGES);
+		}
+		std::vector<PageItem> &page = pages_[PageOf((u32)(key >> 32))];
+		if (old) {
+			for (PageItem &item : page) {
+				if (item.key == key) {
+					item.entry = entry;
+					break;
+				}
+			}
+		} else {
+			page.push_back(PageItem{ key, entry });
+		}
+	}
+
+	delete old;
+}
+
+void TexCache::Erase(u64 key) {
+	TexCacheEntry *entry = index_.GetOrNull(key);
+	if (!entry) {
+		return;
+	}
+	index_.Remove(key);
+	index_.Maintain();
+
+	if (rangeIndex_) {
+		std::vector<PageItem> &page = pages_[PageOf((u32)(key >> 32))];
+		for (size_t i = 0; i < page.size(); ++i) {
+			if (page[i].key == key) {
+				page[i] = page.back();
+				page.pop_back();
+				break;
+			}
+		}
+	}
+
+	delete entry;
+}
+
+void TexCache::clear() {
+	index_.Iterate([](u64 key, TexCacheEntry *entry) {
+		delete entry;
+	});
+	index_.Clear();
+	pages_.clear();
+}
+
 TextureCacheCommon::TextureCacheCommon(Draw::DrawContext *draw, Draw2D *draw2D)
 	: draw_(draw), draw2D_(draw2D), replacer_(draw) {
 	decimationCounter_ = TEXCACHE_DECIMATION_INTERVAL;
@@ -121,6 +224,7 @@ TextureCacheCommon::TextureCacheCommon(Draw::DrawContext *draw, Draw2D *draw2D)
 }
 
 TextureCacheCommon::~TextureCacheCommon() {
+	ReapAsyncDecodes(true);
 	delete textureShaderCache_;
 
 	FreeAlignedMemory(clutBufConverted_);
@@ -133,10 +237,17 @@ void TextureCacheCommon::StartFrame() {
 	textureShaderCache_->Decimate();
 	timesInvalidatedAllThisFrame_ = 0;
 	replacementTimeThisFrame_ = 0.0;
+	Memory::WriteWatch_SetEnabled(g_Config.bTextureWriteWatch);
 
 	if ((DebugOverlay)g_Config.iDebugOverlay == DebugOverlay::DEBUG_STATS) {
 		gpuStats.numReplacerTrackedTex = replacer_.GetNumTrackedTextures();
 		gpuStats.numCachedReplacedTextures = replacer_.GetNumCachedReplacedTextures();
+		gpuStats.numAsyncTexDecodesPending = 0;
+		for (const TexDecodeJob *job : asyncDecodes_) {
+			if (!job->waitable->Ready()) {
+				gpuStats.numAsyncTexDecodesPending++;
+			}
+		}
 	}
 
 	if (texelsScaledThisFrame_) {
@@ -150,6 +261,10 @@ void TextureCacheCommon::StartFrame() {
 	} else {
 		Decimate(nullptr, false);
 	}
+
+	if (!asyncDecodes_.empty()) {
+		ReapAsyncDecodes(false);
+	}
 }
 
 // Produces a signed 1.23.8 value.
@@ -350,16 +465,13 @@ void TextureCacheCommon::UpdateMaxSeenV(TexCacheEntry *entry, bool throughMode)
 	// If the texture is >= 512 pixels tall...
 	if (entry->dim >= 0x900) {
 		if (entry->cluthash != 0 && entry->maxSeenV == 0) {
-			const u64 cachekeyMin = (u64)(entry->addr & 0x3FFFFFFF) << 32;
-			const u64 cachekeyMax = cachekeyMin + (1ULL << 32);
-			for (auto it = cache_.lower_bound(cachekeyMin), end = cache_.upper_bound(cachekeyMax); it != end; ++it) {
+			cache_.ForEachAtAddress(entry->addr, [&](TexCacheEntry *other) {
 				// They should all be the same, just make sure we take any that has already increased.
 				// This is for a new texture.
-				if (it->second->maxSeenV != 0) {
-					entry->maxSeenV = it->second->maxSeenV;
-					break;
+				if (other->maxSeenV != 0) {
+					entry->maxSeenV = other->maxSeenV;
 				}
-			}
+			});
 		}
 
 		// Texture scale/offset and gen modes don't apply in through.
@@ -383,11 +495,9 @@ void TextureCacheCommon::UpdateMaxSeenV(TexCacheEntry *entry, bool throughMode)
 		// We need to keep all CLUT variants in sync so we detect changes properly.
 		// See HandleTextureChange / STATUS_CLUT_RECHECK.
 		if (entry->cluthash != 0) {
-			const u64 cachekeyMin = (u64)(entry->addr & 0x3FFFFFFF) << 32;
-			const u64 cachekeyMax = cachekeyMin + (1ULL << 32);
-			for (auto it = cache_.lower_bound(cachekeyMin), end = cache_.upper_bound(cachekeyMax); it != end; ++it) {
-				it->second->maxSeenV = entry->maxSeenV;
-			}
+			cache_.ForEachAtAddress(entry->addr, [&](TexCacheEntry *other) {
+				other->maxSeenV = entry->maxSeenV;
+			});
 		}
 	}
 }
@@ -445,17 +555,14 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 
 	u32 minihash = MiniHash((const u32 *)Memory::GetPointerUnchecked(texaddr));
 
-	TexCache::iterator entryIter = cache_.find(cachekey);
-	TexCacheEntry *entry = nullptr;
+	TexCacheEntry *entry = cache_.Get(cachekey);
 
 	// Note: It's necessary to reset needshadertexclamp, for otherwise DIRTY_TEXCLAMP won't get set later.
 	// Should probably revisit how this works..
 	gstate_c.SetNeedShaderTexclamp(false);
 	gstate_c.skipDrawReason &= ~SKIPDRAW_BAD_FB_TEXTURE;
 
-	if (entryIter != cache_.end()) {
-		entry = entryIter->second.get();
-
+	if (entry) {
 		// Validate the texture still matches the cache entry.
 		bool match = entry->Matches(dim, texFormat, maxLevel);
 		const char *reason = "different params";
@@ -566,6 +673,16 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 			}
 		}
 
+		if (entry->status & TexCacheEntry::STATUS_ASYNC_DECODE) {
+			if (!match) {
+				// Rebuilding for some other reason, the decode in flight is stale.
+				AbandonAsyncDecode(entry);
+			} else if (PollAsyncDecode(entry)) {
+				match = false;
+				reason = "async decode";
+			}
+		}
+
 		if (match) {
 			// got one!
 			gstate_c.curTextureWidth = w;
@@ -610,8 +727,8 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 	AttachCandidate bestCandidate;
 	if (GetBestFramebufferCandidate(def, 0, &bestCandidate)) {
 		// If we had a texture entry here, let's get rid of it.
-		if (entryIter != cache_.end()) {
-			DeleteTexture(entryIter);
+		if (entry) {
+			DeleteTexture(cachekey);
 		}
 
 		nextTexture_ = nullptr;
@@ -626,7 +743,7 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 	if (!entry) {
 		VERBOSE_LOG(G3D, "No texture in cache for %08x, decoding...", texaddr);
 		entry = new TexCacheEntry{};
-		cache_[cachekey].reset(entry);
+		cache_.Insert(cachekey, entry);
 
 		if (PPGeIsFontTextureAddress(texaddr)) {
 			// It's the builtin font texture.
@@ -643,18 +760,15 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 		}
 
 		if (hasClut && clutRenderAddress_ == 0xFFFFFFFF) {
-			const u64 cachekeyMin = (u64)(texaddr & 0x3FFFFFFF) << 32;
-			const u64 cachekeyMax = cachekeyMin + (1ULL << 32);
-
 			int found = 0;
-			for (auto it = cache_.lower_bound(cachekeyMin), end = cache_.upper_bound(cachekeyMax); it != end; ++it) {
+			cache_.ForEachAtAddress(texaddr, [&](TexCacheEntry *other) {
 				found++;
-			}
+			});
 
 			if (found >= TEXTURE_CLUT_VARIANTS_MIN) {
-				for (auto it = cache_.lower_bound(cachekeyMin), end = cache_.upper_bound(cachekeyMax); it != end; ++it) {
-					it->second->status |= TexCacheEntry::STATUS_CLUT_VARIANTS;
-				}
+				cache_.ForEachAtAddress(texaddr, [&](TexCacheEntry *other) {
+					other->status |= TexCacheEntry::STATUS_CLUT_VARIANTS;
+				});
 
 				entry->status |= TexCacheEntry::STATUS_CLUT_VARIANTS;
 			}
@@ -799,19 +913,19 @@ void TextureCacheCommon::Decimate(TexCacheEntry *exceptThisOne, bool forcePressu
 
 		ForgetLastTexture();
 		int killAgeBase = lowMemoryMode_ ? TEXTURE_KILL_AGE_LOWMEM : TEXTURE_KILL_AGE;
-		for (TexCache::iterator iter = cache_.begin(); iter != cache_.end(); ) {
-			if (iter->second.get() == exceptThisOne) {
-				++iter;
-				continue;
+		cache_.EraseIf([&](TexCacheEntry *entry) {
+			if (entry == exceptThisOne) {
+				return false;
 			}
-			bool hasClut = (iter->second->status & TexCacheEntry::STATUS_CLUT_VARIANTS) != 0;
+			bool hasClut = (entry->status & TexCacheEntry::STATUS_CLUT_VARIANTS) != 0;
 			int killAge = hasClut ? TEXTURE_KILL_AGE_CLUT : killAgeBase;
-			if (iter->second->lastFrame + killAge < gpuStats.numFlips) {
-				DeleteTexture(iter++);
-			} else {
-				++iter;
+			if (entry->lastFrame + killAge < gpuStats.numFlips) {
+				ReleaseTexture(entry, true);
+				cacheSizeEstimate_ -= EstimateTexMemoryUsage(entry);
+				return true;
 			}
-		}
+			return false;
+		});
 
 		VERBOSE_LOG(G3D, "Decimated texture cache, saved %d estimated bytes - now %d bytes", had - cacheSizeEstimate_, cacheSizeEstimate_);
 	}
@@ -820,20 +934,18 @@ void TextureCacheCommon::Decimate(TexCacheEntry *exceptThisOne, bool forcePressu
 	if (PSP_CoreParameter().compat.flags().SecondaryTextureCache && (forcePressure || secondCacheSizeEstimate_ >= TEXCACHE_SECOND_MIN_PRESSURE)) {
 		const u32 had = secondCacheSizeEstimate_;
 
-		for (TexCache::iterator iter = secondCache_.begin(); iter != secondCache_.end(); ) {
-			if (iter->second.get() == exceptThisOne) {
-				++iter;
-				continue;
+		secondCache_.EraseIf([&](TexCacheEntry *entry) {
+			if (entry == exceptThisOne) {
+				return false;
 			}
 			// In low memory mode, we kill them all since secondary cache is disabled.
-			if (lowMemoryMode_ || iter->second->lastFrame + TEXTURE_SECOND_KILL_AGE < gpuStats.numFlips) {
-				ReleaseTexture(iter->second.get(), true);
-				secondCacheSizeEstimate_ -= EstimateTexMemoryUsage(iter->second.get());
-				secondCache_.erase(iter++);
-			} else {
-				++iter;
+			if (lowMemoryMode_ || entry->lastFrame + TEXTURE_SECOND_KILL_AGE < gpuStats.numFlips) {
+				ReleaseTexture(entry, true);
+				secondCacheSizeEstimate_ -= EstimateTexMemoryUsage(entry);
+				return true;
 			}
-		}
+			return false;
+		});
 
 		VERBOSE_LOG(G3D, "Decimated second texture cache, saved %d estimated bytes - now %d bytes", had - secondCacheSizeEstimate_, secondCacheSizeEstimate_);
 	}
@@ -883,13 +995,11 @@ void TextureCacheCommon::HandleTextureChange(TexCacheEntry *const entry, const c
 
 	// Also, mark any textures with the same address but different clut.  They need rechecking.
 	if (entry->cluthash != 0) {
-		const u64 cachekeyMin = (u64)(entry->addr & 0x3FFFFFFF) << 32;
-		const u64 cachekeyMax = cachekeyMin + (1ULL << 32);
-		for (auto it = cache_.lower_bound(cachekeyMin), end = cache_.upper_bound(cachekeyMax); it != end; ++it) {
-			if (it->second->cluthash != entry->cluthash) {
-				it->second->status |= TexCacheEntry::STATUS_CLUT_RECHECK;
+		cache_.ForEachAtAddress(entry->addr, [&](TexCacheEntry *other) {
+			if (other->cluthash != entry->cluthash) {
+				other->status |= TexCacheEntry::STATUS_CLUT_RECHECK;
 			}
-		}
+		});
 	}
 
 	if (entry->numFrames < TEXCACHE_FRAME_CHANGE_FREQUENT) {
@@ -923,30 +1033,19 @@ void TextureCacheCommon::NotifyFramebuffer(VirtualFramebuffer *framebuffer, Fram
 		// Try to match the new framebuffer to existing textures.
 		// Backwards from the "usual" texturing case so can't share a utility function.
 
-		u64 cacheKey = (u64)fb_addr << 32;
-		// If it has a clut, those are the low 32 bits, so it'll be inside this range.
-		// Also, if it's a subsample of the buffer, it'll also be within the FBO.
-		u64 cacheKeyEnd = (u64)fb_endAddr << 32;
+		// All CLUT variants share the address, and a subsample of the buffer will also be within the FBO.
+		auto markOverlap = [&](TexCacheEntry *entry) {
+			entry->status |= TexCacheEntry::STATUS_FRAMEBUFFER_OVERLAP;
+			gpuStats.numTextureInvalidationsByFramebuffer++;
+		};
 
 		// Color - no need to look in the mirrors.
-		for (auto it = cache_.lower_bound(cacheKey), end = cache_.upper_bound(cacheKeyEnd); it != end; ++it) {
-			it->second->status |= TexCacheEntry::STATUS_FRAMEBUFFER_OVERLAP;
-			gpuStats.numTextureInvalidationsByFramebuffer++;
-		}
+		cache_.ForEachInRange(fb_addr, fb_endAddr, markOverlap);
 
 		if (z_stride != 0) {
-			// Depth. Just look at the range, but in each mirror (0x04200000 and 0x04600000).
-			// Games don't use 0x04400000 as far as I know - it has no swizzle effect so kinda useless.
-			cacheKey = (u64)z_addr << 32;
-			cacheKeyEnd = (u64)z_endAddr << 32;
-			for (auto it = cache_.lower_bound(cacheKey | 0x200000), end = cache_.upper_bound(cacheKeyEnd | 0x200000); it != end; ++it) {
-				it->second->status |= TexCacheEntry::STATUS_FRAMEBUFFER_OVERLAP;
-				gpuStats.numTextureInvalidationsByFramebuffer++;
-			}
-			for (auto it = cache_.lower_bound(cacheKey | 0x600000), end = cache_.upper_bound(cacheKeyEnd | 0x600000); it != end; ++it) {
-				it->second->status |= TexCacheEntry::STATUS_FRAMEBUFFER_OVERLAP;
-				gpuStats.numTextureInvalidationsByFramebuffer++;
-			}
+			// Depth. The mirror bits used to be ORed into the low (dim/CLUT) half of the key, so in effect
+			// this has always been the plain depth range, and that's what we keep looking at.
+			cache_.ForEachInRange(z_addr, z_endAddr, markOverlap);
 		}
 		break;
 	}
@@ -1727,6 +1826,39 @@ static void Expand4To8Bits(u8 *dest, const u8 *src, int srcWidth) {
 }
 
 CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, GETextureFormat format, GEPaletteFormat clutformat, uint32_t texaddr, int level, int bufw, TexDecodeFlags flags) {
+	int w = gstate.getTextureWidth(level);
+	int h = gstate.getTextureHeight(level);
+	const uint32_t byteSize = (textureBitsPerPixel[format] * bufw * h) / 8;
+
+	char buf[128];
+	size_t len = snprintf(buf, sizeof(buf), "Tex_%08x_%dx%d_%s", texaddr, w, h, GeTextureFormatToString(format, clutformat));
+	NotifyMemInfo(MemBlockFlags::TEXTURE, texaddr, byteSize, buf, len);
+
+	TexDecodeSource src;
+	src.state = &gstate;
+	src.format = format;
+	src.clutformat = clutformat;
+	src.texaddr = texaddr;
+	src.texptr = Memory::GetPointer(texaddr);
+	src.bufw = bufw;
+	src.clut = clutBuf_;
+	src.clutRaw = clutBufRaw_;
+	src.clutAlphaLinear = clutAlphaLinear_;
+	src.clutAlphaLinearColor = clutAlphaLinearColor_;
+	src.tmpBuf = &tmpTexBuf32_;
+	src.expandClut = expandClut_;
+	return DecodeTextureLevel(out, outPitch, src, level, flags);
+}
+
+CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, const TexDecodeSource &src, int level, TexDecodeFlags flags) {
+	const GPUgstate &state = *src.state;
+	const GETextureFormat format = src.format;
+	const GEPaletteFormat clutformat = src.clutformat;
+	const u32 texaddr = src.texaddr;
+	const int bufw = src.bufw;
+	AlignedVector<u32, 16> &tmpTexBuf32 = *src.tmpBuf;
+	u32 *expandClut = src.expandClut;
+
 	u32 alphaSum = 0xFFFFFFFF;
 	u32 fullAlphaMask = 0x0;
 
@@ -1738,7 +1870,7 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 		_dbg_assert_(false);
 	}
 
-	bool swizzled = gstate.isTextureSwizzled();
+	bool swizzled = state.isTextureSwizzled();
 	if ((texaddr & 0x00600000) != 0 && Memory::IsVRAMAddress(texaddr)) {
 		// This means it's in a mirror, possibly a swizzled mirror.  Let's report.
 		WARN_LOG_REPORT_ONCE(texmirror, G3D, "Decoding texture from VRAM mirror at %08x swizzle=%d", texaddr, swizzled ? 1 : 0);
@@ -1750,25 +1882,20 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 		// Note that (texaddr & 0x00600000) == 0x00600000 is very likely to be depth texturing.
 	}
 
-	int w = gstate.getTextureWidth(level);
-	int h = gstate.getTextureHeight(level);
-	const u8 *texptr = Memory::GetPointer(texaddr);
-	const uint32_t byteSize = (textureBitsPerPixel[format] * bufw * h) / 8;
-
-	char buf[128];
-	size_t len = snprintf(buf, sizeof(buf), "Tex_%08x_%dx%d_%s", texaddr, w, h, GeTextureFormatToString(format, clutformat));
-	NotifyMemInfo(MemBlockFlags::TEXTURE, texaddr, byteSize, buf, len);
+	int w = state.getTextureWidth(level);
+	int h = state.getTextureHeight(level);
+	const u8 *texptr = src.texptr;
 
 	switch (format) {
 	case GE_TFMT_CLUT4:
 	{
-		const bool mipmapShareClut = gstate.isClutSharedForMipmaps();
+		const bool mipmapShareClut = state.isClutSharedForMipmaps();
 		const int clutSharingOffset = mipmapShareClut ? 0 : level * 16;
 
 		if (swizzled) {
-			tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
-			UnswizzleFromMem(tmpTexBuf32_.data(), bufw / 2, texptr, bufw, h, 0);
-			texptr = (u8 *)tmpTexBuf32_.data();
+			tmpTexBuf32.resize(bufw * ((h + 7) & ~7));
+			UnswizzleFromMem(tmpTexBuf32.data(), bufw / 2, texptr, bufw, h, 0);
+			texptr = (u8 *)tmpTexBuf32.data();
 		}
 
 		if (toClut8) {
@@ -1787,40 +1914,40 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 		{
 			// The w > 1 check is to not need a case that handles a single pixel
 			// in DeIndexTexture4Optimal<u16>.
-			if (clutAlphaLinear_ && mipmapShareClut && !expandTo32bit && w >= 4) {
+			if (src.clutAlphaLinear && mipmapShareClut && !expandTo32bit && w >= 4) {
 				// We don't bother with fullalpha here (clutAlphaLinear_)
 				// Here, reverseColors means the CLUT is already reversed.
 				if (reverseColors) {
 					for (int y = 0; y < h; ++y) {
-						DeIndexTexture4Optimal((u16 *)(out + outPitch * y), texptr + (bufw * y) / 2, w, clutAlphaLinearColor_);
+						DeIndexTexture4Optimal((u16 *)(out + outPitch * y), texptr + (bufw * y) / 2, w, src.clutAlphaLinearColor);
 					}
 				} else {
 					for (int y = 0; y < h; ++y) {
-						DeIndexTexture4OptimalRev((u16 *)(out + outPitch * y), texptr + (bufw * y) / 2, w, clutAlphaLinearColor_);
+						DeIndexTexture4OptimalRev((u16 *)(out + outPitch * y), texptr + (bufw * y) / 2, w, src.clutAlphaLinearColor);
 					}
 				}
 			} else {
 				// Need to have the "un-reversed" (raw) CLUT here since we are using a generic conversion function.
 				if (expandTo32bit) {
 					// We simply expand the CLUT to 32-bit, then we deindex as usual. Probably the fastest way.
-					const u16 *clut = GetCurrentRawClut<u16>() + clutSharingOffset;
-					const int clutStart = gstate.getClutIndexStartPos();
-					if (gstate.getClutIndexShift() == 0 || gstate.getClutIndexMask() <= 16) {
-						ConvertFormatToRGBA8888(clutformat, expandClut_ + clutStart, clut + clutStart, 16);
+					const u16 *clut = ((const u16 *)src.clutRaw) + clutSharingOffset;
+					const int clutStart = state.getClutIndexStartPos();
+					if (state.getClutIndexShift() == 0 || state.getClutIndexMask() <= 16) {
+						ConvertFormatToRGBA8888(clutformat, expandClut + clutStart, clut + clutStart, 16);
 					} else {
 						// To be safe for shifts and wrap around, convert the entire CLUT.
-						ConvertFormatToRGBA8888(clutformat, expandClut_, clut, 512);
+						ConvertFormatToRGBA8888(clutformat, expandClut, clut, 512);
 					}
 					fullAlphaMask = 0xFF000000;
 					for (int y = 0; y < h; ++y) {
-						DeIndexTexture4<u32>((u32 *)(out + outPitch * y), texptr + (bufw * y) / 2, w, expandClut_, &alphaSum);
+						DeIndexTexture4<u32>((u32 *)(out + outPitch * y), texptr + (bufw * y) / 2, w, expandClut, &alphaSum, state);
 					}
 				} else {
 					// If we're reversing colors, the CLUT was already reversed, no special handling needed.
-					const u16 *clut = GetCurrentClut<u16>() + clutSharingOffset;
+					const u16 *clut = ((const u16 *)src.clut) + clutSharingOffset;
 					fullAlphaMask = ClutFormatToFullAlpha(clutformat, reverseColors);
 					for (int y = 0; y < h; ++y) {
-						DeIndexTexture4<u16>((u16 *)(out + outPitch * y), texptr + (bufw * y) / 2, w, clut, &alphaSum);
+						DeIndexTexture4<u16>((u16 *)(out + outPitch * y), texptr + (bufw * y) / 2, w, clut, &alphaSum, state);
 					}
 				}
 			}
@@ -1834,16 +1961,16 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 
 		case GE_CMODE_32BIT_ABGR8888:
 		{
-			const u32 *clut = GetCurrentClut<u32>() + clutSharingOffset;
+			const u32 *clut = src.clut + clutSharingOffset;
 			fullAlphaMask = 0xFF000000;
 			for (int y = 0; y < h; ++y) {
-				DeIndexTexture4<u32>((u32 *)(out + outPitch * y), texptr + (bufw * y) / 2, w, clut, &alphaSum);
+				DeIndexTexture4<u32>((u32 *)(out + outPitch * y), texptr + (bufw * y) / 2, w, clut, &alphaSum, state);
 			}
 		}
 		break;
 
 		default:
-			ERROR_LOG_REPORT(G3D, "Unknown CLUT4 texture mode %d", gstate.getClutPaletteFormat());
+			ERROR_LOG_REPORT(G3D, "Unknown CLUT4 texture mode %d", state.getClutPaletteFormat());
 			return CHECKALPHA_ANY;
 		}
 	}
@@ -1851,10 +1978,10 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 
 	case GE_TFMT_CLUT8:
 		if (toClut8) {
-			if (gstate.isTextureSwizzled()) {
-				tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
-				UnswizzleFromMem(tmpTexBuf32_.data(), bufw, texptr, bufw, h, 1);
-				texptr = (u8 *)tmpTexBuf32_.data();
+			if (state.isTextureSwizzled()) {
+				tmpTexBuf32.resize(bufw * ((h + 7) & ~7));
+				UnswizzleFromMem(tmpTexBuf32.data(), bufw, texptr, bufw, h, 1);
+				texptr = (u8 *)tmpTexBuf32.data();
 			}
 			// After deswizzling, we are in the correct format and can just copy.
 			for (int y = 0; y < h; ++y) {
@@ -1863,13 +1990,13 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 			// We can't know anything about alpha.
 			return CHECKALPHA_ANY;
 		}
-		return ReadIndexedTex(out, outPitch, level, texptr, 1, bufw, reverseColors, expandTo32bit);
+		return ReadIndexedTex(out, outPitch, level, texptr, 1, src, reverseColors, expandTo32bit);
 
 	case GE_TFMT_CLUT16:
-		return ReadIndexedTex(out, outPitch, level, texptr, 2, bufw, reverseColors, expandTo32bit);
+		return ReadIndexedTex(out, outPitch, level, texptr, 2, src, reverseColors, expandTo32bit);
 
 	case GE_TFMT_CLUT32:
-		return ReadIndexedTex(out, outPitch, level, texptr, 4, bufw, reverseColors, expandTo32bit);
+		return ReadIndexedTex(out, outPitch, level, texptr, 4, src, reverseColors, expandTo32bit);
 
 	case GE_TFMT_4444:
 	case GE_TFMT_5551:
@@ -1903,9 +2030,9 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 			}
 		}*/ else {
 			// We don't have enough space for all rows in out, so use a temp buffer.
-			tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
-			UnswizzleFromMem(tmpTexBuf32_.data(), bufw * 2, texptr, bufw, h, 2);
-			const u8 *unswizzled = (u8 *)tmpTexBuf32_.data();
+			tmpTexBuf32.resize(bufw * ((h + 7) & ~7));
+			UnswizzleFromMem(tmpTexBuf32.data(), bufw * 2, texptr, bufw, h, 2);
+			const u8 *unswizzled = (u8 *)tmpTexBuf32.data();
 
 			fullAlphaMask = TfmtRawToFullAlpha(format);
 			if (expandTo32bit) {
@@ -1952,9 +2079,9 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 				ReverseColors(out, out, format, h * outPitch / 4, useBGRA);
 			}
 		}*/ else {
-			tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
-			UnswizzleFromMem(tmpTexBuf32_.data(), bufw * 4, texptr, bufw, h, 4);
-			const u8 *unswizzled = (u8 *)tmpTexBuf32_.data();
+			tmpTexBuf32.resize(bufw * ((h + 7) & ~7));
+			UnswizzleFromMem(tmpTexBuf32.data(), bufw * 4, texptr, bufw, h, 4);
+			const u8 *unswizzled = (u8 *)tmpTexBuf32.data();
 
 			fullAlphaMask = TfmtRawToFullAlpha(format);
 			if (reverseColors) {
@@ -1987,37 +2114,42 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 	return AlphaSumIsFull(alphaSum, fullAlphaMask) ? CHECKALPHA_FULL : CHECKALPHA_ANY;
 }
 
-CheckAlphaResult TextureCacheCommon::ReadIndexedTex(u8 *out, int outPitch, int level, const u8 *texptr, int bytesPerIndex, int bufw, bool reverseColors, bool expandTo32Bit) {
-	int w = gstate.getTextureWidth(level);
-	int h = gstate.getTextureHeight(level);
+CheckAlphaResult TextureCacheCommon::ReadIndexedTex(u8 *out, int outPitch, int level, const u8 *texptr, int bytesPerIndex, const TexDecodeSource &src, bool reverseColors, bool expandTo32Bit) {
+	const GPUgstate &state = *src.state;
+	const int bufw = src.bufw;
+	AlignedVector<u32, 16> &tmpTexBuf32 = *src.tmpBuf;
+	u32 *expandClut = src.expandClut;
+
+	int w = state.getTextureWidth(level);
+	int h = state.getTextureHeight(level);
 
-	if (gstate.isTextureSwizzled()) {
-		tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
-		UnswizzleFromMem(tmpTexBuf32_.data(), bufw * bytesPerIndex, texptr, bufw, h, bytesPerIndex);
-		texptr = (u8 *)tmpTexBuf32_.data();
+	if (state.isTextureSwizzled()) {
+		tmpTexBuf32.resize(bufw * ((h + 7) & ~7));
+		UnswizzleFromMem(tmpTexBuf32.data(), bufw * bytesPerIndex, texptr, bufw, h, bytesPerIndex);
+		texptr = (u8 *)tmpTexBuf32.data();
 	}
 
 	// Misshitsu no Sacrifice has separate CLUT data, this is a hack to allow it.
 	// Normally separate CLUTs are not allowed for 8-bit or higher indices.
-	const bool mipmapShareClut = gstate.isClutSharedForMipmaps() || gstate.getClutLoadBlocks() != 0x40;
+	const bool mipmapShareClut = state.isClutSharedForMipmaps() || state.getClutLoadBlocks() != 0x40;
 	const int clutSharingOffset = mipmapShareClut ? 0 : (level & 1) * 256;
 
-	GEPaletteFormat palFormat = (GEPaletteFormat)gstate.getClutPaletteFormat();
+	GEPaletteFormat palFormat = (GEPaletteFormat)state.getClutPaletteFormat();
 
-	const u16 *clut16 = (const u16 *)clutBuf_ + clutSharingOffset;
-	const u32 *clut32 = (const u32 *)clutBuf_ + clutSharingOffset;
+	const u16 *clut16 = (const u16 *)src.clut + clutSharingOffset;
+	const u32 *clut32 = src.clut + clutSharingOffset;
 
 	if (expandTo32Bit && palFormat != GE_CMODE_32BIT_ABGR8888) {
-		const u16 *clut16raw = (const u16 *)clutBufRaw_ + clutSharingOffset;
+		const u16 *clut16raw = (const u16 *)src.clutRaw + clutSharingOffset;
 		// It's possible to access the latter half of the CLUT using the start pos.
-		const int clutStart = gstate.getClutIndexStartPos();
+		const int clutStart = state.getClutIndexStartPos();
 		if (clutStart > 256) {
 			// Access wraps around when start + index goes over.
-			ConvertFormatToRGBA8888(GEPaletteFormat(palFormat), expandClut_, clut16raw, 512);
+			ConvertFormatToRGBA8888(GEPaletteFormat(palFormat), expandClut, clut16raw, 512);
 		} else {
-			ConvertFormatToRGBA8888(GEPaletteFormat(palFormat), expandClut_ + clutStart, clut16raw + clutStart, 256);
+			ConvertFormatToRGBA8888(GEPaletteFormat(palFormat), expandClut + clutStart, clut16raw + clutStart, 256);
 		}
-		clut32 = expandClut_;
+		clut32 = expandClut;
 		palFormat = GE_CMODE_32BIT_ABGR8888;
 	}
 
@@ -2032,19 +2164,19 @@ CheckAlphaResult TextureCacheCommon::ReadIndexedTex(u8 *out, int outPitch, int l
 		switch (bytesPerIndex) {
 		case 1:
 			for (int y = 0; y < h; ++y) {
-				DeIndexTexture((u16 *)(out + outPitch * y), (const u8 *)texptr + bufw * y, w, clut16, &alphaSum);
+				DeIndexTexture((u16 *)(out + outPitch * y), (const u8 *)texptr + bufw * y, w, clut16, &alphaSum, state);
 			}
 			break;
 
 		case 2:
 			for (int y = 0; y < h; ++y) {
-				DeIndexTexture((u16 *)(out + outPitch * y), (const u16_le *)texptr + bufw * y, w, clut16, &alphaSum);
+				DeIndexTexture((u16 *)(out + outPitch * y), (const u16_le *)texptr + bufw * y, w, clut16, &alphaSum, state);
 			}
 			break;
 
 		case 4:
 			for (int y = 0; y < h; ++y) {
-				DeIndexTexture((u16 *)(out + outPitch * y), (const u32_le *)texptr + bufw * y, w, clut16, &alphaSum);
+				DeIndexTexture((u16 *)(out + outPitch * y), (const u32_le *)texptr + bufw * y, w, clut16, &alphaSum, state);
 			}
 			break;
 		}
@@ -2057,19 +2189,19 @@ CheckAlphaResult TextureCacheCommon::ReadIndexedTex(u8 *out, int outPitch, int l
 		switch (bytesPerIndex) {
 		case 1:
 			for (int y = 0; y < h; ++y) {
-				DeIndexTexture((u32 *)(out + outPitch * y), (const u8 *)texptr + bufw * y, w, clut32, &alphaSum);
+				DeIndexTexture((u32 *)(out + outPitch * y), (const u8 *)texptr + bufw * y, w, clut32, &alphaSum, state);
 			}
 			break;
 
 		case 2:
 			for (int y = 0; y < h; ++y) {
-				DeIndexTexture((u32 *)(out + outPitch * y), (const u16_le *)texptr + bufw * y, w, clut32, &alphaSum);
+				DeIndexTexture((u32 *)(out + outPitch * y), (const u16_le *)texptr + bufw * y, w, clut32, &alphaSum, state);
 			}
 			break;
 
 		case 4:
 			for (int y = 0; y < h; ++y) {
-				DeIndexTexture((u32 *)(out + outPitch * y), (const u32_le *)texptr + bufw * y, w, clut32, &alphaSum);
+				DeIndexTexture((u32 *)(out + outPitch * y), (const u32_le *)texptr + bufw * y, w, clut32, &alphaSum, state);
 			}
 			break;
 		}
@@ -2077,7 +2209,7 @@ CheckAlphaResult TextureCacheCommon::ReadIndexedTex(u8 *out, int outPitch, int l
 	break;
 
 	default:
-		ERROR_LOG_REPORT(G3D, "Unhandled clut texture mode %d!!!", gstate.getClutPaletteFormat());
+		ERROR_LOG_REPORT(G3D, "Unhandled clut texture mode %d!!!", state.getClutPaletteFormat());
 		break;
 	}
 
@@ -2088,6 +2220,199 @@ CheckAlphaResult TextureCacheCommon::ReadIndexedTex(u8 *out, int outPitch, int l
 	}
 }
 
+class TexDecodeTask : public Task {
+public:
+	TexDecodeTask(TexDecodeJob *job) : job_(job) {}
+
+	TaskType Type() const override { return TaskType::CPU_COMPUTE; }
+	TaskPriority Priority() const override { return TaskPriority::NORMAL; }
+
+	void Run() override {
+		double start = time_now_d();
+		AlignedVector<u32, 16> tmpBuf;
+
+		TexDecodeSource src;
+		src.state = &job_->state;
+		src.format = job_->format;
+		src.clutformat = job_->clutformat;
+		src.clut = job_->clutIsRaw ? job_->clutRaw : job_->clutConverted;
+		src.clutRaw = job_->clutRaw;
+		src.clutAlphaLinear = job_->clutAlphaLinear;
+		src.clutAlphaLinearColor = job_->clutAlphaLinearColor;
+		src.tmpBuf = &tmpBuf;
+		src.expandClut = job_->expandClut;
+
+		for (int i = 0; i < job_->numLevels; i++) {
+			TexDecodeJob::Level &level = job_->levels[i];
+			src.texaddr = level.texaddr;
+			src.texptr = level.src.data();
+			src.bufw = level.bufw;
+			level.alpha = TextureCacheCommon::DecodeTextureLevel(level.decoded.data(), level.w * job_->bpp, src, i, job_->flags);
+		}
+
+		job_->decodeTime = time_now_d() - start;
+		job_->waitable->Notify();
+	}
+
+private:
+	TexDecodeJob *job_;
+};
+
+bool TextureCacheCommon::StartAsyncDecode(TexCacheEntry *entry) {
+	// We need the old texture to keep drawing with, and to know how it was last decoded.
+	if (!entry->texturePtr || entry->decodeFmt == Draw::DataFormat::UNDEFINED) {
+		return false;
+	}
+	if (entry->status & (TexCacheEntry::STATUS_CLUT_GPU | TexCacheEntry::STATUS_VIDEO | TexCacheEntry::STATUS_3D)) {
+		return false;
+	}
+	if (replacer_.Enabled() || IsVideo(entry->addr)) {
+		return false;
+	}
+
+	if (entry->status & TexCacheEntry::STATUS_ASYNC_DECODE) {
+		// Still busy with an earlier change. Once that lands, the hash check will catch this one.
+		if (FindAsyncDecode(entry)) {
+			return true;
+		}
+		entry->status &= ~TexCacheEntry::STATUS_ASYNC_DECODE;
+	}
+
+	const GETextureFormat format = (GETextureFormat)entry->format;
+	const int bpp = (int)Draw::DataFormatSizeInBytes(entry->decodeFmt);
+
+	// Same level validation as PrepareBuildTexture.
+	int numLevels = entry->maxLevel + 1;
+	size_t bytes = 0;
+	for (int i = 0; i < numLevels; i++) {
+		u32 levelTexaddr = gstate.getTextureAddress(i);
+		if (!Memory::IsValidAddress(levelTexaddr)) {
+			numLevels = i;
+			break;
+		}
+		int tw = gstate.getTextureWidth(i);
+		int th = gstate.getTextureHeight(i);
+		int levelBufw = GetTextureBufw(i, levelTexaddr, format);
+		bytes += (textureBitsPerPixel[format] * std::max(levelBufw, tw) * ((th + 7) & ~7)) / 8;
+		bytes += tw * th * bpp;
+		if (tw == 1 || th == 1) {
+			numLevels = i + 1;
+			break;
+		}
+	}
+
+	if (numLevels == 0 || asyncDecodes_.size() >= TEXCACHE_MAX_ASYNC_DECODES || asyncDecodeBytes_ + bytes > TEXCACHE_MAX_ASYNC_DECODE_BYTES) {
+		return false;
+	}
+
+	TexDecodeJob *job = new TexDecodeJob();
+	job->cachekey = entry->CacheKey();
+	// CheckFullHash already stored the new hash.
+	job->fullhash = entry->fullhash;
+	job->format = format;
+	job->clutformat = gstate.getClutPaletteFormat();
+	job->flags = (TexDecodeFlags)entry->decodeFlags;
+	job->dstFmt = entry->decodeFmt;
+	job->bpp = bpp;
+
+	job->state = gstate;
+	memcpy(job->clutRaw, clutBufRaw_, sizeof(job->clutRaw));
+	memcpy(job->clutConverted, clutBufConverted_, sizeof(job->clutConverted));
+	job->clutIsRaw = clutBuf_ == clutBufRaw_;
+	job->clutAlphaLinear = clutAlphaLinear_;
+	job->clutAlphaLinearColor = clutAlphaLinearColor_;
+
+	job->numLevels = numLevels;
+	for (int i = 0; i < numLevels; i++) {
+		TexDecodeJob::Level &level = job->levels[i];
+		level.texaddr = gstate.getTextureAddress(i);
+		level.bufw = GetTextureBufw(i, level.texaddr, format);
+		level.w = gstate.getTextureWidth(i);
+		level.h = gstate.getTextureHeight(i);
+
+		// Round up to whole swizzle blocks, the decoders may read that far. Zeroes past the end of RAM.
+		const u32 srcSize = (textureBitsPerPixel[format] * std::max(level.bufw, level.w) * ((level.h + 7) & ~7)) / 8;
+		level.src.resize(srcSize);
+		memcpy(level.src.data(), Memory::GetPointerUnchecked(level.texaddr), Memory::ValidSize(level.texaddr, srcSize));
+		level.decoded.resize(level.w * level.h * bpp);
+
+		const u32 byteSize = (textureBitsPerPixel[format] * level.bufw * level.h) / 8;
+		char buf[128];
+		size_t len = snprintf(buf, sizeof(buf), "Tex_%08x_%dx%d_%s", level.texaddr, level.w, level.h, GeTextureFormatToString(format, job->clutformat));
+		NotifyMemInfo(MemBlockFlags::TEXTURE, level.texaddr, byteSize, buf, len);
+	}
+	job->bytes = bytes;
+	job->waitable = new LimitedWaitable();
+
+	asyncDecodes_.push_back(job);
+	asyncDecodeBytes_ += bytes;
+	entry->status |= TexCacheEntry::STATUS_ASYNC_DECODE;
+	gpuStats.numAsyncTexDecodes++;
+
+	g_threadManager.EnqueueTask(new TexDecodeTask(job));
+	return true;
+}
+
+TexDecodeJob *TextureCacheCommon::FindAsyncDecode(const TexCacheEntry *entry) {
+	const u64 cachekey = entry->CacheKey();
+	for (TexDecodeJob *job : asyncDecodes_) {
+		if (job->cachekey == cachekey && !job->abandoned) {
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+bool TextureCacheCommon::PollAsyncDecode(TexCacheEntry *entry) {
+	TexDecodeJob *job = FindAsyncDecode(entry);
+	if (!job) {
+		entry->status &= ~TexCacheEntry::STATUS_ASYNC_DECODE;
+		return false;
+	}
+	if (!job->waitable->WaitFor(0.0)) {
+		return false;
+	}
+	job->consume = true;
+	return true;
+}
+
+void TextureCacheCommon::AbandonAsyncDecode(TexCacheEntry *entry) {
+	TexDecodeJob *job = FindAsyncDecode(entry);
+	if (job) {
+		job->abandoned = true;
+	}
+	entry->status &= ~TexCacheEntry::STATUS_ASYNC_DECODE;
+}
+
+void TextureCacheCommon::FinishAsyncDecode(TexCacheEntry *entry) {
+	// The build has copied out whatever it could use.
+	AbandonAsyncDecode(entry);
+	ReapAsyncDecodes(false);
+}
+
+void TextureCacheCommon::ReapAsyncDecodes(bool waitAll) {
+	for (size_t i = 0; i < asyncDecodes_.size(); ) {
+		TexDecodeJob *job = asyncDecodes_[i];
+		if (!job->abandoned && !waitAll) {
+			// The entry may have been decimated or deleted for a framebuffer.
+			const TexCacheEntry *entry = cache_.Get(job->cachekey);
+			if (!entry || (entry->status & TexCacheEntry::STATUS_ASYNC_DECODE) == 0) {
+				job->abandoned = true;
+			}
+		}
+		if (!waitAll && (!job->abandoned || !job->waitable->Ready())) {
+			i++;
+			continue;
+		}
+
+		job->waitable->WaitAndRelease();
+		gpuStats.msAsyncTexDecode += job->decodeTime * 1000.0;
+		asyncDecodeBytes_ -= job->bytes;
+		delete job;
+		asyncDecodes_.erase(asyncDecodes_.begin() + i);
+	}
+}
+
 void TextureCacheCommon::ApplyTexture() {
 	TexCacheEntry *entry = nextTexture_;
 	if (!entry) {
@@ -2126,7 +2451,7 @@ void TextureCacheCommon::ApplyTexture() {
 			int w = gstate.getTextureWidth(0);
 			int h = gstate.getTextureHeight(0);
 			bool swizzled = gstate.isTextureSwizzled();
-			entry->fullhash = QuickTexHash(replacer_, entry->addr, entry->bufw, w, h, swizzled, GETextureFormat(entry->format), entry);
+			entry->fullhash = HashAndWatchTexture(entry, w, h, swizzled);
 
 			// TODO: Here we could check the secondary cache; maybe the texture is in there?
 			// We would need to abort the build if so.
@@ -2140,8 +2465,16 @@ void TextureCacheCommon::ApplyTexture() {
 		// Okay, this matched and didn't change - but let's check the hash.  Maybe it will change.
 		bool doDelete = true;
 		if (!CheckFullHash(entry, doDelete)) {
-			HandleTextureChange(entry, "hash fail", true, doDelete);
-			nextNeedsRebuild_ = true;
+			if (g_Config.bTextureAsyncDecode && doDelete && StartAsyncDecode(entry)) {
+				// Keep drawing with the old contents, SetTexture will pick up the new ones when ready.
+			} else {
+				if (g_Config.bTextureAsyncDecode) {
+					gpuStats.numAsyncTexDecodeFallbacks++;
+				}
+				AbandonAsyncDecode(entry);
+				HandleTextureChange(entry, "hash fail", true, doDelete);
+				nextNeedsRebuild_ = true;
+			}
 		} else if (nextTexture_ != nullptr) {
 			// The secondary cache may choose an entry from its storage by setting nextTexture_.
 			// This means we should set that, instead of our previous entry.
@@ -2156,6 +2489,9 @@ void TextureCacheCommon::ApplyTexture() {
 		_assert_(!entry->texturePtr);
 		BuildTexture(entry);
 		ForgetLastTexture();
+		if (entry->status & TexCacheEntry::STATUS_ASYNC_DECODE) {
+			FinishAsyncDecode(entry);
+		}
 	}
 
 	gstate_c.SetTextureIsVideo((entry->status & TexCacheEntry::STATUS_VIDEO) != 0);
@@ -2510,15 +2846,16 @@ void TextureCacheCommon::ApplyTextureDepal(TexCacheEntry *entry) {
 
 void TextureCacheCommon::Clear(bool delete_them) {
 	textureShaderCache_->Clear();
+	ReapAsyncDecodes(true);
 
 	ForgetLastTexture();
-	for (TexCache::iterator iter = cache_.begin(); iter != cache_.end(); ++iter) {
-		ReleaseTexture(iter->second.get(), delete_them);
-	}
+	cache_.ForEach([&](TexCacheEntry *entry) {
+		ReleaseTexture(entry, delete_them);
+	});
 	// In case the setting was changed, we ALWAYS clear the secondary cache (enabled or not.)
-	for (TexCache::iterator iter = secondCache_.begin(); iter != secondCache_.end(); ++iter) {
-		ReleaseTexture(iter->second.get(), delete_them);
-	}
+	secondCache_.ForEach([&](TexCacheEntry *entry) {
+		ReleaseTexture(entry, delete_them);
+	});
 	if (cache_.size() + secondCache_.size()) {
 		INFO_LOG(G3D, "Texture cached cleared from %i textures", (int)(cache_.size() + secondCache_.size()));
 		cache_.clear();
@@ -2538,10 +2875,11 @@ void TextureCacheCommon::Clear(bool delete_them) {
 	}
 }
 
-void TextureCacheCommon::DeleteTexture(TexCache::iterator it) {
-	ReleaseTexture(it->second.get(), true);
-	cacheSizeEstimate_ -= EstimateTexMemoryUsage(it->second.get());
-	cache_.erase(it);
+void TextureCacheCommon::DeleteTexture(u64 cachekey) {
+	TexCacheEntry *entry = cache_.Get(cachekey);
+	ReleaseTexture(entry, true);
+	cacheSizeEstimate_ -= EstimateTexMemoryUsage(entry);
+	cache_.Erase(cachekey);
 }
 
 bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
@@ -2558,9 +2896,14 @@ bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 	}
 
 	u32 fullhash;
-	{
+	u32 sizeInRAM = QuickTexHashSize(entry->bufw, h, swizzled, GETextureFormat(entry->format), entry);
+	if (entry->watchStamp != 0 && sizeInRAM <= entry->watchBytes && !Memory::WriteWatch_ChangedSince(entry->addr, sizeInRAM, entry->watchStamp)) {
+		// Nothing has written to it since we last hashed, so the hash can't have changed.
+		gpuStats.numTextureDataBytesHashSkipped += sizeInRAM;
+		fullhash = entry->fullhash;
+	} else {
 		PROFILE_THIS_SCOPE("texhash");
-		fullhash = QuickTexHash(replacer_, entry->addr, entry->bufw, w, h, swizzled, GETextureFormat(entry->format), entry);
+		fullhash = HashAndWatchTexture(entry, w, h, swizzled);
 	}
 
 	if (fullhash == entry->fullhash) {
@@ -2587,10 +2930,9 @@ bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 		if (entry->numInvalidated > 2 && entry->numInvalidated < 128 && !lowMemoryMode_) {
 			// We have a new hash: look for that hash in the secondary cache.
 			u64 secondKey = fullhash | (u64)entry->cluthash << 32;
-			TexCache::iterator secondIter = secondCache_.find(secondKey);
-			if (secondIter != secondCache_.end()) {
+			TexCacheEntry *secondEntry = secondCache_.Get(secondKey);
+			if (secondEntry) {
 				// Found it, but does it match our current params?  If not, abort.
-				TexCacheEntry *secondEntry = secondIter->second.get();
 				if (secondEntry->Matches(entry->dim, entry->format, entry->maxLevel)) {
 					// Reset the numInvalidated value lower, we got a match.
 					if (entry->numInvalidated > 8) {
@@ -2608,14 +2950,14 @@ bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 				secondCacheSizeEstimate_ += EstimateTexMemoryUsage(entry);
 
 				// If the entry already exists in the secondary texture cache, drop it nicely.
-				auto oldIter = secondCache_.find(secondKey);
-				if (oldIter != secondCache_.end()) {
-					ReleaseTexture(oldIter->second.get(), true);
+				TexCacheEntry *oldEntry = secondCache_.Get(secondKey);
+				if (oldEntry) {
+					ReleaseTexture(oldEntry, true);
 				}
 
 				// Archive the entire texture entry as is, since we'll use its params if it is seen again.
 				// We keep parameters on the current entry, since we are STILL building a new texture here.
-				secondCache_[secondKey].reset(new TexCacheEntry(*entry));
+				secondCache_.Insert(secondKey, new TexCacheEntry(*entry));
 
 				// Make sure we don't delete the texture we just archived.
 				entry->texturePtr = nullptr;
@@ -2629,6 +2971,17 @@ bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 	return false;
 }
 
+u32 TextureCacheCommon::HashAndWatchTexture(TexCacheEntry *entry, int w, int h, bool swizzled) {
+	GETextureFormat format = GETextureFormat(entry->format);
+	entry->watchStamp = 0;
+	if (Memory::WriteWatch_Enabled()) {
+		// Protect first, so that any write during or after hashing is caught.
+		entry->watchBytes = QuickTexHashSize(entry->bufw, h, swizzled, format, entry);
+		entry->watchStamp = Memory::WriteWatch_Protect(entry->addr, entry->watchBytes);
+	}
+	return QuickTexHash(replacer_, entry->addr, entry->bufw, w, h, swizzled, format, entry);
+}
+
 void TextureCacheCommon::Invalidate(u32 addr, int size, GPUInvalidationType type) {
 	// They could invalidate inside the texture, let's just give a bit of leeway.
 	// TODO: Keep track of the largest texture size in bytes, and use that instead of this
@@ -2656,14 +3009,10 @@ void TextureCacheCommon::Invalidate(u32 addr, int size, GPUInvalidationType type
 		return;
 	}
 
-	const u64 startKey = (u64)(addr - LARGEST_TEXTURE_SIZE) << 32;
-	u64 endKey = (u64)(addr + size + LARGEST_TEXTURE_SIZE) << 32;
-	if (endKey < startKey) {
-		endKey = (u64)-1;
-	}
+	const u32 startAddr = addr > (u32)LARGEST_TEXTURE_SIZE ? addr - LARGEST_TEXTURE_SIZE : 0;
+	const u32 endAddr = addr_end + LARGEST_TEXTURE_SIZE;
 
-	for (TexCache::iterator iter = cache_.lower_bound(startKey), end = cache_.upper_bound(endKey); iter != end; ++iter) {
-		auto &entry = iter->second;
+	cache_.ForEachInRange(startAddr, endAddr, [&](TexCacheEntry *entry) {
 		u32 texAddr = entry->addr;
 		// Intentional underestimate here.
 		u32 texEnd = entry->addr + entry->SizeInRAM() / 2;
@@ -2677,6 +3026,7 @@ void TextureCacheCommon::Invalidate(u32 addr, int size, GPUInvalidationType type
 				// Just random values to force the hash not to match.
 				entry->fullhash = (entry->fullhash ^ 0x12345678) + 13;
 				entry->minihash = (entry->minihash ^ 0x89ABCDEF) + 89;
+				entry->watchStamp = 0;
 			}
 			if (type != GPU_INVALIDATE_ALL) {
 				gpuStats.numTextureInvalidations++;
@@ -2694,7 +3044,7 @@ void TextureCacheCommon::Invalidate(u32 addr, int size, GPUInvalidationType type
 				entry->invalidHint++;
 			}
 		}
-	}
+	});
 }
 
 void TextureCacheCommon::InvalidateAll(GPUInvalidationType /*unused*/) {
@@ -2708,12 +3058,12 @@ void TextureCacheCommon::InvalidateAll(GPUInvalidationType /*unused*/) {
 	}
 	timesInvalidatedAllThisFrame_++;
 
-	for (TexCache::iterator iter = cache_.begin(), end = cache_.end(); iter != end; ++iter) {
-		if (iter->second->GetHashStatus() == TexCacheEntry::STATUS_RELIABLE) {
-			iter->second->SetHashStatus(TexCacheEntry::STATUS_HASHING);
+	cache_.ForEach([](TexCacheEntry *entry) {
+		if (entry->GetHashStatus() == TexCacheEntry::STATUS_RELIABLE) {
+			entry->SetHashStatus(TexCacheEntry::STATUS_HASHING);
 		}
-		iter->second->invalidHint++;
-	}
+		entry->invalidHint++;
+	});
 }
 
 void TextureCacheCommon::ClearNextFrame() {
@@ -3001,8 +3351,25 @@ void TextureCacheCommon::LoadTextureLevel(TexCacheEntry &entry, uint8_t *data, s
 		if (entry.status & TexCacheEntry::STATUS_CLUT_GPU) {
 			texDecFlags |= TexDecodeFlags::TO_CLUT8;
 		}
+		entry.decodeFlags = (u8)texDecFlags;
+		entry.decodeFmt = dstFmt;
 
-		CheckAlphaResult alphaResult = DecodeTextureLevel((u8 *)pixelData, decPitch, tfmt, clutformat, texaddr, srcLevel, bufw, texDecFlags);
+		CheckAlphaResult alphaResult;
+		const TexDecodeJob *job = (entry.status & TexCacheEntry::STATUS_ASYNC_DECODE) ? FindAsyncDecode(&entry) : nullptr;
+		if (job && job->consume && srcLevel < job->numLevels && job->flags == texDecFlags && job->dstFmt == dstFmt &&
+			job->levels[srcLevel].texaddr == texaddr && job->levels[srcLevel].w == w && job->levels[srcLevel].h == h) {
+			// Already decoded on a worker, just copy it into place.
+			const TexDecodeJob::Level &level = job->levels[srcLevel];
+			const int rowBytes = w * job->bpp;
+			for (int y = 0; y < h; ++y) {
+				memcpy((u8 *)pixelData + decPitch * y, level.decoded.data() + rowBytes * y, rowBytes);
+			}
+			alphaResult = level.alpha;
+			// This is the hash of what we decoded. Anything written since will fail the next check.
+			entry.fullhash = job->fullhash;
+		} else {
+			alphaResult = DecodeTextureLevel((u8 *)pixelData, decPitch, tfmt, clutformat, texaddr, srcLevel, bufw, texDecFlags);
+		}
 		entry.SetAlphaStatus(alphaResult, srcLevel);
 
 		int scaledW = w, scaledH = h;
@@ -3041,12 +3408,11 @@ void TextureCacheCommon::LoadTextureLevel(TexCacheEntry &entry, uint8_t *data, s
 
 std::string TextureCacheCommon::GetTextureReplacementInfo(u32 texAddr) {
 	std::string filename = "";
-	for (TexCache::iterator iter = cache_.begin(); iter != cache_.end(); ++iter) {
-		if (iter->second->addr == texAddr) {
-			filename = StringFromFormat("%08x%08x%08x", iter->second->addr, iter->second->CacheKey(), iter->second->fullhash);
-			break;
+	cache_.ForEachAtAddress(texAddr, [&](TexCacheEntry *entry) {
+		if (entry->addr == texAddr && filename.empty()) {
+			filename = StringFromFormat("%08x%08x%08x", entry->addr, entry->CacheKey(), entry->fullhash);
 		}
-	}
+	});
 	NOTICE_LOG(G3D, "Filename for replacement(Address, Clut Hash, Texture Hash): %s", filename.c_str());
 	return filename;
 }
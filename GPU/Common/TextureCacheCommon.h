@@ -17,12 +17,15 @@
 
 #pragma once
 
+#include <algorithm>
 #include <map>
 #include <vector>
 #include <memory>
 
 #include "Common/CommonTypes.h"
 #include "Common/MemoryUtil.h"
+#include "Common/Data/Collections/Hashmaps.h"
+#include "Core/MemWriteWatch.h"
 #include "Core/System.h"
 #include "GPU/GPU.h"
 #include "GPU/Common/GPUDebugInterface.h"
@@ -167,6 +170,8 @@ struct TexCacheEntry {
 
 		STATUS_VIDEO = 0x10000,
 		STATUS_BGRA = 0x20000,
+
+		STATUS_ASYNC_DECODE = 0x40000,  // New contents are being decoded on a worker, the old texture stays bound.
 	};
 
 	// TexStatus enum flag combination.
@@ -194,6 +199,12 @@ struct TexCacheEntry {
 	u32 fullhash;
 	u32 cluthash;
 	u16 maxSeenV;
+	// Output format and flags (TexDecodeFlags) of the last LoadTextureLevel, reused by async decodes.
+	u8 decodeFlags;
+	Draw::DataFormat decodeFmt;
+	// With write watching, nothing wrote to the first watchBytes at addr after watchStamp (if nonzero.)
+	Memory::WriteWatchStamp watchStamp;
+	u32 watchBytes;
 	ReplacedTexture *replacedTexture;
 
 	TexStatus GetHashStatus() {
@@ -232,9 +243,95 @@ struct TexCacheEntry {
 	static u64 CacheKey(u32 addr, u8 format, u16 dim, u32 cluthash);
 };
 
-// Can't be unordered_map, we use lower_bound ... although for some reason that (used to?) compiles on MSVC.
-// Would really like to replace this with DenseHashMap but can't as long as we need lower_bound.
-typedef std::map<u64, std::unique_ptr<TexCacheEntry>> TexCache;
+// Owns the cache entries. Exact CacheKey lookups go through a hash map, and the lookups by address
+// range (CLUT variants, invalidation, framebuffer overlap) through a coarse page index on the
+// address in the upper 32 bits of the key. The secondary cache is keyed by hashes instead, so it
+// skips the page index.
+class TexCache {
+public:
+	explicit TexCache(bool rangeIndex) : rangeIndex_(rangeIndex), index_(256) {}
+	~TexCache() {
+		clear();
+	}
+	TexCache(const TexCache &) = delete;
+	TexCache &operator=(const TexCache &) = delete;
+
+	TexCacheEntry *Get(u64 key) const {
+		return index_.GetOrNull(key);
+	}
+	// Takes ownership. An entry already stored under the key is deleted.
+	void Insert(u64 key, TexCacheEntry *entry);
+	// Deletes the entry.
+	void Erase(u64 key);
+	void clear();
+
+	size_t size() const {
+		return index_.size();
+	}
+
+	// func(TexCacheEntry *). Must not insert or erase.
+	template <typename F>
+	void ForEach(F func) const {
+		index_.Iterate([&](u64 key, TexCacheEntry *entry) {
+			func(entry);
+		});
+	}
+
+	// Visits entries whose key address is in [start, end), in no particular order. Must not insert or erase.
+	template <typename F>
+	void ForEachInRange(u32 start, u32 end, F func) const {
+		if (start >= end || pages_.empty())
+			return;
+		const u32 lastPage = PageOf(end - 1);
+		for (u32 page = PageOf(start); page <= lastPage; ++page) {
+			for (const PageItem &item : pages_[page]) {
+				const u32 addr = (u32)(item.key >> 32);
+				if (addr >= start && addr < end) {
+					func(item.entry);
+				}
+			}
+		}
+	}
+
+	// All CLUT variants of a texture.
+	template <typename F>
+	void ForEachAtAddress(u32 addr, F func) const {
+		addr &= 0x3FFFFFFF;
+		ForEachInRange(addr, addr + 1, func);
+	}
+
+	// Deletes the entries for which func(TexCacheEntry *) returns true.
+	template <typename F>
+	void EraseIf(F func) {
+		std::vector<u64> keys;
+		index_.Iterate([&](u64 key, TexCacheEntry *entry) {
+			if (func(entry))
+				keys.push_back(key);
+		});
+		for (u64 key : keys) {
+			Erase(key);
+		}
+	}
+
+private:
+	// 64KB pages up to 256MB covers scratchpad, VRAM and its mirrors, and RAM. Anything above shares the last page.
+	static const int PAGE_SHIFT = 16;
+	static const u32 NUM_PAGES = 0x10000000 >> PAGE_SHIFT;
+
+	struct PageItem {
+		u64 key;
+		TexCacheEntry *entry;
+	};
+
+	static u32 PageOf(u32 addr) {
+		return std::min(addr >> PAGE_SHIFT, NUM_PAGES - 1);
+	}
+
+	bool rangeIndex_;
+	DenseHashMap<u64, TexCacheEntry *> index_;
+	// Allocated on first insert.
+	std::vector<std::vector<PageItem>> pages_;
+};
 
 // Urgh.
 #ifdef IGNORE
@@ -328,6 +425,25 @@ struct BuildTexturePlan {
 	}
 };
 
+// Everything DecodeTextureLevel reads, so that a decode can run against a snapshot on a worker thread.
+struct TexDecodeSource {
+	const GPUgstate *state;
+	GETextureFormat format;
+	GEPaletteFormat clutformat;
+	u32 texaddr;
+	const u8 *texptr;
+	int bufw;
+	const u32 *clut;
+	const u32 *clutRaw;
+	bool clutAlphaLinear;
+	u16 clutAlphaLinearColor;
+	// Scratch space owned by the caller.
+	AlignedVector<u32, 16> *tmpBuf;
+	u32 *expandClut;
+};
+
+struct TexDecodeJob;
+
 class TextureCacheCommon {
 public:
 	TextureCacheCommon(Draw::DrawContext *draw, Draw2D *draw2D);
@@ -387,7 +503,7 @@ class TextureCacheCommon {
 	virtual void BindTexture(TexCacheEntry *entry) = 0;
 	virtual void Unbind() = 0;
 	virtual void ReleaseTexture(TexCacheEntry *entry, bool delete_them) = 0;
-	void DeleteTexture(TexCache::iterator it);
+	void DeleteTexture(u64 cachekey);
 	void Decimate(TexCacheEntry *exceptThisOne, bool forcePressure);  // forcePressure defaults to false.
 
 	void ApplyTextureFramebuffer(VirtualFramebuffer *framebuffer, GETextureFormat texFormat, RasterChannel channel);
@@ -397,12 +513,22 @@ class TextureCacheCommon {
 	virtual void BuildTexture(TexCacheEntry *const entry) = 0;
 	virtual void UpdateCurrentClut(GEPaletteFormat clutFormat, u32 clutBase, bool clutIndexIsSimple) = 0;
 	bool CheckFullHash(TexCacheEntry *entry, bool &doDelete);
+	u32 HashAndWatchTexture(TexCacheEntry *entry, int w, int h, bool swizzled);
 
 	virtual void BindAsClutTexture(Draw::Texture *tex, bool smooth) {}
 
 	CheckAlphaResult DecodeTextureLevel(u8 *out, int outPitch, GETextureFormat format, GEPaletteFormat clutformat, uint32_t texaddr, int level, int bufw, TexDecodeFlags flags);
-	void UnswizzleFromMem(u32 *dest, u32 destPitch, const u8 *texptr, u32 bufw, u32 height, u32 bytesPerPixel);
-	CheckAlphaResult ReadIndexedTex(u8 *out, int outPitch, int level, const u8 *texptr, int bytesPerIndex, int bufw, bool reverseColors, bool expandTo32Bit);
+	static CheckAlphaResult DecodeTextureLevel(u8 *out, int outPitch, const TexDecodeSource &src, int level, TexDecodeFlags flags);
+	static void UnswizzleFromMem(u32 *dest, u32 destPitch, const u8 *texptr, u32 bufw, u32 height, u32 bytesPerPixel);
+	static CheckAlphaResult ReadIndexedTex(u8 *out, int outPitch, int level, const u8 *texptr, int bytesPerIndex, const TexDecodeSource &src, bool reverseColors, bool expandTo32Bit);
+
+	// Async decode of changed textures (bTextureAsyncDecode.)
+	bool StartAsyncDecode(TexCacheEntry *entry);
+	TexDecodeJob *FindAsyncDecode(const TexCacheEntry *entry);
+	bool PollAsyncDecode(TexCacheEntry *entry);
+	void AbandonAsyncDecode(TexCacheEntry *entry);
+	void FinishAsyncDecode(TexCacheEntry *entry);
+	void ReapAsyncDecodes(bool waitAll);
 	ReplacedTexture *FindReplacement(TexCacheEntry *entry, int *w, int *h, int *d);
 	void PollReplacement(TexCacheEntry *entry, int *w, int *h, int *d);
 
@@ -444,6 +570,20 @@ class TextureCacheCommon {
 			return replacer.ComputeHash(addr, bufw, w, h, swizzled, format, entry->maxSeenV);
 		}
 
+		u32 sizeInRAM = QuickTexHashSize(bufw, h, swizzled, format, entry);
+		const u32 *checkp = (const u32 *)Memory::GetPointer(addr);
+
+		gpuStats.numTextureDataBytesHashed += sizeInRAM;
+
+		if (Memory::IsValidAddress(addr + sizeInRAM)) {
+			return StableQuickTexHash(checkp, sizeInRAM);
+		} else {
+			return 0;
+		}
+	}
+
+	// Bytes hashed by QuickTexHash, also covers what the replacer hashes.
+	static inline u32 QuickTexHashSize(int bufw, int h, bool swizzled, GETextureFormat format, const TexCacheEntry *entry) {
 		if (h == 512 && entry->maxSeenV < 512 && entry->maxSeenV != 0) {
 			h = (int)entry->maxSeenV;
 		}
@@ -459,15 +599,7 @@ class TextureCacheCommon {
 		} else {
 			sizeInRAM = (textureBitsPerPixel[format] * bufw * h) >> 3;
 		}
-		const u32 *checkp = (const u32 *)Memory::GetPointer(addr);
-
-		gpuStats.numTextureDataBytesHashed += sizeInRAM;
-
-		if (Memory::IsValidAddress(addr + sizeInRAM)) {
-			return StableQuickTexHash(checkp, sizeInRAM);
-		} else {
-			return 0;
-		}
+		return sizeInRAM;
 	}
 
 	static inline u32 MiniHash(const u32 *ptr) {
@@ -493,10 +625,10 @@ class TextureCacheCommon {
 	// TODO: Maybe vary by FPS...
 	double replacementFrameBudget_ = 0.5 / 60.0;
 
-	TexCache cache_;
+	TexCache cache_{ true };
 	u32 cacheSizeEstimate_ = 0;
 
-	TexCache secondCache_;
+	TexCache secondCache_{ false };
 	u32 secondCacheSizeEstimate_ = 0;
 
 	struct VideoInfo {
@@ -545,6 +677,12 @@ class TextureCacheCommon {
 	bool nextNeedsRebuild_;
 
 	u32 *expandClut_;
+
+	// Pending and finished async decodes. Never more than a handful.
+	std::vector<TexDecodeJob *> asyncDecodes_;
+	size_t asyncDecodeBytes_ = 0;
+
+	friend class TexDecodeTask;
 };
 
 inline bool TexCacheEntry::Matches(u16 dim2, u8 format2, u8 maxLevel2) const {
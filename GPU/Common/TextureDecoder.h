@@ -108,9 +108,9 @@ inline CheckAlphaResult CheckAlpha32Rect(const u32 *pixelData, int stride, int w
 }
 
 template <typename IndexT, typename ClutT>
-inline void DeIndexTexture(/*WRITEONLY*/ ClutT *dest, const IndexT *indexed, int length, const ClutT *clut, u32 *outAlphaSum) {
+inline void DeIndexTexture(/*WRITEONLY*/ ClutT *dest, const IndexT *indexed, int length, const ClutT *clut, u32 *outAlphaSum, const GPUgstate &state = gstate) {
 	// Usually, there is no special offset, mask, or shift.
-	const bool nakedIndex = gstate.isClutIndexSimple();
+	const bool nakedIndex = state.isClutIndexSimple();
 
 	ClutT alphaSum = (ClutT)(-1);
 
@@ -130,7 +130,7 @@ inline void DeIndexTexture(/*WRITEONLY*/ ClutT *dest, const IndexT *indexed, int
 		}
 	} else {
 		for (int i = 0; i < length; ++i) {
-			ClutT color = clut[gstate.transformClutIndex(*indexed++)];
+			ClutT color = clut[state.transformClutIndex(*indexed++)];
 			alphaSum &= color;
 			*dest++ = color;
 		}
@@ -146,9 +146,9 @@ inline void DeIndexTexture(/*WRITEONLY*/ ClutT *dest, const u32 texaddr, int len
 }
 
 template <typename ClutT>
-inline void DeIndexTexture4(/*WRITEONLY*/ ClutT *dest, const u8 *indexed, int length, const ClutT *clut, u32 *outAlphaSum) {
+inline void DeIndexTexture4(/*WRITEONLY*/ ClutT *dest, const u8 *indexed, int length, const ClutT *clut, u32 *outAlphaSum, const GPUgstate &state = gstate) {
 	// Usually, there is no special offset, mask, or shift.
-	const bool nakedIndex = gstate.isClutIndexSimple();
+	const bool nakedIndex = state.isClutIndexSimple();
 
 	ClutT alphaSum = (ClutT)(-1);
 	if (nakedIndex) {
@@ -170,8 +170,8 @@ inline void DeIndexTexture4(/*WRITEONLY*/ ClutT *dest, const u8 *indexed, int le
 	} else {
 		while (length >= 2) {
 			u8 index = *indexed++;
-			ClutT color0 = clut[gstate.transformClutIndex((index >> 0) & 0xf)];
-			ClutT color1 = clut[gstate.transformClutIndex((index >> 4) & 0xf)];
+			ClutT color0 = clut[state.transformClutIndex((index >> 0) & 0xf)];
+			ClutT color1 = clut[state.transformClutIndex((index >> 4) & 0xf)];
 			*dest++ = color0;
 			*dest++ = color1;
 			alphaSum &= color0 & color1;
@@ -179,7 +179,7 @@ inline void DeIndexTexture4(/*WRITEONLY*/ ClutT *dest, const u8 *indexed, int le
 		}
 		if (length) {
 			u8 index = *indexed++;
-			ClutT color0 = clut[gstate.transformClutIndex((index >> 0) & 0xf)];
+			ClutT color0 = clut[state.transformClutIndex((index >> 0) & 0xf)];
 			*dest = color0;
 			alphaSum &= color0;
 		}
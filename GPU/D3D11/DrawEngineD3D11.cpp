@@ -252,6 +252,7 @@ void DrawEngineD3D11::BeginFrame() {
 	pushInds_->Reset();
 
 	lastRenderStepId_ = -1;
+	DecimateTrackedVertexArrays();
 }
 
 // In D3D, we're synchronous and state carries over so all we reset here on a new step is the viewport/scissor.
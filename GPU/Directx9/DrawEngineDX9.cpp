@@ -227,6 +227,7 @@ static uint32_t SwapRB(uint32_t c) {
 
 void DrawEngineDX9::BeginFrame() {
 	lastRenderStepId_ = -1;
+	DecimateTrackedVertexArrays();
 }
 
 // In D3D, we're synchronous and state carries over so all we reset here on a new step is the viewport/scissor.
@@ -154,6 +154,7 @@ void DrawEngineGLES::BeginFrame() {
 	render_->BeginPushBuffer(frameData.pushVertex);
 
 	lastRenderStepId_ = -1;
+	DecimateTrackedVertexArrays();
 }
 
 void DrawEngineGLES::EndFrame() {
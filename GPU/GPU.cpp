@@ -29,6 +29,7 @@
 #endif
 #include "GPU/Vulkan/GPU_Vulkan.h"
 #include "GPU/Software/SoftGpu.h"
+#include "GPU/Null/GPU_Null.h"
 
 #if PPSSPP_API(D3D9)
 #include "GPU/Directx9/GPU_DX9.h"
@@ -108,6 +109,9 @@ bool GPU_Init(GraphicsContext *ctx, Draw::DrawContext *draw) {
 		SetGPU(new GPU_Vulkan(ctx, draw));
 		break;
 #endif
+	case GPUCORE_NULL:
+		SetGPU(new GPU_Null(ctx, draw));
+		break;
 	}
 
 	if (gpu && !gpu->IsStarted())
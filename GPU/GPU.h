@@ -81,11 +81,15 @@ struct GPUStatistics {
 		numListSyncs = 0;
 		numVertsSubmitted = 0;
 		numVertsDecoded = 0;
+		numVertexCacheLookups = 0;
+		numVertexCacheHits = 0;
+		numVertexCacheBytesSaved = 0;
 		numUncachedVertsDrawn = 0;
 		numTextureInvalidations = 0;
 		numTextureInvalidationsByFramebuffer = 0;
 		numTexturesHashed = 0;
 		numTextureDataBytesHashed = 0;
+		numTextureDataBytesHashSkipped = 0;
 		numFlushes = 0;
 		numBBOXJumps = 0;
 		numPlaneUpdates = 0;
@@ -105,6 +109,10 @@ struct GPUStatistics {
 		numBlockTransfers = 0;
 		numReplacerTrackedTex = 0;
 		numCachedReplacedTextures = 0;
+		numAsyncTexDecodes = 0;
+		numAsyncTexDecodesPending = 0;
+		numAsyncTexDecodeFallbacks = 0;
+		msAsyncTexDecode = 0;
 		msProcessingDisplayLists = 0;
 		vertexGPUCycles = 0;
 		otherGPUCycles = 0;
@@ -121,11 +129,15 @@ struct GPUStatistics {
 	int numPlaneUpdates;
 	int numVertsSubmitted;
 	int numVertsDecoded;
+	int numVertexCacheLookups;
+	int numVertexCacheHits;
+	int numVertexCacheBytesSaved;
 	int numUncachedVertsDrawn;
 	int numTextureInvalidations;
 	int numTextureInvalidationsByFramebuffer;
 	int numTexturesHashed;
 	int numTextureDataBytesHashed;
+	int numTextureDataBytesHashSkipped;
 	int numTexturesDecoded;
 	int numFramebufferEvaluations;
 	int numBlockingReadbacks;
@@ -142,6 +154,10 @@ struct GPUStatistics {
 	int numBlockTransfers;
 	int numReplacerTrackedTex;
 	int numCachedReplacedTextures;
+	int numAsyncTexDecodes;
+	int numAsyncTexDecodesPending;
+	int numAsyncTexDecodeFallbacks;
+	double msAsyncTexDecode;
 	double msProcessingDisplayLists;
 	int vertexGPUCycles;
 	int otherGPUCycles;
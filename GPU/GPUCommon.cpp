@@ -29,6 +29,7 @@
 #include "Core/CoreTiming.h"
 #include "Core/Debugger/MemBlockInfo.h"
 #include "Core/MemMap.h"
+#include "Core/MemMapBulk.h"
 #include "Core/Reporting.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HLE/sceKernelMemory.h"
@@ -1869,12 +1870,7 @@ bool GPUCommon::PerformMemoryCopy(u32 dest, u32 src, int size, GPUCopyFlag flags
 			// We use matching values in PerformReadbackToMemory/PerformWriteColorFromMemory.
 			// Since they're identical we don't need to copy.
 			if (dest != src) {
-				if (Memory::IsValidRange(dest, size) && Memory::IsValidRange(src, size)) {
-					memcpy(Memory::GetPointerWriteUnchecked(dest), Memory::GetPointerUnchecked(src), size);
-				}
-				if (MemBlockInfoDetailed(size)) {
-					NotifyMemInfoCopy(dest, src, size, "GPUMemcpy/");
-				}
+				Memory::Bulk::TryMove(dest, src, size, "GPUMemcpy/");
 			}
 		}
 		InvalidateCache(dest, size, GPU_INVALIDATE_HINT);
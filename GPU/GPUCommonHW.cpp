@@ -1750,11 +1750,13 @@ size_t GPUCommonHW::FormatGPUStatsCommon(char *buffer, size_t size) {
 		"DL processing time: %0.2f ms, %d drawsync, %d listsync\n"
 		"Draw: %d (%d dec, %d culled), flushes %d, clears %d, bbox jumps %d (%d updates)\n"
 		"Vertices: %d dec: %d drawn: %d\n"
+		"Vertex cache: %d/%d hits, %d kB decode saved\n"
 		"FBOs active: %d (evaluations: %d)\n"
-		"Textures: %d, dec: %d, invalidated: %d, hashed: %d kB\n"
+		"Textures: %d, dec: %d, invalidated: %d, hashed: %d kB (%d kB skipped)\n"
 		"readbacks %d (%d non-block), upload %d (cached %d), depal %d\n"
 		"block transfers: %d\n"
 		"replacer: tracks %d references, %d unique textures\n"
+		"Async tex decode: %d pending, %d started, %d sync, %0.2f ms\n"
 		"Cpy: depth %d, color %d, reint %d, blend %d, self %d\n"
 		"GPU cycles: %d (%0.1f per vertex)\n%s",
 		gpuStats.msProcessingDisplayLists * 1000.0f,
@@ -1770,12 +1772,16 @@ size_t GPUCommonHW::FormatGPUStatsCommon(char *buffer, size_t size) {
 		gpuStats.numVertsSubmitted,
 		gpuStats.numVertsDecoded,
 		gpuStats.numUncachedVertsDrawn,
+		gpuStats.numVertexCacheHits,
+		gpuStats.numVertexCacheLookups,
+		gpuStats.numVertexCacheBytesSaved / 1024,
 		(int)framebufferManager_->NumVFBs(),
 		gpuStats.numFramebufferEvaluations,
 		(int)textureCache_->NumLoadedTextures(),
 		gpuStats.numTexturesDecoded,
 		gpuStats.numTextureInvalidations,
 		gpuStats.numTextureDataBytesHashed / 1024,
+		gpuStats.numTextureDataBytesHashSkipped / 1024,
 		gpuStats.numBlockingReadbacks,
 		gpuStats.numReadbacks,
 		gpuStats.numUploads,
@@ -1784,6 +1790,10 @@ size_t GPUCommonHW::FormatGPUStatsCommon(char *buffer, size_t size) {
 		gpuStats.numBlockTransfers,
 		gpuStats.numReplacerTrackedTex,
 		gpuStats.numCachedReplacedTextures,
+		gpuStats.numAsyncTexDecodesPending,
+		gpuStats.numAsyncTexDecodes,
+		gpuStats.numAsyncTexDecodeFallbacks,
+		gpuStats.msAsyncTexDecode,
 		gpuStats.numDepthCopies,
 		gpuStats.numColorCopies,
 		gpuStats.numReinterpretCopies,
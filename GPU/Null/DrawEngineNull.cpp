@@ -0,0 +1,428 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+
+#include <algorithm>
+
+#include "Common/Log.h"
+#include "Common/Profiler/Profiler.h"
+
+#include "Core/MemMap.h"
+#include "Core/System.h"
+#include "Core/Config.h"
+
+#include "GPU/Math3D.h"
+#include "GPU/GPUState.h"
+#include "GPU/ge_constants.h"
+
+#include "GPU/Common/SplineCommon.h"
+#include "GPU/Common/TransformCommon.h"
+#include "GPU/Common/VertexDecoderCommon.h"
+#include "GPU/Common/SoftwareTransformCommon.h"
+#include "GPU/Debugger/Debugger.h"
+#include "GPU/Null/FramebufferManagerNull.h"
+#include "GPU/Null/TextureCacheNull.h"
+#include "GPU/Null/DrawEngineNull.h"
+#include "GPU/Null/ShaderManagerNull.h"
+
+static const Draw::Primitive nullPrim[8] = {
+	Draw::Primitive::TRIANGLE_LIST,  // Points are expanded to triangles.
+	Draw::Primitive::TRIANGLE_LIST,  // Lines are expanded to triangles too.
+	Draw::Primitive::TRIANGLE_LIST,  // Lines are expanded to triangles too.
+	Draw::Primitive::TRIANGLE_LIST,
+	Draw::Primitive::TRIANGLE_STRIP,
+	Draw::Primitive::TRIANGLE_LIST,  // Fans are converted by the index generator.
+	Draw::Primitive::TRIANGLE_LIST,  // Rectangles are expanded to triangles.
+};
+
+enum {
+	VERTEX_PUSH_SIZE = 1024 * 1024 * 16,
+	INDEX_PUSH_SIZE = 1024 * 1024 * 4,
+};
+
+// thin3d has no 16-bit normalized vertex formats. The null context only looks at sizes,
+// so same-sized float formats stand in for them.
+static const Draw::DataFormat decFmtToDataFormat[] = {
+	Draw::DataFormat::UNDEFINED,  // DEC_NONE
+	Draw::DataFormat::R32_FLOAT,  // DEC_FLOAT_1
+	Draw::DataFormat::R32G32_FLOAT,  // DEC_FLOAT_2
+	Draw::DataFormat::R32G32B32_FLOAT,  // DEC_FLOAT_3
+	Draw::DataFormat::R32G32B32A32_FLOAT,  // DEC_FLOAT_4
+	Draw::DataFormat::R8G8B8A8_SNORM,  // DEC_S8_3
+	Draw::DataFormat::R16G16B16A16_FLOAT,  // DEC_S16_3
+	Draw::DataFormat::R8G8B8A8_UNORM,  // DEC_U8_1
+	Draw::DataFormat::R8G8B8A8_UNORM,  // DEC_U8_2
+	Draw::DataFormat::R8G8B8A8_UNORM,  // DEC_U8_3
+	Draw::DataFormat::R8G8B8A8_UNORM,  // DEC_U8_4
+	Draw::DataFormat::R16G16_FLOAT,  // DEC_U16_1
+	Draw::DataFormat::R16G16_FLOAT,  // DEC_U16_2
+	Draw::DataFormat::R16G16B16A16_FLOAT,  // DEC_U16_3
+	Draw::DataFormat::R16G16B16A16_FLOAT,  // DEC_U16_4
+};
+
+static const SamplerDef samplers[3] = {
+	{ 0, "tex" },
+	{ 1, "fbotex" },
+	{ 2, "pal" },
+};
+
+static void VertexAttribSetup(std::vector<Draw::AttributeDesc> &attributes, u8 fmt, u8 offset, PspAttributeLocation location) {
+	_dbg_assert_(fmt != DEC_NONE && fmt < ARRAY_SIZE(decFmtToDataFormat));
+	attributes.push_back(Draw::AttributeDesc{ (int)location, decFmtToDataFormat[fmt], offset });
+}
+
+DrawEngineNull::DrawEngineNull(Draw::DrawContext *draw)
+	: draw_(draw),
+		inputLayoutMap_(32),
+		pipelineCache_(64),
+		blendCache_(32),
+		depthStencilCache_(64),
+		rasterCache_(4) {
+	decOptions_.expandAllWeightsToFloat = true;
+	decOptions_.expand8BitNormalsToFloat = true;
+
+	indexGen.Setup(decIndex_);
+
+	InitDeviceObjects();
+}
+
+DrawEngineNull::~DrawEngineNull() {
+	DestroyDeviceObjects();
+}
+
+void DrawEngineNull::InitDeviceObjects() {
+	vertexBuffer_ = draw_->CreateBuffer(VERTEX_PUSH_SIZE, Draw::BufferUsageFlag::DYNAMIC | Draw::BufferUsageFlag::VERTEXDATA);
+	indexBuffer_ = draw_->CreateBuffer(INDEX_PUSH_SIZE, Draw::BufferUsageFlag::DYNAMIC | Draw::BufferUsageFlag::INDEXDATA);
+	vertexBufferPos_ = 0;
+	indexBufferPos_ = 0;
+
+	draw_->SetInvalidationCallback(std::bind(&DrawEngineNull::Invalidate, this, std::placeholders::_1));
+}
+
+void DrawEngineNull::ClearPipelines() {
+	pipelineCache_.Iterate([&](const PipelineKey &key, Draw::Pipeline *pipeline) {
+		if (pipeline)
+			pipeline->Release();
+	});
+	pipelineCache_.Clear();
+	inputLayoutMap_.Iterate([&](const uint32_t &key, Draw::InputLayout *il) {
+		il->Release();
+	});
+	inputLayoutMap_.Clear();
+}
+
+void DrawEngineNull::NotifyConfigChanged() {
+	DrawEngineCommon::NotifyConfigChanged();
+	ClearPipelines();
+}
+
+void DrawEngineNull::DestroyDeviceObjects() {
+	if (draw_) {
+		draw_->SetInvalidationCallback(InvalidationCallback());
+	}
+
+	ClearTrackedVertexArrays();
+	ClearPipelines();
+	if (vertexBuffer_) {
+		vertexBuffer_->Release();
+		vertexBuffer_ = nullptr;
+	}
+	if (indexBuffer_) {
+		indexBuffer_->Release();
+		indexBuffer_ = nullptr;
+	}
+	depthStencilCache_.Iterate([&](const uint64_t &key, Draw::DepthStencilState *ds) {
+		ds->Release();
+	});
+	depthStencilCache_.Clear();
+	blendCache_.Iterate([&](const uint64_t &key, Draw::BlendState *bs) {
+		bs->Release();
+	});
+	blendCache_.Clear();
+	rasterCache_.Iterate([&](const uint32_t &key, Draw::RasterState *rs) {
+		rs->Release();
+	});
+	rasterCache_.Clear();
+}
+
+Draw::InputLayout *DrawEngineNull::SetupDecFmtForDraw(const DecVtxFormat &decFmt) {
+	Draw::InputLayout *inputLayout;
+	if (inputLayoutMap_.Get(decFmt.id, &inputLayout)) {
+		return inputLayout;
+	}
+
+	Draw::InputLayoutDesc desc;
+	desc.stride = decFmt.stride;
+	if (decFmt.w0fmt != 0)
+		VertexAttribSetup(desc.attributes, decFmt.w0fmt, decFmt.w0off, PspAttributeLocation::W1);
+	if (decFmt.w1fmt != 0)
+		VertexAttribSetup(desc.attributes, decFmt.w1fmt, decFmt.w1off, PspAttributeLocation::W2);
+	if (decFmt.uvfmt != 0)
+		VertexAttribSetup(desc.attributes, decFmt.uvfmt, decFmt.uvoff, PspAttributeLocation::TEXCOORD);
+	if (decFmt.c0fmt != 0)
+		VertexAttribSetup(desc.attributes, decFmt.c0fmt, decFmt.c0off, PspAttributeLocation::COLOR0);
+	if (decFmt.c1fmt != 0)
+		VertexAttribSetup(desc.attributes, decFmt.c1fmt, decFmt.c1off, PspAttributeLocation::COLOR1);
+	if (decFmt.nrmfmt != 0)
+		VertexAttribSetup(desc.attributes, decFmt.nrmfmt, decFmt.nrmoff, PspAttributeLocation::NORMAL);
+	// Position is always there.
+	VertexAttribSetup(desc.attributes, DecVtxFormat::PosFmt(), decFmt.posoff, PspAttributeLocation::POSITION);
+
+	inputLayout = draw_->CreateInputLayout(desc);
+	inputLayoutMap_.Insert(decFmt.id, inputLayout);
+	return inputLayout;
+}
+
+Draw::Pipeline *DrawEngineNull::GetPipeline(int prim, NullVertexShader *vshader, NullFragmentShader *fshader, Draw::InputLayout *inputLayout) {
+	PipelineKey key{ vshader, fshader, inputLayout, blendState_, depthStencilState_, rasterState_, (uint64_t)prim };
+	Draw::Pipeline *pipeline;
+	if (pipelineCache_.Get(key, &pipeline)) {
+		return pipeline;
+	}
+
+	pipeline = nullptr;
+	if (!vshader->Failed() && !fshader->Failed()) {
+		Draw::PipelineDesc desc{
+			nullPrim[prim],
+			{ vshader->GetShader(), fshader->GetShader() },
+			inputLayout,
+			depthStencilState_,
+			blendState_,
+			rasterState_,
+			&ShaderManagerNull::baseUniformDesc,
+			samplers,
+		};
+		pipeline = draw_->CreateGraphicsPipeline(desc, "GE");
+	}
+	// Failures are cached too, so we don't keep retrying.
+	pipelineCache_.Insert(key, pipeline);
+	return pipeline;
+}
+
+void DrawEngineNull::DrawBuffers(const void *verts, int vertsSize, const u16 *inds, int vertexCount, bool indexed) {
+	if (vertexBufferPos_ + vertsSize > VERTEX_PUSH_SIZE) {
+		vertexBufferPos_ = 0;
+	}
+	draw_->UpdateBuffer(vertexBuffer_, (const uint8_t *)verts, vertexBufferPos_, vertsSize, Draw::UPDATE_DISCARD);
+	draw_->BindVertexBuffer(vertexBuffer_, (int)vertexBufferPos_);
+	vertexBufferPos_ += (vertsSize + 15) & ~15;
+
+	if (indexed) {
+		int indsSize = vertexCount * sizeof(u16);
+		if (indexBufferPos_ + indsSize > INDEX_PUSH_SIZE) {
+			indexBufferPos_ = 0;
+		}
+		draw_->UpdateBuffer(indexBuffer_, (const uint8_t *)inds, indexBufferPos_, indsSize, Draw::UPDATE_DISCARD);
+		draw_->BindIndexBuffer(indexBuffer_, (int)indexBufferPos_);
+		indexBufferPos_ += (indsSize + 15) & ~15;
+		draw_->DrawIndexed(vertexCount, 0);
+	} else {
+		draw_->Draw(vertexCount, 0);
+	}
+}
+
+void DrawEngineNull::BeginFrame() {
+	vertexBufferPos_ = 0;
+	indexBufferPos_ = 0;
+	DecimateTrackedVertexArrays();
+}
+
+// Like D3D11, the state carries over, so all we reset here on a new step is the viewport/scissor.
+void DrawEngineNull::Invalidate(InvalidationCallbackFlags flags) {
+	if (flags & InvalidationCallbackFlags::RENDER_PASS_STATE) {
+		gstate_c.Dirty(DIRTY_VIEWPORTSCISSOR_STATE | DIRTY_TEXTURE_IMAGE | DIRTY_TEXTURE_PARAMS);
+	}
+}
+
+// The inline wrapper in the header checks for numDrawCalls_ == 0
+void DrawEngineNull::DoFlush() {
+	bool textureNeedsApply = false;
+	if (gstate_c.IsDirty(DIRTY_TEXTURE_IMAGE | DIRTY_TEXTURE_PARAMS) && !gstate.isModeClear() && gstate.isTextureMapEnabled()) {
+		textureCache_->SetTexture();
+		gstate_c.Clean(DIRTY_TEXTURE_IMAGE | DIRTY_TEXTURE_PARAMS);
+		textureNeedsApply = true;
+	} else if (gstate.getTextureAddress(0) == (gstate.getFrameBufRawAddress() | 0x04000000)) {
+		// This catches the case of clearing a texture. (#10957)
+		gstate_c.Dirty(DIRTY_TEXTURE_IMAGE);
+	}
+
+	GEPrimitiveType prim = prevPrim_;
+
+	// Always use software for flat shading to fix the provoking index.
+	bool tess = gstate_c.submitType == SubmitType::HW_BEZIER || gstate_c.submitType == SubmitType::HW_SPLINE;
+	bool useHWTransform = CanUseHardwareTransform(prim) && (tess || gstate.getShadeMode() != GE_SHADE_FLAT);
+
+	if (useHWTransform) {
+		int vertexCount;
+		int maxIndex;
+		bool useElements;
+		DecodeVerts(decoded_);
+		DecodeIndsAndGetData(&prim, &vertexCount, &maxIndex, &useElements, false);
+		gpuStats.numUncachedVertsDrawn += vertexCount;
+
+		bool hasColor = (lastVType_ & GE_VTYPE_COL_MASK) != GE_VTYPE_COL_NONE;
+		if (gstate.isModeThrough()) {
+			gstate_c.vertexFullAlpha = gstate_c.vertexFullAlpha && (hasColor || gstate.getMaterialAmbientA() == 255);
+		} else {
+			gstate_c.vertexFullAlpha = gstate_c.vertexFullAlpha && ((hasColor && (gstate.materialupdate & 1)) || gstate.getMaterialAmbientA() == 255) && (!gstate.isLightingEnabled() || gstate.getAmbientA() == 255);
+		}
+
+		if (textureNeedsApply) {
+			textureCache_->ApplyTexture();
+		}
+
+		// Need to ApplyDrawState after ApplyTexture because depal can launch a render pass and that wrecks the state.
+		ApplyDrawState(prim);
+		ApplyDrawStateLate(true, dynState_.stencilRef);
+
+		NullVertexShader *vshader;
+		NullFragmentShader *fshader;
+		shaderManager_->GetShaders(prim, dec_, &vshader, &fshader, pipelineState_, useHWTransform, useHWTessellation_, decOptions_.expandAllWeightsToFloat, decOptions_.applySkinInDecode);
+		Draw::InputLayout *inputLayout = SetupDecFmtForDraw(dec_->GetDecVtxFmt());
+		Draw::Pipeline *pipeline = GetPipeline(prim, vshader, fshader, inputLayout);
+		shaderManager_->UpdateUniforms(framebufferManager_->UseBufferedRendering());
+		if (pipeline) {
+			draw_->BindPipeline(pipeline);
+			shaderManager_->BindUniforms();
+			DrawBuffers(decoded_, numDecodedVerts_ * dec_->GetDecVtxFmt().stride, decIndex_, vertexCount, useElements);
+		}
+	} else {
+		PROFILE_THIS_SCOPE("soft");
+		if (!decOptions_.applySkinInDecode) {
+			decOptions_.applySkinInDecode = true;
+			lastVType_ |= (1 << 26);
+			dec_ = GetVertexDecoder(lastVType_);
+		}
+		DecodeVerts(decoded_);
+		int vertexCount = DecodeInds();
+
+		bool hasColor = (lastVType_ & GE_VTYPE_COL_MASK) != GE_VTYPE_COL_NONE;
+		if (gstate.isModeThrough()) {
+			gstate_c.vertexFullAlpha = gstate_c.vertexFullAlpha && (hasColor || gstate.getMaterialAmbientA() == 255);
+		} else {
+			gstate_c.vertexFullAlpha = gstate_c.vertexFullAlpha && ((hasColor && (gstate.materialupdate & 1)) || gstate.getMaterialAmbientA() == 255) && (!gstate.isLightingEnabled() || gstate.getAmbientA() == 255);
+		}
+
+		gpuStats.numUncachedVertsDrawn += vertexCount;
+		prim = IndexGenerator::GeneralPrim((GEPrimitiveType)drawInds_[0].prim);
+
+		u16 *inds = decIndex_;
+		SoftwareTransformResult result{};
+		SoftwareTransformParams params{};
+		params.decoded = decoded_;
+		params.transformed = transformed_;
+		params.transformedExpanded = transformedExpanded_;
+		params.fbman = framebufferManager_;
+		params.texCache = textureCache_;
+		params.allowClear = true;
+		params.allowSeparateAlphaClear = false;
+		params.provokeFlatFirst = true;
+		params.flippedY = false;
+		params.usesHalfZ = true;
+
+		// We need correct viewport values in gstate_c already.
+		if (gstate_c.IsDirty(DIRTY_VIEWPORTSCISSOR_STATE)) {
+			ViewportAndScissor vpAndScissor;
+			ConvertViewportAndScissor(framebufferManager_->UseBufferedRendering(),
+				framebufferManager_->GetRenderWidth(), framebufferManager_->GetRenderHeight(),
+				framebufferManager_->GetTargetBufferWidth(), framebufferManager_->GetTargetBufferHeight(),
+				vpAndScissor);
+			UpdateCachedViewportState(vpAndScissor);
+		}
+
+		SoftwareTransform swTransform(params);
+
+		const Lin::Vec3 trans(gstate_c.vpXOffset, -gstate_c.vpYOffset, gstate_c.vpZOffset * 0.5f + 0.5f);
+		const Lin::Vec3 scale(gstate_c.vpWidthScale, -gstate_c.vpHeightScale, gstate_c.vpDepthScale * 0.5f);
+		swTransform.SetProjMatrix(gstate.projMatrix, gstate_c.vpWidth < 0, gstate_c.vpHeight < 0, trans, scale);
+
+		swTransform.Transform(prim, dec_->VertexType(), dec_->GetDecVtxFmt(), numDecodedVerts_, &result);
+		if (result.action == SW_CLEAR && everUsedEqualDepth_ && gstate.isClearModeDepthMask() && result.depth > 0.0f && result.depth < 1.0f)
+			result.action = SW_NOT_READY;
+
+		if (textureNeedsApply) {
+			gstate_c.pixelMapped = result.pixelMapped;
+			textureCache_->ApplyTexture();
+			gstate_c.pixelMapped = false;
+		}
+
+		ApplyDrawState(prim);
+
+		if (result.action == SW_NOT_READY)
+			swTransform.BuildDrawingParams(prim, vertexCount, dec_->VertexType(), inds, RemainingIndices(inds), numDecodedVerts_, VERTEX_BUFFER_MAX, &result);
+		if (result.setSafeSize)
+			framebufferManager_->SetSafeSize(result.safeWidth, result.safeHeight);
+
+		ApplyDrawStateLate(result.setStencil, result.stencilValue);
+
+		if (result.action == SW_DRAW_PRIMITIVES) {
+			NullVertexShader *vshader;
+			NullFragmentShader *fshader;
+			shaderManager_->GetShaders(prim, dec_, &vshader, &fshader, pipelineState_, false, false, decOptions_.expandAllWeightsToFloat, true);
+
+			Draw::InputLayout *inputLayout;
+			if (!inputLayoutMap_.Get(0xFFFFFFFF, &inputLayout)) {
+				Draw::InputLayoutDesc desc;
+				desc.stride = sizeof(TransformedVertex);
+				VertexAttribSetup(desc.attributes, DEC_FLOAT_4, offsetof(TransformedVertex, pos), PspAttributeLocation::POSITION);
+				VertexAttribSetup(desc.attributes, DEC_FLOAT_3, offsetof(TransformedVertex, uv), PspAttributeLocation::TEXCOORD);
+				VertexAttribSetup(desc.attributes, DEC_U8_4, offsetof(TransformedVertex, color0), PspAttributeLocation::COLOR0);
+				VertexAttribSetup(desc.attributes, DEC_U8_4, offsetof(TransformedVertex, color1), PspAttributeLocation::COLOR1);
+				VertexAttribSetup(desc.attributes, DEC_FLOAT_1, offsetof(TransformedVertex, fog), PspAttributeLocation::NORMAL);
+				inputLayout = draw_->CreateInputLayout(desc);
+				inputLayoutMap_.Insert(0xFFFFFFFF, inputLayout);
+			}
+
+			Draw::Pipeline *pipeline = GetPipeline(prim, vshader, fshader, inputLayout);
+			shaderManager_->UpdateUniforms(framebufferManager_->UseBufferedRendering());
+			if (pipeline) {
+				draw_->BindPipeline(pipeline);
+				shaderManager_->BindUniforms();
+				DrawBuffers(result.drawBuffer, numDecodedVerts_ * sizeof(TransformedVertex), inds, result.drawNumTrans, result.drawIndexed);
+			}
+		} else if (result.action == SW_CLEAR) {
+			u32 clearColor = result.color;
+			float clearDepth = result.depth;
+
+			uint32_t clearFlag = 0;
+
+			if (gstate.isClearModeColorMask()) clearFlag |= Draw::FBChannel::FB_COLOR_BIT;
+			if (gstate.isClearModeAlphaMask()) clearFlag |= Draw::FBChannel::FB_STENCIL_BIT;
+			if (gstate.isClearModeDepthMask()) clearFlag |= Draw::FBChannel::FB_DEPTH_BIT;
+
+			if (clearFlag & Draw::FBChannel::FB_COLOR_BIT) {
+				framebufferManager_->SetColorUpdated(gstate_c.skipDrawReason);
+			}
+
+			uint8_t clearStencil = clearColor >> 24;
+			draw_->Clear(clearFlag, clearColor, clearDepth, clearStencil);
+
+			if (gstate_c.Use(GPU_USE_CLEAR_RAM_HACK) && gstate.isClearModeColorMask() && (gstate.isClearModeAlphaMask() || gstate_c.framebufFormat == GE_FORMAT_565)) {
+				int scissorX1 = gstate.getScissorX1();
+				int scissorY1 = gstate.getScissorY1();
+				int scissorX2 = gstate.getScissorX2() + 1;
+				int scissorY2 = gstate.getScissorY2() + 1;
+				framebufferManager_->ApplyClearToMemory(scissorX1, scissorY1, scissorX2, scissorY2, clearColor);
+			}
+		}
+		decOptions_.applySkinInDecode = g_Config.bSoftwareSkinning;
+	}
+
+	ResetAfterDrawInline();
+	framebufferManager_->SetColorUpdated(gstate_c.skipDrawReason);
+	GPUDebug::NotifyDraw();
+}
@@ -0,0 +1,142 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+
+#pragma once
+
+#include "Common/Data/Collections/Hashmaps.h"
+#include "Common/GPU/thin3d.h"
+#include "GPU/GPUState.h"
+#include "GPU/Common/GPUDebugInterface.h"
+#include "GPU/Common/IndexGenerator.h"
+#include "GPU/Common/VertexDecoderCommon.h"
+#include "GPU/Common/DrawEngineCommon.h"
+#include "GPU/Common/GPUStateUtils.h"
+#include "GPU/Null/StateMappingNull.h"
+
+struct DecVtxFormat;
+
+class NullVertexShader;
+class NullFragmentShader;
+class ShaderManagerNull;
+class TextureCacheNull;
+class FramebufferManagerNull;
+
+// Handles transform, lighting and drawing, the same way the D3D11 backend does,
+// but everything goes through thin3d so it can run on the null context.
+class DrawEngineNull : public DrawEngineCommon {
+public:
+	DrawEngineNull(Draw::DrawContext *draw);
+	~DrawEngineNull();
+
+	void DeviceLost() override { draw_ = nullptr; }
+	void DeviceRestore(Draw::DrawContext *draw) override { draw_ = draw; }
+
+	void SetShaderManager(ShaderManagerNull *shaderManager) {
+		shaderManager_ = shaderManager;
+	}
+	void SetTextureCache(TextureCacheNull *textureCache) {
+		textureCache_ = textureCache;
+	}
+	void SetFramebufferManager(FramebufferManagerNull *fbManager) {
+		framebufferManager_ = fbManager;
+	}
+	void InitDeviceObjects();
+	void DestroyDeviceObjects();
+
+	void BeginFrame();
+
+	// So that this can be inlined
+	void Flush() {
+		if (!numDrawVerts_)
+			return;
+		DoFlush();
+	}
+
+	void FinishDeferred() {
+		if (!numDrawVerts_)
+			return;
+		DecodeVerts(decoded_);
+	}
+
+	void DispatchFlush() override {
+		if (!numDrawVerts_)
+			return;
+		Flush();
+	}
+
+	void NotifyConfigChanged() override;
+
+	void ClearPipelines();
+
+protected:
+	// No tessellation data transfer, splines and beziers are always tessellated on the CPU.
+	bool UpdateUseHWTessellation(bool enabled) const override { return false; }
+
+private:
+	void Invalidate(InvalidationCallbackFlags flags);
+
+	void DoFlush();
+
+	void ApplyDrawState(int prim);
+	void ApplyDrawStateLate(bool applyStencilRef, uint8_t stencilRef);
+
+	Draw::InputLayout *SetupDecFmtForDraw(const DecVtxFormat &decFmt);
+	Draw::Pipeline *GetPipeline(int prim, NullVertexShader *vshader, NullFragmentShader *fshader, Draw::InputLayout *inputLayout);
+	void DrawBuffers(const void *verts, int vertsSize, const u16 *inds, int vertexCount, bool indexed);
+
+	Draw::DrawContext *draw_;
+
+	// Must stay free of padding, it's hashed and compared as raw bytes.
+	struct PipelineKey {
+		NullVertexShader *vshader;
+		NullFragmentShader *fshader;
+		Draw::InputLayout *inputLayout;
+		Draw::BlendState *blend;
+		Draw::DepthStencilState *depthStencil;
+		Draw::RasterState *raster;
+		uint64_t prim;
+	};
+
+	// Keyed on DecVtxFormat::id, 0xFFFFFFFF is TransformedVertex.
+	DenseHashMap<uint32_t, Draw::InputLayout *> inputLayoutMap_;
+	DenseHashMap<PipelineKey, Draw::Pipeline *> pipelineCache_;
+
+	// Other
+	ShaderManagerNull *shaderManager_ = nullptr;
+	TextureCacheNull *textureCache_ = nullptr;
+	FramebufferManagerNull *framebufferManager_ = nullptr;
+
+	Draw::Buffer *vertexBuffer_ = nullptr;
+	Draw::Buffer *indexBuffer_ = nullptr;
+	size_t vertexBufferPos_ = 0;
+	size_t indexBufferPos_ = 0;
+
+	// thin3d state object caches.
+	DenseHashMap<uint64_t, Draw::BlendState *> blendCache_;
+	DenseHashMap<uint64_t, Draw::DepthStencilState *> depthStencilCache_;
+	DenseHashMap<uint32_t, Draw::RasterState *> rasterCache_;
+
+	// Keep the state objects between ApplyDrawState and pipeline lookup.
+	Draw::BlendState *blendState_ = nullptr;
+	Draw::DepthStencilState *depthStencilState_ = nullptr;
+	Draw::RasterState *rasterState_ = nullptr;
+
+	// State keys
+	NullStateKeys keys_{};
+	NullDynamicState dynState_{};
+};
@@ -0,0 +1,147 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+
+#include <string>
+
+#include "Common/Log.h"
+#include "Common/GraphicsContext.h"
+#include "Common/Profiler/Profiler.h"
+#include "Core/Config.h"
+#include "Core/System.h"
+
+#include "GPU/GPUState.h"
+#include "GPU/ge_constants.h"
+
+#include "GPU/Common/FramebufferManagerCommon.h"
+#include "GPU/Null/ShaderManagerNull.h"
+#include "GPU/Null/GPU_Null.h"
+#include "GPU/Null/FramebufferManagerNull.h"
+#include "GPU/Null/DrawEngineNull.h"
+#include "GPU/Null/TextureCacheNull.h"
+
+GPU_Null::GPU_Null(GraphicsContext *gfxCtx, Draw::DrawContext *draw)
+	: GPUCommonHW(gfxCtx, draw), drawEngine_(draw) {
+	shaderManagerNull_ = new ShaderManagerNull(draw);
+	framebufferManagerNull_ = new FramebufferManagerNull(draw);
+	framebufferManager_ = framebufferManagerNull_;
+	textureCacheNull_ = new TextureCacheNull(draw, framebufferManager_->GetDraw2D());
+	textureCache_ = textureCacheNull_;
+	drawEngineCommon_ = &drawEngine_;
+	shaderManager_ = shaderManagerNull_;
+	drawEngine_.SetShaderManager(shaderManagerNull_);
+	drawEngine_.SetTextureCache(textureCacheNull_);
+	drawEngine_.SetFramebufferManager(framebufferManagerNull_);
+	drawEngine_.Init();
+	framebufferManagerNull_->SetTextureCache(textureCacheNull_);
+	framebufferManagerNull_->SetShaderManager(shaderManagerNull_);
+	framebufferManagerNull_->SetDrawEngine(&drawEngine_);
+	framebufferManagerNull_->Init(msaaLevel_);
+	textureCacheNull_->SetFramebufferManager(framebufferManagerNull_);
+	textureCacheNull_->SetShaderManager(shaderManagerNull_);
+
+	// Sanity check gstate
+	if ((int *)&gstate.transferstart - (int *)&gstate != 0xEA) {
+		ERROR_LOG(G3D, "gstate has drifted out of sync!");
+	}
+
+	UpdateCmdInfo();
+	gstate_c.SetUseFlags(CheckGPUFeatures());
+
+	BuildReportingInfo();
+
+	// Some of our defaults are different from hw defaults, let's assert them.
+	// We restore each frame anyway, but here is convenient for tests.
+	textureCache_->NotifyConfigChanged();
+}
+
+GPU_Null::~GPU_Null() {
+}
+
+u32 GPU_Null::CheckGPUFeatures() const {
+	u32 features = GPUCommonHW::CheckGPUFeatures();
+
+	// Keep the depth math the same as the D3D11 path, the null context has no inverse Z either.
+	features |= GPU_USE_ACCURATE_DEPTH;
+
+	features |= GPU_USE_TEXTURE_FLOAT;
+	features |= GPU_USE_INSTANCE_RENDERING;
+	features |= GPU_USE_TEXTURE_LOD_CONTROL;
+
+	uint32_t fmt4444 = draw_->GetDataFormatSupport(Draw::DataFormat::A4R4G4B4_UNORM_PACK16);
+	uint32_t fmt1555 = draw_->GetDataFormatSupport(Draw::DataFormat::A1R5G5B5_UNORM_PACK16);
+	uint32_t fmt565 = draw_->GetDataFormatSupport(Draw::DataFormat::R5G6B5_UNORM_PACK16);
+	if ((fmt4444 & Draw::FMT_TEXTURE) && (fmt565 & Draw::FMT_TEXTURE) && (fmt1555 & Draw::FMT_TEXTURE)) {
+		features |= GPU_USE_16BIT_FORMATS;
+	}
+
+	return CheckGPUFeaturesLate(features);
+}
+
+void GPU_Null::DeviceLost() {
+	draw_->Invalidate(InvalidationFlags::CACHED_RENDER_STATE);
+	// Pipelines point at the shaders, so they have to go together.
+	drawEngine_.ClearPipelines();
+	shaderManager_->ClearShaders();
+	textureCache_->Clear(false);
+
+	GPUCommonHW::DeviceLost();
+}
+
+void GPU_Null::DeviceRestore(Draw::DrawContext *draw) {
+	GPUCommonHW::DeviceRestore(draw);
+	// Nothing needed.
+}
+
+void GPU_Null::BeginHostFrame() {
+	GPUCommonHW::BeginHostFrame();
+
+	textureCache_->StartFrame();
+	drawEngine_.BeginFrame();
+
+	shaderManager_->DirtyLastShader();
+
+	framebufferManager_->BeginFrame();
+	gstate_c.Dirty(DIRTY_PROJTHROUGHMATRIX);
+
+	if (gstate_c.useFlagsChanged) {
+		// This most likely means that saw equal depth changed.
+		WARN_LOG(G3D, "Shader use flags changed, clearing all shaders and depth buffers");
+		drawEngine_.ClearPipelines();
+		shaderManager_->ClearShaders();
+		framebufferManager_->ClearAllDepthBuffers();
+		gstate_c.useFlagsChanged = false;
+	}
+}
+
+void GPU_Null::FinishDeferred() {
+	// This finishes reading any vertex data that is pending.
+	drawEngine_.FinishDeferred();
+}
+
+void GPU_Null::GetStats(char *buffer, size_t bufsize) {
+	size_t offset = FormatGPUStatsCommon(buffer, bufsize);
+	buffer += offset;
+	bufsize -= offset;
+	if ((int)bufsize < 0)
+		return;
+	snprintf(buffer, bufsize,
+		"Vertex, Fragment shaders loaded: %d, %d\n",
+		shaderManagerNull_->GetNumVertexShaders(),
+		shaderManagerNull_->GetNumFragmentShaders()
+	);
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "GPU/GPUCommonHW.h"
+#include "GPU/Null/DrawEngineNull.h"
+#include "GPU/Common/VertexDecoderCommon.h"
+
+class FramebufferManagerNull;
+class ShaderManagerNull;
+class TextureCacheNull;
+
+// Full hardware-style GPU core that only talks to thin3d. Paired with the null draw context,
+// it runs the whole GE pipeline (decoding, state mapping, texture and framebuffer management)
+// without a real graphics API, which is what headless and benchmark runs want.
+class GPU_Null : public GPUCommonHW {
+public:
+	GPU_Null(GraphicsContext *gfxCtx, Draw::DrawContext *draw);
+	~GPU_Null();
+
+	u32 CheckGPUFeatures() const override;
+
+	void GetStats(char *buffer, size_t bufsize) override;
+	void DeviceLost() override;
+	void DeviceRestore(Draw::DrawContext *draw) override;
+
+protected:
+	void FinishDeferred() override;
+
+private:
+	void BeginHostFrame() override;
+
+	FramebufferManagerNull *framebufferManagerNull_;
+	TextureCacheNull *textureCacheNull_;
+	DrawEngineNull drawEngine_;
+	ShaderManagerNull *shaderManagerNull_;
+};
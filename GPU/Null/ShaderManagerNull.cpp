@@ -0,0 +1,253 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+
+#include <cstring>
+#include <map>
+
+#include "Common/GPU/thin3d.h"
+#include "Common/Log.h"
+#include "Common/CommonTypes.h"
+#include "GPU/GPUState.h"
+#include "GPU/ge_constants.h"
+#include "GPU/Common/VertexShaderGenerator.h"
+#include "GPU/Null/ShaderManagerNull.h"
+
+NullFragmentShader::NullFragmentShader(Draw::DrawContext *draw, FShaderID id, const char *code, bool useHWTransform)
+	: useHWTransform_(useHWTransform), id_(id) {
+	source_ = code;
+
+	module_ = draw->CreateShaderModule(ShaderStage::Fragment, GLSL_VULKAN, (const uint8_t *)code, strlen(code), "fs");
+	if (!module_)
+		failed_ = true;
+}
+
+NullFragmentShader::~NullFragmentShader() {
+	if (module_)
+		module_->Release();
+}
+
+std::string NullFragmentShader::GetShaderString(DebugShaderStringType type) const {
+	switch (type) {
+	case SHADER_STRING_SOURCE_CODE:
+		return source_;
+	case SHADER_STRING_SHORT_DESC:
+		return FragmentShaderDesc(id_);
+	default:
+		return "N/A";
+	}
+}
+
+NullVertexShader::NullVertexShader(Draw::DrawContext *draw, VShaderID id, const char *code, bool useHWTransform)
+	: useHWTransform_(useHWTransform), id_(id) {
+	source_ = code;
+
+	module_ = draw->CreateShaderModule(ShaderStage::Vertex, GLSL_VULKAN, (const uint8_t *)code, strlen(code), "vs");
+	if (!module_)
+		failed_ = true;
+}
+
+NullVertexShader::~NullVertexShader() {
+	if (module_)
+		module_->Release();
+}
+
+std::string NullVertexShader::GetShaderString(DebugShaderStringType type) const {
+	switch (type) {
+	case SHADER_STRING_SOURCE_CODE:
+		return source_;
+	case SHADER_STRING_SHORT_DESC:
+		return VertexShaderDesc(id_);
+	default:
+		return "N/A";
+	}
+}
+
+static constexpr size_t CODE_BUFFER_SIZE = 32768;
+
+const UniformBufferDesc ShaderManagerNull::baseUniformDesc{ sizeof(UB_VS_FS_Base), {} };
+
+ShaderManagerNull::ShaderManagerNull(Draw::DrawContext *draw)
+	: ShaderManagerCommon(draw) {
+	codeBuffer_ = new char[CODE_BUFFER_SIZE];
+	memset(&ub_base, 0, sizeof(ub_base));
+	memset(&ub_lights, 0, sizeof(ub_lights));
+	memset(&ub_bones, 0, sizeof(ub_bones));
+}
+
+ShaderManagerNull::~ShaderManagerNull() {
+	ClearShaders();
+	delete[] codeBuffer_;
+}
+
+void ShaderManagerNull::Clear() {
+	for (auto iter = fsCache_.begin(); iter != fsCache_.end(); ++iter) {
+		delete iter->second;
+	}
+	for (auto iter = vsCache_.begin(); iter != vsCache_.end(); ++iter) {
+		delete iter->second;
+	}
+	fsCache_.clear();
+	vsCache_.clear();
+	lastFSID_.set_invalid();
+	lastVSID_.set_invalid();
+	gstate_c.Dirty(DIRTY_VERTEXSHADER_STATE | DIRTY_FRAGMENTSHADER_STATE);
+}
+
+void ShaderManagerNull::ClearShaders() {
+	Clear();
+	DirtyLastShader();
+	gstate_c.Dirty(DIRTY_ALL_UNIFORMS);
+}
+
+void ShaderManagerNull::DirtyLastShader() {
+	lastFSID_.set_invalid();
+	lastVSID_.set_invalid();
+	lastVShader_ = nullptr;
+	lastFShader_ = nullptr;
+	gstate_c.Dirty(DIRTY_VERTEXSHADER_STATE | DIRTY_FRAGMENTSHADER_STATE);
+}
+
+uint64_t ShaderManagerNull::UpdateUniforms(bool useBufferedRendering) {
+	uint64_t dirty = gstate_c.GetDirtyUniforms();
+	if (dirty != 0) {
+		if (dirty & DIRTY_BASE_UNIFORMS)
+			BaseUpdateUniforms(&ub_base, dirty, false, useBufferedRendering);
+		if (dirty & DIRTY_LIGHT_UNIFORMS)
+			LightUpdateUniforms(&ub_lights, dirty);
+		if (dirty & DIRTY_BONE_UNIFORMS)
+			BoneUpdateUniforms(&ub_bones, dirty);
+	}
+	gstate_c.CleanUniforms();
+	return dirty;
+}
+
+void ShaderManagerNull::BindUniforms() {
+	draw_->UpdateDynamicUniformBuffer(&ub_base, sizeof(ub_base));
+}
+
+void ShaderManagerNull::GetShaders(int prim, VertexDecoder *decoder, NullVertexShader **vshader, NullFragmentShader **fshader, const ComputedPipelineState &pipelineState, bool useHWTransform, bool useHWTessellation, bool weightsAsFloat, bool useSkinInDecode) {
+	VShaderID VSID;
+	FShaderID FSID;
+
+	if (gstate_c.IsDirty(DIRTY_VERTEXSHADER_STATE)) {
+		gstate_c.Clean(DIRTY_VERTEXSHADER_STATE);
+		ComputeVertexShaderID(&VSID, decoder, useHWTransform, useHWTessellation, weightsAsFloat, useSkinInDecode);
+	} else {
+		VSID = lastVSID_;
+	}
+
+	if (gstate_c.IsDirty(DIRTY_FRAGMENTSHADER_STATE)) {
+		gstate_c.Clean(DIRTY_FRAGMENTSHADER_STATE);
+		ComputeFragmentShaderID(&FSID, pipelineState, draw_->GetBugs());
+	} else {
+		FSID = lastFSID_;
+	}
+
+	// Just update uniforms if this is the same shader as last time.
+	if (lastVShader_ != nullptr && lastFShader_ != nullptr && VSID == lastVSID_ && FSID == lastFSID_) {
+		*vshader = lastVShader_;
+		*fshader = lastFShader_;
+		return;
+	}
+
+	VSCache::iterator vsIter = vsCache_.find(VSID);
+	NullVertexShader *vs;
+	if (vsIter == vsCache_.end()) {
+		// Vertex shader not in cache. Generate it, it's never compiled though.
+		std::string genErrorString;
+		uint32_t attrMask;
+		uint64_t uniformMask;
+		VertexShaderFlags flags;
+		GenerateVertexShader(VSID, codeBuffer_, draw_->GetShaderLanguageDesc(), draw_->GetBugs(), &attrMask, &uniformMask, &flags, &genErrorString);
+		_assert_msg_(strlen(codeBuffer_) < CODE_BUFFER_SIZE, "VS length error: %d", (int)strlen(codeBuffer_));
+		vs = new NullVertexShader(draw_, VSID, codeBuffer_, useHWTransform);
+		vsCache_[VSID] = vs;
+	} else {
+		vs = vsIter->second;
+	}
+	lastVSID_ = VSID;
+
+	FSCache::iterator fsIter = fsCache_.find(FSID);
+	NullFragmentShader *fs;
+	if (fsIter == fsCache_.end()) {
+		std::string genErrorString;
+		uint64_t uniformMask;
+		FragmentShaderFlags flags;
+		GenerateFragmentShader(FSID, codeBuffer_, draw_->GetShaderLanguageDesc(), draw_->GetBugs(), &uniformMask, &flags, &genErrorString);
+		_assert_msg_(strlen(codeBuffer_) < CODE_BUFFER_SIZE, "FS length error: %d", (int)strlen(codeBuffer_));
+		fs = new NullFragmentShader(draw_, FSID, codeBuffer_, useHWTransform);
+		fsCache_[FSID] = fs;
+	} else {
+		fs = fsIter->second;
+	}
+
+	lastFSID_ = FSID;
+
+	lastVShader_ = vs;
+	lastFShader_ = fs;
+
+	*vshader = vs;
+	*fshader = fs;
+}
+
+std::vector<std::string> ShaderManagerNull::DebugGetShaderIDs(DebugShaderType type) {
+	std::string id;
+	std::vector<std::string> ids;
+	switch (type) {
+	case SHADER_TYPE_VERTEX:
+		for (auto iter : vsCache_) {
+			iter.first.ToString(&id);
+			ids.push_back(id);
+		}
+		break;
+	case SHADER_TYPE_FRAGMENT:
+		for (auto iter : fsCache_) {
+			iter.first.ToString(&id);
+			ids.push_back(id);
+		}
+		break;
+	default:
+		break;
+	}
+	return ids;
+}
+
+std::string ShaderManagerNull::DebugGetShaderString(std::string id, DebugShaderType type, DebugShaderStringType stringType) {
+	ShaderID shaderId;
+	shaderId.FromString(id);
+	switch (type) {
+	case SHADER_TYPE_VERTEX:
+	{
+		auto iter = vsCache_.find(VShaderID(shaderId));
+		if (iter == vsCache_.end()) {
+			return "";
+		}
+		return iter->second->GetShaderString(stringType);
+	}
+	case SHADER_TYPE_FRAGMENT:
+	{
+		auto iter = fsCache_.find(FShaderID(shaderId));
+		if (iter == fsCache_.end()) {
+			return "";
+		}
+		return iter->second->GetShaderString(stringType);
+	}
+	default:
+		return "N/A";
+	}
+}
@@ -0,0 +1,118 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+
+#pragma once
+
+#include <map>
+
+#include "Common/CommonTypes.h"
+#include "Common/GPU/thin3d.h"
+#include "GPU/Common/ShaderCommon.h"
+#include "GPU/Common/ShaderId.h"
+#include "GPU/Common/ShaderUniforms.h"
+#include "GPU/Common/FragmentShaderGenerator.h"
+
+class NullFragmentShader {
+public:
+	NullFragmentShader(Draw::DrawContext *draw, FShaderID id, const char *code, bool useHWTransform);
+	~NullFragmentShader();
+
+	const std::string &source() const { return source_; }
+
+	bool Failed() const { return failed_; }
+	bool UseHWTransform() const { return useHWTransform_; }
+
+	std::string GetShaderString(DebugShaderStringType type) const;
+	Draw::ShaderModule *GetShader() const { return module_; }
+
+protected:
+	Draw::ShaderModule *module_ = nullptr;
+
+	std::string source_;
+	bool failed_ = false;
+	bool useHWTransform_;
+	FShaderID id_;
+};
+
+class NullVertexShader {
+public:
+	NullVertexShader(Draw::DrawContext *draw, VShaderID id, const char *code, bool useHWTransform);
+	~NullVertexShader();
+
+	const std::string &source() const { return source_; }
+	bool Failed() const { return failed_; }
+	bool UseHWTransform() const { return useHWTransform_; }
+
+	std::string GetShaderString(DebugShaderStringType type) const;
+	Draw::ShaderModule *GetShader() const { return module_; }
+
+protected:
+	Draw::ShaderModule *module_ = nullptr;
+
+	std::string source_;
+	bool failed_ = false;
+	bool useHWTransform_;
+	VShaderID id_;
+};
+
+class ShaderManagerNull : public ShaderManagerCommon {
+public:
+	ShaderManagerNull(Draw::DrawContext *draw);
+	~ShaderManagerNull();
+
+	void GetShaders(int prim, VertexDecoder *decoder, NullVertexShader **vshader, NullFragmentShader **fshader, const ComputedPipelineState &pipelineState, bool useHWTransform, bool useHWTessellation, bool weightsAsFloat, bool useSkinInDecode);
+	void ClearShaders() override;
+	void DirtyLastShader() override;
+
+	void DeviceLost() override { draw_ = nullptr; }
+	void DeviceRestore(Draw::DrawContext *draw) override { draw_ = draw; }
+	int GetNumVertexShaders() const { return (int)vsCache_.size(); }
+	int GetNumFragmentShaders() const { return (int)fsCache_.size(); }
+
+	std::vector<std::string> DebugGetShaderIDs(DebugShaderType type) override;
+	std::string DebugGetShaderString(std::string id, DebugShaderType type, DebugShaderStringType stringType) override;
+
+	uint64_t UpdateUniforms(bool useBufferedRendering);
+	// Must be called after the pipeline is bound, since thin3d keeps the uniform buffer per pipeline.
+	void BindUniforms();
+
+	// The pipeline's uniform buffer only holds the base block, lights and bones are only built.
+	static const UniformBufferDesc baseUniformDesc;
+
+private:
+	void Clear();
+
+	typedef std::map<FShaderID, NullFragmentShader *> FSCache;
+	FSCache fsCache_;
+
+	typedef std::map<VShaderID, NullVertexShader *> VSCache;
+	VSCache vsCache_;
+
+	char *codeBuffer_;
+
+	// Uniform block scratchpad.
+	UB_VS_FS_Base ub_base;
+	UB_VS_Lights ub_lights;
+	UB_VS_Bones ub_bones;
+
+	NullFragmentShader *lastFShader_ = nullptr;
+	NullVertexShader *lastVShader_ = nullptr;
+
+	FShaderID lastFSID_;
+	VShaderID lastVSID_;
+};
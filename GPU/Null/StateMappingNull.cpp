@@ -0,0 +1,385 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+
+#include <algorithm>
+
+#include "Common/Data/Convert/SmallDataConvert.h"
+
+#include "GPU/Math3D.h"
+#include "GPU/GPUState.h"
+#include "GPU/ge_constants.h"
+#include "GPU/Common/GPUStateUtils.h"
+#include "Core/System.h"
+#include "Core/Config.h"
+
+#include "GPU/Common/FramebufferManagerCommon.h"
+#include "GPU/Null/DrawEngineNull.h"
+#include "GPU/Null/StateMappingNull.h"
+#include "GPU/Null/FramebufferManagerNull.h"
+#include "GPU/Null/TextureCacheNull.h"
+
+// These tables all fit into u8s.
+static const Draw::BlendFactor nullBlendFactorLookup[(size_t)BlendFactor::COUNT] = {
+	Draw::BlendFactor::ZERO,
+	Draw::BlendFactor::ONE,
+	Draw::BlendFactor::SRC_COLOR,
+	Draw::BlendFactor::ONE_MINUS_SRC_COLOR,
+	Draw::BlendFactor::DST_COLOR,
+	Draw::BlendFactor::ONE_MINUS_DST_COLOR,
+	Draw::BlendFactor::SRC_ALPHA,
+	Draw::BlendFactor::ONE_MINUS_SRC_ALPHA,
+	Draw::BlendFactor::DST_ALPHA,
+	Draw::BlendFactor::ONE_MINUS_DST_ALPHA,
+	Draw::BlendFactor::CONSTANT_COLOR,
+	Draw::BlendFactor::ONE_MINUS_CONSTANT_COLOR,
+	Draw::BlendFactor::CONSTANT_ALPHA,
+	Draw::BlendFactor::ONE_MINUS_CONSTANT_ALPHA,
+	Draw::BlendFactor::SRC1_COLOR,
+	Draw::BlendFactor::ONE_MINUS_SRC1_COLOR,
+	Draw::BlendFactor::SRC1_ALPHA,
+	Draw::BlendFactor::ONE_MINUS_SRC1_ALPHA,
+	Draw::BlendFactor::ZERO,  // INVALID
+};
+
+static const Draw::BlendOp nullBlendEqLookup[(size_t)BlendEq::COUNT] = {
+	Draw::BlendOp::ADD,
+	Draw::BlendOp::SUBTRACT,
+	Draw::BlendOp::REV_SUBTRACT,
+	Draw::BlendOp::MIN,
+	Draw::BlendOp::MAX,
+};
+
+static const Draw::Comparison compareOps[] = {
+	Draw::Comparison::NEVER,
+	Draw::Comparison::ALWAYS,
+	Draw::Comparison::EQUAL,
+	Draw::Comparison::NOT_EQUAL,
+	Draw::Comparison::LESS,
+	Draw::Comparison::LESS_EQUAL,
+	Draw::Comparison::GREATER,
+	Draw::Comparison::GREATER_EQUAL,
+};
+
+static const Draw::StencilOp stencilOps[] = {
+	Draw::StencilOp::KEEP,
+	Draw::StencilOp::ZERO,
+	Draw::StencilOp::REPLACE,
+	Draw::StencilOp::INVERT,
+	Draw::StencilOp::INCREMENT_AND_CLAMP,
+	Draw::StencilOp::DECREMENT_AND_CLAMP,
+	Draw::StencilOp::KEEP, // reserved
+	Draw::StencilOp::KEEP, // reserved
+};
+
+static const Draw::LogicOp logicOps[] = {
+	Draw::LogicOp::LOGIC_CLEAR,
+	Draw::LogicOp::LOGIC_AND,
+	Draw::LogicOp::LOGIC_AND_REVERSE,
+	Draw::LogicOp::LOGIC_COPY,
+	Draw::LogicOp::LOGIC_AND_INVERTED,
+	Draw::LogicOp::LOGIC_NOOP,
+	Draw::LogicOp::LOGIC_XOR,
+	Draw::LogicOp::LOGIC_OR,
+	Draw::LogicOp::LOGIC_NOR,
+	Draw::LogicOp::LOGIC_EQUIV,
+	Draw::LogicOp::LOGIC_INVERT,
+	Draw::LogicOp::LOGIC_OR_REVERSE,
+	Draw::LogicOp::LOGIC_COPY_INVERTED,
+	Draw::LogicOp::LOGIC_OR_INVERTED,
+	Draw::LogicOp::LOGIC_NAND,
+	Draw::LogicOp::LOGIC_SET,
+};
+
+void DrawEngineNull::ApplyDrawState(int prim) {
+	if (!gstate_c.IsDirty(DIRTY_BLEND_STATE | DIRTY_TEXTURE_IMAGE | DIRTY_TEXTURE_PARAMS | DIRTY_VIEWPORTSCISSOR_STATE | DIRTY_RASTER_STATE | DIRTY_DEPTHSTENCIL_STATE)) {
+		// nothing to do
+		return;
+	}
+
+	bool useBufferedRendering = framebufferManager_->UseBufferedRendering();
+	// Blend
+	if (gstate_c.IsDirty(DIRTY_BLEND_STATE)) {
+		if (gstate.isModeClear()) {
+			keys_.blend.value = 0;  // full wipe
+			keys_.blend.blendEnable = false;
+			dynState_.useBlendColor = false;
+			// Color Test
+			bool alphaMask = gstate.isClearModeAlphaMask();
+			bool colorMask = gstate.isClearModeColorMask();
+			keys_.blend.colorWriteMask = (colorMask ? (1 | 2 | 4) : 0) | (alphaMask ? 8 : 0);
+		} else {
+			keys_.blend.value = 0;
+
+			pipelineState_.Convert(draw_->GetShaderLanguageDesc().bitwiseOps);
+			GenericMaskState &maskState = pipelineState_.maskState;
+			GenericBlendState &blendState = pipelineState_.blendState;
+
+			if (pipelineState_.FramebufferRead()) {
+				FBOTexState fboTexBindState = FBO_TEX_NONE;
+				ApplyFramebufferRead(&fboTexBindState);
+				// The shader takes over the responsibility for blending, so recompute.
+				ApplyStencilReplaceAndLogicOpIgnoreBlend(blendState.replaceAlphaWithStencil, blendState);
+
+				if (fboTexBindState == FBO_TEX_COPY_BIND_TEX) {
+					framebufferManager_->BindFramebufferAsColorTexture(1, framebufferManager_->GetCurrentRenderVFB(), BINDFBCOLOR_MAY_COPY | BINDFBCOLOR_UNCACHED, 0);
+					fboTexBound_ = true;
+					fboTexBindState = FBO_TEX_NONE;
+
+					framebufferManager_->RebindFramebuffer("RebindFramebuffer - ApplyDrawState");
+					// Must dirty blend state here so we re-copy next time.
+					dirtyRequiresRecheck_ |= DIRTY_BLEND_STATE;
+					gstate_c.Dirty(DIRTY_BLEND_STATE);
+				}
+
+				dirtyRequiresRecheck_ |= DIRTY_FRAGMENTSHADER_STATE;
+				gstate_c.Dirty(DIRTY_FRAGMENTSHADER_STATE);
+			} else {
+				if (fboTexBound_) {
+					fboTexBound_ = false;
+					dirtyRequiresRecheck_ |= DIRTY_FRAGMENTSHADER_STATE;
+					gstate_c.Dirty(DIRTY_FRAGMENTSHADER_STATE);
+				}
+			}
+
+			if (blendState.blendEnabled) {
+				keys_.blend.blendEnable = true;
+				keys_.blend.logicOpEnable = false;
+				keys_.blend.blendOpColor = (uint8_t)nullBlendEqLookup[(size_t)blendState.eqColor];
+				keys_.blend.blendOpAlpha = (uint8_t)nullBlendEqLookup[(size_t)blendState.eqAlpha];
+				keys_.blend.srcColor = (uint8_t)nullBlendFactorLookup[(size_t)blendState.srcColor];
+				keys_.blend.srcAlpha = (uint8_t)nullBlendFactorLookup[(size_t)blendState.srcAlpha];
+				keys_.blend.destColor = (uint8_t)nullBlendFactorLookup[(size_t)blendState.dstColor];
+				keys_.blend.destAlpha = (uint8_t)nullBlendFactorLookup[(size_t)blendState.dstAlpha];
+				if (blendState.dirtyShaderBlendFixValues) {
+					dirtyRequiresRecheck_ |= DIRTY_SHADERBLEND;
+					gstate_c.Dirty(DIRTY_SHADERBLEND);
+				}
+				dynState_.useBlendColor = blendState.useBlendColor;
+				if (blendState.useBlendColor) {
+					dynState_.blendColor = blendState.blendColor;
+				}
+			} else {
+				keys_.blend.blendEnable = false;
+				dynState_.useBlendColor = false;
+			}
+
+			if (gstate_c.Use(GPU_USE_LOGIC_OP)) {
+				// Logic Ops
+				if (gstate.isLogicOpEnabled() && gstate.getLogicOp() != GE_LOGIC_COPY) {
+					keys_.blend.blendEnable = false;  // Can't have both blend & logic op - although I think the PSP can!
+					keys_.blend.logicOpEnable = true;
+					keys_.blend.logicOp = (uint8_t)logicOps[gstate.getLogicOp()];
+				} else {
+					keys_.blend.logicOpEnable = false;
+				}
+			}
+
+			keys_.blend.colorWriteMask = maskState.channelMask;
+		}
+	}
+
+	if (gstate_c.IsDirty(DIRTY_RASTER_STATE)) {
+		keys_.raster.value = 0;
+		bool wantCull = !gstate.isModeClear() && prim != GE_PRIM_RECTANGLES && prim > GE_PRIM_LINE_STRIP && gstate.isCullEnabled();
+		keys_.raster.cullMode = (uint8_t)(wantCull ? (gstate.getCullMode() ? Draw::CullMode::FRONT : Draw::CullMode::BACK) : Draw::CullMode::NONE);
+	}
+
+	if (gstate_c.IsDirty(DIRTY_DEPTHSTENCIL_STATE)) {
+		GenericStencilFuncState stencilState;
+		ConvertStencilFuncState(stencilState);
+
+		if (gstate.isModeClear()) {
+			keys_.depthStencil.value = 0;
+			keys_.depthStencil.depthTestEnable = true;
+			keys_.depthStencil.depthCompareOp = (uint8_t)Draw::Comparison::ALWAYS;
+			keys_.depthStencil.depthWriteEnable = gstate.isClearModeDepthMask();
+
+			// Stencil Test
+			bool alphaMask = gstate.isClearModeAlphaMask();
+			if (alphaMask) {
+				keys_.depthStencil.stencilTestEnable = true;
+				keys_.depthStencil.stencilCompareFunc = (uint8_t)Draw::Comparison::ALWAYS;
+				keys_.depthStencil.stencilPassOp = (uint8_t)Draw::StencilOp::REPLACE;
+				keys_.depthStencil.stencilFailOp = (uint8_t)Draw::StencilOp::REPLACE;
+				keys_.depthStencil.stencilDepthFailOp = (uint8_t)Draw::StencilOp::REPLACE;
+				dynState_.useStencil = true;
+				// In clear mode, the stencil value is set to the alpha value of the vertex.
+				// We override this value from software transform for clear rectangles.
+				dynState_.stencilRef = 0xFF;
+				// But we still apply the stencil write mask.
+				dynState_.stencilWriteMask = stencilState.writeMask;
+				dynState_.stencilCompareMask = 0xFF;
+			} else {
+				keys_.depthStencil.stencilTestEnable = false;
+				dynState_.useStencil = false;
+			}
+		} else {
+			keys_.depthStencil.value = 0;
+			// Depth Test
+			if (!IsDepthTestEffectivelyDisabled()) {
+				keys_.depthStencil.depthTestEnable = true;
+				keys_.depthStencil.depthCompareOp = (uint8_t)compareOps[gstate.getDepthTestFunction()];
+				keys_.depthStencil.depthWriteEnable = gstate.isDepthWriteEnabled();
+				UpdateEverUsedEqualDepth(gstate.getDepthTestFunction());
+			} else {
+				keys_.depthStencil.depthTestEnable = false;
+				keys_.depthStencil.depthWriteEnable = false;
+				keys_.depthStencil.depthCompareOp = (uint8_t)Draw::Comparison::ALWAYS;
+			}
+
+			// Stencil Test
+			if (stencilState.enabled) {
+				keys_.depthStencil.stencilTestEnable = true;
+				keys_.depthStencil.stencilCompareFunc = (uint8_t)compareOps[stencilState.testFunc];
+				keys_.depthStencil.stencilPassOp = (uint8_t)stencilOps[stencilState.zPass];
+				keys_.depthStencil.stencilFailOp = (uint8_t)stencilOps[stencilState.sFail];
+				keys_.depthStencil.stencilDepthFailOp = (uint8_t)stencilOps[stencilState.zFail];
+				dynState_.useStencil = true;
+				dynState_.stencilRef = stencilState.testRef;
+				dynState_.stencilCompareMask = stencilState.testMask;
+				dynState_.stencilWriteMask = stencilState.writeMask;
+
+				// Same Spongebob special case as the other backends: invert the depth test and write zero
+				// alpha through blending instead.
+				if (SpongebobDepthInverseConditions(stencilState)) {
+					keys_.blend.blendEnable = true;
+					keys_.blend.blendOpAlpha = (uint8_t)Draw::BlendOp::ADD;
+					keys_.blend.blendOpColor = (uint8_t)Draw::BlendOp::ADD;
+					keys_.blend.srcColor = (uint8_t)Draw::BlendFactor::ZERO;
+					keys_.blend.destColor = (uint8_t)Draw::BlendFactor::ZERO;
+					keys_.blend.logicOpEnable = false;
+					keys_.blend.srcAlpha = (uint8_t)Draw::BlendFactor::ZERO;
+					keys_.blend.destAlpha = (uint8_t)Draw::BlendFactor::ZERO;
+					keys_.blend.colorWriteMask = Draw::COLOR_MASK_A;
+
+					keys_.depthStencil.depthCompareOp = (uint8_t)Draw::Comparison::LESS;  // Inverse of GREATER_EQUAL
+					keys_.depthStencil.stencilCompareFunc = (uint8_t)Draw::Comparison::ALWAYS;
+					// Invert
+					keys_.depthStencil.stencilPassOp = (uint8_t)Draw::StencilOp::ZERO;
+					keys_.depthStencil.stencilFailOp = (uint8_t)Draw::StencilOp::ZERO;
+					keys_.depthStencil.stencilDepthFailOp = (uint8_t)Draw::StencilOp::KEEP;
+
+					dirtyRequiresRecheck_ |= DIRTY_BLEND_STATE | DIRTY_DEPTHSTENCIL_STATE;
+					gstate_c.Dirty(DIRTY_BLEND_STATE | DIRTY_DEPTHSTENCIL_STATE);
+				}
+			} else {
+				keys_.depthStencil.stencilTestEnable = false;
+				dynState_.useStencil = false;
+			}
+		}
+	}
+
+	if (gstate_c.IsDirty(DIRTY_VIEWPORTSCISSOR_STATE)) {
+		ViewportAndScissor vpAndScissor;
+		ConvertViewportAndScissor(useBufferedRendering,
+			framebufferManager_->GetRenderWidth(), framebufferManager_->GetRenderHeight(),
+			framebufferManager_->GetTargetBufferWidth(), framebufferManager_->GetTargetBufferHeight(),
+			vpAndScissor);
+		UpdateCachedViewportState(vpAndScissor);
+
+		float depthMin = vpAndScissor.depthRangeMin;
+		float depthMax = vpAndScissor.depthRangeMax;
+
+		if (depthMin < 0.0f) depthMin = 0.0f;
+		if (depthMax > 1.0f) depthMax = 1.0f;
+
+		Draw::Viewport &vp = dynState_.viewport;
+		vp.TopLeftX = vpAndScissor.viewportX;
+		vp.TopLeftY = vpAndScissor.viewportY;
+		vp.Width = vpAndScissor.viewportW;
+		vp.Height = vpAndScissor.viewportH;
+		vp.MinDepth = depthMin;
+		vp.MaxDepth = depthMax;
+
+		dynState_.scissorX = vpAndScissor.scissorX;
+		dynState_.scissorY = vpAndScissor.scissorY;
+		dynState_.scissorW = std::max(0, vpAndScissor.scissorW);
+		dynState_.scissorH = std::max(0, vpAndScissor.scissorH);
+	}
+
+	// Actually create the state objects only after we're done mapping all the state.
+	// There might have been interactions between depth and blend above.
+	if (gstate_c.IsDirty(DIRTY_BLEND_STATE)) {
+		Draw::BlendState *bs = nullptr;
+		if (!blendCache_.Get(keys_.blend.value, &bs) || !bs) {
+			Draw::BlendStateDesc desc{};
+			desc.enabled = keys_.blend.blendEnable;
+			desc.colorMask = keys_.blend.colorWriteMask;
+			desc.srcCol = (Draw::BlendFactor)keys_.blend.srcColor;
+			desc.dstCol = (Draw::BlendFactor)keys_.blend.destColor;
+			desc.eqCol = (Draw::BlendOp)keys_.blend.blendOpColor;
+			desc.srcAlpha = (Draw::BlendFactor)keys_.blend.srcAlpha;
+			desc.dstAlpha = (Draw::BlendFactor)keys_.blend.destAlpha;
+			desc.eqAlpha = (Draw::BlendOp)keys_.blend.blendOpAlpha;
+			desc.logicEnabled = keys_.blend.logicOpEnable;
+			desc.logicOp = (Draw::LogicOp)keys_.blend.logicOp;
+			bs = draw_->CreateBlendState(desc);
+			blendCache_.Insert(keys_.blend.value, bs);
+		}
+		blendState_ = bs;
+	}
+
+	if (gstate_c.IsDirty(DIRTY_RASTER_STATE)) {
+		Draw::RasterState *rs = nullptr;
+		if (!rasterCache_.Get(keys_.raster.value, &rs) || !rs) {
+			Draw::RasterStateDesc desc{};
+			desc.cull = (Draw::CullMode)keys_.raster.cullMode;
+			desc.frontFace = Draw::Facing::CCW;
+			rs = draw_->CreateRasterState(desc);
+			rasterCache_.Insert(keys_.raster.value, rs);
+		}
+		rasterState_ = rs;
+	}
+
+	if (gstate_c.IsDirty(DIRTY_DEPTHSTENCIL_STATE)) {
+		Draw::DepthStencilState *ds = nullptr;
+		if (!depthStencilCache_.Get(keys_.depthStencil.value, &ds) || !ds) {
+			Draw::DepthStencilStateDesc desc{};
+			desc.depthTestEnabled = keys_.depthStencil.depthTestEnable;
+			desc.depthWriteEnabled = keys_.depthStencil.depthWriteEnable;
+			desc.depthCompare = (Draw::Comparison)keys_.depthStencil.depthCompareOp;
+			desc.stencilEnabled = keys_.depthStencil.stencilTestEnable;
+			desc.stencil.failOp = (Draw::StencilOp)keys_.depthStencil.stencilFailOp;
+			desc.stencil.passOp = (Draw::StencilOp)keys_.depthStencil.stencilPassOp;
+			desc.stencil.depthFailOp = (Draw::StencilOp)keys_.depthStencil.stencilDepthFailOp;
+			desc.stencil.compareOp = (Draw::Comparison)keys_.depthStencil.stencilCompareFunc;
+			ds = draw_->CreateDepthStencilState(desc);
+			depthStencilCache_.Insert(keys_.depthStencil.value, ds);
+		}
+		depthStencilState_ = ds;
+	}
+}
+
+void DrawEngineNull::ApplyDrawStateLate(bool applyStencilRef, uint8_t stencilRef) {
+	if (gstate_c.IsDirty(DIRTY_VIEWPORTSCISSOR_STATE)) {
+		draw_->SetViewport(dynState_.viewport);
+		draw_->SetScissorRect(dynState_.scissorX, dynState_.scissorY, dynState_.scissorW, dynState_.scissorH);
+	}
+	if (gstate_c.IsDirty(DIRTY_BLEND_STATE) && dynState_.useBlendColor) {
+		// Need to do this AFTER ApplyTexture because the process of depalettization can ruin the blend state.
+		float blendColor[4];
+		Uint8x4ToFloat4(blendColor, dynState_.blendColor);
+		draw_->SetBlendFactor(blendColor);
+	}
+	if ((gstate_c.IsDirty(DIRTY_DEPTHSTENCIL_STATE) && dynState_.useStencil) || applyStencilRef) {
+		draw_->SetStencilParams(applyStencilRef ? stencilRef : dynState_.stencilRef, dynState_.stencilWriteMask, dynState_.stencilCompareMask);
+	}
+	gstate_c.Clean(DIRTY_VIEWPORTSCISSOR_STATE | DIRTY_DEPTHSTENCIL_STATE | DIRTY_RASTER_STATE | DIRTY_BLEND_STATE);
+	gstate_c.Dirty(dirtyRequiresRecheck_);
+	dirtyRequiresRecheck_ = 0;
+}
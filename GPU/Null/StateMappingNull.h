@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Common/GPU/thin3d.h"
+
+// Same idea as the D3D11 keys, but the fields hold thin3d enum values since the null backend only
+// ever talks to thin3d.
+
+struct NullBlendKey {
+	union {
+		uint64_t value;
+		struct {
+			unsigned int blendEnable : 1;
+			unsigned int srcColor : 5;  // Draw::BlendFactor
+			unsigned int destColor : 5;  // Draw::BlendFactor
+			unsigned int srcAlpha : 5;  // Draw::BlendFactor
+			unsigned int destAlpha : 5;  // Draw::BlendFactor
+			unsigned int blendOpColor : 3;  // Draw::BlendOp
+			unsigned int blendOpAlpha : 3;  // Draw::BlendOp
+			unsigned int logicOpEnable : 1;
+			unsigned int logicOp : 4;  // Draw::LogicOp
+			unsigned int colorWriteMask : 4;
+		};
+	};
+};
+
+struct NullDepthStencilKey {
+	union {
+		uint64_t value;
+		struct {
+			unsigned int depthTestEnable : 1;
+			unsigned int depthWriteEnable : 1;
+			unsigned int depthCompareOp : 3;  // Draw::Comparison
+			unsigned int stencilTestEnable : 1;
+			unsigned int stencilCompareFunc : 3;  // Draw::Comparison
+			unsigned int stencilPassOp : 3;  // Draw::StencilOp
+			unsigned int stencilFailOp : 3;  // Draw::StencilOp
+			unsigned int stencilDepthFailOp : 3;  // Draw::StencilOp
+		};
+	};
+};
+
+struct NullRasterKey {
+	union {
+		uint32_t value;
+		struct {
+			unsigned int cullMode : 2;  // Draw::CullMode
+		};
+	};
+};
+
+struct NullStateKeys {
+	NullBlendKey blend;
+	NullDepthStencilKey depthStencil;
+	NullRasterKey raster;
+};
+
+// Unlike D3D11, the stencil masks are dynamic state in thin3d.
+struct NullDynamicState {
+	bool useBlendColor;
+	uint32_t blendColor;
+	bool useStencil;
+	uint8_t stencilRef;
+	uint8_t stencilWriteMask;
+	uint8_t stencilCompareMask;
+	Draw::Viewport viewport;
+	int scissorX;
+	int scissorY;
+	int scissorW;
+	int scissorH;
+};
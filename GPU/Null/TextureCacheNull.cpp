@@ -0,0 +1,281 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+
+#include <algorithm>
+#include <cstring>
+
+#include "Common/MemoryUtil.h"
+#include "Core/MemMap.h"
+#include "GPU/ge_constants.h"
+#include "GPU/GPUState.h"
+#include "GPU/Common/GPUStateUtils.h"
+#include "GPU/Common/DrawEngineCommon.h"
+#include "GPU/Common/FramebufferManagerCommon.h"
+#include "GPU/Common/TextureDecoder.h"
+#include "GPU/Null/TextureCacheNull.h"
+#include "GPU/Null/FramebufferManagerNull.h"
+#include "Core/Config.h"
+
+#include "ext/xxhash.h"
+
+TextureCacheNull::TextureCacheNull(Draw::DrawContext *draw, Draw2D *draw2D)
+	: TextureCacheCommon(draw, draw2D) {
+	nextTexture_ = nullptr;
+}
+
+TextureCacheNull::~TextureCacheNull() {
+	Clear(true);
+	for (auto &iter : samplerCache_) {
+		iter.second->Release();
+	}
+}
+
+void TextureCacheNull::SetFramebufferManager(FramebufferManagerNull *fbManager) {
+	framebufferManager_ = fbManager;
+}
+
+void TextureCacheNull::ReleaseTexture(TexCacheEntry *entry, bool delete_them) {
+	Draw::Texture *texture = NullTex(entry);
+	if (texture) {
+		texture->Release();
+		entry->texturePtr = nullptr;
+	}
+}
+
+void TextureCacheNull::ForgetLastTexture() {
+	lastBoundTexture_ = nullptr;
+}
+
+void TextureCacheNull::UpdateCurrentClut(GEPaletteFormat clutFormat, u32 clutBase, bool clutIndexIsSimple) {
+	const u32 clutBaseBytes = clutBase * (clutFormat == GE_CMODE_32BIT_ABGR8888 ? sizeof(u32) : sizeof(u16));
+	// Same as the other backends, see TextureCacheD3D11 for the caveats.
+	const u32 clutExtendedBytes = std::min(clutTotalBytes_ + clutBaseBytes, clutMaxBytes_);
+
+	if (replacer_.Enabled())
+		clutHash_ = XXH32((const char *)clutBufRaw_, clutExtendedBytes, 0xC0108888);
+	else
+		clutHash_ = XXH3_64bits((const char *)clutBufRaw_, clutExtendedBytes) & 0xFFFFFFFF;
+	clutBuf_ = clutBufRaw_;
+
+	// Special optimization: fonts typically draw clut4 with just alpha values in a single color.
+	clutAlphaLinear_ = false;
+	clutAlphaLinearColor_ = 0;
+	if (clutFormat == GE_CMODE_16BIT_ABGR4444 && clutIndexIsSimple) {
+		const u16_le *clut = GetCurrentClut<u16_le>();
+		clutAlphaLinear_ = true;
+		clutAlphaLinearColor_ = clut[15] & 0x0FFF;
+		for (int i = 0; i < 16; ++i) {
+			u16 step = clutAlphaLinearColor_ | (i << 12);
+			if (clut[i] != step) {
+				clutAlphaLinear_ = false;
+				break;
+			}
+		}
+	}
+
+	clutLastFormat_ = gstate.clutformat;
+}
+
+Draw::SamplerState *TextureCacheNull::GetOrCreateSampler(const SamplerCacheKey &key) {
+	auto iter = samplerCache_.find(key);
+	if (iter != samplerCache_.end()) {
+		return iter->second;
+	}
+
+	Draw::SamplerStateDesc desc{};
+	desc.magFilter = key.magFilt ? Draw::TextureFilter::LINEAR : Draw::TextureFilter::NEAREST;
+	desc.minFilter = key.minFilt ? Draw::TextureFilter::LINEAR : Draw::TextureFilter::NEAREST;
+	desc.mipFilter = key.mipFilt ? Draw::TextureFilter::LINEAR : Draw::TextureFilter::NEAREST;
+	desc.maxAniso = key.aniso ? (float)(1 << g_Config.iAnisotropyLevel) : 1.0f;
+	desc.wrapU = key.sClamp ? Draw::TextureAddressMode::CLAMP_TO_EDGE : Draw::TextureAddressMode::REPEAT;
+	desc.wrapV = key.tClamp ? Draw::TextureAddressMode::CLAMP_TO_EDGE : Draw::TextureAddressMode::REPEAT;
+	desc.wrapW = desc.wrapU;
+	Draw::SamplerState *sampler = draw_->CreateSamplerState(desc);
+	samplerCache_[key] = sampler;
+	return sampler;
+}
+
+void TextureCacheNull::BindTexture(TexCacheEntry *entry) {
+	if (!entry) {
+		draw_->BindTexture(0, nullptr);
+		lastBoundTexture_ = nullptr;
+		return;
+	}
+	Draw::Texture *texture = NullTex(entry);
+	if (texture != lastBoundTexture_) {
+		draw_->BindTexture(0, texture);
+		lastBoundTexture_ = texture;
+	}
+	int maxLevel = (entry->status & TexCacheEntry::STATUS_NO_MIPS) ? 0 : entry->maxLevel;
+	SamplerCacheKey samplerKey = GetSamplingParams(maxLevel, entry);
+	ApplySamplingParams(samplerKey);
+	gstate_c.SetUseShaderDepal(ShaderDepalMode::OFF);
+}
+
+void TextureCacheNull::ApplySamplingParams(const SamplerCacheKey &key) {
+	Draw::SamplerState *state = GetOrCreateSampler(key);
+	draw_->BindSamplerStates(0, 1, &state);
+}
+
+void TextureCacheNull::Unbind() {
+	ForgetLastTexture();
+}
+
+void TextureCacheNull::BindAsClutTexture(Draw::Texture *tex, bool smooth) {
+	draw_->BindTexture(TEX_SLOT_CLUT, tex);
+}
+
+void TextureCacheNull::BuildTexture(TexCacheEntry *const entry) {
+	BuildTexturePlan plan;
+	if (!PrepareBuildTexture(plan, entry)) {
+		return;
+	}
+
+	Draw::DataFormat dstFmt = GetDestFormat(GETextureFormat(entry->format), gstate.getClutPaletteFormat());
+	if (plan.doReplace) {
+		dstFmt = plan.replaced->Format();
+	} else if (plan.scaleFactor > 1 || plan.saveTexture) {
+		dstFmt = Draw::DataFormat::R8G8B8A8_UNORM;
+	} else if (plan.decodeToClut8) {
+		dstFmt = Draw::DataFormat::R8_UNORM;
+	}
+
+	_assert_(entry->texturePtr == nullptr);
+
+	int levels;
+	if (plan.depth == 1) {
+		// We don't have mip generation, so clamp the number of levels to the ones we can load directly.
+		levels = std::min(plan.levelsToCreate, plan.levelsToLoad);
+	} else {
+		levels = plan.depth;
+	}
+
+	// The PSP only supports 8 mip levels, but we support 12 in the texture replacer (4k textures down to 1).
+	uint8_t *levelData[12]{};
+
+	for (int i = 0; i < levels; i++) {
+		int srcLevel = (i == 0) ? plan.baseLevelSrc : i;
+
+		int mipWidth;
+		int mipHeight;
+		plan.GetMipSize(i, &mipWidth, &mipHeight);
+
+		int stride;
+		int dataSize;
+		int blockSize = 0;
+		if (plan.doReplace && Draw::DataFormatIsBlockCompressed(dstFmt, &blockSize)) {
+			stride = ((mipWidth + 3) & ~3) * blockSize / 4;
+			dataSize = plan.replaced->GetLevelDataSizeAfterCopy(i);
+		} else {
+			stride = std::max(mipWidth * (int)Draw::DataFormatSizeInBytes(dstFmt), 16);
+			dataSize = stride * mipHeight;
+		}
+
+		uint8_t *data;
+		if (plan.depth == 1) {
+			data = (uint8_t *)AllocateAlignedMemory(dataSize, 16);
+			levelData[i] = data;
+		} else {
+			// 3D textures are uploaded as a single level holding all slices.
+			if (i == 0)
+				levelData[0] = (uint8_t *)AllocateAlignedMemory(dataSize * plan.depth, 16);
+			data = levelData[0] ? levelData[0] + dataSize * i : nullptr;
+		}
+
+		if (!data) {
+			ERROR_LOG(G3D, "Ran out of RAM trying to allocate a temporary texture upload buffer (%dx%d)", mipWidth, mipHeight);
+			for (int j = 0; j < 12; j++)
+				FreeAlignedMemory(levelData[j]);
+			return;
+		}
+
+		LoadTextureLevel(*entry, data, 0, stride, plan, srcLevel, dstFmt, TexDecodeFlags{});
+	}
+
+	int tw;
+	int th;
+	plan.GetMipSize(0, &tw, &th);
+
+	Draw::TextureDesc desc{};
+	desc.type = plan.depth == 1 ? Draw::TextureType::LINEAR2D : Draw::TextureType::LINEAR3D;
+	desc.format = dstFmt;
+	desc.width = tw;
+	desc.height = th;
+	desc.depth = plan.depth;
+	desc.mipLevels = plan.depth == 1 ? levels : 1;
+	desc.generateMips = false;
+	desc.swizzle = Draw::TextureSwizzle::DEFAULT;
+	desc.tag = "TexCache";
+	for (int i = 0; i < desc.mipLevels; i++) {
+		desc.initData.push_back(levelData[i]);
+	}
+	entry->texturePtr = draw_->CreateTexture(desc);
+
+	for (int i = 0; i < 12; i++) {
+		FreeAlignedMemory(levelData[i]);
+	}
+
+	if (plan.depth > 1) {
+		entry->status |= TexCacheEntry::STATUS_3D;
+	}
+
+	if (desc.mipLevels == 1) {
+		entry->status |= TexCacheEntry::STATUS_NO_MIPS;
+	} else {
+		entry->status &= ~TexCacheEntry::STATUS_NO_MIPS;
+	}
+
+	if (plan.doReplace) {
+		entry->SetAlphaStatus(TexCacheEntry::TexStatus(plan.replaced->AlphaStatus()));
+	}
+}
+
+Draw::DataFormat TextureCacheNull::GetDestFormat(GETextureFormat format, GEPaletteFormat clutFormat) const {
+	if (!gstate_c.Use(GPU_USE_16BIT_FORMATS)) {
+		return Draw::DataFormat::R8G8B8A8_UNORM;
+	}
+
+	switch (format) {
+	case GE_TFMT_CLUT4:
+	case GE_TFMT_CLUT8:
+	case GE_TFMT_CLUT16:
+	case GE_TFMT_CLUT32:
+		switch (clutFormat) {
+		case GE_CMODE_16BIT_ABGR4444: return Draw::DataFormat::A4R4G4B4_UNORM_PACK16;
+		case GE_CMODE_16BIT_ABGR5551: return Draw::DataFormat::A1R5G5B5_UNORM_PACK16;
+		case GE_CMODE_16BIT_BGR5650: return Draw::DataFormat::R5G6B5_UNORM_PACK16;
+		default: return Draw::DataFormat::R8G8B8A8_UNORM;
+		}
+	case GE_TFMT_4444:
+		return Draw::DataFormat::A4R4G4B4_UNORM_PACK16;
+	case GE_TFMT_5551:
+		return Draw::DataFormat::A1R5G5B5_UNORM_PACK16;
+	case GE_TFMT_5650:
+		return Draw::DataFormat::R5G6B5_UNORM_PACK16;
+	case GE_TFMT_8888:
+	case GE_TFMT_DXT1:
+	case GE_TFMT_DXT3:
+	case GE_TFMT_DXT5:
+	default:
+		return Draw::DataFormat::R8G8B8A8_UNORM;
+	}
+}
+
+void *TextureCacheNull::GetNativeTextureView(const TexCacheEntry *entry) {
+	return (void *)NullTex(entry);
+}
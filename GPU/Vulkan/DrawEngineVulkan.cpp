@@ -178,6 +178,7 @@ void DrawEngineVulkan::BeginFrame() {
 	tessDataTransferVulkan->SetPushPool(pushUBO_);
 
 	DirtyAllUBOs();
+	DecimateTrackedVertexArrays();
 }
 
 void DrawEngineVulkan::EndFrame() {
@@ -411,6 +411,7 @@ static const JitDisableFlag jitDisableFlags[] = {
 	{ MIPSComp::JitDisable::LSU_VFPU, "LSU_VFPU" },
 	{ MIPSComp::JitDisable::SIMD, "SIMD" },
 	{ MIPSComp::JitDisable::BLOCKLINK, "Block Linking" },
+	{ MIPSComp::JitDisable::LINKED_REGS, "Registers across linked blocks" },
 	{ MIPSComp::JitDisable::POINTERIFY, "Pointerify" },
 	{ MIPSComp::JitDisable::STATIC_ALLOC, "Static regalloc" },
 	{ MIPSComp::JitDisable::CACHE_POINTERS, "Cached pointers" },
@@ -1156,6 +1157,22 @@ UI::EventReturn JitCompareScreen::OnShowStats(UI::EventParams &e) {
 	NOTICE_LOG(JIT, "Average Bloat: %0.2f%%", 100 * bcStats.avgBloat);
 	NOTICE_LOG(JIT, "Min Bloat: %0.2f%%  (%08x)", 100 * bcStats.minBloat, bcStats.minBloatBlock);
 	NOTICE_LOG(JIT, "Max Bloat: %0.2f%%  (%08x)", 100 * bcStats.maxBloat, bcStats.maxBloatBlock);
+	if (bcStats.diskCacheHits != 0 || bcStats.diskCacheMisses != 0)
+		NOTICE_LOG(JIT, "Disk cache: %d hits, %d misses, %d invalidations", bcStats.diskCacheHits, bcStats.diskCacheMisses, bcStats.diskCacheInvalidations);
+	if (bcStats.numTier2Blocks != 0)
+		NOTICE_LOG(JIT, "Tier 1 blocks: %d, tier 2 blocks: %d", bcStats.numTier1Blocks, bcStats.numTier2Blocks);
+	if (bcStats.bgCompiles != 0) {
+		NOTICE_LOG(JIT, "Background compiles: %d, compile avg %0.3f ms (max %0.3f ms), latency avg %0.3f ms (max %0.3f ms)", bcStats.bgCompiles,
+			bcStats.bgCompileTimeAvg * 1000.0f, bcStats.bgCompileTimeMax * 1000.0f, bcStats.bgLatencyAvg * 1000.0f, bcStats.bgLatencyMax * 1000.0f);
+	}
+	if (bcStats.arenaBytes != 0) {
+		u64 used = bcStats.arenaLiveBytes + bcStats.arenaGarbageBytes;
+		NOTICE_LOG(JIT, "IR arena: %d KB, %d KB live, %d KB garbage (%0.1f%% fragmented), %d compactions", (int)(bcStats.arenaBytes / 1024),
+			(int)(bcStats.arenaLiveBytes / 1024), (int)(bcStats.arenaGarbageBytes / 1024), used != 0 ? 100.0 * bcStats.arenaGarbageBytes / used : 0.0, bcStats.arenaCompactions);
+	}
+	if (bcStats.linkedRegExits != 0) {
+		NOTICE_LOG(JIT, "Linked register exits: %d, %d flushes avoided, %d regs reloaded", bcStats.linkedRegExits, bcStats.linkedRegsKept, bcStats.linkedRegsLoaded);
+	}
 
 	int ctr = 0, sz = (int)bcStats.bloatMap.size();
 	for (auto iter : bcStats.bloatMap) {
@@ -66,6 +66,7 @@
 #include "Core/Config.h"
 #include "Core/ConfigValues.h"
 #include "Core/KeyMap.h"
+#include "Core/MemWriteWatch.h"
 #include "Core/TiltEventProcessor.h"
 #include "Core/Instance.h"
 #include "Core/System.h"
@@ -450,6 +451,22 @@ void GameSettingsScreen::CreateGraphicsSettings(UI::ViewGroup *graphicsSettings)
 		return UI::EVENT_CONTINUE;
 	});
 
+	CheckBox *texAsyncDecode = graphicsSettings->Add(new CheckBox(&g_Config.bTextureAsyncDecode, gr->T("Async texture decoding", "Decode changed textures in the background")));
+	texAsyncDecode->SetDisabledPtr(&g_Config.bSoftwareRendering);
+	texAsyncDecode->OnClick.Add([=](EventParams& e) {
+		settingInfo_->Show(gr->T("Async texture decoding Tip", "Less stutter when games update textures, but they may show old contents for a frame"), e.v);
+		return UI::EVENT_CONTINUE;
+	});
+
+	if (Memory::WriteWatch_Supported()) {
+		CheckBox *texWriteWatch = graphicsSettings->Add(new CheckBox(&g_Config.bTextureWriteWatch, gr->T("Texture write tracking", "Track texture memory writes (skip rehashing)")));
+		texWriteWatch->SetDisabledPtr(&g_Config.bSoftwareRendering);
+		texWriteWatch->OnClick.Add([=](EventParams& e) {
+			settingInfo_->Show(gr->T("Texture write tracking Tip", "Uses memory protection to avoid rehashing textures nothing wrote to"), e.v);
+			return UI::EVENT_CONTINUE;
+		});
+	}
+
 	static const char *quality[] = { "Low", "Medium", "High" };
 	PopupMultiChoice *beziersChoice = graphicsSettings->Add(new PopupMultiChoice(&g_Config.iSplineBezierQuality, gr->T("LowCurves", "Spline/Bezier curves quality"), quality, 0, ARRAY_SIZE(quality), I18NCat::GRAPHICS, screenManager()));
 	beziersChoice->OnChoice.Add([=](EventParams &e) {
@@ -496,6 +513,13 @@ void GameSettingsScreen::CreateGraphicsSettings(UI::ViewGroup *graphicsSettings)
 	});
 	swSkin->SetDisabledPtr(&g_Config.bSoftwareRendering);
 
+	CheckBox *vtxCache = graphicsSettings->Add(new CheckBox(&g_Config.bVertexCache, gr->T("Vertex Cache")));
+	vtxCache->OnClick.Add([=](EventParams &e) {
+		settingInfo_->Show(gr->T("VertexCache Tip", "Reuse decoded vertices of unchanged models, faster in some games"), e.v);
+		return UI::EVENT_CONTINUE;
+	});
+	vtxCache->SetDisabledPtr(&g_Config.bSoftwareRendering);
+
 	CheckBox *tessellationHW = graphicsSettings->Add(new CheckBox(&g_Config.bHardwareTessellation, gr->T("Hardware Tessellation")));
 	tessellationHW->OnClick.Add([=](EventParams &e) {
 		settingInfo_->Show(gr->T("HardwareTessellation Tip", "Uses hardware to make curves"), e.v);
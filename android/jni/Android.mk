@@ -260,6 +260,7 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Common/File/DirListing.cpp \
   $(SRC)/Common/File/FileDescriptor.cpp \
   $(SRC)/Common/GPU/thin3d.cpp \
+  $(SRC)/Common/GPU/Null/thin3d_null.cpp \
   $(SRC)/Common/GPU/GPUBackendCommon.cpp \
   $(SRC)/Common/GPU/Shader.cpp \
   $(SRC)/Common/GPU/ShaderWriter.cpp \
@@ -314,6 +315,7 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Common/FakeCPUDetect.cpp \
   $(SRC)/Common/Log.cpp \
   $(SRC)/Common/LogManager.cpp \
+  $(SRC)/Common/DeferredLog.cpp \
   $(SRC)/Common/LogReporting.cpp \
   $(SRC)/Common/MemArenaAndroid.cpp \
   $(SRC)/Common/MemArenaDarwin.cpp \
@@ -474,6 +476,7 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/GPU/Common/StencilCommon.cpp \
   $(SRC)/GPU/Common/SplineCommon.cpp.arm \
   $(SRC)/GPU/Common/DrawEngineCommon.cpp.arm \
+  $(SRC)/GPU/Common/DecodedVertexCache.cpp.arm \
   $(SRC)/GPU/Common/TransformCommon.cpp.arm \
   $(SRC)/GPU/Common/TextureDecoder.cpp \
   $(SRC)/GPU/Common/PostShader.cpp \
@@ -496,6 +499,12 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/GPU/GLES/StateMappingGLES.cpp.arm \
   $(SRC)/GPU/GLES/ShaderManagerGLES.cpp.arm \
   $(SRC)/GPU/GLES/FragmentTestCacheGLES.cpp.arm \
+  $(SRC)/GPU/Null/DrawEngineNull.cpp \
+  $(SRC)/GPU/Null/FramebufferManagerNull.cpp \
+  $(SRC)/GPU/Null/GPU_Null.cpp \
+  $(SRC)/GPU/Null/ShaderManagerNull.cpp \
+  $(SRC)/GPU/Null/StateMappingNull.cpp \
+  $(SRC)/GPU/Null/TextureCacheNull.cpp \
   $(SRC)/GPU/Software/BinManager.cpp \
   $(SRC)/GPU/Software/Clipper.cpp \
   $(SRC)/GPU/Software/DrawPixel.cpp.arm \
@@ -543,7 +552,9 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Core/FileLoaders/RamCachingFileLoader.cpp \
   $(SRC)/Core/FileLoaders/RetryingFileLoader.cpp \
   $(SRC)/Core/MemFault.cpp \
+  $(SRC)/Core/MemWriteWatch.cpp \
   $(SRC)/Core/MemMap.cpp \
+  $(SRC)/Core/MemMapBulk.cpp \
   $(SRC)/Core/MemMapFunctions.cpp \
   $(SRC)/Core/Reporting.cpp \
   $(SRC)/Core/Replay.cpp \
@@ -557,6 +568,8 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Core/Debugger/Breakpoints.cpp \
   $(SRC)/Core/Debugger/DisassemblyManager.cpp \
   $(SRC)/Core/Debugger/MemBlockInfo.cpp \
+  $(SRC)/Core/Debugger/SamplingProfiler.cpp \
+  $(SRC)/Core/Debugger/SyscallProfiler.cpp \
   $(SRC)/Core/Debugger/SymbolMap.cpp \
   $(SRC)/Core/Debugger/WebSocket.cpp \
   $(SRC)/Core/Debugger/WebSocket/BreakpointSubscriber.cpp \
@@ -573,6 +586,7 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Core/Debugger/WebSocket/InputSubscriber.cpp \
   $(SRC)/Core/Debugger/WebSocket/LogBroadcaster.cpp \
   $(SRC)/Core/Debugger/WebSocket/MemorySubscriber.cpp \
+  $(SRC)/Core/Debugger/WebSocket/ProfilerSubscriber.cpp \
   $(SRC)/Core/Debugger/WebSocket/MemoryInfoSubscriber.cpp \
   $(SRC)/Core/Debugger/WebSocket/ReplaySubscriber.cpp \
   $(SRC)/Core/Debugger/WebSocket/SteppingBroadcaster.cpp \
@@ -674,6 +688,8 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Core/FileSystems/tlzrc.cpp \
   $(SRC)/Core/MIPS/JitCommon/JitCommon.cpp \
   $(SRC)/Core/MIPS/JitCommon/JitBlockCache.cpp \
+  $(SRC)/Core/MIPS/JitCommon/JitPageIndex.cpp \
+  $(SRC)/Core/MIPS/JitCommon/JitHeatMap.cpp \
   $(SRC)/Core/MIPS/JitCommon/JitState.cpp \
   $(SRC)/Core/Util/AudioFormat.cpp \
   $(SRC)/Core/Util/MemStick.cpp \
@@ -903,6 +919,19 @@ ifeq ($(UNITTEST),1)
   LOCAL_SRC_FILES := \
     $(SRC)/unittest/JitHarness.cpp \
     $(SRC)/unittest/TestIRPassSimplify.cpp \
+    $(SRC)/unittest/TestIRInterpreter.cpp \
+    $(SRC)/unittest/TestJitPageIndex.cpp \
+    $(SRC)/unittest/TestDecodedVertexCache.cpp \
+    $(SRC)/unittest/TestTexCache.cpp \
+    $(SRC)/unittest/TestCoreTiming.cpp \
+    $(SRC)/unittest/TestBlockAllocator.cpp \
+    $(SRC)/unittest/TestDeferredLog.cpp \
+    $(SRC)/unittest/TestKernelObjectPool.cpp \
+    $(SRC)/unittest/TestSyscallProfiler.cpp \
+    $(SRC)/unittest/TestThreadQueueList.cpp \
+    $(SRC)/unittest/TestMemMapBulk.cpp \
+    $(SRC)/unittest/TestMemWriteWatch.cpp \
+    $(SRC)/unittest/TestMemBlockInfo.cpp \
     $(SRC)/unittest/TestShaderGenerators.cpp \
     $(SRC)/unittest/TestSoftwareGPUJit.cpp \
     $(SRC)/unittest/TestThreadManager.cpp \
@@ -35,6 +35,8 @@
 #include "Core/ConfigValues.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/Debugger/SamplingProfiler.h"
+#include "Core/Debugger/SyscallProfiler.h"
 #include "Core/System.h"
 #include "Core/WebServer.h"
 #include "Core/HLE/sceUtility.h"
@@ -165,11 +167,16 @@ int printUsage(const char *progname, const char *reason)
 	fprintf(stderr, "  --screenshot=FILE     compare against a screenshot\n");
 	fprintf(stderr, "  --max-mse=NUMBER      maximum allowed MSE error for screenshot\n");
 	fprintf(stderr, "  --timeout=SECONDS     abort test it if takes longer than SECONDS\n");
+	fprintf(stderr, "  --profile=FILE        sample hot guest functions, append report to FILE\n");
+	fprintf(stderr, "  --syscall-profile=FILE\n");
+	fprintf(stderr, "                        time HLE syscalls, append report to FILE\n");
+	fprintf(stderr, "  --syscall-trace=FILE  write a Chrome trace of the last test's syscalls to FILE\n");
 
 	fprintf(stderr, "  -v, --verbose         show the full passed/failed result\n");
 	fprintf(stderr, "  -i                    use the interpreter\n");
 	fprintf(stderr, "  --ir                  use ir interpreter\n");
 	fprintf(stderr, "  -j                    use jit (default)\n");
+	fprintf(stderr, "  --ir-cache            reuse IR blocks from the on-disk cache\n");
 	fprintf(stderr, "  -c, --compare         compare with output in file.expected\n");
 	fprintf(stderr, "  --bench               run multiple times and output speed\n");
 	fprintf(stderr, "\nSee headless.txt for details.\n");
@@ -181,6 +188,8 @@ static HeadlessHost *getHost(GPUCore gpuCore) {
 	switch (gpuCore) {
 	case GPUCORE_SOFTWARE:
 		return new HeadlessHost();
+	case GPUCORE_NULL:
+		return new NullHeadlessHost();
 #ifdef HEADLESSHOST_CLASS
 	default:
 		return new HEADLESSHOST_CLASS();
@@ -194,6 +203,9 @@ static HeadlessHost *getHost(GPUCore gpuCore) {
 struct AutoTestOptions {
 	double timeout;
 	double maxScreenshotError;
+	const char *profileFilename;
+	const char *syscallProfileFilename;
+	const char *syscallTraceFilename;
 	bool compare : 1;
 	bool verbose : 1;
 	bool bench : 1;
@@ -234,6 +246,15 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, const
 
 	Core_UpdateDebugStats((DebugOverlay)g_Config.iDebugOverlay == DebugOverlay::DEBUG_STATS || g_Config.bLogFrameDrops);
 
+	if (opt.profileFilename) {
+		SamplingProfilerReset();
+		SamplingProfilerStart();
+	}
+	if (opt.syscallProfileFilename || opt.syscallTraceFilename) {
+		SyscallProfilerReset();
+		SyscallProfilerStart();
+	}
+
 	PSP_BeginHostFrame();
 	Draw::DrawContext *draw = coreParameter.graphicsContext ? coreParameter.graphicsContext->GetDrawContext() : nullptr;
 	if (draw)
@@ -271,6 +292,38 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, const
 	}
 	PSP_EndHostFrame();
 
+	if (opt.profileFilename) {
+		SamplingProfilerStop();
+		// Symbols are still loaded, so get the report before shutdown.
+		SamplingProfilerReport report = SamplingProfilerGetReport(100, 20);
+		FILE *fp = File::OpenCFile(Path(opt.profileFilename), "at");
+		if (fp) {
+			fprintf(fp, "== %s\n%s\n", currentTestName.c_str(), SamplingProfilerFormatReport(report).c_str());
+			fclose(fp);
+		} else {
+			fprintf(stderr, "Unable to write profile to '%s'\n", opt.profileFilename);
+		}
+	}
+
+	if (opt.syscallProfileFilename || opt.syscallTraceFilename) {
+		SyscallProfilerStop();
+		if (opt.syscallProfileFilename) {
+			SyscallProfilerReport report = SyscallProfilerGetReport(100, 0);
+			FILE *fp = File::OpenCFile(Path(opt.syscallProfileFilename), "at");
+			if (fp) {
+				fprintf(fp, "== %s\n%s\n", currentTestName.c_str(), SyscallProfilerFormatReport(report).c_str());
+				fclose(fp);
+			} else {
+				fprintf(stderr, "Unable to write syscall profile to '%s'\n", opt.syscallProfileFilename);
+			}
+		}
+		if (opt.syscallTraceFilename) {
+			std::string trace = SyscallProfilerExportTrace();
+			if (!File::WriteDataToFile(false, trace.data(), trace.size(), Path(opt.syscallTraceFilename)))
+				fprintf(stderr, "Unable to write syscall trace to '%s'\n", opt.syscallTraceFilename);
+		}
+	}
+
 	if (draw) {
 		draw->BindFramebufferAsRenderTarget(nullptr, { Draw::RPAction::CLEAR, Draw::RPAction::DONT_CARE, Draw::RPAction::DONT_CARE }, "Headless");
 		// Vulkan may get angry if we don't do a final present.
@@ -338,6 +391,7 @@ int main(int argc, const char* argv[])
 	GPUCore gpuCore = GPUCORE_SOFTWARE;
 	CPUCore cpuCore = CPUCore::JIT;
 	int debuggerPort = -1;
+	bool irBlockCache = false;
 
 	std::vector<std::string> testFilenames;
 	const char *mountIso = nullptr;
@@ -368,6 +422,8 @@ int main(int argc, const char* argv[])
 			cpuCore = CPUCore::JIT_IR;
 		else if (!strcmp(argv[i], "--ir"))
 			cpuCore = CPUCore::IR_INTERPRETER;
+		else if (!strcmp(argv[i], "--ir-cache"))
+			irBlockCache = true;
 		else if (!strcmp(argv[i], "-c") || !strcmp(argv[i], "--compare"))
 			testOptions.compare = true;
 		else if (!strcmp(argv[i], "--bench"))
@@ -379,9 +435,10 @@ int main(int argc, const char* argv[])
 			const char *gpuName = argv[i] + strlen("--graphics=");
 			if (!strcasecmp(gpuName, "gles"))
 				gpuCore = GPUCORE_GLES;
-			// There used to be a separate "null" rendering core - just use software.
-			else if (!strcasecmp(gpuName, "software") || !strcasecmp(gpuName, "null"))
+			else if (!strcasecmp(gpuName, "software"))
 				gpuCore = GPUCORE_SOFTWARE;
+			else if (!strcasecmp(gpuName, "null"))
+				gpuCore = GPUCORE_NULL;
 			else if (!strcasecmp(gpuName, "directx9"))
 				gpuCore = GPUCORE_DIRECTX9;
 			else if (!strcasecmp(gpuName, "directx11"))
@@ -404,6 +461,12 @@ int main(int argc, const char* argv[])
 			testOptions.timeout = strtod(argv[i] + strlen("--timeout="), nullptr);
 		else if (!strncmp(argv[i], "--max-mse=", strlen("--max-mse=")) && strlen(argv[i]) > strlen("--max-mse="))
 			testOptions.maxScreenshotError = strtod(argv[i] + strlen("--max-mse="), nullptr);
+		else if (!strncmp(argv[i], "--profile=", strlen("--profile=")) && strlen(argv[i]) > strlen("--profile="))
+			testOptions.profileFilename = argv[i] + strlen("--profile=");
+		else if (!strncmp(argv[i], "--syscall-profile=", strlen("--syscall-profile=")) && strlen(argv[i]) > strlen("--syscall-profile="))
+			testOptions.syscallProfileFilename = argv[i] + strlen("--syscall-profile=");
+		else if (!strncmp(argv[i], "--syscall-trace=", strlen("--syscall-trace=")) && strlen(argv[i]) > strlen("--syscall-trace="))
+			testOptions.syscallTraceFilename = argv[i] + strlen("--syscall-trace=");
 		else if (!strncmp(argv[i], "--debugger=", strlen("--debugger=")) && strlen(argv[i]) > strlen("--debugger="))
 			debuggerPort = (int)strtoul(argv[i] + strlen("--debugger="), NULL, 10);
 		else if (!strcmp(argv[i], "--teamcity"))
@@ -422,6 +485,18 @@ int main(int argc, const char* argv[])
 	if (testFilenames.empty())
 		return printUsage(argv[0], argc <= 1 ? NULL : "No executables specified");
 
+	if (testOptions.profileFilename) {
+		// Each test appends its report, start with an empty file.
+		FILE *fp = File::OpenCFile(Path(testOptions.profileFilename), "wt");
+		if (fp)
+			fclose(fp);
+	}
+	if (testOptions.syscallProfileFilename) {
+		FILE *fp = File::OpenCFile(Path(testOptions.syscallProfileFilename), "wt");
+		if (fp)
+			fclose(fp);
+	}
+
 	LogManager::Init(&g_Config.bEnableLogging);
 	LogManager *logman = LogManager::GetInstance();
 
@@ -498,6 +573,7 @@ int main(int argc, const char* argv[])
 	g_Config.iPSPModel = PSP_MODEL_SLIM;
 	g_Config.iGlobalVolume = VOLUME_FULL;
 	g_Config.iReverbVolume = VOLUME_FULL;
+	g_Config.bIRBlockCache = irBlockCache;
 	g_Config.internalDataDirectory.clear();
 
 	Path exePath = File::GetExeDirectory();
@@ -16,6 +16,9 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include "Common/File/FileUtil.h"
+#include "Common/GPU/thin3d.h"
+#include "Common/GPU/thin3d_create.h"
+#include "Common/GraphicsContext.h"
 #include "Common/Log.h"
 #include "Common/StringUtils.h"
 #include "Core/CoreParameter.h"
@@ -59,3 +62,42 @@ void HeadlessHost::SendAndCollectOutput(const std::string &output) {
 	if (PSP_CoreParameter().collectDebugOutput)
 		*PSP_CoreParameter().collectDebugOutput += output;
 }
+
+class NullGraphicsContext : public GraphicsContext {
+public:
+	NullGraphicsContext() {
+		draw_ = Draw::T3DCreateNullContext();
+		draw_->CreatePresets();
+	}
+	~NullGraphicsContext() {
+		Shutdown();
+	}
+
+	void Shutdown() override {
+		if (draw_) {
+			draw_->DestroyPresets();
+			delete draw_;
+			draw_ = nullptr;
+		}
+	}
+	void Resize() override {}
+
+	Draw::DrawContext *GetDrawContext() override {
+		return draw_;
+	}
+
+private:
+	Draw::DrawContext *draw_ = nullptr;
+};
+
+bool NullHeadlessHost::InitGraphics(std::string *error_message, GraphicsContext **ctx, GPUCore core) {
+	gfx_ = new NullGraphicsContext();
+	*ctx = gfx_;
+	gpuCore_ = core;
+	return true;
+}
+
+void NullHeadlessHost::ShutdownGraphics() {
+	delete gfx_;
+	gfx_ = nullptr;
+}
@@ -72,3 +72,10 @@ class HeadlessHost {
 	bool writeFailureScreenshot_ = true;
 	bool writeDebugOutput_ = true;
 };
+
+// Runs the hardware GPU pipeline against the null thin3d context, no window or driver needed.
+class NullHeadlessHost : public HeadlessHost {
+public:
+	bool InitGraphics(std::string *error_message, GraphicsContext **ctx, GPUCore core) override;
+	void ShutdownGraphics() override;
+};
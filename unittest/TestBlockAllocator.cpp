@@ -0,0 +1,285 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <vector>
+
+#include "Common/Serialize/Serializer.h"
+#include "Common/TimeUtil.h"
+#include "Core/Util/BlockAllocator.h"
+#include "UnitTest.h"
+
+struct ListAllocatorBlock {
+	u32 start;
+	u32 size;
+	bool taken;
+};
+
+// The first fit walk BlockAllocator always used, over a plain list of blocks.
+class ListAllocator {
+public:
+	ListAllocator(u32 grain) : grain_(grain) {}
+
+	void Init(u32 rangeStart, u32 rangeSize) {
+		rangeSize_ = rangeSize;
+		blocks_.clear();
+		blocks_.push_back({ rangeStart, rangeSize, false });
+	}
+
+	u32 AllocAligned(u32 &size, u32 sizeGrain, u32 grain, bool fromTop) {
+		if (size == 0 || size > rangeSize_)
+			return -1;
+		if (grain < grain_)
+			grain = grain_;
+		if (sizeGrain < grain_)
+			sizeGrain = grain_;
+		size = (size + sizeGrain - 1) & ~(sizeGrain - 1);
+
+		for (size_t n = 0; n < blocks_.size(); ++n) {
+			size_t i = fromTop ? blocks_.size() - 1 - n : n;
+			ListAllocatorBlock &b = blocks_[i];
+			u32 offset;
+			if (!fromTop) {
+				offset = b.start % grain;
+				if (offset != 0)
+					offset = grain - offset;
+			} else {
+				offset = (b.start + b.size - size) % grain;
+			}
+			u32 needed = offset + size;
+			if (b.taken || b.size < needed)
+				continue;
+
+			// Split off what's left over, then the alignment padding.
+			if (!fromTop) {
+				if (b.size != needed)
+					SplitAfter(i, b.size - needed);
+				if (offset >= grain_)
+					i = SplitBefore(i, offset);
+			} else {
+				if (b.size != needed)
+					i = SplitBefore(i, b.size - needed);
+				if (offset >= grain_)
+					SplitAfter(i, offset);
+			}
+			blocks_[i].taken = true;
+			return blocks_[i].start;
+		}
+		return -1;
+	}
+
+	u32 AllocAt(u32 position, u32 size) {
+		if (size > rangeSize_)
+			return -1;
+		u32 alignedPosition = position & ~(grain_ - 1);
+		u32 alignedSize = (size + position - alignedPosition + grain_ - 1) & ~(grain_ - 1);
+
+		int i = Find(alignedPosition);
+		if (i == -1 || blocks_[i].taken || blocks_[i].start + blocks_[i].size < alignedPosition + alignedSize)
+			return -1;
+		if (blocks_[i].start != alignedPosition)
+			i = SplitBefore(i, alignedPosition - blocks_[i].start);
+		if (blocks_[i].size > alignedSize)
+			SplitAfter(i, blocks_[i].size - alignedSize);
+		blocks_[i].taken = true;
+		return position;
+	}
+
+	bool Free(u32 position, bool exact) {
+		int i = Find(position);
+		if (i == -1 || !blocks_[i].taken || (exact && blocks_[i].start != position))
+			return false;
+		blocks_[i].taken = false;
+		if (i + 1 < (int)blocks_.size() && !blocks_[i + 1].taken) {
+			blocks_[i].size += blocks_[i + 1].size;
+			blocks_.erase(blocks_.begin() + i + 1);
+		}
+		if (i > 0 && !blocks_[i - 1].taken) {
+			blocks_[i - 1].size += blocks_[i].size;
+			blocks_.erase(blocks_.begin() + i);
+		}
+		return true;
+	}
+
+	const std::vector<ListAllocatorBlock> &Blocks() const {
+		return blocks_;
+	}
+
+private:
+	int Find(u32 addr) const {
+		for (size_t i = 0; i < blocks_.size(); ++i) {
+			if (blocks_[i].start <= addr && blocks_[i].start + blocks_[i].size > addr)
+				return (int)i;
+		}
+		return -1;
+	}
+
+	// Returns the index of the original block, which now starts size bytes later.
+	size_t SplitBefore(size_t i, u32 size) {
+		ListAllocatorBlock inserted{ blocks_[i].start, size, false };
+		blocks_[i].start += size;
+		blocks_[i].size -= size;
+		blocks_.insert(blocks_.begin() + i, inserted);
+		return i + 1;
+	}
+
+	void SplitAfter(size_t i, u32 size) {
+		blocks_[i].size -= size;
+		ListAllocatorBlock inserted{ blocks_[i].start + blocks_[i].size, size, false };
+		blocks_.insert(blocks_.begin() + i + 1, inserted);
+	}
+
+	std::vector<ListAllocatorBlock> blocks_;
+	u32 rangeSize_ = 0;
+	u32 grain_;
+};
+
+static bool CompareAllocators(BlockAllocator &alloc, const ListAllocator &list) {
+	u32 freeBytes = 0;
+	u32 largestFree = 0;
+	for (const ListAllocatorBlock &b : list.Blocks()) {
+		if (alloc.GetBlockStartFromAddress(b.start) != b.start || alloc.GetBlockSizeFromAddress(b.start + b.size - 1) != b.size) {
+			printf("BlockAllocator FAILED: block %08x (size %08x) differs\n", b.start, b.size);
+			return false;
+		}
+		if (alloc.IsBlockFree(b.start) == b.taken) {
+			printf("BlockAllocator FAILED: block %08x should be %s\n", b.start, b.taken ? "taken" : "free");
+			return false;
+		}
+		if (!b.taken) {
+			freeBytes += b.size;
+			if (b.size > largestFree)
+				largestFree = b.size;
+		}
+	}
+	EXPECT_EQ_HEX(alloc.GetTotalFreeBytes(), freeBytes);
+	EXPECT_EQ_HEX(alloc.GetLargestFreeBlockSize(), largestFree);
+	return true;
+}
+
+static bool TestBlockAllocatorAgainstList(u32 seed) {
+	static const u32 RANGE_START = 0x08800000;
+	static const u32 RANGE_SIZE = 0x01800000;
+
+	BlockAllocator alloc(0x100);
+	ListAllocator list(0x100);
+	alloc.Init(RANGE_START, RANGE_SIZE, false);
+	list.Init(RANGE_START, RANGE_SIZE);
+
+	std::vector<u32> allocated;
+	for (int i = 0; i < 5000; ++i) {
+		u32 op = NextRandom(seed) % 10;
+		if (op < 5 || allocated.empty()) {
+			// Mostly small blocks with some large ones, like a game's partition allocations.
+			u32 size = (NextRandom(seed) & 7) == 0 ? NextRandom(seed) % 0x200000 + 1 : NextRandom(seed) % 0x4000 + 1;
+			u32 grain = 0x100 << (NextRandom(seed) % 5);
+			bool fromTop = (NextRandom(seed) & 1) != 0;
+			u32 allocSize = size;
+			u32 listSize = size;
+			u32 addr = alloc.AllocAligned(allocSize, 0x100, grain, fromTop, "test");
+			u32 expected = list.AllocAligned(listSize, 0x100, grain, fromTop);
+			if (addr != expected || allocSize != listSize) {
+				printf("BlockAllocator FAILED: alloc %08x (grain %08x, top %d) got %08x, expected %08x\n", size, grain, fromTop ? 1 : 0, addr, expected);
+				return false;
+			}
+			if (addr != (u32)-1)
+				allocated.push_back(addr);
+		} else if (op < 6) {
+			u32 position = RANGE_START + NextRandom(seed) % RANGE_SIZE;
+			u32 size = NextRandom(seed) % 0x8000 + 1;
+			u32 addr = alloc.AllocAt(position, size, "test");
+			u32 expected = list.AllocAt(position, size);
+			if (addr != expected) {
+				printf("BlockAllocator FAILED: alloc at %08x got %08x, expected %08x\n", position, addr, expected);
+				return false;
+			}
+			if (addr != (u32)-1)
+				allocated.push_back(addr);
+		} else {
+			size_t n = NextRandom(seed) % allocated.size();
+			u32 addr = allocated[n];
+			allocated[n] = allocated.back();
+			allocated.pop_back();
+
+			bool exact = op == 9;
+			bool freed = exact ? alloc.FreeExact(addr) : alloc.Free(addr);
+			EXPECT_EQ_INT(freed, list.Free(addr, exact));
+		}
+
+		if (!CompareAllocators(alloc, list))
+			return false;
+	}
+
+	// And the index should come back properly from a save state.
+	std::vector<u8> saved;
+	EXPECT_TRUE(CChunkFileReader::MeasureAndSavePtr(alloc, &saved) == CChunkFileReader::ERROR_NONE);
+	BlockAllocator restored(0x100);
+	std::string errorString;
+	EXPECT_TRUE(CChunkFileReader::LoadPtr(saved.data(), restored, &errorString) == CChunkFileReader::ERROR_NONE);
+	return CompareAllocators(restored, list);
+}
+
+// Not a pass/fail check, prints the cost of churning allocations with many blocks live.
+bool TestBlockAllocatorBenchmark() {
+	static const u32 RANGE_START = 0x08800000;
+	static const u32 RANGE_SIZE = 0x01800000;
+	static const int LIVE = 2000;
+	static const int ITERATIONS = 20000;
+
+	auto run = [&](auto &&alloc, auto &&free) {
+		std::vector<u32> live;
+		u32 seed = 1;
+		for (int i = 0; i < LIVE; ++i)
+			live.push_back(alloc(NextRandom(seed) % 0x2000 + 1, (NextRandom(seed) & 1) != 0));
+
+		double st = time_now_d();
+		for (int i = 0; i < ITERATIONS; ++i) {
+			size_t n = NextRandom(seed) % live.size();
+			free(live[n]);
+			live[n] = alloc(NextRandom(seed) % 0x2000 + 1, (NextRandom(seed) & 1) != 0);
+		}
+		return time_now_d() - st;
+	};
+
+	ListAllocator list(0x100);
+	list.Init(RANGE_START, RANGE_SIZE);
+	double listTime = run([&](u32 size, bool fromTop) {
+		return list.AllocAligned(size, 0x100, 0x100, fromTop);
+	}, [&](u32 addr) {
+		list.Free(addr, false);
+	});
+
+	BlockAllocator indexed(0x100);
+	indexed.Init(RANGE_START, RANGE_SIZE, false);
+	double indexedTime = run([&](u32 size, bool fromTop) {
+		return indexed.Alloc(size, fromTop, "bench");
+	}, [&](u32 addr) {
+		indexed.Free(addr);
+	});
+
+	printf("BlockAllocator: list %0.2f ns, indexed %0.2f ns per free and alloc with %d live (%0.2fx)\n",
+		listTime * 1e9 / ITERATIONS, indexedTime * 1e9 / ITERATIONS, LIVE, listTime / indexedTime);
+	return true;
+}
+
+bool TestBlockAllocator() {
+	for (u32 seed = 1; seed <= 4; ++seed) {
+		if (!TestBlockAllocatorAgainstList(seed))
+			return false;
+	}
+	return true;
+}
@@ -0,0 +1,267 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Common/Serialize/Serializer.h"
+#include "Common/TimeUtil.h"
+#include "Core/CoreTiming.h"
+#include "Core/MIPS/MIPS.h"
+#include "UnitTest.h"
+
+struct CoreTimingTestEvent {
+	s64 time;
+	u64 userdata;
+	int type;
+};
+
+// The pending queue as a sorted list, the way CoreTiming used to keep it.
+class CoreTimingTestQueue {
+public:
+	void Schedule(s64 time, int type, u64 userdata) {
+		auto it = std::upper_bound(events_.begin(), events_.end(), time, [](s64 t, const CoreTimingTestEvent &ev) {
+			return t < ev.time;
+		});
+		events_.insert(it, CoreTimingTestEvent{ time, userdata, type });
+	}
+
+	s64 Unschedule(int type, u64 userdata, s64 now) {
+		s64 result = 0;
+		for (size_t i = 0; i < events_.size(); ) {
+			if (events_[i].type == type && events_[i].userdata == userdata) {
+				result = events_[i].time - now;
+				events_.erase(events_.begin() + i);
+			} else {
+				++i;
+			}
+		}
+		return result;
+	}
+
+	void Remove(int type) {
+		events_.erase(std::remove_if(events_.begin(), events_.end(), [&](const CoreTimingTestEvent &ev) {
+			return ev.type == type;
+		}), events_.end());
+	}
+
+	bool IsScheduled(int type) const {
+		for (const auto &ev : events_) {
+			if (ev.type == type)
+				return true;
+		}
+		return false;
+	}
+
+	bool PopDue(s64 now, CoreTimingTestEvent *ev) {
+		if (events_.empty() || events_[0].time > now)
+			return false;
+		*ev = events_[0];
+		events_.erase(events_.begin());
+		return true;
+	}
+
+private:
+	std::vector<CoreTimingTestEvent> events_;
+};
+
+struct CoreTimingTestFired {
+	int type;
+	u64 userdata;
+	int cyclesLate;
+};
+
+static const int CORETIMING_TEST_TYPES = 8;
+static int coreTimingTestTypes[CORETIMING_TEST_TYPES];
+static std::vector<CoreTimingTestFired> coreTimingTestFired;
+
+template <int N>
+static void CoreTimingTestCallback(u64 userdata, int cyclesLate) {
+	coreTimingTestFired.push_back(CoreTimingTestFired{ coreTimingTestTypes[N], userdata, cyclesLate });
+}
+
+static const CoreTiming::TimedCallback coreTimingTestCallbacks[CORETIMING_TEST_TYPES] = {
+	&CoreTimingTestCallback<0>, &CoreTimingTestCallback<1>, &CoreTimingTestCallback<2>, &CoreTimingTestCallback<3>,
+	&CoreTimingTestCallback<4>, &CoreTimingTestCallback<5>, &CoreTimingTestCallback<6>, &CoreTimingTestCallback<7>,
+};
+
+static const char *const coreTimingTestNames[CORETIMING_TEST_TYPES] = {
+	"Test0", "Test1", "Test2", "Test3", "Test4", "Test5", "Test6", "Test7",
+};
+
+static void RegisterTestEvents() {
+	for (int i = 0; i < CORETIMING_TEST_TYPES; ++i)
+		coreTimingTestTypes[i] = CoreTiming::RegisterEvent(coreTimingTestNames[i], coreTimingTestCallbacks[i]);
+}
+
+static void RunCycles(int cycles) {
+	currentMIPS->downcount -= cycles;
+	CoreTiming::Advance();
+}
+
+struct CoreTimingTestState {
+	void DoState(PointerWrap &p) {
+		CoreTiming::DoState(p);
+	}
+};
+
+static bool TestCoreTimingAgainstList() {
+	CoreTimingTestQueue reference;
+	u32 seed = 1;
+	for (int i = 0; i < 20000; ++i) {
+		int type = coreTimingTestTypes[NextRandom(seed) % CORETIMING_TEST_TYPES];
+		u64 userdata = NextRandom(seed) % 4;
+		s64 now = (s64)CoreTiming::GetTicks();
+
+		switch (NextRandom(seed) % 8) {
+		case 0:
+		case 1:
+		case 2:
+		{
+			// Small ranges so there are plenty of ties.
+			s64 cycles = (NextRandom(seed) % 64) * 100;
+			CoreTiming::ScheduleEvent(cycles, type, userdata);
+			reference.Schedule(now + cycles, type, userdata);
+			break;
+		}
+
+		case 3:
+		{
+			s64 left = CoreTiming::UnscheduleEvent(type, userdata);
+			s64 expected = reference.Unschedule(type, userdata, now);
+			EXPECT_EQ_INT(left, expected);
+			break;
+		}
+
+		case 4:
+			CoreTiming::RemoveEvent(type);
+			reference.Remove(type);
+			break;
+
+		case 5:
+			EXPECT_EQ_INT(CoreTiming::IsScheduled(type), reference.IsScheduled(type));
+			break;
+
+		default:
+		{
+			coreTimingTestFired.clear();
+			RunCycles(NextRandom(seed) % 1000);
+			now = (s64)CoreTiming::GetTicks();
+
+			CoreTimingTestEvent ev;
+			size_t n = 0;
+			while (reference.PopDue(now, &ev)) {
+				if (n >= coreTimingTestFired.size()) {
+					printf("CoreTiming FAILED: event %d/%d didn't fire at %lld\n", ev.type, (int)ev.userdata, (long long)now);
+					return false;
+				}
+				const CoreTimingTestFired &fired = coreTimingTestFired[n++];
+				if (fired.type != ev.type || fired.userdata != ev.userdata || fired.cyclesLate != (int)(now - ev.time)) {
+					printf("CoreTiming FAILED: fired %d/%d, expected %d/%d\n", fired.type, (int)fired.userdata, ev.type, (int)ev.userdata);
+					return false;
+				}
+			}
+			EXPECT_EQ_INT((int)n, (int)coreTimingTestFired.size());
+			break;
+		}
+		}
+	}
+	return true;
+}
+
+static bool TestCoreTimingSaveState() {
+	for (int i = 0; i < 100; ++i)
+		CoreTiming::ScheduleEvent((i % 10) * 1000, coreTimingTestTypes[i % CORETIMING_TEST_TYPES], i);
+	std::string before = CoreTiming::GetScheduledEventsSummary();
+
+	CoreTimingTestState state;
+	std::vector<u8> saved;
+	EXPECT_TRUE(CChunkFileReader::MeasureAndSavePtr(state, &saved) == CChunkFileReader::ERROR_NONE);
+
+	CoreTiming::ClearPendingEvents();
+	CoreTiming::ScheduleEvent(5, coreTimingTestTypes[0], 0);
+
+	std::string errorString;
+	EXPECT_TRUE(CChunkFileReader::LoadPtr(saved.data(), state, &errorString) == CChunkFileReader::ERROR_NONE);
+	for (int i = 0; i < CORETIMING_TEST_TYPES; ++i)
+		CoreTiming::RestoreRegisterEvent(coreTimingTestTypes[i], coreTimingTestNames[i], coreTimingTestCallbacks[i]);
+
+	std::string after = CoreTiming::GetScheduledEventsSummary();
+	EXPECT_EQ_STR(after, before);
+	CoreTiming::ClearPendingEvents();
+	return true;
+}
+
+// Not a pass/fail check, prints the cost of rescheduling timers with many events pending.
+static void RunCoreTimingBenchmark() {
+	static const int PENDING = 4000;
+	static const int ITERATIONS = 200000;
+
+	CoreTimingTestQueue list;
+	u32 seed = 1;
+	for (int i = 0; i < PENDING; ++i) {
+		s64 cycles = NextRandom(seed) % 1000000;
+		CoreTiming::ScheduleEvent(cycles, coreTimingTestTypes[i % CORETIMING_TEST_TYPES], i);
+		list.Schedule(cycles, coreTimingTestTypes[i % CORETIMING_TEST_TYPES], i);
+	}
+
+	// Like an alarm or VTimer being cancelled and rearmed.
+	seed = 2;
+	double st = time_now_d();
+	for (int i = 0; i < ITERATIONS; ++i) {
+		int n = NextRandom(seed) % PENDING;
+		int type = coreTimingTestTypes[n % CORETIMING_TEST_TYPES];
+		s64 left = list.Unschedule(type, n, 0);
+		list.Schedule(left + 1000, type, n);
+	}
+	double listTime = time_now_d() - st;
+
+	seed = 2;
+	st = time_now_d();
+	for (int i = 0; i < ITERATIONS; ++i) {
+		int n = NextRandom(seed) % PENDING;
+		int type = coreTimingTestTypes[n % CORETIMING_TEST_TYPES];
+		s64 left = CoreTiming::UnscheduleEvent(type, n);
+		CoreTiming::ScheduleEvent(left + 1000, type, n);
+	}
+	double heapTime = time_now_d() - st;
+
+	printf("CoreTiming: list %0.2f ns, heap %0.2f ns per reschedule with %d pending (%0.2fx)\n",
+		listTime * 1e9 / ITERATIONS, heapTime * 1e9 / ITERATIONS, PENDING, listTime / heapTime);
+	CoreTiming::ClearPendingEvents();
+}
+
+bool TestCoreTiming() {
+	CoreTiming::Init();
+	RegisterTestEvents();
+
+	bool retval = TestCoreTimingAgainstList() && TestCoreTimingSaveState();
+	CoreTiming::ClearPendingEvents();
+
+	CoreTiming::Shutdown();
+	return retval;
+}
+
+bool TestCoreTimingBenchmark() {
+	CoreTiming::Init();
+	RegisterTestEvents();
+	RunCoreTimingBenchmark();
+	CoreTiming::Shutdown();
+	return true;
+}
@@ -0,0 +1,153 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstring>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "GPU/Common/DecodedVertexCache.h"
+#include "GPU/Common/VertexDecoderCommon.h"
+#include "GPU/ge_constants.h"
+#include "GPU/GPU.h"
+#include "GPU/GPUState.h"
+#include "UnitTest.h"
+
+static const int NUM_VERTS = 64;
+
+static bool DecodeAndCompare(DecodedVertexCache &cache, const VertexDecoder &dec, u32 vtype, const std::vector<u8> &src) {
+	const int stride = dec.GetDecVtxFmt().stride;
+	std::vector<u8> expected(NUM_VERTS * stride), actual(NUM_VERTS * stride);
+	dec.DecodeVerts(expected.data(), src.data(), &gstate_c.uv, 0, NUM_VERTS - 1);
+	cache.DecodeVerts(&dec, vtype, actual.data(), src.data(), gstate_c.uv, 0, NUM_VERTS - 1);
+	return memcmp(expected.data(), actual.data(), expected.size()) == 0;
+}
+
+static bool TestDecodedVertexCachePromotion() {
+	const u32 vtype = GE_VTYPE_POS_FLOAT | GE_VTYPE_COL_8888;
+	VertexDecoderOptions options{};
+	VertexDecoder dec;
+	dec.SetVertexType(vtype, options, nullptr);
+	gstate_c.uv = { 1.0f, 1.0f, 0.0f, 0.0f };
+
+	std::vector<u8> src(NUM_VERTS * dec.VertexSize());
+	for (int i = 0; i < NUM_VERTS; ++i) {
+		u8 *v = src.data() + i * dec.VertexSize();
+		u32 color = 0xFF000000 | (i * 0x030507);
+		float pos[3] = { (float)i, (float)(i * 2), 0.5f };
+		memcpy(v + dec.coloff, &color, sizeof(color));
+		memcpy(v + dec.posoff, pos, sizeof(pos));
+	}
+
+	DecodedVertexCache cache;
+	gpuStats.ResetFrame();
+	gpuStats.numFlips = 100;
+
+	// Not kept until it's been the same for a few frames, and then served from the cache.
+	int hitsBefore = 0;
+	for (int frame = 0; frame < 6; ++frame) {
+		gpuStats.numFlips++;
+		hitsBefore = gpuStats.numVertexCacheHits;
+		EXPECT_TRUE(DecodeAndCompare(cache, dec, vtype, src));
+		if (frame < 3) {
+			EXPECT_EQ_INT(gpuStats.numVertexCacheHits, 0);
+		}
+	}
+	EXPECT_EQ_INT(gpuStats.numVertexCacheHits, hitsBefore + 1);
+	EXPECT_TRUE(gpuStats.numVertexCacheBytesSaved > 0);
+
+	// A change in the data has to show up right away.
+	src[dec.VertexSize() * 5 + dec.coloff] ^= 0xFF;
+	hitsBefore = gpuStats.numVertexCacheHits;
+	gpuStats.numFlips++;
+	EXPECT_TRUE(DecodeAndCompare(cache, dec, vtype, src));
+	EXPECT_EQ_INT(gpuStats.numVertexCacheHits, hitsBefore);
+
+	// As does a change in UV scale, which the decoder applies.
+	gstate_c.uv.uScale = 2.0f;
+	EXPECT_TRUE(DecodeAndCompare(cache, dec, vtype, src));
+	EXPECT_EQ_INT(gpuStats.numVertexCacheHits, hitsBefore);
+	gstate_c.uv.uScale = 1.0f;
+
+	// Unused entries go away.
+	gpuStats.numFlips += 1000;
+	for (int i = 0; i < 20; ++i)
+		cache.Decimate();
+	hitsBefore = gpuStats.numVertexCacheHits;
+	EXPECT_TRUE(DecodeAndCompare(cache, dec, vtype, src));
+	EXPECT_EQ_INT(gpuStats.numVertexCacheHits, hitsBefore);
+	return true;
+}
+
+static bool TestDecodedVertexCacheSideEffects() {
+	const u32 vtype = GE_VTYPE_TC_16BIT | GE_VTYPE_COL_8888 | GE_VTYPE_POS_16BIT | GE_VTYPE_THROUGH;
+	VertexDecoderOptions options{};
+	VertexDecoder dec;
+	dec.SetVertexType(vtype, options, nullptr);
+
+	std::vector<u8> src(NUM_VERTS * dec.VertexSize());
+	for (int i = 0; i < NUM_VERTS; ++i) {
+		u8 *v = src.data() + i * dec.VertexSize();
+		u16 uv[2] = { (u16)(10 + i), (u16)(20 + i) };
+		memcpy(v + dec.tcoff, uv, sizeof(uv));
+		u32 color = i == 7 ? 0x80FFFFFF : 0xFFFFFFFF;
+		memcpy(v + dec.coloff, &color, sizeof(color));
+	}
+
+	DecodedVertexCache cache;
+	for (int frame = 0; frame < 6; ++frame) {
+		gpuStats.numFlips++;
+		gstate_c.vertexFullAlpha = true;
+		gstate_c.vertBounds = { 512, 512, 0, 0 };
+		EXPECT_TRUE(DecodeAndCompare(cache, dec, vtype, src));
+		// The cached decode has to leave the same state behind as the real one.
+		EXPECT_FALSE(gstate_c.vertexFullAlpha);
+		EXPECT_EQ_INT(gstate_c.vertBounds.minU, 10);
+		EXPECT_EQ_INT(gstate_c.vertBounds.maxV, 20 + NUM_VERTS - 1);
+	}
+	EXPECT_TRUE(gpuStats.numVertexCacheHits > 0);
+	return true;
+}
+
+static bool TestDecodedVertexCacheBypass() {
+	// Morphing depends on gstate_c.morphWeights, so it can't be cached.
+	const u32 vtype = GE_VTYPE_POS_FLOAT | (1 << GE_VTYPE_MORPHCOUNT_SHIFT);
+	VertexDecoderOptions options{};
+	VertexDecoder dec;
+	dec.SetVertexType(vtype, options, nullptr);
+	gstate_c.morphWeights[0] = 0.5f;
+	gstate_c.morphWeights[1] = 0.5f;
+
+	std::vector<u8> src(NUM_VERTS * dec.VertexSize());
+	DecodedVertexCache cache;
+	int lookups = gpuStats.numVertexCacheLookups;
+	for (int frame = 0; frame < 6; ++frame) {
+		gpuStats.numFlips++;
+		EXPECT_TRUE(DecodeAndCompare(cache, dec, vtype, src));
+	}
+	EXPECT_EQ_INT(gpuStats.numVertexCacheLookups, lookups);
+	return true;
+}
+
+bool TestDecodedVertexCache() {
+	if (!TestDecodedVertexCachePromotion())
+		return false;
+	if (!TestDecodedVertexCacheSideEffects())
+		return false;
+	if (!TestDecodedVertexCacheBypass())
+		return false;
+	return true;
+}
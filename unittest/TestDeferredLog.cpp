@@ -0,0 +1,215 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/ConsoleListener.h"
+#include "Common/DeferredLog.h"
+#include "Common/LogManager.h"
+#include "Common/TimeUtil.h"
+#include "UnitTest.h"
+
+static bool CaptureDeferred(DeferredLogRecord *rec, const char *format, ...) {
+	rec->format = format;
+	va_list args;
+	va_start(args, format);
+	bool captured = DeferredLogCapture(rec, format, args);
+	va_end(args);
+	return captured;
+}
+
+static bool CheckDeferredFormat(const char *format, ...) {
+	va_list args;
+	va_start(args, format);
+	char expected[1024];
+	vsnprintf(expected, sizeof(expected), format, args);
+	va_end(args);
+
+	DeferredLogRecord rec{};
+	rec.format = format;
+	va_start(args, format);
+	bool captured = DeferredLogCapture(&rec, format, args);
+	va_end(args);
+	if (!captured) {
+		printf("DeferredLog FAILED: couldn't capture '%s'\n", format);
+		return false;
+	}
+
+	std::string actual;
+	DeferredLogFormat(rec, &actual);
+	if (actual != expected) {
+		printf("DeferredLog FAILED: '%s' formatted as '%s', expected '%s'\n", format, actual.c_str(), expected);
+		return false;
+	}
+	return true;
+}
+
+static bool TestDeferredLogFormats() {
+	EXPECT_TRUE(CheckDeferredFormat("No arguments, 100%% plain"));
+	EXPECT_TRUE(CheckDeferredFormat("%d %i %u %x %X %o %c", -5, 42, 0xFFFFFFFFU, 0xBEEF, 0xCAFE, 8, 'Z'));
+	EXPECT_TRUE(CheckDeferredFormat("%08x %-6d| %+d % d %#x", 0x1234, 7, 3, 4, 255));
+	EXPECT_TRUE(CheckDeferredFormat("%lld %llx %ld %zu %hhd %hd", -1234567890123LL, 0x123456789ABCULL, -7L, (size_t)99, 300, 70000));
+	EXPECT_TRUE(CheckDeferredFormat("%f %0.3f %e %g %10.2f", 1.5, 3.14159, 12345.678, 0.0001, -2.25f));
+	EXPECT_TRUE(CheckDeferredFormat("%s, %10s, %-10s|, %.3s", "hello", "right", "left", "truncated"));
+	EXPECT_TRUE(CheckDeferredFormat("%*d %-*d| %.*f %*.*s|", 6, 12, 5, 3, 2, 1.23456, 8, 2, "abcdef"));
+	EXPECT_TRUE(CheckDeferredFormat("%s %p", "ptr", (void *)0x1000));
+	EXPECT_TRUE(CheckDeferredFormat("%08x '%s'", 0x0880ABCD, ""));
+
+	// Precision bounds the read, so names without a terminator (like fixed size fields) are fine.
+	struct {
+		char name[4];
+		char after[4];
+	} unterminated{ { 'a', 'b', 'c', 'd' }, { 'e', 'f', 'g', 0 } };
+	EXPECT_TRUE(CheckDeferredFormat("%.*s|%.4s|%.0s|", 3, unterminated.name, unterminated.name, unterminated.name));
+
+	// Strings longer than the record aren't cut off, they just can't be deferred.
+	std::string longString(300, 'x');
+	DeferredLogRecord rec{};
+	EXPECT_FALSE(CaptureDeferred(&rec, "%d %s", 5, longString.c_str()));
+	EXPECT_FALSE(CaptureDeferred(&rec, "%s %d", longString.c_str(), 5));
+	std::string fitString(100, 'y');
+	EXPECT_TRUE(CheckDeferredFormat("%d %s", 5, fitString.c_str()));
+
+	// Only the precision is stored, which leaves room for the rest.
+	EXPECT_TRUE(CaptureDeferred(&rec, "%.*s %.3s %d", 2, longString.c_str(), longString.c_str(), 5));
+	std::string formatted;
+	DeferredLogFormat(rec, &formatted);
+	EXPECT_TRUE(formatted == "xx xxx 5");
+
+	// Things we don't try to defer.
+	EXPECT_FALSE(CaptureDeferred(&rec, "%ls", L"wide"));
+	EXPECT_FALSE(CaptureDeferred(&rec, "%Lf", (long double)1.0));
+	return true;
+}
+
+class CaptureLogListener : public LogListener {
+public:
+	void Log(const LogMessage &msg) override {
+		if (capture)
+			lines.push_back(msg.msg);
+		count++;
+	}
+
+	bool capture = true;
+	int count = 0;
+	std::vector<std::string> lines;
+};
+
+static bool TestDeferredLogManager(LogManager *logManager, CaptureLogListener *listener) {
+	static const int LINES_PER_THREAD = 300;
+
+	logManager->SetDeferred(true);
+	auto logLines = [](int thread) {
+		for (int i = 0; i < LINES_PER_THREAD; ++i)
+			GenericLog(LogLevel::LDEBUG, LogType::JIT, __FILE__, __LINE__, "Thread %d line %d: %s", thread, i, "text");
+	};
+	std::thread first(logLines, 1);
+	std::thread second(logLines, 2);
+	first.join();
+	second.join();
+	logManager->SetDeferred(false);
+
+	// Unless lines were dropped, every line should be there, in order for each thread.
+	int next[3]{};
+	for (const std::string &line : listener->lines) {
+		int thread = 0, index = -1;
+		if (sscanf(line.c_str(), "Thread %d line %d", &thread, &index) != 2 || thread < 1 || thread > 2) {
+			printf("DeferredLog FAILED: unexpected line %s", line.c_str());
+			return false;
+		}
+		EXPECT_EQ_INT(index, next[thread]);
+		next[thread]++;
+	}
+	EXPECT_EQ_INT((int)listener->lines.size(), 2 * LINES_PER_THREAD);
+	return true;
+}
+
+// Not a pass/fail check, prints how long the logging thread spends on verbose lines.
+static bool BenchmarkDeferredLog(LogManager *logManager, CaptureLogListener *listener) {
+	static const int ITERATIONS = 200 * 1024;
+	// Stay under half the ring size, so the flush thread isn't woken early and the benchmark
+	// measures the logging, not drops or formatting.
+	static const int BATCH = 256;
+	listener->capture = false;
+
+	double flushTime = 0.0;
+	auto logLines = [&]() {
+		double logTime = 0.0;
+		for (int i = 0; i < ITERATIONS; i += BATCH) {
+			double st = time_now_d();
+			for (int j = i; j < i + BATCH; ++j)
+				GenericLog(LogLevel::LDEBUG, LogType::JIT, __FILE__, __LINE__, "Compiled block at %08x, %d instructions (%s)", 0x08804000 + j * 4, j & 63, "benchmark");
+			logTime += time_now_d() - st;
+
+			if (logManager->IsDeferred()) {
+				st = time_now_d();
+				logManager->FlushDeferred();
+				flushTime += time_now_d() - st;
+			}
+		}
+		return logTime;
+	};
+
+	double immediateTime = logLines();
+	logManager->SetDeferred(true);
+	double deferredTime = logLines();
+	logManager->SetDeferred(false);
+
+	printf("Log: immediate %0.2f ns, deferred %0.2f ns per line on the logging thread (%0.2fx), flush %0.2f ns per line\n",
+		immediateTime * 1e9 / ITERATIONS, deferredTime * 1e9 / ITERATIONS, immediateTime / deferredTime, flushTime * 1e9 / ITERATIONS);
+	listener->capture = true;
+	return true;
+}
+
+// Runs func on a fresh LogManager, with only a capturing listener, and restores the previous one after.
+template <typename F>
+static bool RunWithLogManager(F func) {
+	bool enabled = true;
+	LogManager *previous = LogManager::GetInstance();
+	LogManager::SetInstance(nullptr);
+	LogManager::Init(&enabled);
+	LogManager *logManager = LogManager::GetInstance();
+	logManager->RemoveListener(logManager->GetConsoleListener());
+	logManager->RemoveListener(logManager->GetRingbufferListener());
+	logManager->SetLogLevel(LogType::JIT, LogLevel::LDEBUG);
+	logManager->SetEnabled(LogType::JIT, true);
+
+	CaptureLogListener listener;
+	logManager->AddListener(&listener);
+
+	bool retval = func(logManager, &listener);
+
+	logManager->RemoveListener(&listener);
+	LogManager::Shutdown();
+	LogManager::SetInstance(previous);
+	return retval;
+}
+
+bool TestDeferredLog() {
+	if (!TestDeferredLogFormats())
+		return false;
+	return RunWithLogManager(&TestDeferredLogManager);
+}
+
+bool TestDeferredLogBenchmark() {
+	return RunWithLogManager(&BenchmarkDeferredLog);
+}
@@ -0,0 +1,194 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Common/TimeUtil.h"
+#include "Core/MIPS/MIPS.h"
+#include "Core/MIPS/IR/IRInst.h"
+#include "Core/MIPS/IR/IRInterpreter.h"
+
+struct IRInterpreterBlock {
+	const char *name;
+	const std::vector<IRInst> insts;
+	// Instructions after IRCompileThreaded(), including the end marker.
+	size_t threadedSize;
+};
+
+static float AsFloat(u32 bits) {
+	float f;
+	memcpy(&f, &bits, 4);
+	return f;
+}
+
+static const IRInterpreterBlock blocks[] = {
+	{
+		"IntegerLoop",
+		{
+			{ IROp::AddConst, { MIPS_REG_A0 }, MIPS_REG_A0, 0, 1 },
+			{ IROp::Add, { MIPS_REG_V0 }, MIPS_REG_V0, MIPS_REG_A0 },
+			{ IROp::Xor, { MIPS_REG_V1 }, MIPS_REG_V0, MIPS_REG_A1 },
+			{ IROp::ShlImm, { MIPS_REG_T0 }, MIPS_REG_V1, 3 },
+			{ IROp::SarImm, { MIPS_REG_T1 }, MIPS_REG_T0, 2 },
+			{ IROp::Slt, { MIPS_REG_T2 }, MIPS_REG_A0, MIPS_REG_A1 },
+			{ IROp::SltUConst, { MIPS_REG_T3 }, MIPS_REG_T1, 0, 0x1000 },
+			{ IROp::MovNZ, { MIPS_REG_T4 }, MIPS_REG_T3, MIPS_REG_T1 },
+			{ IROp::Downcount, { 0 }, 0, 0, 9 },
+			{ IROp::ExitToConstIfNeq, { 0 }, MIPS_REG_T2, MIPS_REG_ZERO, 0x08804000 },
+			{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804020 },
+		},
+		11,
+	},
+	{
+		"MultiplyAndBits",
+		{
+			{ IROp::SetConst, { MIPS_REG_A2 }, 0, 0, 0x12345678 },
+			{ IROp::Mult, { 0 }, MIPS_REG_A2, MIPS_REG_A0 },
+			{ IROp::MfLo, { MIPS_REG_V0 }, 0, 0 },
+			{ IROp::MfHi, { MIPS_REG_V1 }, 0, 0 },
+			{ IROp::RorImm, { MIPS_REG_T0 }, MIPS_REG_V0, 7 },
+			{ IROp::Clz, { MIPS_REG_T1 }, MIPS_REG_T0 },
+			{ IROp::BSwap32, { MIPS_REG_T2 }, MIPS_REG_T1 },
+			{ IROp::Max, { MIPS_REG_T3 }, MIPS_REG_T2, MIPS_REG_A1 },
+			// Not handled directly, runs through IRInterpret().
+			{ IROp::ReverseBits, { MIPS_REG_T5 }, MIPS_REG_T3 },
+			{ IROp::Downcount, { 0 }, 0, 0, 4 },
+			{ IROp::ExitToReg, { 0 }, MIPS_REG_RA },
+		},
+		11,
+	},
+	{
+		"FloatOps",
+		{
+			{ IROp::SetConstF, { 0 }, 0, 0, 0x3F800000 },
+			{ IROp::FAdd, { 1 }, 1, 0 },
+			{ IROp::FMul, { 2 }, 1, 1 },
+			{ IROp::FSub, { 3 }, 2, 0 },
+			{ IROp::FSqrt, { 4 }, 3 },
+			{ IROp::FMov, { 5 }, 4 },
+			{ IROp::FMovToGPR, { MIPS_REG_V0 }, 5 },
+			{ IROp::FCmp, { IRFpCompareMode::LessOrdered }, 0, 1 },
+			{ IROp::FpCondToReg, { MIPS_REG_V1 } },
+			{ IROp::Downcount, { 0 }, 0, 0, 7 },
+			{ IROp::ExitToConstIfGtZ, { 0 }, MIPS_REG_V1, 0, 0x08804100 },
+			{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804140 },
+		},
+		12,
+	},
+};
+
+static void ResetState(MIPSState *mips) {
+	memset(mips->r, 0, sizeof(mips->r));
+	memset(mips->f, 0, sizeof(mips->f));
+	mips->r[MIPS_REG_A1] = 10000;
+	mips->r[MIPS_REG_RA] = 0x08804200;
+	mips->f[1] = AsFloat(0x3F000000);
+	mips->fpcond = 0;
+	mips->hi = 0;
+	mips->lo = 0;
+	mips->downcount = 1000;
+	mips->pc = 0x08804000;
+}
+
+struct IRInterpreterSnapshot {
+	u32 r[32];
+	float f[32];
+	u32 hi, lo, fpcond;
+	int downcount;
+	u32 pc;
+};
+
+static void TakeSnapshot(const MIPSState *mips, u32 pc, IRInterpreterSnapshot *snap) {
+	memcpy(snap->r, mips->r, sizeof(snap->r));
+	memcpy(snap->f, mips->f, sizeof(snap->f));
+	snap->hi = mips->hi;
+	snap->lo = mips->lo;
+	snap->fpcond = mips->fpcond;
+	snap->downcount = mips->downcount;
+	snap->pc = pc;
+}
+
+static bool VerifyBlock(const IRInterpreterBlock &block) {
+	std::vector<IRThreadedInst> threaded;
+	IRCompileThreaded(block.insts.data(), (int)block.insts.size(), threaded);
+	if (threaded.size() != block.threadedSize) {
+		printf("%s FAILED: threaded to %d instructions, expected %d\n", block.name, (int)threaded.size(), (int)block.threadedSize);
+		return false;
+	}
+
+	// Run it a few times so the state evolves.
+	IRInterpreterSnapshot expected{}, actual{};
+	ResetState(&mipsr4k);
+	u32 pc = 0;
+	for (int i = 0; i < 10; ++i)
+		pc = IRInterpret(&mipsr4k, block.insts.data(), (int)block.insts.size());
+	TakeSnapshot(&mipsr4k, pc, &expected);
+
+	ResetState(&mipsr4k);
+	for (int i = 0; i < 10; ++i)
+		pc = IRInterpretThreaded(&mipsr4k, threaded.data());
+	TakeSnapshot(&mipsr4k, pc, &actual);
+
+	if (actual.pc != expected.pc) {
+		printf("%s FAILED: exited to %08x, expected %08x\n", block.name, actual.pc, expected.pc);
+		return false;
+	}
+	if (memcmp(&actual, &expected, sizeof(actual)) != 0) {
+		printf("%s FAILED: state differs between dispatchers\n", block.name);
+		return false;
+	}
+	return true;
+}
+
+// Not a pass/fail check, just prints the difference between the dispatchers.
+static void BenchmarkBlock(const IRInterpreterBlock &block) {
+	std::vector<IRThreadedInst> threaded;
+	IRCompileThreaded(block.insts.data(), (int)block.insts.size(), threaded);
+	const int iterations = 2000000;
+
+	ResetState(&mipsr4k);
+	double st = time_now_d();
+	for (int i = 0; i < iterations; ++i)
+		IRInterpret(&mipsr4k, block.insts.data(), (int)block.insts.size());
+	double switchTime = time_now_d() - st;
+
+	ResetState(&mipsr4k);
+	st = time_now_d();
+	for (int i = 0; i < iterations; ++i)
+		IRInterpretThreaded(&mipsr4k, threaded.data());
+	double threadedTime = time_now_d() - st;
+
+	printf("%s: switch %0.2f ns/block, threaded %0.2f ns/block (%0.2fx)\n", block.name,
+		switchTime * 1e9 / iterations, threadedTime * 1e9 / iterations, switchTime / threadedTime);
+}
+
+bool TestIRInterpreter() {
+	bool retval = true;
+	for (const auto &block : blocks) {
+		if (!VerifyBlock(block))
+			retval = false;
+	}
+	return retval;
+}
+
+bool TestIRInterpreterBenchmark() {
+	for (const auto &block : blocks)
+		BenchmarkBlock(block);
+	return true;
+}
@@ -0,0 +1,285 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "Common/TimeUtil.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/IR/IRJit.h"
+#include "Core/MIPS/JitCommon/JitPageIndex.h"
+#include "UnitTest.h"
+
+struct PageIndexTestBlock {
+	u32 start;
+	u32 size;
+	bool valid;
+};
+
+// Blocks are tracked by both the index and a plain list, and invalidation should agree.
+class PageIndexTestCache {
+public:
+	int Add(u32 start, u32 size) {
+		int num = (int)blocks_.size();
+		blocks_.push_back({ start, size, true });
+		index_.Add(start, size, num);
+		return num;
+	}
+
+	int Invalidate(u32 start, u32 size) {
+		int count = 0;
+		if (!index_.HasCode(start, size))
+			return 0;
+
+		std::vector<int> found;
+		index_.FindBlocks(start, size, found);
+		for (int num : found) {
+			PageIndexTestBlock &b = blocks_[num];
+			if (b.valid && b.start < start + size && b.start + b.size > start) {
+				b.valid = false;
+				index_.Remove(b.start, b.size, num);
+				count++;
+			}
+		}
+		return count;
+	}
+
+	int InvalidateSlow(u32 start, u32 size) {
+		int count = 0;
+		for (PageIndexTestBlock &b : slowBlocks_) {
+			if (b.valid && b.start < start + size && b.start + b.size > start) {
+				b.valid = false;
+				count++;
+			}
+		}
+		return count;
+	}
+
+	void SyncSlow() {
+		slowBlocks_ = blocks_;
+	}
+
+	void Clear() {
+		blocks_.clear();
+		index_.Clear();
+	}
+
+	const JitPageIndex &Index() const {
+		return index_;
+	}
+
+private:
+	std::vector<PageIndexTestBlock> blocks_;
+	std::vector<PageIndexTestBlock> slowBlocks_;
+	JitPageIndex index_;
+};
+
+// The way JitBlockCache used to look up blocks, for comparison.
+class PageIndexTestMapCache {
+public:
+	void Add(u32 start, u32 size, int num) {
+		map_[std::make_pair(start + size, start)] = num;
+	}
+
+	int Invalidate(u32 start, u32 size) {
+		int count = 0;
+		const u32 end = start + size;
+	restart:
+		auto next = map_.lower_bound(std::make_pair(start, 0));
+		auto last = map_.upper_bound(std::make_pair(end + 0x4000, 0));
+		for (; next != last; ++next) {
+			if (next->first.second < end && next->first.first > start) {
+				map_.erase(next);
+				count++;
+				goto restart;
+			}
+		}
+		return count;
+	}
+
+private:
+	std::map<std::pair<u32, u32>, u32> map_;
+};
+
+static bool TestPageIndexBasics() {
+	JitPageIndex index;
+	index.Add(0x08804000, 0x10, 0);
+	index.Add(0x08804010, 0x800, 1);
+	// Adding the same block twice to a page (i.e. proxies) should keep it once.
+	index.Add(0x08804400, 0x10, 1);
+	// Scratchpad isn't part of the flat range.
+	index.Add(0x00010000, 0x20, 2);
+
+	EXPECT_TRUE(index.HasCode(0x08804000, 4));
+	EXPECT_TRUE(index.HasCode(0x48804800, 4));
+	EXPECT_FALSE(index.HasCode(0x08804C00, 0x400));
+	EXPECT_FALSE(index.HasCode(0x08000000, 0x804000));
+	EXPECT_TRUE(index.HasCode(0x00010010, 4));
+	EXPECT_FALSE(index.HasCode(0x00010400, 4));
+	EXPECT_TRUE(index.HasCode(0, 0x3FFFFFFF));
+	EXPECT_EQ_INT((int)index.CountPages(), 4);
+
+	std::vector<int> found;
+	index.FindBlocks(0x08804000, 0x1000, found);
+	EXPECT_EQ_INT((int)found.size(), 2);
+	EXPECT_EQ_INT(found[0], 0);
+	EXPECT_EQ_INT(found[1], 1);
+
+	const std::vector<int> *page = index.GetBlocksInPage(0x08804400);
+	EXPECT_TRUE(page != nullptr);
+	EXPECT_EQ_INT((int)page->size(), 1);
+
+	found.clear();
+	index.FindBlocks(0, 0x3FFFFFFF, found);
+	EXPECT_EQ_INT((int)found.size(), 3);
+
+	index.Remove(0x08804010, 0x800, 1);
+	EXPECT_FALSE(index.HasCode(0x08804400, 0x400));
+	EXPECT_TRUE(index.HasCode(0x08804000, 0x400));
+	index.Remove(0x00010000, 0x20, 2);
+	EXPECT_FALSE(index.HasCode(0x00010000, 0x4000));
+	EXPECT_EQ_INT((int)index.CountPages(), 1);
+
+	index.Clear();
+	EXPECT_FALSE(index.HasCode(0, 0x3FFFFFFF));
+	return true;
+}
+
+static void AddRandomBlocks(PageIndexTestCache &cache, u32 &seed, u32 start, u32 size, int count) {
+	for (int i = 0; i < count; ++i) {
+		u32 blockStart = start + (NextRandom(seed) % size & ~3);
+		u32 blockSize = 4 * (1 + NextRandom(seed) % 64);
+		cache.Add(blockStart, blockSize);
+	}
+}
+
+static bool TestPageIndexRandom() {
+	PageIndexTestCache cache;
+	u32 seed = 1;
+	AddRandomBlocks(cache, seed, 0x08804000, 0x200000, 5000);
+	AddRandomBlocks(cache, seed, 0x00010000, 0x4000, 100);
+	cache.SyncSlow();
+
+	for (int i = 0; i < 2000; ++i) {
+		u32 start = (NextRandom(seed) & 1) ? 0x08804000 + NextRandom(seed) % 0x210000 : 0x00010000 + NextRandom(seed) % 0x4000;
+		u32 size = 4 + (NextRandom(seed) % 0x2000);
+		int fast = cache.Invalidate(start, size);
+		int slow = cache.InvalidateSlow(start, size);
+		if (fast != slow) {
+			printf("Invalidating %08x + %x: found %d blocks, expected %d\n", start, size, fast, slow);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool TestIRBlockCacheInvalidate() {
+	static const u32 BLOCK_START = 0x08804100;
+	static const u32 BLOCK_SIZE = 0x20;
+	static const u32 ORIG_OP = 0x24020001;
+
+	for (u32 off = 0; off < BLOCK_SIZE; off += 4)
+		Memory::Write_U32(ORIG_OP, BLOCK_START + off);
+
+	MIPSComp::IRBlockCache blocks;
+	int num = blocks.AllocateBlock(BLOCK_START);
+	MIPSComp::IRBlock *block = blocks.GetBlock(num);
+	block->SetOriginalSize(BLOCK_SIZE);
+	blocks.SetBlockInstructions(block, std::vector<IRInst>(4));
+	blocks.FinalizeBlock(num);
+
+	EXPECT_TRUE(blocks.MayHaveCode(BLOCK_START, 4));
+	EXPECT_EQ_INT(blocks.GetBlockNumberFromAddress(BLOCK_START + 8), num);
+	EXPECT_EQ_INT((int)blocks.FindInvalidatedBlockNumbers(BLOCK_START + 8, 4).size(), 1);
+	EXPECT_FALSE(Memory::Read_U32(BLOCK_START) == ORIG_OP);
+
+	blocks.DestroyBlock(num, num);
+	EXPECT_EQ_INT(Memory::Read_U32(BLOCK_START), ORIG_OP);
+	EXPECT_TRUE(block->GetInstructions() == nullptr);
+	// Nothing should be left in the index, or later writes would take the slow path.
+	EXPECT_FALSE(blocks.MayHaveCode(BLOCK_START, BLOCK_SIZE));
+	EXPECT_EQ_INT(blocks.GetBlockNumberFromAddress(BLOCK_START + 8), -1);
+	EXPECT_EQ_INT((int)blocks.FindInvalidatedBlockNumbers(BLOCK_START, BLOCK_SIZE).size(), 0);
+
+	blocks.Clear();
+	return true;
+}
+
+// Not a pass/fail check, prints the cost of reloading an overlay the old and new way.
+bool TestJitPageIndexBenchmark() {
+	static const u32 MAIN_START = 0x08804000;
+	static const u32 OVERLAY_START = 0x08C00000;
+	static const u32 OVERLAY_SIZE = 0x40000;
+	static const u32 DATA_START = 0x09000000;
+	static const int ITERATIONS = 200;
+
+	PageIndexTestCache cache;
+	PageIndexTestMapCache mapCache;
+	u32 seed = 1;
+	auto addBlocks = [&](u32 start, u32 size, int count) {
+		for (int i = 0; i < count; ++i) {
+			u32 blockStart = start + (NextRandom(seed) % size & ~3);
+			u32 blockSize = 4 * (1 + NextRandom(seed) % 32);
+			int num = cache.Add(blockStart, blockSize);
+			mapCache.Add(blockStart, blockSize, num);
+		}
+	};
+	addBlocks(MAIN_START, 0x200000, 20000);
+
+	double indexTime = 0.0;
+	double mapTime = 0.0;
+	int invalidated = 0;
+	for (int i = 0; i < ITERATIONS; ++i) {
+		addBlocks(OVERLAY_START, OVERLAY_SIZE, 2000);
+
+		// Games stream overlays and data in chunks, most of which hits no code at all.
+		double st = time_now_d();
+		for (u32 offset = 0; offset < 0x100000; offset += 0x800)
+			cache.Invalidate(DATA_START + offset, 0x800);
+		for (u32 offset = 0; offset < OVERLAY_SIZE; offset += 0x800)
+			invalidated += cache.Invalidate(OVERLAY_START + offset, 0x800);
+		indexTime += time_now_d() - st;
+
+		st = time_now_d();
+		for (u32 offset = 0; offset < 0x100000; offset += 0x800)
+			mapCache.Invalidate(DATA_START + offset, 0x800);
+		for (u32 offset = 0; offset < OVERLAY_SIZE; offset += 0x800)
+			mapCache.Invalidate(OVERLAY_START + offset, 0x800);
+		mapTime += time_now_d() - st;
+	}
+
+	printf("Overlay reloads: map %0.2f us, page index %0.2f us per reload (%0.2fx, %d blocks)\n",
+		mapTime * 1e6 / ITERATIONS, indexTime * 1e6 / ITERATIONS, mapTime / indexTime, invalidated / ITERATIONS);
+	return true;
+}
+
+bool TestJitPageIndex() {
+	if (!TestPageIndexBasics())
+		return false;
+	if (!TestPageIndexRandom())
+		return false;
+
+	Memory::g_MemorySize = Memory::RAM_NORMAL_SIZE;
+	if (!Memory::Init()) {
+		printf("TestJitPageIndex FAILED: unable to map memory\n");
+		return false;
+	}
+	bool retval = TestIRBlockCacheInvalidate();
+	Memory::Shutdown();
+	return retval;
+}
@@ -0,0 +1,293 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Common/Serialize/Serializer.h"
+#include "Common/Serialize/SerializeFuncs.h"
+#include "Common/TimeUtil.h"
+#include "Core/CoreTiming.h"
+#include "Core/HLE/sceKernel.h"
+#include "Core/HLE/sceKernelSemaphore.h"
+#include "UnitTest.h"
+
+template <int ID_TYPE>
+struct TestKernelObject : public KernelObject {
+	const char *GetName() override { return "Test"; }
+	const char *GetTypeName() override { return GetStaticTypeName(); }
+	static const char *GetStaticTypeName() { return ID_TYPE == SCE_KERNEL_TMID_Semaphore ? "TestSemaphore" : "TestEventFlag"; }
+	static u32 GetMissingErrorCode() { return ID_TYPE == SCE_KERNEL_TMID_Semaphore ? SCE_KERNEL_ERROR_UNKNOWN_SEMID : SCE_KERNEL_ERROR_UNKNOWN_EVFID; }
+	static int GetStaticIDType() { return ID_TYPE; }
+	int GetIDType() const override { return ID_TYPE; }
+
+	void DoState(PointerWrap &p) override {
+		auto s = p.Section("TestKernelObject", 1);
+		if (!s)
+			return;
+		Do(p, value);
+	}
+
+	int value = 0;
+};
+
+typedef TestKernelObject<SCE_KERNEL_TMID_Semaphore> TestSemaphore;
+typedef TestKernelObject<SCE_KERNEL_TMID_EventFlag> TestEventFlag;
+
+// The previous pool[] and occupied[] layout, to compare save states and lookup speed against.
+class LegacyKernelObjectPool {
+public:
+	LegacyKernelObjectPool() {
+		memset(occupied, 0, sizeof(occupied));
+	}
+	~LegacyKernelObjectPool() {
+		for (int i = 0; i < maxCount; i++) {
+			if (occupied[i])
+				delete pool[i];
+		}
+	}
+
+	SceUID Create(KernelObject *obj, int rangeBottom = initialNextID, int rangeTop = 0x7fffffff) {
+		if (rangeTop > maxCount)
+			rangeTop = maxCount;
+		if (nextID >= rangeBottom && nextID < rangeTop)
+			rangeBottom = nextID++;
+		for (int i = rangeBottom; i < rangeTop; i++) {
+			if (!occupied[i]) {
+				occupied[i] = true;
+				pool[i] = obj;
+				return i + handleOffset;
+			}
+		}
+		return 0;
+	}
+
+	template <class T>
+	T *Get(SceUID handle, u32 &outError) {
+		if (handle < handleOffset || handle >= handleOffset + maxCount || !occupied[handle - handleOffset]) {
+			outError = T::GetMissingErrorCode();
+			return 0;
+		}
+		T *t = static_cast<T *>(pool[handle - handleOffset]);
+		if (t == nullptr || t->GetIDType() != T::GetStaticIDType()) {
+			outError = T::GetMissingErrorCode();
+			return 0;
+		}
+		outError = SCE_KERNEL_ERROR_OK;
+		return t;
+	}
+
+	template <class T>
+	u32 Destroy(SceUID handle) {
+		u32 error;
+		if (Get<T>(handle, error)) {
+			int index = handle - handleOffset;
+			occupied[index] = false;
+			delete pool[index];
+			pool[index] = nullptr;
+		}
+		return error;
+	}
+
+	void DoState(PointerWrap &p) {
+		auto s = p.Section("KernelObjectPool", 1);
+		if (!s)
+			return;
+		int _maxCount = maxCount;
+		Do(p, _maxCount);
+		Do(p, nextID);
+		DoArray(p, occupied, maxCount);
+		for (int i = 0; i < maxCount; ++i) {
+			if (!occupied[i])
+				continue;
+			int type = pool[i]->GetIDType();
+			Do(p, type);
+			pool[i]->DoState(p);
+		}
+	}
+
+private:
+	enum {
+		maxCount = 4096,
+		handleOffset = 0x100,
+		initialNextID = 0x10
+	};
+	KernelObject *pool[maxCount];
+	bool occupied[maxCount];
+	int nextID = initialNextID;
+};
+
+static bool TestKernelObjectLookups() {
+	KernelObjectPool objects;
+	TestSemaphore *sema = new TestSemaphore();
+	TestEventFlag *flag = new TestEventFlag();
+	SceUID semaID = objects.Create(sema);
+	SceUID flagID = objects.Create(flag);
+	EXPECT_TRUE(semaID != 0 && flagID != 0 && semaID != flagID);
+	EXPECT_EQ_INT(sema->GetUID(), semaID);
+	EXPECT_EQ_INT(objects.GetCount(), 2);
+
+	u32 error = 0;
+	EXPECT_TRUE(objects.Get<TestSemaphore>(semaID, error) == sema);
+	EXPECT_EQ_HEX(error, SCE_KERNEL_ERROR_OK);
+	EXPECT_TRUE(objects.Get<TestEventFlag>(flagID, error) == flag);
+
+	// Wrong type, out of range, and never created handles.
+	EXPECT_TRUE(objects.Get<TestEventFlag>(semaID, error) == nullptr);
+	EXPECT_EQ_HEX(error, SCE_KERNEL_ERROR_UNKNOWN_EVFID);
+	EXPECT_TRUE(objects.Get<TestSemaphore>(0, error) == nullptr);
+	EXPECT_EQ_HEX(error, SCE_KERNEL_ERROR_UNKNOWN_SEMID);
+	EXPECT_TRUE(objects.Get<TestSemaphore>(-1, error) == nullptr);
+	EXPECT_TRUE(objects.Get<TestSemaphore>(0x7FFFFFFF, error) == nullptr);
+	EXPECT_TRUE(objects.Get<TestSemaphore>(flagID + 1, error) == nullptr);
+	EXPECT_FALSE(objects.IsValid(flagID + 1));
+
+	int type = 0;
+	EXPECT_TRUE(objects.GetIDType(flagID, &type));
+	EXPECT_EQ_INT(type, SCE_KERNEL_TMID_EventFlag);
+
+	SceUID_le uids[4];
+	EXPECT_EQ_INT(objects.ListIDType(SCE_KERNEL_TMID_Semaphore, uids, 4), 1);
+	EXPECT_EQ_INT(uids[0], semaID);
+
+	// Destroying with the wrong type must leave the object alone.
+	EXPECT_EQ_HEX(objects.Destroy<TestEventFlag>(semaID), SCE_KERNEL_ERROR_UNKNOWN_EVFID);
+	EXPECT_TRUE(objects.IsValid(semaID));
+	EXPECT_EQ_HEX(objects.Destroy<TestSemaphore>(semaID), SCE_KERNEL_ERROR_OK);
+	EXPECT_FALSE(objects.IsValid(semaID));
+	EXPECT_TRUE(objects.Get<TestSemaphore>(semaID, error) == nullptr);
+	EXPECT_EQ_INT(objects.ListIDType(SCE_KERNEL_TMID_Semaphore, uids, 4), 0);
+	EXPECT_EQ_INT(objects.GetCount(), 1);
+
+	objects.Clear();
+	EXPECT_EQ_INT(objects.GetCount(), 0);
+	EXPECT_FALSE(objects.IsValid(flagID));
+	return true;
+}
+
+// The slot table must still save in the format of the old pool[] and occupied[] arrays.
+static bool TestKernelObjectSaveState() {
+	KernelObjectPool objects;
+	LegacyKernelObjectPool legacy;
+
+	std::vector<SceUID> ids;
+	for (int i = 0; i < 100; ++i) {
+		TestSemaphore *sema = new TestSemaphore();
+		TestEventFlag *flag = new TestEventFlag();
+		sema->value = i;
+		flag->value = -i;
+		SceUID semaID = objects.Create(sema);
+		SceUID flagID = objects.Create(flag, 0x200, 0x800);
+
+		TestSemaphore *legacySema = new TestSemaphore();
+		TestEventFlag *legacyFlag = new TestEventFlag();
+		legacySema->value = i;
+		legacyFlag->value = -i;
+		EXPECT_EQ_INT(legacy.Create(legacySema), semaID);
+		EXPECT_EQ_INT(legacy.Create(legacyFlag, 0x200, 0x800), flagID);
+		ids.push_back(semaID);
+	}
+	for (size_t i = 0; i < ids.size(); i += 3) {
+		EXPECT_EQ_HEX(objects.Destroy<TestSemaphore>(ids[i]), legacy.Destroy<TestSemaphore>(ids[i]));
+	}
+
+	std::vector<u8> saved, legacySaved;
+	EXPECT_TRUE(CChunkFileReader::MeasureAndSavePtr(objects, &saved) == CChunkFileReader::ERROR_NONE);
+	EXPECT_TRUE(CChunkFileReader::MeasureAndSavePtr(legacy, &legacySaved) == CChunkFileReader::ERROR_NONE);
+	EXPECT_EQ_INT((int)saved.size(), (int)legacySaved.size());
+	EXPECT_TRUE(saved == legacySaved);
+	objects.Clear();
+	return true;
+}
+
+// Runs the real sceKernelSignalSema/sceKernelWaitSema pair, which never blocks since each wait
+// takes the count the signal just added.  Returns the time taken, or a negative value on failure.
+static double TimeSemaSignalWait(int semaphores, int iterations) {
+	CoreTiming::Init();
+	__KernelSemaInit();
+
+	std::vector<SceUID> ids;
+	for (int i = 0; i < semaphores; ++i) {
+		ids.push_back(sceKernelCreateSema("bench", 0, 0, 1, 0));
+		kernelObjects.Create(new TestEventFlag());
+	}
+
+	bool failed = false;
+	double st = time_now_d();
+	for (int i = 0; i < iterations; ++i) {
+		SceUID id = ids[i & (semaphores - 1)];
+		if (sceKernelSignalSema(id, 1) != 0 || sceKernelWaitSema(id, 1, 0) != 0)
+			failed = true;
+	}
+	double elapsed = time_now_d() - st;
+
+	kernelObjects.Clear();
+	CoreTiming::Shutdown();
+	return failed ? -1.0 : elapsed;
+}
+
+// Not a pass/fail check, prints the cost of a signal/wait pair and of the two lookups inside it.
+bool TestKernelObjectPoolBenchmark() {
+	static const int SEMAPHORES = 64;
+	static const int ITERATIONS = 4000000;
+
+	auto run = [&](auto &objects) {
+		std::vector<SceUID> ids;
+		for (int i = 0; i < SEMAPHORES; ++i) {
+			// Interleave other types, like a game would.
+			ids.push_back(objects.Create(new TestSemaphore()));
+			objects.Create(new TestEventFlag());
+		}
+
+		u32 error;
+		double st = time_now_d();
+		for (int i = 0; i < ITERATIONS; ++i) {
+			SceUID id = ids[i & (SEMAPHORES - 1)];
+			// Signal, then wait, each looking the semaphore up again.
+			TestSemaphore *sema = objects.template Get<TestSemaphore>(id, error);
+			if (sema)
+				sema->value++;
+			sema = objects.template Get<TestSemaphore>(id, error);
+			if (sema && sema->value > 0)
+				sema->value--;
+		}
+		return time_now_d() - st;
+	};
+
+	LegacyKernelObjectPool legacy;
+	double legacyTime = run(legacy);
+	KernelObjectPool objects;
+	double slotTime = run(objects);
+	objects.Clear();
+
+	double syscallTime = TimeSemaSignalWait(SEMAPHORES, ITERATIONS);
+	if (syscallTime < 0.0) {
+		printf("KernelObjectPool FAILED: sceKernelSignalSema/sceKernelWaitSema returned an error\n");
+		return false;
+	}
+
+	printf("KernelObjectPool: sceKernelSignalSema+sceKernelWaitSema %0.2f ns, of which lookups pool+occupied %0.2f ns, slots %0.2f ns (%0.2fx)\n",
+		syscallTime * 1e9 / ITERATIONS, legacyTime * 1e9 / ITERATIONS, slotTime * 1e9 / ITERATIONS, legacyTime / slotTime);
+	return true;
+}
+
+bool TestKernelObjectPool() {
+	if (!TestKernelObjectLookups())
+		return false;
+	return TestKernelObjectSaveState();
+}
@@ -0,0 +1,156 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Common/TimeUtil.h"
+#include "Core/Debugger/MemBlockInfo.h"
+#include "Core/MIPS/MIPS.h"
+
+static const char *const tags[] = { "sceIoRead", "ReplaceMemcpy/VideoDecode", "GPUMemcpy/Texture", "sceMpegAvcDecode" };
+
+// Mostly small writes marching forward with the same tag, with textures and copies mixed in.
+// When flushEach is set, every notify is applied on its own before the next one.
+static void ReplayTraffic(int count, bool flushEach) {
+	srand(5);
+	u32 cursor = 0x08900000;
+	for (int i = 0; i < count; ++i) {
+		currentMIPS->pc = 0x08804000 + (i / 64) * 4;
+		u32 start, size;
+		int kind = i % 100;
+		if (kind < 80) {
+			const char *tag = tags[(i / 256) % 3];
+			start = cursor;
+			size = 16;
+			NotifyMemInfoPC(MemBlockFlags::WRITE, start, size, currentMIPS->pc, tag, strlen(tag));
+			cursor += size;
+			if (cursor >= 0x09000000)
+				cursor = 0x08900000;
+		} else if (kind < 90) {
+			start = 0x08800000 + (rand() % 0x400) * 0x1000;
+			size = 0x1000 + (rand() % 4) * 0x1000;
+			NotifyMemInfoPC(MemBlockFlags::TEXTURE, start, size, currentMIPS->pc, "Texture", 7);
+		} else if (kind < 97) {
+			const char *tag = tags[rand() % 4];
+			start = 0x08800000 + (rand() % 0x8000) * 0x100;
+			size = 0x100 + (rand() % 8) * 0x40;
+			NotifyMemInfoPC(MemBlockFlags::WRITE, start, size, currentMIPS->pc, tag, strlen(tag));
+		} else {
+			u32 src = 0x08800000 + (rand() % 0x8000) * 0x100;
+			start = 0x08800000 + (rand() % 0x8000) * 0x100;
+			size = 0x400;
+			NotifyMemInfoCopy(start, src, size, "Copy/");
+		}
+
+		if (flushEach)
+			FindMemInfo(start, size);
+	}
+}
+
+static bool SameInfo(const std::vector<MemBlockInfo> &a, const std::vector<MemBlockInfo> &b) {
+	if (a.size() != b.size())
+		return false;
+	for (size_t i = 0; i < a.size(); ++i) {
+		if (a[i].flags != b[i].flags || a[i].start != b[i].start || a[i].size != b[i].size)
+			return false;
+		// Ticks are left out, the extra queries in the reference run can move them.
+		if (a[i].pc != b[i].pc || a[i].tag != b[i].tag || a[i].allocated != b[i].allocated)
+			return false;
+	}
+	return true;
+}
+
+static bool TestMemBlockInfoCoalesce() {
+	MemBlockInfoInit();
+	for (u32 i = 0; i < 64; ++i)
+		NotifyMemInfoPC(MemBlockFlags::WRITE, 0x08a00000 + i * 16, 16, 0x08804000, "Decode", 6);
+
+	bool retval = true;
+	std::vector<MemBlockInfo> results = FindMemInfoByFlag(MemBlockFlags::WRITE, 0x08a00000, 0x400);
+	if (results.size() != 1 || results[0].start != 0x08a00000 || results[0].size != 0x400 || results[0].tag != "Decode") {
+		printf("MemBlockInfo FAILED: sequential writes did not end up as one block\n");
+		retval = false;
+	}
+
+	// A different tag in the middle should still split it, even right after a flush.
+	NotifyMemInfoPC(MemBlockFlags::WRITE, 0x08a00100, 16, 0x08804000, "Other", 5);
+	NotifyMemInfoPC(MemBlockFlags::WRITE, 0x08a00110, 16, 0x08804000, "Other", 5);
+	results = FindMemInfoByFlag(MemBlockFlags::WRITE, 0x08a00000, 0x400);
+	if (results.size() != 3 || results[1].start != 0x08a00100 || results[1].size != 0x20 || results[1].tag != "Other") {
+		printf("MemBlockInfo FAILED: tag change was lost\n");
+		retval = false;
+	}
+
+	MemBlockInfoShutdown();
+	return retval;
+}
+
+static bool TestMemBlockInfoBatching() {
+	const int count = 20000;
+
+	MemBlockInfoInit();
+	ReplayTraffic(count, true);
+	std::vector<MemBlockInfo> expected = FindMemInfo(0x08000000, 0x02000000);
+	MemBlockInfoShutdown();
+
+	MemBlockInfoInit();
+	ReplayTraffic(count, false);
+	std::vector<MemBlockInfo> actual = FindMemInfo(0x08000000, 0x02000000);
+	MemBlockInfoShutdown();
+
+	if (!SameInfo(expected, actual)) {
+		printf("MemBlockInfo FAILED: batched notifies gave %d blocks, expected %d\n", (int)actual.size(), (int)expected.size());
+		return false;
+	}
+	return true;
+}
+
+// Not a pass/fail check, just prints the cost of heavy notify traffic.
+static void RunMemBlockInfoBenchmark() {
+	const int count = 200000;
+
+	MemBlockInfoInit();
+	double st = time_now_d();
+	ReplayTraffic(count, false);
+	double notifyTime = time_now_d() - st;
+
+	st = time_now_d();
+	std::vector<MemBlockInfo> results = FindMemInfo(0x08000000, 0x02000000);
+	double findTime = time_now_d() - st;
+	MemBlockInfoShutdown();
+
+	printf("MemBlockInfo: %0.1f ns/notify, final flush and find %0.2f ms (%d blocks)\n",
+		notifyTime * 1e9 / count, findTime * 1e3, (int)results.size());
+}
+
+bool TestMemBlockInfo() {
+	MemBlockOverrideDetailed();
+	bool retval = TestMemBlockInfoCoalesce() && TestMemBlockInfoBatching();
+	MemBlockReleaseDetailed();
+	return retval;
+}
+
+bool TestMemBlockInfoBenchmark() {
+	MemBlockOverrideDetailed();
+	RunMemBlockInfoBenchmark();
+	MemBlockReleaseDetailed();
+	return true;
+}
@@ -0,0 +1,223 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Common/TimeUtil.h"
+#include "Core/MemMap.h"
+#include "Core/MemMapBulk.h"
+#include "UnitTest.h"
+
+// What the libc replacements did before: memcpy in 16 byte blocks, then bytes.
+static void ReferenceCopyForward16(u8 *dst, const u8 *src, size_t bytes) {
+	const size_t blocks = bytes & ~0x0f;
+	for (size_t offset = 0; offset < blocks; offset += 0x10) {
+		u8 block[16];
+		memcpy(block, src + offset, 0x10);
+		memcpy(dst + offset, block, 0x10);
+	}
+	for (size_t offset = blocks; offset < bytes; ++offset)
+		dst[offset] = src[offset];
+}
+
+static bool TestBulkHostCopy() {
+	std::vector<u8> expected(8192), actual(8192);
+	srand(42);
+	for (int i = 0; i < 500; ++i) {
+		for (size_t j = 0; j < expected.size(); ++j)
+			expected[j] = (u8)rand();
+		actual = expected;
+
+		// Overlap in both directions, misaligned, and not at all.
+		size_t size = rand() % 1024;
+		size_t src = rand() % 1024 + 1024;
+		size_t dest = src + (rand() % 64) - 32;
+		if (i % 5 == 0)
+			dest = src + 2048;
+		ReferenceCopyForward16(&expected[dest], &expected[src], size);
+		Memory::Bulk::CopyForward16Host(&actual[dest], &actual[src], size);
+		if (actual != expected) {
+			printf("CopyForward16Host FAILED: size %d from %d to %d\n", (int)size, (int)src, (int)dest);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool TestBulkAddresses() {
+	using Memory::Bulk::PhysicalAddress;
+	using Memory::Bulk::RangesOverlap;
+	EXPECT_EQ_HEX(PhysicalAddress(0x48800000, 0x100), 0x08800000);
+	EXPECT_EQ_HEX(PhysicalAddress(0x88800000, 0x100), 0x08800000);
+	EXPECT_EQ_HEX(PhysicalAddress(0x04600010, 0x100), 0x04000010);
+	EXPECT_EQ_HEX(PhysicalAddress(0x44200010, 0x100), 0x04000010);
+	// Crossing a mirror boundary keeps the mirror, the views are contiguous there.
+	EXPECT_EQ_HEX(PhysicalAddress(0x041FFF00, 0x200), 0x041FFF00);
+	EXPECT_TRUE(RangesOverlap(0x48800000, 0x08800010, 0x20));
+	EXPECT_TRUE(RangesOverlap(0x04200000, 0x04000000, 0x10));
+	EXPECT_FALSE(RangesOverlap(0x08800000, 0x08800010, 0x10));
+	return true;
+}
+
+static bool TestBulkGuest() {
+	const u32 base = 0x08800000;
+	u8 *ptr = Memory::GetPointerWriteUnchecked(base);
+	for (int i = 0; i < 256; ++i)
+		ptr[i] = (u8)i;
+
+	// Overlapping through the uncached mirror should still copy in 16 byte blocks.
+	std::vector<u8> expected(ptr, ptr + 256);
+	ReferenceCopyForward16(&expected[4], &expected[0], 100);
+	EXPECT_TRUE(Memory::Bulk::CopyForward16(base + 4 + 0x40000000, base, 100));
+	EXPECT_TRUE(memcmp(ptr, expected.data(), expected.size()) == 0);
+
+	// And memmove semantics the same way, even between VRAM mirrors.
+	u8 *vram = Memory::GetPointerWriteUnchecked(0x04000000);
+	for (int i = 0; i < 64; ++i)
+		vram[i] = (u8)i;
+	EXPECT_TRUE(Memory::Bulk::Move(0x04200008, 0x04000000, 32));
+	for (int i = 0; i < 32; ++i)
+		EXPECT_EQ_INT(vram[8 + i], i);
+
+	EXPECT_TRUE(Memory::Bulk::Set(base, 'x', 16));
+	ptr[16] = 0;
+	u32 len = 0;
+	EXPECT_TRUE(Memory::Bulk::StringLength(base, 0x1000, &len));
+	EXPECT_EQ_INT(len, 16);
+	EXPECT_FALSE(Memory::Bulk::StringLength(base, 8, &len));
+	EXPECT_EQ_INT(len, 8);
+
+	strcpy((char *)ptr + 32, "xxxxxxxxxxxxxxxxy");
+	int result = 0;
+	EXPECT_TRUE(Memory::Bulk::StringCompare(base, base + 32, 0xFFFFFFFF, &result));
+	EXPECT_TRUE(result < 0);
+	EXPECT_TRUE(Memory::Bulk::StringCompare(base, base + 32, 16, &result));
+	EXPECT_EQ_INT(result, 0);
+	// An empty string sorts first.
+	ptr[64] = 0;
+	EXPECT_TRUE(Memory::Bulk::StringCompare(base + 64, base, 0xFFFFFFFF, &result));
+	EXPECT_TRUE(result < 0);
+
+	// Running off the end of RAM without a terminator.
+	const u32 end = 0x08000000 + Memory::g_MemorySize;
+	memset(Memory::GetPointerWriteUnchecked(end - 16), 'z', 16);
+	EXPECT_FALSE(Memory::Bulk::StringLength(end - 16, 0x1000, &len));
+	EXPECT_EQ_INT(len, 16);
+	return true;
+}
+
+// The previous strcmp replacement, which scanned both strings before comparing.
+static u32 OldSafeStringLen(const u32 ptr) {
+	u32 maxLen = Memory::ValidSize(ptr, 0x07FFFFFF);
+	const u8 *p = Memory::GetPointerRange(ptr, maxLen);
+	if (!p)
+		return 0;
+	const u8 *end = (const u8 *)memchr(p, '\0', maxLen);
+	if (!end)
+		return 0;
+	return (u32)(end - p);
+}
+
+static int OldStringCompare(u32 aPtr, u32 bPtr) {
+	u32 aLen = OldSafeStringLen(aPtr);
+	const char *a = (const char *)Memory::GetPointerRange(aPtr, aLen);
+	u32 bLen = OldSafeStringLen(bPtr);
+	const char *b = (const char *)Memory::GetPointerRange(bPtr, bLen);
+	if (a && b && aLen != 0 && bLen != 0)
+		return strcmp(a, b);
+	return 0;
+}
+
+static void OldMove(u32 destPtr, u32 srcPtr, u32 bytes) {
+	u8 *dst = Memory::GetPointerWriteRange(destPtr, bytes);
+	const u8 *src = Memory::GetPointerRange(srcPtr, bytes);
+	if (dst && src)
+		memmove(dst, src, bytes);
+}
+
+// Not a pass/fail check, just prints the difference against the previous replacements.
+static void BenchmarkBulk() {
+	static const u32 sizes[] = { 64, 512, 4096, 65536, 512 * 1024 };
+	const u32 a = 0x08800000;
+	const u32 b = 0x08900000;
+	u8 *pa = Memory::GetPointerWriteUnchecked(a);
+	u8 *pb = Memory::GetPointerWriteUnchecked(b);
+
+	for (u32 size : sizes) {
+		const int iterations = (int)(64 * 1024 * 1024 / size) + 1;
+		for (u32 i = 0; i < size; ++i)
+			pa[i] = pb[i] = (u8)(i % 251 + 1);
+		pa[size] = 0;
+		pb[size] = 0;
+
+		int sum = 0;
+		double st = time_now_d();
+		for (int i = 0; i < iterations; ++i)
+			sum += OldStringCompare(a, b);
+		double oldCompare = time_now_d() - st;
+
+		st = time_now_d();
+		for (int i = 0; i < iterations; ++i) {
+			int result;
+			Memory::Bulk::StringCompare(a, b, 0xFFFFFFFF, &result);
+			sum += result;
+		}
+		double newCompare = time_now_d() - st;
+
+		st = time_now_d();
+		for (int i = 0; i < iterations; ++i)
+			OldMove(b, a, size);
+		double oldMove = time_now_d() - st;
+
+		st = time_now_d();
+		for (int i = 0; i < iterations; ++i)
+			Memory::Bulk::Move(b, a, size);
+		double newMove = time_now_d() - st;
+
+		printf("Bulk %6d bytes: strcmp %0.1f -> %0.1f ns, memmove %0.1f -> %0.1f ns%s\n", (int)size,
+			oldCompare * 1e9 / iterations, newCompare * 1e9 / iterations,
+			oldMove * 1e9 / iterations, newMove * 1e9 / iterations, sum == 1 ? " " : "");
+	}
+}
+
+bool TestMemMapBulk() {
+	if (!TestBulkHostCopy() || !TestBulkAddresses())
+		return false;
+
+	Memory::g_MemorySize = Memory::RAM_NORMAL_SIZE;
+	if (!Memory::Init()) {
+		printf("TestMemMapBulk FAILED: unable to map memory\n");
+		return false;
+	}
+	bool retval = TestBulkGuest();
+	Memory::Shutdown();
+	return retval;
+}
+
+bool TestMemMapBulkBenchmark() {
+	Memory::g_MemorySize = Memory::RAM_NORMAL_SIZE;
+	if (!Memory::Init()) {
+		printf("TestMemMapBulkBenchmark FAILED: unable to map memory\n");
+		return false;
+	}
+	BenchmarkBulk();
+	Memory::Shutdown();
+	return true;
+}
@@ -0,0 +1,124 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+
+// Write watching is only implemented on desktop Linux, see MemWriteWatch.h.
+#if PPSSPP_PLATFORM(LINUX) && !PPSSPP_PLATFORM(ANDROID)
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+#include "Common/ExceptionHandlerSetup.h"
+#include "Core/MemFault.h"
+#include "Core/MemMap.h"
+#include "Core/MemWriteWatch.h"
+#include "UnitTest.h"
+
+static const u32 WATCHED_ADDR = 0x08900000;
+static const u32 UNTOUCHED_ADDR = 0x08A00000;
+static const u32 RANGE_SIZE = 0x4000;
+
+static bool TestWriteWatchFaults() {
+	Memory::WriteWatchStamp watched = Memory::WriteWatch_Protect(WATCHED_ADDR, RANGE_SIZE);
+	Memory::WriteWatchStamp untouched = Memory::WriteWatch_Protect(UNTOUCHED_ADDR, RANGE_SIZE);
+	EXPECT_TRUE(watched != 0);
+	EXPECT_TRUE(untouched != 0);
+	EXPECT_FALSE(Memory::WriteWatch_ChangedSince(WATCHED_ADDR, RANGE_SIZE, watched));
+	EXPECT_FALSE(Memory::WriteWatch_ChangedSince(UNTOUCHED_ADDR, RANGE_SIZE, untouched));
+
+	// A plain host write, like the interpreter or a memcpy replacement would do. This faults once.
+	volatile u8 *ptr = Memory::GetPointerWrite(WATCHED_ADDR + 0x1234);
+	EXPECT_TRUE(ptr != nullptr);
+	*ptr = 0x5A;
+	EXPECT_EQ_INT(Memory::Read_U8(WATCHED_ADDR + 0x1234), 0x5A);
+	EXPECT_TRUE(Memory::WriteWatch_ChangedSince(WATCHED_ADDR, RANGE_SIZE, watched));
+	EXPECT_TRUE(Memory::WriteWatch_ChangedSince(WATCHED_ADDR + 0x1000, 4, watched));
+	// Other pages of the same range weren't written.
+	EXPECT_FALSE(Memory::WriteWatch_ChangedSince(WATCHED_ADDR, 0x1000, watched));
+	EXPECT_FALSE(Memory::WriteWatch_ChangedSince(UNTOUCHED_ADDR, RANGE_SIZE, untouched));
+
+	// Reads don't count.
+	EXPECT_EQ_INT(Memory::Read_U32(UNTOUCHED_ADDR), 0);
+	EXPECT_FALSE(Memory::WriteWatch_ChangedSince(UNTOUCHED_ADDR, RANGE_SIZE, untouched));
+	return true;
+}
+
+static bool TestWriteWatchHostWrites() {
+	static const u32 READ_SIZE = 0x1000;
+	u8 data[READ_SIZE];
+	for (u32 i = 0; i < READ_SIZE; ++i)
+		data[i] = (u8)(i * 7 + 1);
+
+	int fds[2];
+	EXPECT_EQ_INT(pipe(fds), 0);
+	u8 *dst = Memory::GetPointerWrite(WATCHED_ADDR);
+
+	// The kernel doesn't fault on protected pages, read() just fails.
+	Memory::WriteWatchStamp stamp = Memory::WriteWatch_Protect(WATCHED_ADDR, RANGE_SIZE);
+	EXPECT_TRUE(stamp != 0);
+	EXPECT_EQ_INT((int)write(fds[1], data, READ_SIZE), (int)READ_SIZE);
+	ssize_t result = read(fds[0], dst, READ_SIZE);
+	int readError = errno;
+	EXPECT_EQ_INT((int)result, -1);
+	EXPECT_EQ_INT(readError, EFAULT);
+
+	// Bracketed, it goes through and the pages are stamped.
+	Memory::WriteWatch_BeginHostWrite(dst, READ_SIZE);
+	result = read(fds[0], dst, READ_SIZE);
+	Memory::WriteWatch_EndHostWrite(dst, READ_SIZE);
+	close(fds[0]);
+	close(fds[1]);
+
+	EXPECT_EQ_INT((int)result, (int)READ_SIZE);
+	EXPECT_TRUE(memcmp(dst, data, READ_SIZE) == 0);
+	EXPECT_TRUE(Memory::WriteWatch_ChangedSince(WATCHED_ADDR, READ_SIZE, stamp));
+	EXPECT_FALSE(Memory::WriteWatch_ChangedSince(WATCHED_ADDR + READ_SIZE, RANGE_SIZE - READ_SIZE, stamp));
+	return true;
+}
+
+bool TestMemWriteWatch() {
+	if (!Memory::WriteWatch_Supported()) {
+		printf("TestMemWriteWatch: page size not supported, skipping\n");
+		return true;
+	}
+
+	Memory::g_MemorySize = Memory::RAM_NORMAL_SIZE;
+	if (!Memory::Init()) {
+		printf("TestMemWriteWatch FAILED: unable to map memory\n");
+		return false;
+	}
+	InstallExceptionHandler(&Memory::HandleFault);
+	Memory::WriteWatch_SetAvailable(true);
+	Memory::WriteWatch_SetEnabled(true);
+
+	bool retval = Memory::WriteWatch_Enabled();
+	if (!retval)
+		printf("TestMemWriteWatch FAILED: unable to enable write watch\n");
+	retval = retval && TestWriteWatchFaults() && TestWriteWatchHostWrites();
+
+	Memory::WriteWatch_SetEnabled(false);
+	Memory::WriteWatch_SetAvailable(false);
+	UninstallExceptionHandler();
+	Memory::Shutdown();
+	return retval;
+}
+
+#endif
@@ -0,0 +1,111 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "Common/Data/Format/JSONReader.h"
+#include "Core/Debugger/SyscallProfiler.h"
+#include "Core/HLE/HLE.h"
+#include "UnitTest.h"
+
+static const HLEFunction profiledFuncs[] = {
+	{ 0x00000001, nullptr, "sceTestFast", 'i', "" },
+	{ 0x00000002, nullptr, "sceTestSlow", 'i', "x" },
+};
+
+static bool TestSyscallProfilerReport() {
+	SyscallProfilerReset();
+	SyscallProfilerStart();
+
+	// Frame 1: many cheap calls.  Frame 2: two slow ones.
+	double t = 100.0;
+	for (int i = 0; i < 10; ++i) {
+		SyscallProfilerRecord(&profiledFuncs[0], "TestModule", 0, t, 0.000010);
+		t += 0.001;
+	}
+	SyscallProfilerRecordFrame();
+	SyscallProfilerRecord(&profiledFuncs[1], "TestModule", 0, t, 0.002);
+	SyscallProfilerRecord(&profiledFuncs[1], "TestModule", 0, t + 0.01, 0.003);
+	SyscallProfilerRecord(&profiledFuncs[0], "TestModule", 0, t + 0.02, 0.000010);
+	SyscallProfilerRecordFrame();
+	SyscallProfilerStop();
+
+	SyscallProfilerReport report = SyscallProfilerGetReport(0, 0);
+	EXPECT_FALSE(report.running);
+	EXPECT_EQ_INT(report.calls, 13);
+	EXPECT_EQ_INT(report.frameCount, 2);
+	EXPECT_EQ_INT((int)report.frames.size(), 2);
+	EXPECT_EQ_INT(report.frames[0].calls, 10);
+	EXPECT_EQ_INT(report.frames[1].calls, 3);
+	EXPECT_EQ_INT(report.droppedEvents, 0);
+	EXPECT_EQ_INT((int)report.functions.size(), 2);
+
+	// The slow one should sort first.
+	const SyscallProfilerFunction &slow = report.functions[0];
+	const SyscallProfilerFunction &fast = report.functions[1];
+	EXPECT_TRUE(!strcmp(slow.name, "sceTestSlow"));
+	EXPECT_EQ_INT(slow.calls, 2);
+	EXPECT_EQ_FLOAT(slow.maxSeconds, 0.003);
+	EXPECT_TRUE(fabs(slow.maxFrameSeconds - 0.005) < 1e-9);
+	EXPECT_EQ_INT(fast.calls, 11);
+	EXPECT_TRUE(fabs(fast.maxFrameSeconds - 0.0001) < 1e-9);
+
+	report = SyscallProfilerGetReport(1, 1);
+	EXPECT_EQ_INT((int)report.functions.size(), 1);
+	EXPECT_EQ_INT((int)report.frames.size(), 1);
+	EXPECT_EQ_INT(report.frames[0].calls, 3);
+	return true;
+}
+
+static bool TestSyscallProfilerTrace() {
+	std::string trace = SyscallProfilerExportTrace();
+	json::JsonReader reader(trace.data(), trace.size());
+	if (!reader.ok()) {
+		printf("SyscallProfiler FAILED: trace isn't valid JSON\n");
+		return false;
+	}
+
+	const JsonNode *events = reader.root().getArray("traceEvents");
+	EXPECT_TRUE(events != nullptr);
+	int complete = 0, frames = 0;
+	for (const JsonNode *event : events->value) {
+		json::JsonGet e(event->value);
+		std::string ph = e.getStringOr("ph", "");
+		if (ph == "X") {
+			complete++;
+			EXPECT_TRUE(e.getFloat("dur") >= 10.0);
+			EXPECT_TRUE(!strcmp(e.getStringOr("cat", ""), "TestModule"));
+		} else if (ph == "i") {
+			frames++;
+		}
+	}
+	EXPECT_EQ_INT(complete, 13);
+	EXPECT_EQ_INT(frames, 2);
+	return true;
+}
+
+bool TestSyscallProfiler() {
+	if (!TestSyscallProfilerReport())
+		return false;
+	if (!TestSyscallProfilerTrace())
+		return false;
+	SyscallProfilerReset();
+	return true;
+}
@@ -0,0 +1,279 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "Common/TimeUtil.h"
+#include "GPU/Common/TextureCacheCommon.h"
+#include "UnitTest.h"
+
+static TexCacheEntry *NewEntry(u32 addr, u8 format, u16 dim, u32 cluthash = 0) {
+	TexCacheEntry *entry = new TexCacheEntry{};
+	entry->addr = addr;
+	entry->format = format;
+	entry->dim = dim;
+	entry->cluthash = cluthash;
+	return entry;
+}
+
+static u64 InsertEntry(TexCache &cache, u32 addr, u8 format, u16 dim, u32 cluthash = 0) {
+	TexCacheEntry *entry = NewEntry(addr, format, dim, cluthash);
+	u64 key = entry->CacheKey();
+	cache.Insert(key, entry);
+	return key;
+}
+
+static std::vector<u32> AddressesInRange(const TexCache &cache, u32 start, u32 end) {
+	std::vector<u32> found;
+	cache.ForEachInRange(start, end, [&](TexCacheEntry *entry) {
+		found.push_back(entry->addr);
+	});
+	std::sort(found.begin(), found.end());
+	return found;
+}
+
+static bool TestTexCacheBasics() {
+	for (bool rangeIndex : { false, true }) {
+		TexCache cache(rangeIndex);
+		u64 a = InsertEntry(cache, 0x04000000, GE_TFMT_8888, 0x0808);
+		u64 b = InsertEntry(cache, 0x08800000, GE_TFMT_5650, 0x0707);
+		EXPECT_EQ_INT((int)cache.size(), 2);
+		EXPECT_TRUE(cache.Get(a) != nullptr && cache.Get(a)->addr == 0x04000000);
+		EXPECT_TRUE(cache.Get(b) != nullptr && cache.Get(b)->addr == 0x08800000);
+		EXPECT_TRUE(cache.Get(a + 1) == nullptr);
+
+		// Replacing keeps one entry per key, and the range index sees the new one.
+		TexCacheEntry *replacement = NewEntry(0x08800000, GE_TFMT_5650, 0x0707);
+		cache.Insert(b, replacement);
+		EXPECT_EQ_INT((int)cache.size(), 2);
+		EXPECT_TRUE(cache.Get(b) == replacement);
+		if (rangeIndex) {
+			std::vector<TexCacheEntry *> seen;
+			cache.ForEachAtAddress(0x08800000, [&](TexCacheEntry *entry) {
+				seen.push_back(entry);
+			});
+			EXPECT_EQ_INT((int)seen.size(), 1);
+			EXPECT_TRUE(seen[0] == replacement);
+		}
+
+		cache.Erase(a);
+		cache.Erase(a);
+		EXPECT_EQ_INT((int)cache.size(), 1);
+		EXPECT_TRUE(cache.Get(a) == nullptr);
+		EXPECT_TRUE(AddressesInRange(cache, 0x04000000, 0x04000001).empty());
+
+		for (u32 i = 0; i < 100; ++i)
+			InsertEntry(cache, 0x08900000 + i * 0x1000, GE_TFMT_4444, 0x0505);
+		EXPECT_EQ_INT((int)cache.size(), 101);
+		cache.EraseIf([](TexCacheEntry *entry) {
+			return (entry->addr & 0x1000) != 0;
+		});
+		EXPECT_EQ_INT((int)cache.size(), 51);
+		int odd = 0;
+		cache.ForEach([&](TexCacheEntry *entry) {
+			if (entry->addr & 0x1000)
+				odd++;
+		});
+		EXPECT_EQ_INT(odd, 0);
+		if (rangeIndex)
+			EXPECT_EQ_INT((int)AddressesInRange(cache, 0x08900000, 0x08A00000).size(), 50);
+
+		cache.clear();
+		EXPECT_EQ_INT((int)cache.size(), 0);
+		EXPECT_TRUE(cache.Get(b) == nullptr);
+		EXPECT_TRUE(AddressesInRange(cache, 0, 0xFFFFFFFF).empty());
+	}
+	return true;
+}
+
+static bool TestTexCacheRanges() {
+	TexCache cache(true);
+	// Either side of a page boundary.
+	InsertEntry(cache, 0x0400FFF0, GE_TFMT_8888, 0x0404);
+	InsertEntry(cache, 0x04010000, GE_TFMT_8888, 0x0404);
+	InsertEntry(cache, 0x04030000, GE_TFMT_8888, 0x0404);
+	// Above 256MB, everything shares the last page.
+	InsertEntry(cache, 0x1F000000, GE_TFMT_8888, 0x0404);
+	InsertEntry(cache, 0x2F000000, GE_TFMT_8888, 0x0404);
+	InsertEntry(cache, 0x3FFFFF00, GE_TFMT_8888, 0x0404);
+
+	std::vector<u32> found = AddressesInRange(cache, 0x0400FFF8, 0x04010004);
+	EXPECT_EQ_INT((int)found.size(), 1);
+	EXPECT_EQ_INT(found[0], 0x04010000);
+	found = AddressesInRange(cache, 0x0400F000, 0x04030000);
+	EXPECT_EQ_INT((int)found.size(), 2);
+	EXPECT_EQ_INT(found[0], 0x0400FFF0);
+	EXPECT_EQ_INT(found[1], 0x04010000);
+	found = AddressesInRange(cache, 0x04000000, 0x04040000);
+	EXPECT_EQ_INT((int)found.size(), 3);
+	EXPECT_TRUE(AddressesInRange(cache, 0x04010001, 0x04030000).empty());
+	EXPECT_TRUE(AddressesInRange(cache, 0x04010000, 0x04010000).empty());
+
+	found = AddressesInRange(cache, 0x1F000000, 0x1F000001);
+	EXPECT_EQ_INT((int)found.size(), 1);
+	EXPECT_EQ_INT(found[0], 0x1F000000);
+	found = AddressesInRange(cache, 0x20000000, 0x40000000);
+	EXPECT_EQ_INT((int)found.size(), 2);
+	EXPECT_EQ_INT(found[0], 0x2F000000);
+	EXPECT_EQ_INT(found[1], 0x3FFFFF00);
+	found = AddressesInRange(cache, 0x0FFF0000, 0xFFFFFFFF);
+	EXPECT_EQ_INT((int)found.size(), 3);
+	return true;
+}
+
+static bool TestTexCacheClutVariants() {
+	TexCache cache(true);
+	const u32 addr = 0x04100000;
+	std::vector<u64> keys;
+	for (u32 clut = 1; clut <= 4; ++clut)
+		keys.push_back(InsertEntry(cache, addr, GE_TFMT_CLUT8, 0x0808, clut * 0x1234567));
+	// Same texture at a neighbour, and a non-CLUT format at the same address.
+	InsertEntry(cache, addr + 0x10, GE_TFMT_CLUT8, 0x0808, 0x1234567);
+	InsertEntry(cache, addr, GE_TFMT_8888, 0x0707);
+	EXPECT_EQ_INT((int)cache.size(), 6);
+
+	auto variantsAt = [&](u32 at) {
+		std::vector<u64> found;
+		cache.ForEachAtAddress(at, [&](TexCacheEntry *entry) {
+			found.push_back(entry->CacheKey());
+		});
+		std::sort(found.begin(), found.end());
+		return found;
+	};
+	std::vector<u64> expected = keys;
+	expected.push_back(TexCacheEntry::CacheKey(addr, GE_TFMT_8888, 0x0707, 0));
+	std::sort(expected.begin(), expected.end());
+	EXPECT_TRUE(variantsAt(addr) == expected);
+	// Mirrors (like uncached VRAM) find the same entries.
+	EXPECT_TRUE(variantsAt(addr | 0x40000000) == expected);
+
+	cache.Erase(keys[1]);
+	cache.Erase(keys[2]);
+	expected.erase(std::remove(expected.begin(), expected.end(), keys[1]), expected.end());
+	expected.erase(std::remove(expected.begin(), expected.end(), keys[2]), expected.end());
+	EXPECT_TRUE(variantsAt(addr) == expected);
+	return true;
+}
+
+typedef std::map<u64, TexCacheEntry *> TexCacheMap;
+
+// The lookups as they were done on the previous std::map, keyed the same way with the address on top.
+template <typename F>
+static void ForEachInMapRange(const TexCacheMap &cache, u32 start, u32 end, F func) {
+	const auto last = cache.lower_bound((u64)end << 32);
+	for (auto it = cache.lower_bound((u64)start << 32); it != last; ++it)
+		func(it->second);
+}
+
+// Prints the cost of the lookups against a std::map, and fails if they ever find different entries.
+bool TestTexCacheBenchmark() {
+	static const int NUM_ADDRESSES = 4000;
+	static const int ITERATIONS = 200000;
+	static const int RANGE_ITERATIONS = 20000;
+
+	TexCache indexed(true);
+	TexCacheMap map;
+	std::vector<u64> keys;
+	std::vector<u32> addrs;
+	u32 seed = 1;
+	for (int i = 0; i < NUM_ADDRESSES; ++i) {
+		u32 addr = (i & 1 ? 0x04000000 + NextRandom(seed) % 0x200000 : 0x08800000 + NextRandom(seed) % 0x1800000) & ~0xF;
+		addrs.push_back(addr);
+		// Some textures get drawn with several palettes.
+		int variants = 1 + (NextRandom(seed) & 3) / 3;
+		for (int j = 0; j < variants; ++j) {
+			TexCacheEntry *entry = NewEntry(addr, GE_TFMT_CLUT8, 0x0808, NextRandom(seed));
+			u64 key = entry->CacheKey();
+			if (indexed.Get(key))
+				continue;
+			indexed.Insert(key, entry);
+			map[key] = entry;
+			keys.push_back(key);
+		}
+	}
+	EXPECT_EQ_INT((int)indexed.size(), (int)map.size());
+
+	// Get() happens for every texture bound.
+	uintptr_t getFound = 0;
+	double st = time_now_d();
+	for (int i = 0; i < ITERATIONS; ++i)
+		getFound += (uintptr_t)indexed.Get(keys[i % keys.size()]);
+	double getTime = time_now_d() - st;
+
+	uintptr_t mapGetFound = 0;
+	st = time_now_d();
+	for (int i = 0; i < ITERATIONS; ++i) {
+		auto it = map.find(keys[i % keys.size()]);
+		mapGetFound += it != map.end() ? (uintptr_t)it->second : 0;
+	}
+	double mapGetTime = time_now_d() - st;
+
+	if (getFound != mapGetFound) {
+		printf("TexCache FAILED: Get() didn't find the same entries as the map\n");
+		return false;
+	}
+
+	// Ranges are what invalidation and CLUT variant lookups use, most of them small.
+	std::vector<std::pair<u32, u32>> ranges;
+	for (int i = 0; i < RANGE_ITERATIONS; ++i) {
+		u32 start = (NextRandom(seed) & 1) ? addrs[NextRandom(seed) % addrs.size()] : 0x08800000 + NextRandom(seed) % 0x1800000;
+		u32 size = (NextRandom(seed) & 3) == 0 ? 1 : 0x800 << (NextRandom(seed) % 6);
+		ranges.push_back(std::make_pair(start, start + size));
+	}
+
+	std::vector<uintptr_t> indexedFound(ranges.size());
+	st = time_now_d();
+	for (size_t i = 0; i < ranges.size(); ++i) {
+		indexed.ForEachInRange(ranges[i].first, ranges[i].second, [&](TexCacheEntry *entry) {
+			indexedFound[i] += (uintptr_t)entry;
+		});
+	}
+	double rangeTime = time_now_d() - st;
+
+	std::vector<uintptr_t> mapFound(ranges.size());
+	st = time_now_d();
+	for (size_t i = 0; i < ranges.size(); ++i) {
+		ForEachInMapRange(map, ranges[i].first, ranges[i].second, [&](TexCacheEntry *entry) {
+			mapFound[i] += (uintptr_t)entry;
+		});
+	}
+	double mapRangeTime = time_now_d() - st;
+
+	for (size_t i = 0; i < ranges.size(); ++i) {
+		if (indexedFound[i] != mapFound[i]) {
+			printf("TexCache FAILED: range %08x-%08x found different entries than the map\n", ranges[i].first, ranges[i].second);
+			return false;
+		}
+	}
+
+	printf("TexCache: Get map %0.2f ns, hash %0.2f ns (%0.2fx), ForEachInRange map %0.2f ns, pages %0.2f ns (%0.2fx), %d entries\n",
+		mapGetTime * 1e9 / ITERATIONS, getTime * 1e9 / ITERATIONS, mapGetTime / getTime,
+		mapRangeTime * 1e9 / RANGE_ITERATIONS, rangeTime * 1e9 / RANGE_ITERATIONS, mapRangeTime / rangeTime, (int)keys.size());
+	return true;
+}
+
+bool TestTexCache() {
+	if (!TestTexCacheBasics())
+		return false;
+	if (!TestTexCacheRanges())
+		return false;
+	return TestTexCacheClutVariants();
+}
@@ -0,0 +1,243 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "Common/Serialize/Serializer.h"
+#include "Common/Serialize/SerializeFuncs.h"
+#include "Common/TimeUtil.h"
+#include "Core/HLE/ThreadQueueList.h"
+#include "UnitTest.h"
+
+// Straightforward model of the ready queue ordering: best priority first, FIFO within a priority.
+struct ThreadQueueModel {
+	std::deque<SceUID> queues[ThreadQueueList::NUM_QUEUES];
+
+	SceUID pop_first_better(u32 priority) {
+		for (u32 i = 0; i < priority && i < ThreadQueueList::NUM_QUEUES; ++i) {
+			if (!queues[i].empty()) {
+				SceUID threadID = queues[i].front();
+				queues[i].pop_front();
+				return threadID;
+			}
+		}
+		return 0;
+	}
+
+	SceUID peek_first() const {
+		for (const auto &queue : queues) {
+			if (!queue.empty())
+				return queue.front();
+		}
+		return 0;
+	}
+
+	void remove(u32 priority, SceUID threadID) {
+		auto &queue = queues[priority];
+		for (auto it = queue.begin(); it != queue.end(); ++it) {
+			if (*it == threadID) {
+				queue.erase(it);
+				return;
+			}
+		}
+	}
+
+	void rotate(u32 priority) {
+		auto &queue = queues[priority];
+		if (queue.size() > 1) {
+			queue.push_back(queue.front());
+			queue.pop_front();
+		}
+	}
+};
+
+// The previous lookup, which walked a chain of every priority level ever used.
+struct ChainedThreadQueue {
+	struct Queue {
+		Queue *next;
+		std::deque<SceUID> data;
+	};
+
+	Queue *first = nullptr;
+	Queue queues[ThreadQueueList::NUM_QUEUES]{};
+	bool linked[ThreadQueueList::NUM_QUEUES]{};
+
+	void prepare(u32 priority) {
+		if (linked[priority])
+			return;
+		linked[priority] = true;
+		Queue *cur = &queues[priority];
+		for (int i = (int)priority - 1; i >= 0; --i) {
+			if (linked[i]) {
+				cur->next = queues[i].next;
+				queues[i].next = cur;
+				return;
+			}
+		}
+		cur->next = first;
+		first = cur;
+	}
+
+	void push_back(u32 priority, SceUID threadID) {
+		queues[priority].data.push_back(threadID);
+	}
+
+	SceUID pop_first_better(u32 priority) {
+		Queue *cur = first;
+		Queue *stop = &queues[priority];
+		while (cur != nullptr && cur < stop) {
+			if (!cur->data.empty()) {
+				SceUID threadID = cur->data.front();
+				cur->data.pop_front();
+				return threadID;
+			}
+			cur = cur->next;
+		}
+		return 0;
+	}
+};
+
+static bool TestThreadQueueOrdering() {
+	ThreadQueueList list;
+	ThreadQueueModel model;
+	std::vector<std::pair<u32, SceUID>> queued;
+	SceUID nextID = 1;
+	srand(1234);
+
+	for (int step = 0; step < 20000; ++step) {
+		int op = rand() % 8;
+		if (op <= 2 || queued.empty()) {
+			// Cluster priorities like games do, with some at both extremes of the bitmap.
+			static const u32 priorities[] = { 0, 8, 16, 31, 32, 63, 64, 65, 100, 126, 127 };
+			u32 priority = priorities[rand() % (sizeof(priorities) / sizeof(priorities[0]))];
+			SceUID threadID = nextID++;
+			list.prepare(priority);
+			if (op == 0) {
+				list.push_front(priority, threadID);
+				model.queues[priority].push_front(threadID);
+			} else {
+				list.push_back(priority, threadID);
+				model.queues[priority].push_back(threadID);
+			}
+			queued.push_back(std::make_pair(priority, threadID));
+		} else if (op == 3) {
+			u32 stop = rand() % (ThreadQueueList::NUM_QUEUES + 1);
+			SceUID actual = list.pop_first_better(stop);
+			SceUID expected = model.pop_first_better(stop);
+			if (actual != expected) {
+				printf("pop_first_better(%d) FAILED at step %d: got %d, expected %d\n", stop, step, actual, expected);
+				return false;
+			}
+		} else if (op == 4) {
+			SceUID expected = model.peek_first();
+			SceUID actual = expected == 0 ? 0 : list.pop_first();
+			model.pop_first_better(ThreadQueueList::NUM_QUEUES);
+			if (actual != expected) {
+				printf("pop_first FAILED at step %d: got %d, expected %d\n", step, actual, expected);
+				return false;
+			}
+		} else if (op == 5) {
+			const auto &entry = queued[rand() % queued.size()];
+			list.remove(entry.first, entry.second);
+			model.remove(entry.first, entry.second);
+		} else if (op == 6) {
+			u32 priority = queued[rand() % queued.size()].first;
+			list.rotate(priority);
+			model.rotate(priority);
+		}
+
+		if (list.peek_first() != model.peek_first()) {
+			printf("peek_first FAILED at step %d: got %d, expected %d\n", step, list.peek_first(), model.peek_first());
+			return false;
+		}
+		for (u32 priority : { 0, 31, 63, 64, 127 }) {
+			if (list.empty(priority) != model.queues[priority].empty()) {
+				printf("empty(%d) FAILED at step %d\n", priority, step);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool TestThreadQueueSaveState() {
+	ThreadQueueList list;
+	for (u32 priority : { 20, 70, 110 }) {
+		list.prepare(priority);
+		for (int i = 0; i < 3; ++i)
+			list.push_back(priority, priority * 10 + i);
+	}
+	list.pop_first();
+
+	std::vector<u8> saved;
+	EXPECT_TRUE(CChunkFileReader::MeasureAndSavePtr(list, &saved) == CChunkFileReader::ERROR_NONE);
+
+	ThreadQueueList loaded;
+	std::string errorString;
+	EXPECT_TRUE(CChunkFileReader::LoadPtr(&saved[0], loaded, &errorString) == CChunkFileReader::ERROR_NONE);
+	// The non-empty bitmap isn't saved, so this also checks it's rebuilt on load.
+	EXPECT_EQ_INT(loaded.pop_first_better(20), 0);
+	EXPECT_EQ_INT(loaded.pop_first_better(21), 201);
+	EXPECT_EQ_INT(loaded.pop_first(), 202);
+	EXPECT_EQ_INT(loaded.pop_first_better(110), 700);
+	EXPECT_EQ_INT(loaded.peek_first(), 701);
+	EXPECT_FALSE(loaded.empty(110));
+	return true;
+}
+
+// Not a pass/fail check, just prints the difference between the lookups.
+bool TestThreadQueueListBenchmark() {
+	// Plenty of priority levels get used over a game's life, but few threads are ready at once.
+	ThreadQueueList list;
+	ChainedThreadQueue chained;
+	for (u32 priority = 16; priority < 120; priority += 2) {
+		list.prepare(priority);
+		chained.prepare(priority);
+	}
+	list.push_back(110, 1);
+	chained.push_back(110, 1);
+
+	const int iterations = 2000000;
+	double st = time_now_d();
+	for (int i = 0; i < iterations; ++i) {
+		SceUID threadID = list.pop_first_better(120);
+		list.push_back(110, threadID);
+	}
+	double bitmapTime = time_now_d() - st;
+
+	st = time_now_d();
+	for (int i = 0; i < iterations; ++i) {
+		SceUID threadID = chained.pop_first_better(120);
+		chained.push_back(110, threadID);
+	}
+	double chainTime = time_now_d() - st;
+
+	printf("ThreadQueueList: chain walk %0.2f ns/switch, bitmap %0.2f ns/switch (%0.2fx)\n",
+		chainTime * 1e9 / iterations, bitmapTime * 1e9 / iterations, chainTime / bitmapTime);
+	return true;
+}
+
+bool TestThreadQueueList() {
+	if (!TestThreadQueueOrdering())
+		return false;
+	return TestThreadQueueSaveState();
+}
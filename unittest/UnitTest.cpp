@@ -1012,9 +1012,35 @@ bool TestRiscVEmitter();
 bool TestShaderGenerators();
 bool TestSoftwareGPUJit();
 bool TestIRPassSimplify();
+bool TestIRInterpreter();
+bool TestJitPageIndex();
+bool TestDecodedVertexCache();
+bool TestTexCache();
+bool TestCoreTiming();
+bool TestBlockAllocator();
+bool TestDeferredLog();
+bool TestKernelObjectPool();
+bool TestSyscallProfiler();
+bool TestThreadQueueList();
+bool TestMemMapBulk();
+#if PPSSPP_PLATFORM(LINUX) && !PPSSPP_PLATFORM(ANDROID)
+bool TestMemWriteWatch();
+#endif
+bool TestMemBlockInfo();
 bool TestThreadManager();
 bool TestVFS();
 
+bool TestBlockAllocatorBenchmark();
+bool TestCoreTimingBenchmark();
+bool TestDeferredLogBenchmark();
+bool TestIRInterpreterBenchmark();
+bool TestJitPageIndexBenchmark();
+bool TestKernelObjectPoolBenchmark();
+bool TestMemBlockInfoBenchmark();
+bool TestMemMapBulkBenchmark();
+bool TestTexCacheBenchmark();
+bool TestThreadQueueListBenchmark();
+
 TestItem availableTests[] = {
 #if PPSSPP_ARCH(ARM64) || PPSSPP_ARCH(AMD64) || PPSSPP_ARCH(X86)
 	TEST_ITEM(Arm64Emitter),
@@ -1035,6 +1061,21 @@ TestItem availableTests[] = {
 	TEST_ITEM(MathUtil),
 	TEST_ITEM(Parsers),
 	TEST_ITEM(IRPassSimplify),
+	TEST_ITEM(IRInterpreter),
+	TEST_ITEM(JitPageIndex),
+	TEST_ITEM(DecodedVertexCache),
+	TEST_ITEM(TexCache),
+	TEST_ITEM(CoreTiming),
+	TEST_ITEM(BlockAllocator),
+	TEST_ITEM(DeferredLog),
+	TEST_ITEM(KernelObjectPool),
+	TEST_ITEM(SyscallProfiler),
+	TEST_ITEM(ThreadQueueList),
+	TEST_ITEM(MemMapBulk),
+#if PPSSPP_PLATFORM(LINUX) && !PPSSPP_PLATFORM(ANDROID)
+	TEST_ITEM(MemWriteWatch),
+#endif
+	TEST_ITEM(MemBlockInfo),
 	TEST_ITEM(Jit),
 	TEST_ITEM(MatrixTranspose),
 	TEST_ITEM(ParseLBN),
@@ -1058,6 +1099,20 @@ TestItem availableTests[] = {
 	TEST_ITEM(IniFile),
 };
 
+// Only run when asked for by name, not part of "all".
+TestItem availableBenchmarks[] = {
+	TEST_ITEM(BlockAllocatorBenchmark),
+	TEST_ITEM(CoreTimingBenchmark),
+	TEST_ITEM(DeferredLogBenchmark),
+	TEST_ITEM(IRInterpreterBenchmark),
+	TEST_ITEM(JitPageIndexBenchmark),
+	TEST_ITEM(KernelObjectPoolBenchmark),
+	TEST_ITEM(MemBlockInfoBenchmark),
+	TEST_ITEM(MemMapBulkBenchmark),
+	TEST_ITEM(TexCacheBenchmark),
+	TEST_ITEM(ThreadQueueListBenchmark),
+};
+
 int main(int argc, const char *argv[]) {
 	SetCurrentThreadName("UnitTest");
 
@@ -1079,6 +1134,12 @@ int main(int argc, const char *argv[]) {
 				break;
 			}
 		}
+		for (auto f : availableBenchmarks) {
+			if (!strcasecmp(argv[1], f.name)) {
+				testFunc = f.func;
+				break;
+			}
+		}
 	}
 
 	if (allTests) {
@@ -1105,6 +1166,11 @@ int main(int argc, const char *argv[]) {
 		for (auto f : availableTests) {
 			fprintf(stderr, "  * %s\n", f.name);
 		}
+		fprintf(stderr, "\n");
+		fprintf(stderr, "Available benchmarks:\n");
+		for (auto f : availableBenchmarks) {
+			fprintf(stderr, "  * %s\n", f.name);
+		}
 		return 1;
 	} else {
 		if (!testFunc()) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
 #include <algorithm>
 
 inline bool rel_equal(float a, float b, float precision) {
@@ -13,6 +14,12 @@ inline bool rel_equal(float a, float b, float precision) {
 	return quot < precision;
 }
 
+// Small repeatable generator, so randomized tests and benchmarks see the same sequence every run.
+inline uint32_t NextRandom(uint32_t &seed) {
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
 
 #define EXPECT_TRUE(a) if (!(a)) { printf("%s:%i: Test Fail\n", __FUNCTION__, __LINE__); return false; }
 #define EXPECT_FALSE(a) if ((a)) { printf("%s:%i: Test Fail\n", __FUNCTION__, __LINE__); return false; }